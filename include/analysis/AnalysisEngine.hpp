@@ -0,0 +1,112 @@
+#pragma once
+
+#include "go/Board.hpp"
+#include "search/Search.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace analysis {
+
+// One line of input, in the field names of KataGo's analysis engine:
+//   {"id":"g1","boardXSize":19,"boardYSize":19,"rules":"chinese","komi":7.5,
+//    "initialStones":[["B","D4"]],"initialPlayer":"W","moves":[["W","Q16"],["B","D16"]],
+//    "analyzeTurns":[0,2],"maxVisits":400,"includeOwnership":true}
+// Only id is required. Turn t is the position after the first t moves; the default is
+// the final position. Rules are "tromp-taylor", "chinese" or "japanese".
+struct AnalysisQuery {
+    std::string id;
+    go::Rules rules;
+    std::vector<std::pair<go::Player, go::Move>> initial_stones;
+    go::Player initial_player = go::Player::Black;
+    std::vector<std::pair<go::Player, go::Move>> moves;
+    std::vector<int> analyze_turns;
+    int max_visits = 0; // 0 takes AnalysisOptions::max_visits
+    bool include_ownership = false;
+};
+
+// Throws std::invalid_argument for malformed JSON, unknown rules, non-square or
+// oversized boards and unparseable vertices. Move legality is checked on submit.
+AnalysisQuery parse_query(std::string_view line);
+
+struct AnalysisOptions {
+    int threads = 0;              // positions searched at once; 0 means one per hardware thread
+    int max_visits = 500;         // per position unless the query sets maxVisits
+    int ownership_playouts = 64;  // light playouts behind includeOwnership
+    std::size_t pv_length = 16;
+    search::SearchConfig search;  // per-position search; runs single-threaded without noise
+};
+
+// Answers analysis queries on a pool of worker threads that all share one evaluator
+// (wrap it in a search::BatchingEvaluator to batch network calls across positions).
+// Every requested turn becomes an independent single-threaded search, so throughput
+// scales with the pool instead of fighting over one tree. Each finished turn is passed
+// to the response callback as one JSON line, in completion order:
+//   {"id":..,"turnNumber":..,"rootInfo":{"visits":..,"winrate":..,"currentPlayer":"B"},
+//    "moveInfos":[{"move":"D4","visits":..,"winrate":..,"prior":..,"order":0,"pv":[..]}],
+//    "ownership":[..]}
+// Winrates are for the player to move. There is no ownership head, so ownership (row
+// by row from the top left, +1 black) comes from light playouts of the analysed
+// position. Rejected queries get {"id":..,"error":".."}. The callback is serialised.
+class AnalysisEngine {
+public:
+    using ResponseCallback = std::function<void(const std::string& line)>;
+
+    struct Counters {
+        std::uint64_t positions = 0;
+        std::uint64_t visits = 0;
+    };
+
+    AnalysisEngine(AnalysisOptions options, std::shared_ptr<search::Evaluator> evaluator, ResponseCallback respond);
+    ~AnalysisEngine();
+
+    AnalysisEngine(const AnalysisEngine&) = delete;
+    AnalysisEngine& operator=(const AnalysisEngine&) = delete;
+
+    // Parses one query line and queues its turns; returns without waiting for them.
+    void submit(std::string_view line);
+    void submit(const AnalysisQuery& query);
+
+    // Blocks until every queued turn has been answered.
+    void wait_idle();
+
+    Counters counters() const;
+    int threads() const noexcept { return static_cast<int>(workers_.size()); }
+
+private:
+    struct Task {
+        std::shared_ptr<const AnalysisQuery> query;
+        int turn = 0;
+        go::Board board;
+        go::Player to_play = go::Player::Black;
+    };
+
+    void worker_loop();
+    std::string analyze(const Task& task);
+    void respond(const std::string& line);
+    void respond_error(const std::string& id, const std::string& message);
+
+    AnalysisOptions options_;
+    std::shared_ptr<search::Evaluator> evaluator_;
+    ResponseCallback respond_;
+    std::mutex respond_mutex_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable idle_;
+    std::deque<Task> queue_;
+    int busy_ = 0;
+    bool stopping_ = false;
+    Counters counters_;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace analysis
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace analysis {
+
+// Just enough JSON for the analysis engine's queries: a parsed value tree with typed
+// accessors that throw std::invalid_argument on a type mismatch.
+class JsonValue {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    JsonValue() = default;
+    static JsonValue boolean(bool value);
+    static JsonValue number(double value);
+    static JsonValue string(std::string value);
+    static JsonValue array(std::vector<JsonValue> items);
+    static JsonValue object(std::vector<std::pair<std::string, JsonValue>> members);
+
+    Type type() const noexcept { return type_; }
+    bool is_null() const noexcept { return type_ == Type::Null; }
+
+    bool as_bool() const;
+    double as_number() const;
+    // A number that is integral and fits an int.
+    int as_int() const;
+    const std::string& as_string() const;
+    const std::vector<JsonValue>& as_array() const;
+    const std::vector<std::pair<std::string, JsonValue>>& as_object() const;
+
+    // The member called key of an object, nullptr when absent (last one wins on duplicates).
+    const JsonValue* find(std::string_view key) const;
+
+private:
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    double number_ = 0.0;
+    std::string string_;
+    std::vector<JsonValue> items_;
+    std::vector<std::pair<std::string, JsonValue>> members_;
+};
+
+// Parses one complete JSON text. Throws std::invalid_argument naming the offset of the
+// first error; nesting deeper than 64 levels is rejected rather than recursed into.
+JsonValue parse_json(std::string_view text);
+
+// Writes text as a quoted JSON string, escaping quotes, backslashes and control characters.
+void write_json_string(std::ostream& out, std::string_view text);
+
+} // namespace analysis
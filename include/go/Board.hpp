@@ -1,6 +1,7 @@
 #pragma once
 
 #include "go/Rules.hpp"
+#include "go/Symmetry.hpp"
 #include "go/Zobrist.hpp"
 
 #include <array>
@@ -43,48 +44,148 @@ public:
     explicit Board(const Rules& rules = {});
 
     void clear();
+    // Replaces the stones without replaying moves; the move history restarts at this position.
+    void set_position(const std::vector<PointState>& points, Player to_play, std::optional<int> ko_vertex = std::nullopt);
 
     bool play_move(Player player, Move move);
+    // Decided from the chain bookkeeping without touching the position.
     bool is_legal(Player player, Move move) const;
 
     std::size_t board_size() const noexcept { return rules_.board_size; }
     const Rules& rules() const noexcept { return rules_; }
+    // Changes komi, ko, suicide or scoring rules in place, keeping the position and its
+    // history. Moves already played stay played; the new rules govern the next ones.
+    // Throws std::invalid_argument if the board size differs.
+    void set_rules(const Rules& rules);
 
     PointState point_state(std::size_t vertex) const;
+    const std::vector<PointState>& points() const noexcept { return board_; }
+    // Liberties of the chain through vertex, kept up to date move by move; 0 for empty points.
+    int liberties(std::size_t vertex) const noexcept {
+        return board_[vertex] == PointState::Empty ? 0 : chain_liberties_[static_cast<std::size_t>(chain_head_[vertex])];
+    }
+
+    // The last kRecentMoves moves, age 0 being the most recent; std::nullopt before the
+    // start of the game (or of set_position()).
+    static constexpr std::size_t kRecentMoves = 8;
+    std::optional<Move> recent_move(std::size_t age) const noexcept;
     Player to_play() const noexcept { return to_play_; }
     void set_to_play(Player player);
     std::optional<int> ko_vertex() const noexcept { return ko_vertex_; }
 
-    std::uint64_t position_hash() const noexcept { return position_hash_; }
+    std::uint64_t position_hash() const noexcept { return hashes_[0]; }
     std::uint64_t state_key() const noexcept;
+    // position_hash() of the board transformed by `symmetry`, maintained incrementally.
+    std::uint64_t symmetric_position_hash(int symmetry) const noexcept {
+        return hashes_[static_cast<std::size_t>(symmetry)];
+    }
+    // Equal for all eight orientations of a position with the same side to move.
+    CanonicalKey canonical_state_key(Player to_play) const noexcept;
+    CanonicalKey canonical_state_key() const noexcept { return canonical_state_key(to_play_); }
+
+    // The position mapped through `symmetry`, including the ko point and recent moves.
+    // The superko history does not carry over.
+    Board transformed(int symmetry) const;
     const std::unordered_set<std::uint64_t>& seen_positions() const noexcept { return position_history_; }
 
+    // Area score with komi added to White; see go/Scoring.hpp for the allocation-free
+    // engine behind it and a variant that also fills an ownership map.
     ScoreResult tromp_taylor_score() const;
 
+    // 3x3 pattern codes (see go/Pattern.hpp) for every point, updated as stones come and
+    // go. Off by default: tracking adds work to every move and to every board copy.
+    void set_pattern_tracking(bool enabled);
+    bool tracks_patterns() const noexcept { return !patterns_.empty(); }
+    // Only while tracks_patterns(); meaningful for empty points.
+    std::uint32_t pattern(std::size_t vertex) const noexcept { return patterns_[vertex]; }
+
+    // Records what each move changed so undo() can take it back. Off by default: the
+    // log grows with every move and is copied with the board. Like the superko history,
+    // it restarts at clear() and set_position().
+    void set_undo_log(bool enabled);
+    bool keeps_undo_log() const noexcept { return undo_enabled_; }
+    // Moves undo() can still take back.
+    std::size_t undo_depth() const noexcept { return undo_log_.size(); }
+    // Restores the position, side to move, ko point, recent moves and superko history
+    // from before the last logged move; false when there is none.
+    bool undo();
+
 private:
-    std::size_t index(std::size_t x, std::size_t y) const noexcept;
-    bool in_bounds(int x, int y) const noexcept;
-    std::vector<int> neighbors(int vertex) const;
-    int count_liberties(int vertex, PointState color, std::vector<bool>& visited, std::vector<bool>& liberty_visited) const;
-    int collect_group(int vertex, PointState color, std::vector<int>& out_vertices) const;
+    // Up to four on-board neighbours per vertex, -1 past the edge; shared by all boards
+    // of one size.
+    using Adjacency = std::array<int, 4>;
+    // The eight neighbours in pattern slot order, -1 past the edge.
+    using PatternNeighbors = std::array<int, 8>;
+
+    // What a stone at a vertex would do, worked out before anything is changed.
+    struct MoveEffect {
+        std::array<int, 4> captured{}; // heads of the opponent chains it takes
+        int captured_chains = 0;
+        int captured_stones = 0;
+        std::optional<int> ko;
+        std::uint64_t hash = 0; // position_hash() after the move
+    };
+
+    // One logged move. The stones it captured are undo_captures_[captures, next record's).
+    struct UndoRecord {
+        int vertex = -1; // -1 for a pass
+        Player player = Player::Black;
+        Player to_play = Player::Black; // side to move before the move
+        std::optional<int> ko;          // ko point before the move
+        int dropped_recent = 0;         // recent move pushed out of the window
+        bool new_position = false;      // the move added its position to the superko history
+        std::uint32_t captures = 0;
+    };
+
+    bool analyze_move(Player player, int vertex, MoveEffect& effect) const;
 
     bool violates_superko(std::uint64_t prospective_hash) const;
 
     void place_stone(int vertex, PointState color);
     void remove_stone(int vertex);
+    void remove_chain(int head);
+    void merge_chains(int head, int other_head);
+    int count_chain_liberties(int head) const;
+    void rebuild_chains();
     void set_ko(std::optional<int> vertex);
+    void toggle_stone_hash(int vertex, PointState color);
+    void toggle_ko_hash(int vertex);
+    void record_move(int vertex);
+    void log_undo(Player player, int vertex);
+    // Relinks every chain from the stones alone, for positions not reached by a move.
+    void relink_chains();
+    void rebuild_patterns();
+    void set_pattern_color(int vertex, std::uint32_t color);
+    void refresh_atari_flags(int head);
 
     Rules rules_{};
     std::size_t board_len_ = 0;
     std::vector<PointState> board_;
+    const Adjacency* adjacency_ = nullptr;
+
+    // Chains are circular lists through chain_next_; chain_head_ names the representative
+    // whose chain_liberties_ / chain_stones_ entries are current.
+    std::vector<int> chain_head_;
+    std::vector<int> chain_next_;
+    std::vector<int> chain_liberties_;
+    std::vector<int> chain_stones_;
+    std::array<int, kRecentMoves> recent_moves_{};
 
     Player to_play_ = Player::Black;
     std::optional<int> ko_vertex_;
 
-    ZobristTable zobrist_;
-    std::uint64_t position_hash_ = 0;
+    const ZobristTable* zobrist_ = nullptr;
+    const SymmetryMap* symmetry_ = nullptr;
+    std::array<std::uint64_t, kSymmetries> hashes_{}; // [0] is position_hash()
     std::unordered_set<std::uint64_t> position_history_;
     std::vector<std::uint64_t> history_stack_;
+
+    const PatternNeighbors* pattern_neighbors_ = nullptr;
+    std::vector<std::uint32_t> patterns_; // empty unless tracking
+
+    bool undo_enabled_ = false;
+    std::vector<UndoRecord> undo_log_;
+    std::vector<int> undo_captures_;
 };
 
 Player other(Player p);
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "go/Board.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace go {
+
+// Reads ladders: the attacker keeps the prey chain in atari, the defender may only extend
+// from atari or capture an attacking chain that is itself in atari. Moves are played on
+// a private padded copy of the position and taken back from an undo log, so after
+// reset() no query allocates. Simple ko is respected and suicide is never played. A
+// reading that exceeds kNodeBudget positions, or would overflow the undo log, is
+// abandoned and counts as an escape; aborted() tells such answers apart.
+class LadderReader {
+public:
+    static constexpr std::size_t kMaxSize = 25;
+    static constexpr std::size_t kMaxPoints = (kMaxSize + 2) * (kMaxSize + 2);
+    static constexpr int kNodeBudget = 2000;
+    static constexpr std::size_t kMaxLog = 4096;
+
+    LadderReader() = default;
+    explicit LadderReader(const Board& board) { reset(board); }
+
+    // Copies the stones and ko point of board; queries then read from this position.
+    void reset(const Board& board);
+
+    // Whether the chain through vertex dies in a ladder with to_move playing next: the
+    // owner to move means escaping from atari, the opponent to move means chasing a
+    // chain with two liberties (or taking one with one). Chains with more liberties,
+    // and two-liberty chains whose owner moves, are never captured.
+    bool captured(std::size_t vertex, Player to_move);
+    // attacker playing at the empty vertex ataris an opponent chain that then cannot
+    // escape the ladder.
+    bool is_capture_move(Player attacker, std::size_t vertex);
+    // defender extending at vertex, the liberty of an own chain in atari, leaves a chain
+    // that the opponent still captures in a ladder.
+    bool is_failed_escape(Player defender, std::size_t vertex);
+
+    // Whether the last query was abandoned, over kNodeBudget or out of undo log, and so
+    // answered as an escape rather than read out.
+    bool aborted() const noexcept { return aborted_; }
+    // Undo log entries a reading may hold, at most kMaxLog. A move is only played with
+    // room for a whole-board capture left, so the limit also bounds the reading depth.
+    void set_log_limit(std::size_t entries) noexcept { log_limit_ = std::min(entries, kMaxLog); }
+
+    // Positions visited by all queries since reset().
+    std::uint64_t nodes() const noexcept { return total_nodes_; }
+
+private:
+    enum Color : std::uint8_t {
+        Empty = 0,
+        Black = 1,
+        White = 2,
+        Off = 3
+    };
+
+    struct Change {
+        std::uint16_t point;
+        std::uint8_t color;
+    };
+
+    std::size_t padded(std::size_t vertex) const noexcept { return (vertex / size_ + 1) * stride_ + vertex % size_ + 1; }
+    static std::uint8_t color_of(Player player) noexcept { return player == Player::Black ? Black : White; }
+    static std::uint8_t opponent_of(std::uint8_t color) noexcept { return color == Black ? White : Black; }
+
+    // Liberties of the chain through point, up to `limit` of them written to libs;
+    // returns how many were found, at most limit.
+    int liberties(std::size_t point, std::size_t* libs, int limit);
+    // Plays color at point unless it is occupied, the ko point or suicide; on success
+    // the change is logged for undo_to(). Without room in the log it aborts the reading.
+    bool play(std::size_t point, std::uint8_t color);
+    void undo_to(std::size_t log_size, int ko) noexcept;
+    void set(std::size_t point, std::uint8_t color) noexcept;
+
+    bool defender_loses(std::size_t prey, int depth);
+    bool attacker_wins(std::size_t prey, int depth);
+    bool over_budget() noexcept {
+        aborted_ = aborted_ || ++nodes_ > kNodeBudget;
+        return aborted_;
+    }
+    void start_query() noexcept {
+        nodes_ = 0;
+        aborted_ = false;
+    }
+
+    std::size_t size_ = 0;
+    std::size_t stride_ = 0;
+    std::array<std::ptrdiff_t, 4> offsets_{};
+    int ko_ = -1;
+    int nodes_ = 0;
+    bool aborted_ = false;
+    std::uint64_t total_nodes_ = 0;
+
+    std::array<std::uint8_t, kMaxPoints> color_{};
+    // Flood-fill stamps and stack.
+    std::array<std::uint32_t, kMaxPoints> mark_{};
+    std::uint32_t epoch_ = 0;
+    std::array<std::uint16_t, kMaxPoints> stack_{};
+
+    std::array<Change, kMaxLog> log_{};
+    std::size_t log_size_ = 0;
+    std::size_t log_limit_ = kMaxLog;
+};
+
+// One-off queries through a per-thread reader; prefer a LadderReader when asking
+// several questions about the same position.
+bool ladder_captured(const Board& board, std::size_t vertex, Player to_move);
+bool is_ladder_capture(const Board& board, Player attacker, std::size_t vertex);
+bool is_failed_ladder_escape(const Board& board, Player defender, std::size_t vertex);
+
+} // namespace go
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "go/Board.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace go {
+
+// Pass-alive chains and territory by Benson's algorithm, for both colours. A chain is
+// pass-alive when it keeps two vital regions (non-own regions whose every empty point
+// is its liberty) through the iterative pruning, so it cannot be captured even if its
+// owner always passes. A region bordered only by pass-alive chains whose every empty
+// point touches one of them is pass-alive territory: the opponent can never make an eye
+// there, and stones of theirs inside are dead.
+class PassAliveMap {
+public:
+    // Recomputes from board unless it holds the same stones as at the previous update;
+    // between moves and after passes this is a hash comparison.
+    void update(const Board& board);
+
+    // +1 black, -1 white, 0 unsettled; covers pass-alive stones and territory, including
+    // the dead stones inside it.
+    std::int8_t owner(std::size_t vertex) const noexcept { return owner_[vertex]; }
+    // board_size^2 entries, as owner().
+    const std::int8_t* owners() const noexcept { return owner_.data(); }
+    // Settled points whose territory still holds dead opponent stones to capture.
+    bool holds_dead_stones(std::size_t vertex) const noexcept { return dead_[vertex] != 0; }
+    std::size_t settled_count() const noexcept { return settled_count_; }
+
+    // Moves that cannot change who owns the point: inside the opponent's settled area,
+    // or inside player's own territory when there is nothing left to capture there.
+    bool is_pointless(Player player, std::size_t vertex) const noexcept {
+        const std::int8_t own = player == Player::Black ? 1 : -1;
+        return owner_[vertex] != 0 && (owner_[vertex] != own || dead_[vertex] == 0);
+    }
+
+    // Full Benson passes run so far; updates answered from the cache do not count.
+    std::uint64_t computations() const noexcept { return computations_; }
+
+private:
+    struct Border {
+        int region;
+        int chain;
+        int empty_neighbors; // empty points of region next to chain
+    };
+
+    void compute(const Board& board, PointState color);
+
+    std::size_t size_ = 0;
+    std::uint64_t hash_ = 0;
+    bool valid_ = false;
+    std::uint64_t computations_ = 0;
+
+    std::vector<std::int8_t> owner_;
+    std::vector<std::uint8_t> dead_;
+    std::size_t settled_count_ = 0;
+
+    // Scratch reused across computations.
+    std::vector<int> chain_of_;
+    std::vector<int> region_of_;
+    std::vector<int> stack_;
+    std::vector<int> region_empty_;
+    std::vector<std::uint8_t> region_enclosed_; // every empty point touches the colour
+    std::vector<std::uint8_t> region_live_;
+    std::vector<std::uint8_t> chain_live_;
+    std::vector<int> vital_count_;
+    std::vector<int> border_stamp_;
+    std::vector<Border> borders_;
+};
+
+// The calling thread's map, updated for board. Search expansion and rollout evaluation
+// of the same position on one thread share a single computation.
+const PassAliveMap& pass_alive_map(const Board& board);
+
+} // namespace go
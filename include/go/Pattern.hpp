@@ -0,0 +1,49 @@
+#pragma once
+
+#include "go/Board.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace go {
+
+// The 3x3 neighbourhood of a point packed into 20 bits. Bits 2i..2i+1 hold the colour of
+// neighbour slot i (0 empty, 1 black, 2 white, 3 off the board), with the slots ordered
+// N, E, S, W, NE, SE, SW, NW (north being row 0). Bit 16+i is set when orthogonal
+// neighbour i is a stone whose chain has exactly one liberty.
+constexpr int kPatternSlots = 8;
+constexpr int kPatternBits = 20;
+constexpr std::uint32_t kPatternCount = 1u << kPatternBits;
+constexpr std::uint32_t kPatternOff = 3;
+
+// (dx, dy) of each slot.
+constexpr std::array<std::array<int, 2>, kPatternSlots> kPatternOffsets{
+    {{0, -1}, {1, 0}, {0, 1}, {-1, 0}, {1, -1}, {1, 1}, {-1, 1}, {-1, -1}}};
+
+// The slot that sees this point from neighbour `slot`.
+constexpr int opposite_slot(int slot) {
+    return slot < 4 ? (slot + 2) % 4 : 4 + (slot - 2) % 4;
+}
+
+constexpr std::uint32_t pattern_color(std::uint32_t code, int slot) {
+    return (code >> (2 * slot)) & 3u;
+}
+
+constexpr bool pattern_atari(std::uint32_t code, int slot) {
+    return ((code >> (16 + slot)) & 1u) != 0;
+}
+
+// Recomputed from the stones and liberties of board; Board::pattern() keeps the same
+// codes up to date move by move.
+std::uint32_t compute_pattern(const Board& board, std::size_t vertex);
+
+// The neighbourhood as seen by `player`: black and white swapped when player is white,
+// so 1 always means the player's stones.
+std::uint32_t pattern_for_player(std::uint32_t code, Player player);
+
+// The code of the same neighbourhood after applying board symmetry `symmetry` (see
+// Symmetry.hpp).
+std::uint32_t transform_pattern(std::uint32_t code, int symmetry);
+
+} // namespace go
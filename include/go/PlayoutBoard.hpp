@@ -0,0 +1,130 @@
+#pragma once
+
+#include "go/Board.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace go {
+
+// xorshift64* with Lemire's range reduction; cheap enough to call once per playout move.
+class PlayoutRng {
+public:
+    PlayoutRng() noexcept : PlayoutRng(0x5eed1234u) {}
+    explicit PlayoutRng(std::uint64_t seed) noexcept : state_(seed ? seed : 0x9e3779b97f4a7c15ull) {}
+
+    std::uint32_t next() noexcept {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return static_cast<std::uint32_t>((state_ * 0x2545f4914f6cdd1dull) >> 32);
+    }
+
+    // Uniform in [0, bound).
+    std::uint32_t below(std::uint32_t bound) noexcept {
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>(next()) * bound) >> 32);
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+// Stripped-down board for light Monte-Carlo playouts. Points live on a grid padded with
+// one ring of off-board sentinels, chains track pseudo-liberties (one per stone/empty
+// adjacency) plus their vertex sum and sum of squares, which is enough to spot a chain in
+// atari without listing its liberties. Simple ko only, no hashes or history, and nothing
+// allocates after construction, so one board per thread can be reset from a go::Board
+// and played out over and over.
+class PlayoutBoard {
+public:
+    static constexpr std::size_t kMaxSize = 25;
+    static constexpr std::size_t kMaxPoints = (kMaxSize + 2) * (kMaxSize + 2);
+
+    PlayoutBoard() = default;
+
+    // Copies the stones, ko point and komi of board; to_play moves first.
+    void reset(const Board& board, Player to_play);
+    // Marks settled points from board_size^2 owners (+1 black, -1 white, 0 open), e.g.
+    // go::PassAliveMap::owners(). play_random() never plays on them and score() counts
+    // them for their owner whatever stands there. Cleared by reset().
+    void settle(const std::int8_t* owners) noexcept;
+
+    std::size_t board_size() const noexcept { return size_; }
+    Player to_play() const noexcept { return to_play_; }
+    // Empty points outside settled areas.
+    std::size_t empty_count() const noexcept { return empty_count_; }
+
+    // Translation between go::Board vertices and the padded grid.
+    int padded(std::size_t vertex) const noexcept {
+        return static_cast<int>((vertex / size_ + 1) * stride_ + vertex % size_ + 1);
+    }
+    std::size_t unpadded(int point) const noexcept {
+        const std::size_t p = static_cast<std::size_t>(point);
+        return (p / stride_ - 1) * size_ + p % stride_ - 1;
+    }
+    PointState point_state(std::size_t vertex) const noexcept;
+
+    // Legal under simple ko with suicide forbidden.
+    bool is_legal(int point, Player player) const noexcept;
+    // A point whose four neighbours are player's (or the edge) and at most one diagonal
+    // is the opponent's (none on the edge), i.e. an eye playouts should not fill.
+    bool is_eye(int point, Player player) const noexcept;
+
+    // point must satisfy is_legal(point, to_play()).
+    void play(int point);
+    void pass() noexcept;
+    // Plays a uniformly random legal move for to_play() that does not fill its own eye,
+    // or passes when there is none. Returns the padded point played, -1 for a pass.
+    int play_random(PlayoutRng& rng);
+
+    // Tromp-Taylor area score, black minus white minus komi. When ownership is given it
+    // receives board_size^2 entries: +1 black, -1 white, 0 neutral.
+    float score(std::int8_t* ownership = nullptr) const;
+
+private:
+    enum Color : std::uint8_t {
+        Empty = 0,
+        Black = 1,
+        White = 2,
+        Off = 3
+    };
+
+    static std::uint8_t color_of(Player player) noexcept { return player == Player::Black ? Black : White; }
+
+    bool in_atari(int head) const noexcept {
+        const std::size_t h = static_cast<std::size_t>(head);
+        return static_cast<std::uint64_t>(lib_sum_[h]) * lib_sum_[h] == lib_sum_sq_[h] * libs_[h];
+    }
+
+    void add_liberty(int head, int point) noexcept;
+    void remove_liberty(int head, int point) noexcept;
+    void add_empty(int point) noexcept;
+    void remove_empty(int point) noexcept;
+    void merge_chains(int keep, int other) noexcept;
+    int remove_chain(int head) noexcept;
+
+    std::size_t size_ = 0;
+    std::size_t stride_ = 0;
+    std::array<int, 4> offsets_{};
+    Player to_play_ = Player::Black;
+    int ko_ = -1;
+    float komi_ = 0.0f;
+
+    std::array<std::uint8_t, kMaxPoints> color_{};
+    std::array<std::uint16_t, kMaxPoints> head_{};
+    std::array<std::uint16_t, kMaxPoints> next_{};
+    // Valid at chain heads.
+    std::array<std::uint16_t, kMaxPoints> stones_{};
+    std::array<std::uint32_t, kMaxPoints> libs_{};
+    std::array<std::uint32_t, kMaxPoints> lib_sum_{};
+    std::array<std::uint64_t, kMaxPoints> lib_sum_sq_{};
+
+    std::array<std::int8_t, kMaxPoints> settled_{};
+
+    std::array<std::uint16_t, kMaxPoints> empty_{};
+    std::array<std::uint16_t, kMaxPoints> empty_index_{};
+    std::size_t empty_count_ = 0;
+};
+
+} // namespace go
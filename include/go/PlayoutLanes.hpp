@@ -0,0 +1,104 @@
+#pragma once
+
+#include "go/Board.hpp"
+#include "go/PlayoutBoard.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace go {
+
+// Lanes independent light playouts advanced in lockstep on row bitboards. Each colour
+// holds one 32-bit word per board row and lane, rows outermost and lanes innermost, so
+// the whole-board work of a move runs over contiguous lane vectors that compile to SIMD:
+// the candidate mask with its eye test, the chain floods that look for liberties and
+// captures, and the Tromp-Taylor fill of score_all. Per lane there is only the random
+// pick and a look at the move's four neighbours, which settles most moves before any
+// flood is needed.
+//
+// Rules and move choice match PlayoutBoard: simple ko, no suicide, uniformly random moves
+// that never fill the mover's own eye. Every running lane moves (or passes) once per
+// step, so all running lanes share the side to move. Instantiated for 8 and 16 lanes.
+template <std::size_t Lanes>
+class PlayoutLanes {
+public:
+    static constexpr std::size_t kLanes = Lanes;
+    static constexpr std::size_t kMaxSize = PlayoutBoard::kMaxSize;
+    static constexpr int kNoMove = -2;
+
+    // Every lane starts from board with to_play moving; lane i draws from its own stream
+    // derived from seed.
+    void reset(const Board& board, Player to_play, std::uint64_t seed);
+
+    // Plays up to `moves` moves in every lane that is still running; a lane stops after
+    // two passes in a row or max_moves moves. Returns the number of lanes still running.
+    std::size_t play_random_moves(int moves);
+    // Runs every lane to completion.
+    void play_out() { while (play_random_moves(64) > 0) {} }
+    void set_max_moves(int max_moves) noexcept { max_moves_ = max_moves; }
+
+    // Tromp-Taylor black minus white minus komi for every lane. ownership, when given,
+    // receives Lanes * board_size^2 entries (lane-major): +1 black, -1 white, 0 neutral.
+    void score_all(float* scores, std::int8_t* ownership = nullptr) const;
+
+    std::size_t board_size() const noexcept { return size_; }
+    bool running(std::size_t lane) const noexcept { return running_[lane]; }
+    Player to_play(std::size_t lane) const noexcept { return to_play_[lane]; }
+    int moves_played(std::size_t lane) const noexcept { return moves_[lane]; }
+    // go::Board vertex of the lane's move in the last play_random_moves step: -1 for a
+    // pass, kNoMove if the lane had already stopped.
+    int last_move(std::size_t lane) const noexcept { return last_move_[lane]; }
+    PointState point_state(std::size_t lane, std::size_t vertex) const noexcept;
+    bool is_legal(std::size_t lane, std::size_t vertex, Player player) const noexcept;
+
+private:
+    using Row = std::array<std::uint32_t, Lanes>;
+    using Rows = std::array<Row, kMaxSize>;
+
+    void step();
+    // Grows chain through passable, lane by lane, until each lane's chain touches a point
+    // of open or stops growing; the seeds stay in the chain whether passable or not.
+    // Returns all ones for the lanes that touched one.
+    Row find_liberties(Rows& chain, const Rows& passable, const Rows& open) const noexcept;
+    // An empty point other than (skip_y, skip_bit) next to the lane's chain of stones
+    // through (y, bit), as a go::Board vertex, or -1 if there is none. With eye_first the
+    // whole chain is searched for a liberty that only the chain's stones surround, which
+    // rarely gets filled; any liberty is taken if there is none.
+    int liberty(std::size_t lane, const Rows& stones, std::size_t y, std::uint32_t bit, std::size_t skip_y,
+                std::uint32_t skip_bit, bool eye_first = false) const noexcept;
+    // Drops the suicides known for player (a Player as index) in lane.
+    void forget(std::size_t player, std::size_t lane) noexcept;
+    // Floods reach through passable until no lane changes.
+    void fill(Rows& reach, const Rows& passable) const noexcept;
+
+    std::size_t size_ = 0;
+    std::uint32_t row_mask_ = 0;
+    float komi_ = 0.0f;
+    int max_moves_ = 0; // 0 means three times the board area
+    Player player_ = Player::Black;
+
+    Rows black_{};
+    Rows white_{};
+    // Candidates of the current step; points found to be suicide are cleared on retry.
+    Rows candidates_{};
+    // Per player: points surrounded by opponent stones that were found to be suicide, and
+    // the liberties of those stones' chains that proved it. A point stays suicide until
+    // the lane fills one of those liberties or captures a stone next to it, so later steps
+    // leave it out of the candidates.
+    std::array<Rows, 2> suicide_{};
+    std::array<Rows, 2> witnesses_{};
+
+    std::array<int, Lanes> ko_{};
+    std::array<int, Lanes> passes_{};
+    std::array<int, Lanes> moves_{};
+    std::array<int, Lanes> last_move_{};
+    std::array<bool, Lanes> running_{};
+    std::array<Player, Lanes> to_play_{};
+    std::array<PlayoutRng, Lanes> rng_{};
+};
+
+extern template class PlayoutLanes<8>;
+extern template class PlayoutLanes<16>;
+
+} // namespace go
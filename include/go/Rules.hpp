@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 namespace go {
 
@@ -20,7 +22,16 @@ struct Rules {
     bool allow_suicide = false;
     KoRule ko_rule = KoRule::PositionalSuperko;
     ScoringRule scoring_rule = ScoringRule::TrompTaylorArea;
+
+    bool operator==(const Rules&) const = default;
 };
 
-} // namespace go
+// Mixes every field into 64 bits, for keys that must tell apart evaluations of the same
+// stones under different rules. Equal rules hash equal; 0 is never returned.
+std::uint64_t rules_hash(const Rules& rules) noexcept;
 
+// Sets the ko, suicide and scoring rules named by "tromp-taylor", "chinese" or "japanese",
+// leaving the board size and komi alone. Throws std::invalid_argument for other names.
+void apply_rules_name(Rules& rules, std::string_view name);
+
+} // namespace go
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "go/Board.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace go {
+
+// Tromp-Taylor area scoring on row bitboards: each colour's stones are flooded through
+// the empty points, row by row with a horizontal fill inside each row, until nothing
+// changes. An empty point reached by one colour only is that colour's territory. Works
+// on the stack for every board size up to 25 and never allocates.
+//
+// Matches Board::tromp_taylor_score(), which is implemented on top of it. When ownership
+// is given it receives board_size^2 entries: +1 black, -1 white, 0 neutral.
+ScoreResult score_area(const Board& board, std::int8_t* ownership = nullptr);
+
+// Scores count boards into scores[0..count). Ownership, when given, is written board
+// after board, each taking board_size^2 entries of its own board.
+void score_area_batch(const Board* const* boards, std::size_t count, ScoreResult* scores,
+                      std::int8_t* ownership = nullptr);
+
+} // namespace go
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace go {
+
+// The eight dihedral symmetries of the board. Symmetry s transposes the board when bit 2
+// is set, then mirrors x when bit 0 is set and y when bit 1 is set; 0 is the identity.
+constexpr int kSymmetries = 8;
+
+using SymmetryMap = std::array<int, kSymmetries>;
+
+// table[vertex][s] is the image of vertex under symmetry s; shared by all boards of one
+// size (1-25), throws std::invalid_argument otherwise.
+const SymmetryMap* symmetry_table(std::size_t board_size);
+
+int transform_vertex(int vertex, int symmetry, std::size_t board_size);
+
+constexpr int inverse_symmetry(int symmetry) {
+    // Mirrors commute with each other, but applied after a transpose they swap axes.
+    return symmetry < 4 ? symmetry : 4 | ((symmetry & 1) << 1) | ((symmetry & 2) >> 1);
+}
+
+// The smallest of a position's eight symmetric keys, and the symmetry that maps the
+// position onto that canonical orientation.
+struct CanonicalKey {
+    std::uint64_t key = 0;
+    int symmetry = 0;
+};
+
+} // namespace go
@@ -7,8 +7,12 @@
 class ZobristTable {
 public:
     ZobristTable() = default;
+    // Deterministic for a given board size.
     explicit ZobristTable(std::size_t board_size);
 
+    // Shared, immutable table for board sizes 1-25; throws std::invalid_argument otherwise.
+    static const ZobristTable& for_board_size(std::size_t board_size);
+
     std::uint64_t black_stone_hash(std::size_t vertex) const;
     std::uint64_t white_stone_hash(std::size_t vertex) const;
     std::uint64_t ko_hash(std::size_t vertex) const;
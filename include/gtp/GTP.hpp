@@ -2,15 +2,35 @@
 
 #include "go/Board.hpp"
 #include "search/Search.hpp"
+#include "sgf/SGF.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iosfwd>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace gtp {
 
+// Latency of the genmove searches one session has run. queue_wait is the time a search
+// waited for its first pool worker, so it stays zero without a shared scheduler.
+struct SessionMetrics {
+    std::uint64_t searches = 0;
+    std::chrono::nanoseconds search_time{0};
+    std::chrono::nanoseconds max_search_time{0};
+    std::chrono::nanoseconds queue_wait{0};
+    std::chrono::nanoseconds max_queue_wait{0};
+
+    void add(const SessionMetrics& other);
+};
+
 class Server {
 public:
     Server(go::Board board,
@@ -18,9 +38,22 @@ public:
            std::ostream& out,
            search::SearchConfig search_config = {},
            std::shared_ptr<search::Evaluator> evaluator = nullptr);
+    ~Server();
 
+    // Reads commands until quit or end of input. lz-analyze and kata-analyze answer with
+    // a stream of info lines from a background search; the next command line stops it,
+    // closes the response with an empty line and is then handled as usual.
     void run();
 
+    // Merges statistics from out-of-process searches (see search::DistributedCoordinator) into genmove.
+    void set_root_contributor(std::shared_ptr<search::RootSearchContributor> contributor);
+
+    // Runs searches on a pool shared with other sessions (see gtp::SessionServer).
+    void set_scheduler(std::shared_ptr<search::SearchScheduler> scheduler);
+
+    // Safe to call from other threads while run() is serving commands.
+    SessionMetrics metrics() const;
+
 private:
     using HandlerResult = std::pair<bool, std::string>;
     using Handler = std::function<HandlerResult(const std::string& args)>;
@@ -31,11 +64,35 @@ private:
     HandlerResult handle_boardsize(const std::string& args);
     HandlerResult handle_clear_board(const std::string& args);
     HandlerResult handle_komi(const std::string& args);
+    HandlerResult handle_kgs_rules(const std::string& args);
     HandlerResult handle_play(const std::string& args);
     HandlerResult handle_genmove(const std::string& args);
     HandlerResult handle_final_score(const std::string& args);
     HandlerResult handle_showboard(const std::string& args);
     HandlerResult handle_quit(const std::string& args);
+    HandlerResult handle_tenuki_stats(const std::string& args);
+    HandlerResult handle_tenuki_trace(const std::string& args);
+    HandlerResult handle_tenuki_session_stats(const std::string& args);
+    HandlerResult handle_tenuki_set(const std::string& args);
+    HandlerResult handle_loadsgf(const std::string& args);
+    HandlerResult handle_printsgf(const std::string& args);
+    HandlerResult handle_undo(const std::string& args);
+    HandlerResult handle_gg_undo(const std::string& args);
+    HandlerResult undo_moves(std::size_t count);
+    HandlerResult handle_lz_analyze(const std::string& args);
+    HandlerResult handle_kata_analyze(const std::string& args);
+
+    struct AnalysisRequest {
+        go::Player color = go::Player::Black;
+        int interval_centiseconds = 100;
+        std::size_t max_moves = 0; // 0 reports every visited move
+        bool kata = false;
+    };
+
+    HandlerResult parse_analysis_request(const std::string& args, bool kata);
+    void start_analysis(const std::string& id);
+    void stop_analysis();
+    std::string format_analysis(const std::vector<search::MoveAnalysis>& moves, const AnalysisRequest& request) const;
 
     std::pair<bool, go::Move> parse_vertex(const std::string& vertex) const;
     std::string vertex_to_string(int vertex) const;
@@ -44,6 +101,11 @@ private:
 
     void register_handlers();
     void reset_search();
+    // Applies komi or rule changes to the current game without resetting it; the search
+    // switches to the tree kept for the new rules, if any (see SearchAgent::notify_position).
+    void change_rules(const go::Rules& rules);
+    // An empty board that keeps an undo log, tracking patterns if the current board does.
+    go::Board fresh_board(const go::Rules& rules) const;
 
     go::Board board_;
     std::istream& in_;
@@ -52,6 +114,13 @@ private:
     std::unique_ptr<search::SearchAgent> search_agent_;
     search::SearchConfig search_config_{};
     int move_number_ = 0;
+    std::vector<sgf::MoveRecord> history_; // moves since the board was last set up, for printsgf
+    sgf::Setup setup_;                     // stones that set-up placed, for printsgf
+    std::optional<AnalysisRequest> analysis_request_; // set by a handler, started by run()
+    std::thread analysis_thread_;
+    std::atomic<bool> analysis_stop_{false};
+    mutable std::mutex metrics_mutex_;
+    SessionMetrics metrics_; // guarded by metrics_mutex_
 };
 
 } // namespace gtp
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "go/Rules.hpp"
+#include "gtp/GTP.hpp"
+#include "search/Scheduler.hpp"
+#include "search/Search.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gtp {
+
+struct SessionServerOptions {
+    go::Rules rules;             // board every new session starts from
+    bool track_patterns = false; // see go::Board::set_pattern_tracking
+    search::SearchConfig search; // num_threads caps the pool workers one search may use
+    int backlog = 64;
+};
+
+// Serves many GTP sessions on one unix or tcp endpoint (see search::listen_on_endpoint).
+// Each connection gets its own gtp::Server, with its own board and search tree, read
+// and written on a thread of its own. Every session's searches run as jobs on one
+// shared search::SearchScheduler and evaluate through one shared evaluator, so the
+// host runs a fixed number of search threads however many games are open, and a
+// search::BatchingEvaluator in front of the backend batches leaves across games.
+class SessionServer {
+public:
+    // Sessions so far, over finished and running ones alike. Means are per search.
+    struct Stats {
+        std::uint64_t sessions_started = 0;
+        std::uint64_t sessions_active = 0;
+        SessionMetrics searches;
+    };
+
+    SessionServer(std::string endpoint,
+                  SessionServerOptions options,
+                  std::shared_ptr<search::SearchScheduler> scheduler,
+                  std::shared_ptr<search::Evaluator> evaluator = nullptr);
+    ~SessionServer();
+
+    SessionServer(const SessionServer&) = delete;
+    SessionServer& operator=(const SessionServer&) = delete;
+
+    // Binds the endpoint; throws std::runtime_error on failure.
+    void listen();
+    // Accepts sessions until stop(), then waits for the open sessions to end.
+    void serve();
+    // Callable from any thread: closes the listener and hangs up every session.
+    void stop();
+
+    Stats stats() const;
+
+private:
+    struct Session {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> finished{false};
+        mutable std::mutex mutex;
+        Server* server = nullptr; // guarded by mutex, set while run() serves commands
+        SessionMetrics metrics;   // guarded by mutex, final once server is cleared
+    };
+
+    void run_session(Session& session);
+    // Joins finished sessions and folds their metrics into retired_.
+    void reap(bool all);
+
+    std::string endpoint_;
+    SessionServerOptions options_;
+    std::shared_ptr<search::SearchScheduler> scheduler_;
+    std::shared_ptr<search::Evaluator> evaluator_;
+    int listen_fd_ = -1;
+    std::atomic<bool> stopping_{false};
+
+    mutable std::mutex sessions_mutex_;
+    std::vector<std::shared_ptr<Session>> sessions_; // guarded by sessions_mutex_
+    std::uint64_t sessions_started_ = 0;             // guarded by sessions_mutex_
+    SessionMetrics retired_;                         // guarded by sessions_mutex_
+};
+
+} // namespace gtp
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "nn/Features.hpp"
+#include "nn/NeuralEvaluator.hpp"
+#include "search/Search.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nn {
+
+struct SharedSegment;
+
+// Segment layout, created by EvalServer under a POSIX shared memory name ("/tenuki-eval"):
+//   header: magic "TNKE", version, slot count, max board size, input planes, slot stride,
+//           the server pid, a process-shared robust mutex and condition variables, the
+//           shutdown flag and a ring of queued slot indices (one entry per slot, so it
+//           never overflows).
+//   slots:  state, owner pid, board size, value, a completion condition variable, then
+//           input_planes * max_board_size^2 encoded feature floats (NCHW) and
+//           max_board_size^2 + 1 softmaxed policy floats (pass last).
+// A client claims a free slot, encodes its position straight into it, queues the slot
+// index and sleeps on the slot until the server marks it done. Slots left behind by a
+// client process that died are reclaimed by the next client that needs one.
+struct EvalServerOptions {
+    int slots = 64;
+    int max_batch = 16;
+    std::chrono::microseconds max_wait{1000}; // how long a partial batch waits to fill
+    int max_board_size = 19;
+};
+
+// Owns the shared segment and the network. serve() forms batches from whatever every
+// connected engine process has queued, so weights are loaded once per host and batches
+// fill across processes.
+class EvalServer {
+public:
+    struct Stats {
+        std::uint64_t batches = 0;
+        std::uint64_t positions = 0;
+
+        double mean_batch() const noexcept {
+            return batches > 0 ? static_cast<double>(positions) / static_cast<double>(batches) : 0.0;
+        }
+    };
+
+    // Creates (replacing any stale segment of the same name) and initialises the
+    // segment; throws std::runtime_error on failure.
+    EvalServer(std::string name, std::shared_ptr<NeuralEvaluator> evaluator, EvalServerOptions options = {});
+    ~EvalServer();
+
+    EvalServer(const EvalServer&) = delete;
+    EvalServer& operator=(const EvalServer&) = delete;
+
+    // Evaluates queued batches until stop() is called.
+    void serve();
+    // Async-signal-safe; serve() returns within one polling interval.
+    void stop() noexcept { stop_requested_.store(true, std::memory_order_relaxed); }
+
+    Stats stats() const noexcept;
+    const std::string& name() const noexcept { return name_; }
+
+private:
+    void run_batch(const std::vector<std::uint32_t>& slots);
+
+    std::string name_;
+    std::shared_ptr<NeuralEvaluator> evaluator_;
+    EvalServerOptions options_;
+    SharedSegment* segment_ = nullptr;
+    std::size_t mapped_bytes_ = 0;
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<std::uint64_t> batches_{0};
+    std::atomic<std::uint64_t> positions_{0};
+    std::vector<float> inputs_;
+    std::vector<float> policies_;
+    std::vector<float> values_;
+};
+
+// Engine-side Evaluator that sends positions to an EvalServer. Features are encoded
+// in the client, so the server only runs the network. Safe to call from several search
+// threads; evaluate_batch() queues its positions together so they land in one server
+// batch when slots allow.
+class SharedMemoryEvaluator : public search::Evaluator {
+public:
+    // Maps the segment; throws std::runtime_error if no compatible server created it.
+    // A call that waits longer than `timeout` for a dead or stopped server throws.
+    explicit SharedMemoryEvaluator(std::string name, std::chrono::milliseconds timeout = std::chrono::seconds(30));
+    ~SharedMemoryEvaluator() override;
+
+    SharedMemoryEvaluator(const SharedMemoryEvaluator&) = delete;
+    SharedMemoryEvaluator& operator=(const SharedMemoryEvaluator&) = delete;
+
+    search::EvaluationResult evaluate(const go::Board& board, go::Player to_play) override;
+    std::vector<search::EvaluationResult> evaluate_batch(const std::vector<search::EvaluationRequest>& requests) override;
+
+    FeatureSet feature_set() const noexcept { return feature_set_; }
+    std::size_t max_board_size() const noexcept;
+
+private:
+    std::string name_;
+    std::chrono::milliseconds timeout_;
+    SharedSegment* segment_ = nullptr;
+    std::size_t mapped_bytes_ = 0;
+    FeatureSet feature_set_ = FeatureSet::Extended;
+};
+
+} // namespace nn
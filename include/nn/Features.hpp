@@ -0,0 +1,102 @@
+#pragma once
+
+#include "go/Board.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace nn {
+
+enum class FeatureSet {
+    Basic,    // kBasicInputPlanes
+    Extended, // kExtendedInputPlanes
+    Ladder    // kLadderInputPlanes
+};
+
+// NCHW keeps each plane contiguous (what Network::forward reads); NHWC keeps the
+// planes of one point together.
+enum class TensorLayout {
+    NCHW,
+    NHWC
+};
+
+// Basic planes, from the perspective of the side to move: own stones, opponent stones,
+// empty points, the ko point and a constant plane marking the board.
+constexpr int kBasicInputPlanes = 5;
+
+// Extended planes, from the perspective of the side to move:
+//   0-2   own stones, opponent stones, empty points
+//   3-5   stones whose chain has 1, 2, 3+ liberties
+//   6     ko point
+//   7     legal moves for the side to move
+//   8-12  the last kHistoryPlanes moves, most recent first (passes leave them empty)
+//   13    constant: black to move
+//   14    constant: komi from the side to move's point of view, mapped from [-15, 15]
+//         to [0, 1] as (komi / 15 + 1) / 2 and clamped there; int8 networks quantize
+//         their input unsigned, so a negative plane would read as 0
+//   15    constant plane marking the board
+constexpr int kHistoryPlanes = 5;
+constexpr int kExtendedInputPlanes = 16;
+
+// Ladder planes: the extended planes followed by
+//   16    stones whose chain dies in a ladder with the side to move playing next
+//   17    moves for the side to move that start a working ladder
+// read by go::LadderReader.
+constexpr int kLadderInputPlanes = 18;
+
+int feature_planes(FeatureSet set);
+const char* feature_set_name(FeatureSet set);
+// Accepts "basic", "extended" or "ladder"; throws std::invalid_argument otherwise.
+FeatureSet parse_feature_set(const std::string& name);
+// The feature set a network with `planes` input planes was trained on; throws
+// std::invalid_argument if none matches.
+FeatureSet feature_set_for_planes(int planes);
+const char* tensor_layout_name(TensorLayout layout);
+
+// Writes feature_planes(set) * board_size^2 floats for one position at out. Chain
+// liberties and legality come straight from the board's incremental bookkeeping.
+void encode_features(const go::Board& board, go::Player to_play, FeatureSet set, TensorLayout layout, float* out);
+
+// Writes kBasicInputPlanes * board_size^2 floats in NCHW order.
+void encode_basic_features(const go::Board& board, go::Player to_play, float* planes);
+
+// A reusable, kAlignment-aligned batch tensor. reserve() only reallocates when the
+// batch outgrows the buffer, so evaluators can keep one per thread and encode every
+// leaf in place.
+class FeatureBatch {
+public:
+    static constexpr std::size_t kAlignment = 64;
+
+    FeatureBatch() = default;
+    FeatureBatch(FeatureSet set, TensorLayout layout, std::size_t board_size, std::size_t capacity);
+
+    void reserve(FeatureSet set, TensorLayout layout, std::size_t board_size, std::size_t capacity);
+
+    void encode(std::size_t slot, const go::Board& board, go::Player to_play) {
+        encode_features(board, to_play, set_, layout_, position(slot));
+    }
+
+    float* position(std::size_t slot) noexcept { return data_.get() + slot * stride_; }
+    const float* data() const noexcept { return data_.get(); }
+    float* data() noexcept { return data_.get(); }
+    // Floats per position.
+    std::size_t stride() const noexcept { return stride_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+    FeatureSet feature_set() const noexcept { return set_; }
+    TensorLayout layout() const noexcept { return layout_; }
+
+private:
+    struct AlignedDelete {
+        void operator()(float* data) const;
+    };
+
+    std::unique_ptr<float[], AlignedDelete> data_;
+    std::size_t allocated_ = 0;
+    std::size_t stride_ = 0;
+    std::size_t capacity_ = 0;
+    FeatureSet set_ = FeatureSet::Extended;
+    TensorLayout layout_ = TensorLayout::NCHW;
+};
+
+} // namespace nn
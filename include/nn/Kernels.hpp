@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+
+namespace nn {
+
+// All tensors are dense row-major float arrays. A feature map is laid out as
+// [channels][height * width] (NCHW for a single position).
+
+// C[M][N] += A[M][K] * B[K][N]. Dispatches at runtime to an AVX-512 or AVX2/FMA
+// micro-kernel when the host supports it and falls back to portable loops otherwise.
+void gemm(int m, int n, int k, const float* a, const float* b, float* c);
+
+// Name of the gemm implementation selected for this host ("avx512", "avx2" or "generic").
+const char* gemm_backend();
+
+// Expands a [channels][height*width] map into [channels*9][height*width] columns so a
+// 3x3 convolution with zero padding becomes a single gemm.
+void im2col_3x3(const float* input, int channels, int height, int width, float* columns);
+
+// out[out_channels][hw] = bias + conv3x3(input). weights are [out][in][3][3];
+// columns must hold in_channels * 9 * height * width floats.
+void conv3x3(const float* input, int in_channels, int out_channels, int height, int width,
+             const float* weights, const float* bias, float* columns, float* out);
+
+// out[out_channels][hw] = bias + weights[out][in] * input[in][hw].
+void conv1x1(const float* input, int in_channels, int out_channels, int spatial,
+             const float* weights, const float* bias, float* out);
+
+// Straightforward direct convolution with zero padding, used as a reference by tests
+// and benchmarks. kernel must be odd.
+void conv_reference(const float* input, int in_channels, int out_channels, int height, int width,
+                    int kernel, const float* weights, const float* bias, float* out);
+
+void relu(float* data, std::size_t count);
+// data = max(data + residual, 0)
+void add_relu(float* data, const float* residual, std::size_t count);
+
+// pooled[c] = mean of channel c, pooled[channels + c] = max of channel c.
+void global_pool(const float* input, int channels, int spatial, float* pooled);
+
+// out[o] = bias[o] + sum_i weights[o][i] * input[i]
+void dense(const float* input, int inputs, int outputs, const float* weights, const float* bias, float* out);
+
+} // namespace nn
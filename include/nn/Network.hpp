@@ -0,0 +1,136 @@
+#pragma once
+
+#include "nn/Quantization.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace search {
+class SearchScheduler;
+}
+
+namespace nn {
+
+// Residual policy/value network:
+//   input conv 3x3 (input_planes -> trunk_channels) + ReLU
+//   blocks x [conv 3x3 + ReLU, conv 3x3, + skip, ReLU]
+//   policy head: conv 1x1 (-> policy_channels) + ReLU, then
+//                conv 1x1 (-> 1) for the board logits and
+//                dense(global pool) (2 * policy_channels -> 1) for the pass logit
+//   value head:  conv 1x1 (-> value_channels) + ReLU, global pool (mean, max),
+//                dense (-> value_hidden) + ReLU, dense (-> 1), tanh
+// The trunk is fully convolutional so one set of weights runs on any board size.
+struct NetworkShape {
+    int input_planes = 0;
+    int trunk_channels = 0;
+    int blocks = 0;
+    int policy_channels = 0;
+    int value_channels = 0;
+    int value_hidden = 0;
+};
+
+// Batch normalisation is expected to be folded into the convolution weights and
+// biases before export.
+struct ConvLayer {
+    int in_channels = 0;
+    int out_channels = 0;
+    int kernel = 0;
+    std::vector<float> weights; // [out][in][kernel][kernel]
+    std::vector<float> bias;    // [out]
+};
+
+struct DenseLayer {
+    int inputs = 0;
+    int outputs = 0;
+    std::vector<float> weights; // [outputs][inputs]
+    std::vector<float> bias;    // [outputs]
+};
+
+struct ResidualBlock {
+    ConvLayer first;
+    ConvLayer second;
+};
+
+struct NetworkWeights {
+    NetworkShape shape;
+    ConvLayer input;
+    std::vector<ResidualBlock> blocks;
+    ConvLayer policy_conv;
+    ConvLayer policy_board;
+    DenseLayer policy_pass;
+    ConvLayer value_conv;
+    DenseLayer value_hidden;
+    DenseLayer value_output;
+};
+
+// Weights file, all values little-endian:
+//   char[4] magic "TNKN", u32 version (1),
+//   u32 input_planes, trunk_channels, blocks, policy_channels, value_channels, value_hidden,
+//   then f32 tensors in this order, each weights followed by bias:
+//     input conv, blocks[i].first, blocks[i].second, policy_conv, policy_board,
+//     policy_pass, value_conv, value_hidden, value_output.
+// Tensor sizes follow from the header; trailing bytes are rejected.
+NetworkWeights load_weights(std::istream& in);
+NetworkWeights load_weights_file(const std::string& path);
+void save_weights(const NetworkWeights& weights, std::ostream& out);
+
+// Deterministic He-initialised weights, for tests and benchmarks.
+NetworkWeights make_random_weights(const NetworkShape& shape, std::uint32_t seed);
+
+// How the 3x3 trunk convolutions are computed.
+enum class ConvAlgorithm {
+    Im2col,  // im2col + gemm, works on the weights as loaded
+    Winograd // F(4x4, 3x3) on weights transformed once at construction
+};
+
+const char* conv_algorithm_name(ConvAlgorithm algorithm);
+// Accepts "im2col" or "winograd"; throws std::invalid_argument otherwise.
+ConvAlgorithm parse_conv_algorithm(const std::string& name);
+
+class Network {
+public:
+    explicit Network(NetworkWeights weights, ConvAlgorithm algorithm = ConvAlgorithm::Winograd);
+
+    const NetworkShape& shape() const noexcept { return weights_.shape; }
+    ConvAlgorithm conv_algorithm() const noexcept { return algorithm_; }
+    Precision precision() const noexcept { return precision_; }
+
+    // Layers quantize() replaces: the input conv, both convs of every block and the
+    // two head convs. CalibrationTable entries follow this order.
+    std::size_t quantizable_layer_count() const noexcept;
+    // Switches those layers to int8 using calibrated input ranges; throws
+    // std::invalid_argument if the table does not match the network.
+    void quantize(const CalibrationTable& table);
+    // Runs fp32 forward passes over the positions and widens the table's per-layer
+    // activation maxima, resizing it to quantizable_layer_count() first.
+    void calibrate(const float* inputs, int batch, int board_size, CalibrationTable& table) const;
+
+    // inputs holds batch positions of [input_planes][board_size * board_size] floats.
+    // Writes batch * (board_size * board_size + 1) raw policy logits (pass last) and
+    // batch values in [-1, 1]. With a pool, positions are spread over its workers and the
+    // caller waits; otherwise they run on the calling thread. Scratch buffers are kept per
+    // thread between calls.
+    void forward(const float* inputs, int batch, int board_size, float* policy_logits, float* values,
+                 search::SearchScheduler* pool = nullptr) const;
+
+private:
+    struct Workspace;
+
+    void forward_position(const float* input, int board_size, Workspace& workspace, float* policy_logits,
+                          float* value) const;
+    // layer indexes the convolutions in quantizable_layer_count() order; the 3x3 trunk
+    // layers come first, so it also indexes winograd_weights_.
+    void conv_layer(const float* input, const ConvLayer& conv, std::size_t layer, int board_size,
+                    Workspace& workspace, float* out) const;
+
+    NetworkWeights weights_;
+    ConvAlgorithm algorithm_;
+    Precision precision_ = Precision::Float32;
+    std::vector<std::vector<float>> winograd_weights_;
+    std::vector<QuantizedConv> quantized_;
+};
+
+} // namespace nn
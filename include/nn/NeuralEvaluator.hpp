@@ -0,0 +1,55 @@
+#pragma once
+
+#include "go/Board.hpp"
+#include "nn/Features.hpp"
+#include "nn/Network.hpp"
+#include "search/Scheduler.hpp"
+#include "search/Search.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nn {
+
+// Runs a Network on the CPU. evaluate() is safe to call from several search threads at
+// once; evaluate_batch() pushes a whole batch through the network and, with threads > 1,
+// spreads its positions over a pool of that many workers started with the evaluator.
+// The feature set follows the network's input planes.
+class NeuralEvaluator : public search::Evaluator {
+public:
+    explicit NeuralEvaluator(std::shared_ptr<const Network> network, int threads = 1);
+
+    search::EvaluationResult evaluate(const go::Board& board, go::Player to_play) override;
+    std::vector<search::EvaluationResult> evaluate_batch(const std::vector<search::EvaluationRequest>& requests) override;
+
+    // Runs `batch` positions already encoded with feature_set() in NCHW layout and writes
+    // batch * (board_size^2 + 1) softmaxed policies (pass last) and batch values.
+    void evaluate_encoded(const float* inputs, std::size_t batch, std::size_t board_size, float* policies,
+                          float* values);
+
+    const Network& network() const noexcept { return *network_; }
+    FeatureSet feature_set() const noexcept { return feature_set_; }
+
+private:
+    std::shared_ptr<const Network> network_;
+    FeatureSet feature_set_;
+    std::unique_ptr<search::SearchScheduler> pool_; // null for a single thread
+};
+
+struct NeuralEvaluatorOptions {
+    int threads = 1;
+    ConvAlgorithm conv = ConvAlgorithm::Winograd;
+    Precision precision = Precision::Float32;
+    std::string calibration_path; // required for Precision::Int8, see nn_calibrate
+};
+
+// Loads a weights file (see Network.hpp for the format), quantized as requested; throws
+// std::runtime_error.
+std::shared_ptr<Network> load_network(const std::string& weights_path, const NeuralEvaluatorOptions& options = {});
+
+// load_network() wrapped in a NeuralEvaluator.
+std::shared_ptr<search::Evaluator> make_neural_evaluator(const std::string& weights_path,
+                                                         const NeuralEvaluatorOptions& options = {});
+
+} // namespace nn
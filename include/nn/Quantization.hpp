@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace nn {
+
+struct ConvLayer;
+
+enum class Precision {
+    Float32,
+    Int8 // post-training quantized conv layers, see Network::quantize()
+};
+
+const char* precision_name(Precision precision);
+// Accepts "fp32" or "int8"; throws std::invalid_argument otherwise.
+Precision parse_precision(const std::string& name);
+
+// Largest input activation seen by every quantizable layer over a set of calibration
+// positions, in layer order: input conv, blocks[i].first, blocks[i].second,
+// policy_conv, value_conv.
+//
+// File layout (little-endian): char[4] "TNKQ", u32 version (1), u32 count, f32 x count.
+struct CalibrationTable {
+    std::vector<float> activation_max;
+};
+
+CalibrationTable load_calibration(std::istream& in);
+CalibrationTable load_calibration_file(const std::string& path);
+void save_calibration(const CalibrationTable& table, std::ostream& out);
+
+// Inputs of quantized layers are non-negative (features or post-ReLU) and are stored
+// as unsigned 7-bit codes; weights are signed 8-bit with one scale per output channel.
+// The 7-bit activation range keeps the pairwise sums of AVX2 maddubs within int16.
+constexpr int kActivationLevels = 127;
+constexpr int kWeightLevels = 127;
+
+struct QuantizedConv {
+    int in_channels = 0;
+    int out_channels = 0;
+    int kernel = 0;
+    int depth = 0;                    // in_channels * kernel^2 rounded up to a multiple of 4
+    std::vector<std::int8_t> weights; // [out][depth], zero padded
+    std::vector<float> output_scales; // per output channel: input_scale * weight_scale
+    std::vector<float> bias;
+    float input_scale = 1.0f;         // activation value of one quantization step
+};
+
+QuantizedConv quantize_conv(const ConvLayer& conv, float activation_max);
+
+// Rounds depth up to the 4-deep groups the int8 kernels consume.
+int quantized_depth(int depth);
+
+// Quantizes columns[depth][n] (zero padded to padded_depth rows) into the interleaved
+// layout the int8 gemm reads: packed[(k / 4) * n * 4 + j * 4 + k % 4].
+void quantize_pack(const float* columns, int depth, int padded_depth, int n, float input_scale, std::uint8_t* packed);
+
+// c[m][n] = a[m][k] * b[k][n] in int32, with a signed and b unsigned packed as above;
+// k must be a multiple of 4. Dispatches to AVX-512 VNNI or AVX2 maddubs kernels when
+// available.
+void gemm_u8s8(int m, int n, int k, const std::int8_t* a, const std::uint8_t* b_packed, std::int32_t* c);
+const char* int8_gemm_backend();
+
+// 3x3 variant of quantize_pack: quantizes the [channels][height*width] input once into
+// codes, then gathers the zero-padded 3x3 neighbourhoods straight into packed columns.
+void quantize_im2col_pack_3x3(const float* input, int channels, int height, int width, int padded_depth,
+                              float input_scale, std::uint8_t* codes, std::uint8_t* packed);
+
+// out[out_channels][height*width] for a 1x1 or 3x3 quantized convolution. codes is
+// only used by 3x3 layers (in_channels * spatial bytes); packed needs depth * spatial
+// bytes and accum out_channels * spatial ints.
+void quantized_conv(const float* input, const QuantizedConv& conv, int height, int width, std::uint8_t* codes,
+                    std::uint8_t* packed, std::int32_t* accum, float* out);
+
+} // namespace nn
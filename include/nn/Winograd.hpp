@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+namespace nn {
+
+// Winograd F(4x4, 3x3): each 4x4 output tile is computed from a 6x6 input tile with
+// 36 element-wise products per channel pair instead of 144 multiply-adds. The 36
+// products over all channels become 36 independent gemms, so the heavy lifting still
+// runs through the vectorized gemm kernel.
+constexpr int kWinogradOutputTile = 4;
+constexpr int kWinogradInputTile = 6;
+constexpr int kWinogradPoints = kWinogradInputTile * kWinogradInputTile;
+
+// Number of 4x4 output tiles covering a height x width plane.
+std::size_t winograd_tile_count(int height, int width);
+
+// Floats needed for the pre-transformed weights of one layer: 36 * out * in.
+std::size_t winograd_weights_size(int in_channels, int out_channels);
+
+// Transforms [out][in][3][3] weights into [36][out][in] (U = G g G^T). Done once at
+// network load time.
+void winograd_transform_weights(const float* weights, int in_channels, int out_channels, float* transformed);
+
+// out[out_channels][height*width] = bias + conv3x3(input) using pre-transformed weights.
+// input_scratch needs 36 * in_channels * tiles floats and output_scratch
+// 36 * out_channels * tiles floats, where tiles = winograd_tile_count(height, width).
+void conv3x3_winograd(const float* input, int in_channels, int out_channels, int height, int width,
+                      const float* transformed_weights, const float* bias, float* input_scratch,
+                      float* output_scratch, float* out);
+
+} // namespace nn
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "search/Search.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace search {
+
+// Gathers the single-position evaluate() calls of concurrent search threads into
+// batches for a backend that prefers them. A batch goes out as soon as max_batch
+// requests are queued, or when the oldest waiter has waited max_wait; the thread that
+// completes or times out a batch dispatches it itself, so no extra thread is needed.
+// evaluate_batch() calls are already batched and pass straight through.
+class BatchingEvaluator : public Evaluator {
+public:
+    BatchingEvaluator(std::shared_ptr<Evaluator> inner, int max_batch,
+                      std::chrono::microseconds max_wait = std::chrono::microseconds(1000));
+
+    EvaluationResult evaluate(const go::Board& board, go::Player to_play) override;
+    std::vector<EvaluationResult> evaluate_batch(const std::vector<EvaluationRequest>& requests) override;
+
+    int max_batch() const noexcept { return max_batch_; }
+
+private:
+    struct Pending {
+        EvaluationRequest request;
+        EvaluationResult result;
+        bool taken = false;
+        bool done = false;
+        std::exception_ptr error;
+    };
+
+    void dispatch(std::unique_lock<std::mutex>& lock);
+
+    std::shared_ptr<Evaluator> inner_;
+    int max_batch_;
+    std::chrono::microseconds max_wait_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<Pending*> queue_;
+};
+
+} // namespace search
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "go/Board.hpp"
+#include "search/Search.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace search {
+
+// Wire format shared by the coordinator and its workers. Every message is a 12 byte
+// header (magic "TNKD", u16 version, u16 type, u32 payload size) followed by the
+// payload. All integers are little-endian, floats are IEEE-754 bit patterns.
+//   SearchRequest: u32 board_size, f64 komi, u8 allow_suicide, u8 ko_rule, u8 scoring_rule,
+//                  u8 to_play, i32 ko_vertex (-1 for none), i32 move_number, i32 playouts,
+//                  u32 seed, then board_size * board_size bytes of go::PointState.
+//   SearchResult:  u32 count, then count entries of (i32 move, f32 prior, i32 visits, f32 value_sum).
+//   Shutdown:      empty payload; the worker stops serving.
+enum class MessageType : std::uint16_t {
+    SearchRequest = 1,
+    SearchResult = 2,
+    Shutdown = 3
+};
+
+struct SearchRequest {
+    go::Rules rules;
+    std::vector<go::PointState> points;
+    go::Player to_play = go::Player::Black;
+    int ko_vertex = -1;
+    int move_number = 0;
+    int playouts = 0;
+    unsigned int seed = 0;
+};
+
+std::vector<std::uint8_t> encode_search_request(const SearchRequest& request);
+SearchRequest decode_search_request(const std::vector<std::uint8_t>& payload);
+std::vector<std::uint8_t> encode_search_result(const std::vector<RootMoveStats>& stats);
+std::vector<RootMoveStats> decode_search_result(const std::vector<std::uint8_t>& payload);
+
+// Runs searches on behalf of a coordinator. Endpoints are "unix:/path/to/socket" or
+// "tcp:host:port". Workers replay only the stones, side to move and ko point, so the
+// coordinator drops any move its own (superko-aware) root does not consider legal.
+class SearchWorker {
+public:
+    SearchWorker(std::string endpoint, SearchConfig config, std::shared_ptr<Evaluator> evaluator);
+    ~SearchWorker();
+
+    SearchWorker(const SearchWorker&) = delete;
+    SearchWorker& operator=(const SearchWorker&) = delete;
+
+    // Binds the endpoint so coordinators can connect; throws std::runtime_error on failure.
+    void listen();
+    // Serves one coordinator connection at a time until a Shutdown message arrives.
+    void serve();
+
+    int requests_served() const noexcept { return requests_served_; }
+
+private:
+    bool handle_connection(int fd);
+    std::vector<RootMoveStats> run_request(const SearchRequest& request);
+
+    std::string endpoint_;
+    SearchConfig config_;
+    std::shared_ptr<Evaluator> evaluator_;
+    int listen_fd_ = -1;
+    int requests_served_ = 0;
+};
+
+// Fans every search out to a set of workers and sums their root statistics. finish()
+// waits at most result_timeout_ms for the replies and drops workers that miss it.
+class DistributedCoordinator : public RootSearchContributor {
+public:
+    explicit DistributedCoordinator(std::vector<std::string> endpoints,
+                                    int connect_timeout_ms = 5000,
+                                    int result_timeout_ms = 10000);
+    ~DistributedCoordinator() override;
+
+    DistributedCoordinator(const DistributedCoordinator&) = delete;
+    DistributedCoordinator& operator=(const DistributedCoordinator&) = delete;
+
+    void begin(const go::Board& board, go::Player to_play, int move_number, int playouts) override;
+    std::vector<RootMoveStats> finish() override;
+
+    // Number of workers still connected; a worker that fails or times out mid-search is dropped.
+    std::size_t worker_count() const noexcept;
+    void shutdown_workers();
+
+private:
+    struct Connection {
+        std::string endpoint;
+        int fd = -1;
+        bool pending = false;
+    };
+
+    void drop(Connection& connection);
+
+    std::vector<Connection> connections_;
+    std::chrono::milliseconds result_timeout_;
+    unsigned int seed_ = 0x5eed1234u;
+};
+
+// Socket helpers for other servers on the same endpoints (see gtp::SessionServer).
+// Both return -1 when the socket cannot be opened and throw std::runtime_error for a
+// malformed endpoint. Listening on a unix endpoint replaces any stale socket file.
+int listen_on_endpoint(const std::string& endpoint, int backlog);
+int connect_to_endpoint(const std::string& endpoint);
+// Unlinks the socket file of a unix endpoint; does nothing for tcp.
+void remove_endpoint_file(const std::string& endpoint);
+
+// Splits a comma separated endpoint list, skipping empty entries.
+std::vector<std::string> parse_endpoint_list(const std::string& text);
+
+} // namespace search
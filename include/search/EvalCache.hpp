@@ -0,0 +1,64 @@
+#pragma once
+
+#include "search/Search.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace search {
+
+// Memoizes an evaluator by the canonical (symmetry-reduced) state key, so all eight
+// orientations of a position share one entry. Policies are stored in the canonical
+// orientation and mapped back to the caller's. The table is direct-mapped: a new
+// position replaces whatever occupied its slot.
+//
+// The key covers stones, ko, side to move and the rules (go::rules_hash); positions that
+// differ only in move history or superko context share an entry.
+class CachingEvaluator : public Evaluator {
+public:
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+
+    // capacity is the number of cached positions; throws std::invalid_argument if 0.
+    CachingEvaluator(std::shared_ptr<Evaluator> inner, std::size_t capacity);
+
+    EvaluationResult evaluate(const go::Board& board, go::Player to_play) override;
+    // Misses, minus duplicate orientations within the batch, go to the inner evaluator
+    // as one batch.
+    std::vector<EvaluationResult> evaluate_batch(const std::vector<EvaluationRequest>& requests) override;
+
+    Stats stats() const noexcept;
+    std::size_t capacity() const noexcept { return shard_capacity_ * kShards; }
+
+private:
+    static constexpr std::size_t kShards = 16;
+
+    struct Entry {
+        std::uint64_t key = 0;
+        bool used = false;
+        EvaluationResult result; // canonical orientation
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+    };
+
+    Entry& slot_for(std::uint64_t key);
+    Shard& shard_for(std::uint64_t key) { return shards_[static_cast<std::size_t>(key >> 60) % kShards]; }
+
+    std::shared_ptr<Evaluator> inner_;
+    std::size_t shard_capacity_ = 0;
+    std::array<Shard, kShards> shards_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+};
+
+} // namespace search
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "search/Search.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace search {
+
+// Cost of one evaluator call: a fixed launch latency per batch plus a per-position term,
+// either slept away or burned on the calling thread.
+struct LatencyModel {
+    std::chrono::microseconds batch_latency{0};
+    std::chrono::microseconds position_cost{0};
+    bool spin = false; // busy-wait instead of sleeping, for sub-scheduler-tick costs
+};
+
+// Stand-in for an accelerator: uniform policy, zero value, and batches that take
+// LatencyModel time and run one at a time, like a single device queue. Records the batch
+// sizes it receives and how long the "device" was busy.
+class LatencyEvaluator : public Evaluator {
+public:
+    struct Stats {
+        std::uint64_t batches = 0;
+        std::uint64_t positions = 0;
+        std::vector<std::uint64_t> batch_sizes; // batch_sizes[n] = batches of n positions
+        double busy_seconds = 0.0;
+
+        double mean_batch() const noexcept {
+            return batches > 0 ? static_cast<double>(positions) / static_cast<double>(batches) : 0.0;
+        }
+    };
+
+    explicit LatencyEvaluator(LatencyModel model);
+
+    EvaluationResult evaluate(const go::Board& board, go::Player to_play) override;
+    std::vector<EvaluationResult> evaluate_batch(const std::vector<EvaluationRequest>& requests) override;
+
+    Stats stats() const;
+    void reset_stats();
+    const LatencyModel& model() const noexcept { return model_; }
+
+private:
+    LatencyModel model_;
+    mutable std::mutex device_mutex_;
+    Stats stats_;
+};
+
+} // namespace search
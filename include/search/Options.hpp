@@ -0,0 +1,95 @@
+#pragma once
+
+#include "search/Search.hpp"
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace search {
+
+// Everything a tenuki_cli process can be configured with: the search, and the board,
+// evaluator chain and session pool main.cpp builds around it. Each field is an option
+// named after it (snake_case; dashes are accepted for underscores), settable from a
+// config file, a --name flag, or, for the SearchConfig fields, GTP tenuki-set.
+//
+// Enum-like evaluator settings stay strings here, parsed where the evaluator is built,
+// so this header does not depend on the network code.
+struct EngineOptions {
+    SearchConfig search;
+
+    std::size_t board_size = 19;
+    double komi = 7.5;
+
+    std::string weights;               // network weights file
+    std::string eval_server;           // tenuki_eval_server shared memory segment
+    int nn_threads = 1;                // threads per network batch
+    std::string nn_conv = "winograd";  // im2col | winograd
+    std::string nn_precision = "fp32"; // fp32 | int8
+    std::string nn_calibration;        // int8 calibration file
+    std::string nn_symmetry = "none";  // none | random | average
+    int eval_cache = 0;                // positions cached in front of the network; 0 disables
+    int eval_batch = 0;                // > 1 batches evaluations across --serve sessions
+    int rollouts = 0;                  // without a network, light playouts per leaf
+    bool rollout_amaf = false;         // priors from the rollouts' all-moves-as-first statistics
+    std::string patterns;              // without a network, 3x3 pattern prior table
+
+    int pool_threads = 0;    // --serve: pool workers; 0 means one per hardware thread
+    int session_threads = 1; // --serve: most pool workers one search may use
+};
+
+// All option names, SearchConfig fields first.
+std::vector<std::string> option_names();
+bool is_option(const std::string& name);
+// SearchConfig fields, which a running engine can change between searches.
+bool is_search_option(const std::string& name);
+
+// Throws std::invalid_argument for unknown names, for values that do not parse
+// (booleans are 1/0, true/false or on/off; parallel_mode is tree or root) and for
+// options validate_options() refuses; options is then left as it was. Setting
+// max_playouts also turns playout cap randomization off and sets random_playouts_min
+// and random_playouts_max to it, as TENUKI_MAX_PLAYOUTS does.
+void set_option(EngineOptions& options, const std::string& name, const std::string& value);
+// set_option() for each setting in turn, validating once after the last, so the
+// random_playouts_min/random_playouts_max pair can be raised in either order.
+void set_options(EngineOptions& options, const std::vector<std::pair<std::string, std::string>>& settings);
+// Throws std::invalid_argument unless max_playouts is positive, virtual_loss_visits,
+// trace_events_per_thread and retained_trees are not negative, and random_playouts_min
+// is at most random_playouts_max.
+void validate_options(const EngineOptions& options);
+std::string get_option(const EngineOptions& options, const std::string& name);
+
+// Reads "name = value" lines; blank lines and text after '#' are ignored. Throws
+// std::invalid_argument naming the line at fault, or, for options validate_options()
+// refuses, once the last line is read; options is then left as it was.
+void load_options(EngineOptions& options, std::istream& in);
+// load_options() on a file; throws std::runtime_error if it cannot be read.
+void load_options_file(EngineOptions& options, const std::string& path);
+// Every option as "name = value" lines, readable back by load_options().
+std::string format_options(const EngineOptions& options);
+
+// Playout rate of the search at each thread count tried by autotune_threads().
+struct ThreadTiming {
+    int threads = 0;
+    double playouts_per_second = 0.0;
+};
+
+struct AutotuneResult {
+    int threads = 1;
+    std::vector<ThreadTiming> timings;
+};
+
+// Times searches of `playouts` from `board` with config at 1, 2, 4, ... threads, up to
+// max_threads (the hardware threads when 0), and returns the fastest count. A larger
+// count has to beat the best smaller one by 5% to be picked, so timing noise does not
+// buy threads that do nothing. The search runs on fresh agents; config is not changed.
+AutotuneResult autotune_threads(const SearchConfig& config,
+                                std::shared_ptr<Evaluator> evaluator,
+                                const go::Board& board,
+                                int max_threads = 0,
+                                int playouts = 1600);
+
+} // namespace search
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "search/Search.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace search {
+
+// Log-weights of 3x3 patterns (go/Pattern.hpp) seen by the side to move, i.e. with
+// colour 1 meaning the mover's stones. Every pattern is stored under all eight of its
+// orientations in one sorted array, so a lookup is a binary search on the raw code;
+// patterns missing from the table weigh 0.
+class PatternWeights {
+public:
+    PatternWeights() = default;
+    // Entries need not be sorted or in any particular orientation; a later entry for the
+    // same shape replaces an earlier one. Throws std::invalid_argument for codes outside
+    // the 20-bit pattern space or non-finite weights.
+    PatternWeights(const std::vector<std::pair<std::uint32_t, float>>& entries, float pass_weight);
+
+    float weight(std::uint32_t code) const noexcept;
+    float pass_weight() const noexcept { return pass_weight_; }
+    // Stored codes, all orientations counted.
+    std::size_t size() const noexcept { return codes_.size(); }
+
+    // One entry per shape, in the orientation with the smallest code.
+    std::vector<std::pair<std::uint32_t, float>> canonical_entries() const;
+
+private:
+    std::vector<std::uint32_t> codes_;
+    std::vector<float> weights_;
+    float pass_weight_ = 0.0f;
+};
+
+// Binary table: "TNKP", version, entry count, pass weight, then (code, weight) pairs,
+// all little-endian 32-bit. Throws std::runtime_error on malformed input.
+PatternWeights load_pattern_weights(std::istream& in);
+PatternWeights load_pattern_weights_file(const std::string& path);
+void save_pattern_weights(const PatternWeights& weights, std::ostream& out);
+
+// Move priors from local shape: each empty point gets exp(weight) of its pattern, pass
+// exp(pass_weight), normalised. On boards that track patterns the codes are read
+// straight from the board; otherwise they are recomputed point by point. The value
+// comes from value_source when one is given (its policy is dropped), else it is 0.
+class PatternEvaluator : public Evaluator {
+public:
+    explicit PatternEvaluator(PatternWeights weights, std::shared_ptr<Evaluator> value_source = nullptr);
+
+    EvaluationResult evaluate(const go::Board& board, go::Player to_play) override;
+    std::vector<EvaluationResult> evaluate_batch(const std::vector<EvaluationRequest>& requests) override;
+
+    // board_size^2 + 1 priors summing to 1; occupied points get 0.
+    void priors(const go::Board& board, go::Player to_play, std::vector<float>& policy) const;
+    const PatternWeights& weights() const noexcept { return weights_; }
+
+private:
+    PatternWeights weights_;
+    std::shared_ptr<Evaluator> value_source_;
+};
+
+} // namespace search
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "search/Search.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace search {
+
+struct RolloutConfig {
+    int playouts = 16;              // random games per evaluation
+    int max_moves = 0;              // per game; 0 means three times the board area
+    bool amaf_policy = false;       // prior from all-moves-as-first win rates instead of uniform
+    bool settle_pass_alive = false; // keep playouts out of pass-alive areas, score them as is
+    std::uint64_t seed = 0x5eed1234u;
+};
+
+// Values leaves by light Monte-Carlo playouts: uniformly random legal moves that never
+// fill the mover's own eyes, played on a go::PlayoutBoard until both sides pass, then
+// scored Tromp-Taylor. The value is the mean outcome for the side to move (+1 win,
+// -1 loss, 0 jigo). With settle_pass_alive, Benson pass-alive chains and territory of
+// the start position (go/PassAlive.hpp) are settled on the playout board, so games end
+// once the rest of the board is decided. Safe to call from several search threads;
+// each keeps its own playout board and random stream.
+class RolloutEvaluator : public Evaluator {
+public:
+    // Everything one evaluation learned from its playouts.
+    struct Rollouts {
+        float value = 0.0f;            // mean outcome for the side to move
+        float mean_score = 0.0f;       // black minus white minus komi
+        std::vector<float> ownership;  // per vertex, +1 always black ... -1 always white
+        std::vector<float> amaf_wins;  // per vertex, games the side to move won after playing
+        std::vector<float> amaf_games; // there first (jigo counts half), and how many games
+        int moves = 0;                 // moves played over all games
+    };
+
+    struct Counters {
+        std::uint64_t playouts = 0;
+        std::uint64_t moves = 0;
+    };
+
+    explicit RolloutEvaluator(RolloutConfig config = {});
+
+    EvaluationResult evaluate(const go::Board& board, go::Player to_play) override;
+    Rollouts rollouts(const go::Board& board, go::Player to_play);
+
+    // Totals over every evaluation so far.
+    Counters counters() const noexcept;
+    const RolloutConfig& config() const noexcept { return config_; }
+
+private:
+    RolloutConfig config_;
+    std::uint64_t id_; // unique per instance; keys the thread-local playout scratch
+    std::atomic<std::uint64_t> streams_{0};
+    std::atomic<std::uint64_t> playouts_{0};
+    std::atomic<std::uint64_t> moves_{0};
+};
+
+} // namespace search
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace search {
+
+struct SchedulerOptions {
+    int threads = 0;     // pool workers; 0 means one per hardware thread
+    int slice_steps = 8; // steps a worker runs for one job before looking for other work
+};
+
+// A pool of search workers shared by many SearchAgents (see SearchAgent::set_scheduler),
+// so concurrent games share the cores instead of each spawning num_threads threads.
+//
+// A job is a step function run until it returns false. It enters the pool as up to
+// max_parallel tickets, which caps how many workers one job can occupy. A worker runs
+// slice_steps steps for its ticket, then queues the ticket at the back of its own
+// deque. Before that deque, it checks the shared queue of newly arrived tickets, so a
+// new job starts within one slice however busy the pool is. Jobs already running on a
+// worker take turns round-robin, and idle workers steal tickets from the other end of
+// a busy worker's deque.
+class SearchScheduler {
+public:
+    struct JobStats {
+        std::chrono::nanoseconds queue_wait{0}; // from run() to the first step starting
+        std::chrono::nanoseconds wall{0};       // from run() to the last step returning
+        std::uint64_t steps = 0;
+        std::uint64_t slices = 0;
+    };
+
+    struct Counters {
+        std::uint64_t jobs = 0;
+        std::uint64_t slices = 0;
+        std::uint64_t steps = 0;
+        std::uint64_t steals = 0;
+    };
+
+    explicit SearchScheduler(SchedulerOptions options = {});
+    ~SearchScheduler();
+
+    SearchScheduler(const SearchScheduler&) = delete;
+    SearchScheduler& operator=(const SearchScheduler&) = delete;
+
+    // Calls step(worker) on at most max_parallel pool workers at a time until a call
+    // returns false, then waits for the calls in flight. worker is the pool index in
+    // [0, threads()), so scratch state indexed by it is never shared between calls.
+    // Blocks the caller, which must not itself be a pool worker. The first exception a
+    // step throws ends the job and is rethrown here.
+    JobStats run(const std::function<bool(int worker)>& step, int max_parallel);
+
+    int threads() const noexcept { return static_cast<int>(workers_.size()); }
+    Counters counters() const noexcept;
+
+private:
+    struct Job {
+        const std::function<bool(int)>* step = nullptr;
+        std::chrono::steady_clock::time_point submitted;
+        std::atomic<bool> started{false};
+        std::atomic<bool> done{false};
+        std::atomic<std::uint64_t> steps{0};
+        std::atomic<std::uint64_t> slices{0};
+        std::chrono::steady_clock::time_point first_step;
+        int tickets = 0;          // guarded by mutex
+        std::exception_ptr error; // guarded by mutex
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job*> tickets;
+    };
+
+    void worker_loop(int index);
+    Job* take(int index);
+    void requeue(int index, Job* job);
+    void release(Job* job, std::exception_ptr error);
+    void wake_one();
+
+    SchedulerOptions options_;
+    std::vector<std::unique_ptr<Worker>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex inject_mutex_;
+    std::deque<Job*> injected_;
+    std::mutex idle_mutex_;
+    std::condition_variable idle_;
+    std::atomic<int> queued_{0};   // tickets sitting in any queue
+    std::atomic<int> sleeping_{0}; // workers waiting on idle_
+    bool stopping_ = false;        // guarded by idle_mutex_
+
+    std::atomic<std::uint64_t> jobs_{0};
+    std::atomic<std::uint64_t> slices_{0};
+    std::atomic<std::uint64_t> steps_{0};
+    std::atomic<std::uint64_t> steals_{0};
+};
+
+} // namespace search
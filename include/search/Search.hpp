@@ -1,16 +1,30 @@
 #pragma once
 
 #include "go/Board.hpp"
+#include "search/Scheduler.hpp"
+#include "search/SearchStats.hpp"
+#include "search/Topology.hpp"
+#include "search/Trace.hpp"
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
+#include <iosfwd>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <random>
 #include <unordered_map>
 #include <vector>
 
 namespace search {
 
+enum class ParallelMode {
+    TreeParallel, // all workers share one tree, diversified by virtual loss
+    RootParallel  // workers are split into independent trees merged at the root
+};
+
 struct SearchConfig {
     int max_playouts = 256;
     float cpuct = 1.6f;
@@ -27,6 +41,42 @@ struct SearchConfig {
     bool use_virtual_loss = true;
     float virtual_loss = 1.0f;
     int virtual_loss_visits = 1;
+    ParallelMode parallel_mode = ParallelMode::TreeParallel;
+    int root_parallel_groups = 0; // number of independent trees; 0 means one per thread
+    bool pin_threads = false; // bind each spawned search worker to one logical cpu
+    // On NUMA hosts, one pinned root-parallel tree per node. This overrides parallel_mode
+    // and root_parallel_groups there, even in TreeParallel mode; single-node hosts ignore it.
+    bool numa_local_trees = false;
+    bool collect_stats = false;    // per-phase counters, see SearchAgent::stats()
+    bool enable_trace = false;     // event timeline, see SearchAgent::write_trace()
+    int trace_events_per_thread = 1 << 16;
+    // Read ladders when expanding a node: extending a chain that still dies in a ladder
+    // has its prior scaled by ladder_escape_factor, starting a working ladder by
+    // ladder_capture_factor, before the priors are renormalised.
+    bool read_ladders = false;
+    float ladder_escape_factor = 0.1f;
+    float ladder_capture_factor = 4.0f;
+    // Leave out of expansion the moves inside Benson pass-alive areas that cannot change
+    // their owner (go::PassAliveMap::is_pointless).
+    bool prune_pass_alive = false;
+    // Trees of recent positions the game left (the parent after each move, the current
+    // tree after an undo), kept so going back to one resumes its search instead of
+    // starting over; 0 keeps none.
+    int retained_trees = 8;
+};
+
+struct RootMoveStats {
+    int move = -1; // -1 denotes pass
+    float prior = 0.0f;
+    int visit_count = 0;
+    float value_sum = 0.0f;
+};
+
+// One root move of a running analysis: its merged statistics and the line the main
+// tree expects after it, the move itself first.
+struct MoveAnalysis {
+    RootMoveStats stats;
+    std::vector<int> pv; // -1 denotes pass
 };
 
 struct EvaluationResult {
@@ -34,10 +84,17 @@ struct EvaluationResult {
     float value = 0.0f;        // value estimate from the perspective of the current player.
 };
 
+struct EvaluationRequest {
+    const go::Board* board = nullptr;
+    go::Player to_play = go::Player::Black;
+};
+
 class Evaluator {
 public:
     virtual ~Evaluator() = default;
     virtual EvaluationResult evaluate(const go::Board& board, go::Player to_play) = 0;
+    // Evaluates several positions in one call; backends override this to share work across the batch.
+    virtual std::vector<EvaluationResult> evaluate_batch(const std::vector<EvaluationRequest>& requests);
 };
 
 class UniformEvaluator : public Evaluator {
@@ -45,17 +102,82 @@ public:
     EvaluationResult evaluate(const go::Board& board, go::Player to_play) override;
 };
 
+// Search effort running outside the agent (for example in worker processes) whose
+// root statistics are merged with the local tree before a move is chosen.
+class RootSearchContributor {
+public:
+    virtual ~RootSearchContributor() = default;
+    // Called before the local search starts; must not wait for the contributed result.
+    virtual void begin(const go::Board& board, go::Player to_play, int move_number, int playouts) = 0;
+    // Blocks until the contributed statistics for the last begin() are available.
+    virtual std::vector<RootMoveStats> finish() = 0;
+};
+
 class SearchAgent {
 public:
     SearchAgent(SearchConfig config, std::shared_ptr<Evaluator> evaluator);
 
     go::Move select_move(const go::Board& board, go::Player to_play, int move_number);
 
+    // Runs one search from the position and returns the merged root statistics without choosing a move.
+    std::vector<RootMoveStats> search(const go::Board& board, go::Player to_play, int move_number);
+
+    // Searches from the position until stop is set, ignoring max_playouts. Every interval
+    // the calling thread hands report a snapshot of the visited root moves, most visited
+    // first, while the search runs on num_threads workers of its own. Snapshots copy the
+    // root children and walk one principal variation per move, one node lock at a time,
+    // so reporting never holds up the workers for long.
+    using AnalysisCallback = std::function<void(const std::vector<MoveAnalysis>&)>;
+    std::vector<RootMoveStats> analyze(const go::Board& board,
+                                       go::Player to_play,
+                                       int move_number,
+                                       const std::atomic<bool>& stop,
+                                       std::chrono::milliseconds interval,
+                                       const AnalysisCallback& report);
+
+    // Visited root moves with their principal variations (at most pv_length moves each).
+    std::vector<MoveAnalysis> analysis_snapshot(std::size_t pv_length = 16) const;
+
     void notify_move(go::Move move, const go::Board& board_after_move, go::Player to_play);
 
+    // The game jumped to another position without a move, as after an undo, or its rules
+    // changed (trees are keyed by position and rules). The current tree joins the retained
+    // ones, and a retained tree for the new position, if any, becomes the root along with
+    // the retained trees of the moves played from it.
+    void notify_position(const go::Board& board, go::Player to_play);
+
     void reset();
 
+    // Root child statistics summed over every search tree (one unless root parallel).
+    std::vector<RootMoveStats> root_statistics() const;
+    // Root child statistics of each search tree, the main tree first.
+    std::vector<std::vector<RootMoveStats>> tree_statistics() const;
+
+    void set_root_contributor(std::shared_ptr<RootSearchContributor> contributor);
+
+    // Runs later searches as jobs on a shared pool instead of threads of their own, on
+    // at most num_threads pool workers at once (all of them when num_threads is 0).
+    // Thread pinning does not apply to pool workers. Pass nullptr to go back to threads.
+    void set_scheduler(std::shared_ptr<SearchScheduler> scheduler);
+
+    // Queue wait and wall time of the last search run on the scheduler.
+    const SearchScheduler::JobStats& last_job() const noexcept { return last_job_; }
+
+    // Per-phase counters of the last search, merged over its workers. Empty unless
+    // SearchConfig::collect_stats is set and TENUKI_SEARCH_STATS is compiled in.
+    const SearchStats& stats() const noexcept { return stats_; }
+    // Search workers that could not be bound to their cpu (pin_threads or numa_local_trees)
+    // since the agent was created. They keep searching unpinned.
+    int pin_failures() const noexcept { return pin_failures_.load(std::memory_order_relaxed); }
+
+    // Dumps the recorded event timeline as Chrome trace JSON. Returns false when
+    // SearchConfig::enable_trace is off. Best called between searches.
+    bool write_trace(std::ostream& out) const;
+
     const SearchConfig& config() const noexcept { return config_; }
+    // Later searches run with config. The current tree stays; retained trees beyond the
+    // new retained_trees are dropped, oldest first. Call between searches.
+    void set_config(const SearchConfig& config);
 
 private:
     struct Node {
@@ -83,10 +205,31 @@ private:
 
     using Child = Node::Child;
 
+    // A tree set aside by notify_move or notify_position. played_move is the move whose
+    // subtree was handed on to the next root, played_key the position it led to.
+    struct RetainedTree {
+        std::uint64_t key = 0;
+        std::unique_ptr<Node> root;
+        std::optional<int> played_move;
+        std::uint64_t played_key = 0;
+    };
+
     void ensure_root(const go::Board& board, go::Player to_play);
-    go::Move select_move_from_root(int move_number, std::mt19937& rng) const;
+    void retain_tree(std::uint64_t key, std::unique_ptr<Node> tree, std::optional<int> played_move,
+                     std::uint64_t played_key);
+    std::unique_ptr<Node> restore_tree(std::uint64_t key);
+    // Runs playouts simulations on the search trees, fewer once stop is set. While the
+    // workers run, the calling thread calls while_running when given, and works itself
+    // only on single-threaded searches without it.
+    void run_playouts(const go::Board& board, int move_number, int playouts,
+                      const std::atomic<bool>* stop, const std::function<void()>& while_running);
+    void prepare_root(Node& root, const go::Board& board, std::mt19937& rng);
+    void ensure_group_roots(const go::Board& board, int group_count, int move_number);
+    int tree_group_count(int thread_count) const;
+    int worker_cpu(int worker_index, int group) const;
+    go::Move select_move_from_stats(const std::vector<RootMoveStats>& stats, int move_number, std::mt19937& rng) const;
     bool try_expand(Node& node, const go::Board& board, float& value);
-    float run_simulation(const go::Board& root_board, std::mt19937& rng);
+    float run_simulation(const go::Board& root_board, Node& root, std::mt19937& rng);
     float simulate(go::Board board_copy, Node& node, std::mt19937& rng);
     int select_child(Node& node, std::mt19937& rng);
     void apply_virtual_loss(Node& node, std::size_t child_index);
@@ -99,13 +242,31 @@ private:
 
     SearchConfig config_{};
     std::shared_ptr<Evaluator> evaluator_;
+    std::shared_ptr<RootSearchContributor> contributor_;
+    std::shared_ptr<SearchScheduler> scheduler_;
+    SearchScheduler::JobStats last_job_;
     std::unique_ptr<Node> root_;
+    std::vector<std::unique_ptr<Node>> group_roots_; // extra independent trees for root parallelism
+    std::vector<RetainedTree> retained_;             // oldest first, at most retained_trees
     std::uint64_t root_hash_ = 0;
     go::Player root_player_ = go::Player::Black;
     bool root_ready_ = false;
     std::mt19937 rng_;
+    CpuTopology topology_;
+    std::atomic<int> pin_failures_{0};
+    SearchStats stats_;
+    std::unique_ptr<TraceRecorder> trace_;
 };
 
 std::shared_ptr<Evaluator> make_uniform_evaluator();
 
+// Adds the visits and values of `extra` to matching moves of `stats`; moves unknown to `stats` are
+// dropped. Distributed workers replay positions without their history, so this is where the
+// coordinator's superko-aware root filters out the moves they should not have searched.
+void merge_root_statistics(std::vector<RootMoveStats>& stats, const std::vector<RootMoveStats>& extra);
+
+// Sums visits and values per move over the union of moves in `trees`, in first-seen order.
+// A move's prior is the mean over the trees that hold it.
+std::vector<RootMoveStats> merge_tree_statistics(const std::vector<std::vector<RootMoveStats>>& trees);
+
 } // namespace search
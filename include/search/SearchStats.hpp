@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Set to 0 (CMake option TENUKI_SEARCH_STATS=OFF) to compile the instrumentation out entirely.
+#ifndef TENUKI_SEARCH_STATS
+#define TENUKI_SEARCH_STATS 1
+#endif
+
+namespace search {
+
+enum class SearchPhase : std::uint8_t {
+    Selection,  // PUCT child selection, including its mutex wait
+    BoardPlay,  // play_move on the simulation board copy
+    Legality,   // legal move generation in try_expand
+    Evaluation, // evaluator latency
+    Backprop,   // value propagation along the path
+    MutexWait,  // time blocked on contended node mutexes (counts contended acquisitions only)
+    Count
+};
+
+struct PhaseStats {
+    std::uint64_t count = 0;
+    std::uint64_t nanoseconds = 0;
+};
+
+struct SearchStats {
+    std::array<PhaseStats, static_cast<std::size_t>(SearchPhase::Count)> phases{};
+    std::uint64_t simulations = 0;
+    std::uint64_t depth_sum = 0;
+    std::uint64_t max_depth = 0;
+    std::uint64_t wall_nanoseconds = 0;
+
+    PhaseStats& phase(SearchPhase p) noexcept { return phases[static_cast<std::size_t>(p)]; }
+    const PhaseStats& phase(SearchPhase p) const noexcept { return phases[static_cast<std::size_t>(p)]; }
+
+    void merge(const SearchStats& other) noexcept;
+    void clear() noexcept { *this = SearchStats{}; }
+};
+
+const char* phase_name(SearchPhase phase) noexcept;
+
+// One "name count total_ms avg_us" line per phase followed by simulation and depth totals.
+std::string format_search_stats(const SearchStats& stats);
+
+// Accumulates the lifetime of the scope into `stats` (when non-null) under `phase`.
+class PhaseTimer {
+public:
+#if TENUKI_SEARCH_STATS
+    PhaseTimer(SearchStats* stats, SearchPhase phase) noexcept : stats_(stats), phase_(phase) {
+        if (stats_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PhaseTimer() {
+        if (stats_) {
+            const auto elapsed = std::chrono::steady_clock::now() - start_;
+            PhaseStats& entry = stats_->phase(phase_);
+            entry.count += 1;
+            entry.nanoseconds += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+private:
+    SearchStats* stats_;
+    SearchPhase phase_;
+    std::chrono::steady_clock::time_point start_{};
+#else
+    PhaseTimer(SearchStats*, SearchPhase) noexcept {}
+#endif
+
+public:
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+
+} // namespace search
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "search/Search.hpp"
+
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace search {
+
+enum class SymmetryMode {
+    Random, // each position is evaluated in one randomly drawn orientation
+    Average // all eight orientations go into the same inner batch and are averaged
+};
+
+const char* symmetry_mode_name(SymmetryMode mode);
+// Accepts "random" or "average"; throws std::invalid_argument otherwise.
+SymmetryMode parse_symmetry_mode(const std::string& name);
+
+// Evaluates positions through dihedral transforms of the board and maps the policy of
+// every orientation back onto the original points before returning it.
+class SymmetricEvaluator : public Evaluator {
+public:
+    SymmetricEvaluator(std::shared_ptr<Evaluator> inner, SymmetryMode mode, unsigned int seed = 0x5eed1234u);
+
+    EvaluationResult evaluate(const go::Board& board, go::Player to_play) override;
+    std::vector<EvaluationResult> evaluate_batch(const std::vector<EvaluationRequest>& requests) override;
+
+    SymmetryMode mode() const noexcept { return mode_; }
+
+private:
+    std::shared_ptr<Evaluator> inner_;
+    SymmetryMode mode_;
+    std::mutex rng_mutex_;
+    std::mt19937 rng_;
+};
+
+} // namespace search
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace search {
+
+struct CpuTopology {
+    std::vector<std::vector<int>> numa_nodes; // logical cpus of each NUMA node
+
+    std::size_t cpu_count() const noexcept;
+    bool is_numa() const noexcept { return numa_nodes.size() > 1; }
+};
+
+// Reads the NUMA layout from sysfs where available, keeping only the cpus in the process
+// affinity mask, so a process confined by taskset or a cgroup is not pinned outside it.
+// Anything else, including hosts without sysfs, is reported as a single node holding
+// every allowed cpu (every hardware thread where the mask is unknown).
+CpuTopology detect_topology();
+
+// Logical cpus the calling thread may run on; empty where the OS does not say.
+std::vector<int> allowed_cpus();
+
+// Keeps the cpus of each node that are in `allowed` and drops nodes left empty. An empty
+// `allowed` means no restriction.
+CpuTopology restrict_topology(const CpuTopology& topology, const std::vector<int>& allowed);
+
+// Parses a Linux cpulist such as "0-3,8,10-11"; malformed entries are skipped.
+std::vector<int> parse_cpu_list(const std::string& text);
+
+// Logical cpu for worker `worker_index` inside NUMA node `node`, cycling through that node's cpus.
+int cpu_for_worker(const CpuTopology& topology, std::size_t node, int worker_index);
+
+// Binds the calling thread to one cpu. Returns false (and does nothing) where unsupported.
+bool pin_current_thread(int cpu);
+
+std::string describe_topology(const CpuTopology& topology);
+
+} // namespace search
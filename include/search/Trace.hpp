@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Set to 0 (CMake option TENUKI_SEARCH_TRACE=OFF) to compile the trace hooks out entirely.
+#ifndef TENUKI_SEARCH_TRACE
+#define TENUKI_SEARCH_TRACE 1
+#endif
+
+namespace search {
+
+enum class TraceEvent : std::uint8_t {
+    Search,        // one SearchAgent::search call on the calling thread
+    Simulation,    // one playout from root to leaf and back
+    SelectChild,   // PUCT selection at one node
+    MutexWait,     // blocked on a contended node mutex
+    Evaluate,      // one evaluator call
+    BatchDispatch, // one batch handed to a batched evaluator backend
+    TreeReuse,     // subtree promotion in notify_move
+    Count
+};
+
+const char* trace_event_name(TraceEvent event) noexcept;
+
+// Timeline of begin/end events kept in fixed-size per-thread ring buffers. Each ring
+// has a single writer and is written without locks; when full, the oldest events are
+// overwritten. Rings are addressed by slot so repeated searches reuse them.
+class TraceRecorder {
+public:
+    explicit TraceRecorder(std::size_t events_per_thread = 1u << 16);
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // Writes the recorded events as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+    void write_chrome_trace(std::ostream& out) const;
+    void clear();
+
+    struct Ring;
+    Ring* ring(int slot);
+
+private:
+    std::size_t capacity_;
+    std::chrono::steady_clock::time_point epoch_;
+    mutable std::mutex mutex_;
+    std::map<int, std::unique_ptr<Ring>> rings_;
+};
+
+// Sends this thread's trace_begin/trace_end calls to ring `slot` of `recorder` (no-op
+// when null) until the scope ends. Only one thread may use a slot at a time.
+class TraceThreadScope {
+public:
+    TraceThreadScope(TraceRecorder* recorder, int slot) noexcept;
+    ~TraceThreadScope();
+
+    TraceThreadScope(const TraceThreadScope&) = delete;
+    TraceThreadScope& operator=(const TraceThreadScope&) = delete;
+
+private:
+#if TENUKI_SEARCH_TRACE
+    TraceRecorder::Ring* previous_ = nullptr;
+    bool attached_ = false;
+#endif
+};
+
+bool trace_active() noexcept;
+void trace_begin(TraceEvent event) noexcept;
+void trace_end(TraceEvent event) noexcept;
+
+class TraceSpan {
+public:
+    explicit TraceSpan(TraceEvent event) noexcept : event_(event) { trace_begin(event_); }
+    ~TraceSpan() { trace_end(event_); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceEvent event_;
+};
+
+} // namespace search
@@ -14,14 +14,34 @@ struct MoveRecord {
     go::Move move;
 };
 
+// Stones placed before the first move (AB/AW, with AE clearing earlier ones), the player
+// to move after them (PL) and the handicap they stand for (HA, informational).
+struct Setup {
+    std::vector<int> black;
+    std::vector<int> white;
+    std::optional<go::Player> to_play;
+    int handicap = 0;
+
+    bool empty() const noexcept { return black.empty() && white.empty(); }
+};
+
 struct GameTree {
     std::size_t board_size = 19;
-    double komi = 7.5;
+    std::optional<double> komi; // KM; unset when the game does not give one
+    Setup setup;
     std::vector<MoveRecord> moves;
 };
 
+// Reads the main line of the first game: the first variation is followed at every branch.
+// Throws std::invalid_argument for points off the board and for setup stones placed
+// after the first move, which a move list cannot represent.
 GameTree load(std::istream& input);
 void save(const GameTree& game, std::ostream& output);
 
+// Places the game's setup stones on board, an empty board of the game's size, and gives
+// the move to PL, else to the first move's player, else to White after handicap stones
+// alone. Leaves the board untouched when the game has no setup.
+void apply_setup(const GameTree& game, go::Board& board);
+
 } // namespace sgf
 
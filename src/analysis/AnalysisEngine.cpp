@@ -0,0 +1,360 @@
+#include "analysis/AnalysisEngine.hpp"
+
+#include "analysis/Json.hpp"
+#include "search/RolloutEvaluator.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace analysis {
+namespace {
+
+go::Player parse_player(const JsonValue& value) {
+    const std::string& text = value.as_string();
+    if (text == "B" || text == "b" || text == "black") {
+        return go::Player::Black;
+    }
+    if (text == "W" || text == "w" || text == "white") {
+        return go::Player::White;
+    }
+    throw std::invalid_argument("Invalid player: " + text);
+}
+
+// GTP coordinates: column letters skipping I, row 1 at the bottom.
+go::Move parse_vertex(const std::string& text, std::size_t size) {
+    if (text == "pass" || text == "PASS" || text == "Pass") {
+        return go::Move::Pass();
+    }
+    if (text.size() < 2) {
+        throw std::invalid_argument("Invalid vertex: " + text);
+    }
+    const char letter = static_cast<char>(text.front() & ~0x20);
+    if (letter < 'A' || letter > 'Z' || letter == 'I') {
+        throw std::invalid_argument("Invalid vertex: " + text);
+    }
+    const std::size_t column = static_cast<std::size_t>(letter - 'A') - (letter > 'I' ? 1u : 0u);
+    std::size_t row = 0;
+    for (std::size_t i = 1; i < text.size(); ++i) {
+        if (text[i] < '0' || text[i] > '9' || row > size) {
+            throw std::invalid_argument("Invalid vertex: " + text);
+        }
+        row = row * 10 + static_cast<std::size_t>(text[i] - '0');
+    }
+    if (column >= size || row == 0 || row > size) {
+        throw std::invalid_argument("Invalid vertex: " + text);
+    }
+    return go::Move(static_cast<int>((size - row) * size + column));
+}
+
+std::string vertex_name(int move, std::size_t size) {
+    if (move < 0) {
+        return "pass";
+    }
+    const std::size_t v = static_cast<std::size_t>(move);
+    char column = static_cast<char>('A' + v % size);
+    if (column >= 'I') {
+        column += 1;
+    }
+    return column + std::to_string(size - v / size);
+}
+
+std::vector<std::pair<go::Player, go::Move>> parse_move_list(const JsonValue& value, std::size_t size) {
+    std::vector<std::pair<go::Player, go::Move>> moves;
+    for (const JsonValue& entry : value.as_array()) {
+        const std::vector<JsonValue>& pair = entry.as_array();
+        if (pair.size() != 2) {
+            throw std::invalid_argument("Moves must be [player, vertex] pairs");
+        }
+        moves.emplace_back(parse_player(pair[0]), parse_vertex(pair[1].as_string(), size));
+    }
+    return moves;
+}
+
+// The id of a query that failed to parse, when one can still be read.
+std::string salvage_id(std::string_view line) {
+    try {
+        const JsonValue value = parse_json(line);
+        if (value.type() == JsonValue::Type::Object) {
+            if (const JsonValue* id = value.find("id"); id && id->type() == JsonValue::Type::String) {
+                return id->as_string();
+            }
+        }
+    } catch (const std::invalid_argument&) {
+    }
+    return {};
+}
+
+} // namespace
+
+AnalysisQuery parse_query(std::string_view line) {
+    const JsonValue value = parse_json(line);
+    AnalysisQuery query;
+    const JsonValue* id = value.find("id");
+    if (!id) {
+        throw std::invalid_argument("Query has no id");
+    }
+    query.id = id->as_string();
+
+    std::size_t size = 19;
+    const JsonValue* width = value.find("boardXSize");
+    const JsonValue* height = value.find("boardYSize");
+    if (width || height) {
+        const int x = width ? width->as_int() : height->as_int();
+        const int y = height ? height->as_int() : x;
+        if (x != y) {
+            throw std::invalid_argument("Only square boards are supported");
+        }
+        if (x < 1 || x > 25) {
+            throw std::invalid_argument("Board size must be between 1 and 25");
+        }
+        size = static_cast<std::size_t>(x);
+    }
+    query.rules.board_size = size;
+    if (const JsonValue* rules = value.find("rules")) {
+        go::apply_rules_name(query.rules, rules->as_string());
+    }
+    if (const JsonValue* komi = value.find("komi")) {
+        query.rules.komi = komi->as_number();
+    }
+    if (const JsonValue* stones = value.find("initialStones")) {
+        query.initial_stones = parse_move_list(*stones, size);
+    }
+    if (const JsonValue* player = value.find("initialPlayer")) {
+        query.initial_player = parse_player(*player);
+    }
+    if (const JsonValue* moves = value.find("moves")) {
+        query.moves = parse_move_list(*moves, size);
+    }
+    if (const JsonValue* turns = value.find("analyzeTurns")) {
+        for (const JsonValue& turn : turns->as_array()) {
+            query.analyze_turns.push_back(turn.as_int());
+        }
+    } else {
+        query.analyze_turns.push_back(static_cast<int>(query.moves.size()));
+    }
+    if (const JsonValue* visits = value.find("maxVisits")) {
+        query.max_visits = visits->as_int();
+        if (query.max_visits < 1) {
+            throw std::invalid_argument("maxVisits must be positive");
+        }
+    }
+    if (const JsonValue* ownership = value.find("includeOwnership")) {
+        query.include_ownership = ownership->as_bool();
+    }
+    return query;
+}
+
+AnalysisEngine::AnalysisEngine(AnalysisOptions options, std::shared_ptr<search::Evaluator> evaluator, ResponseCallback respond)
+    : options_(std::move(options)),
+      evaluator_(evaluator ? std::move(evaluator) : search::make_uniform_evaluator()),
+      respond_(std::move(respond)) {
+    options_.search.num_threads = 1;
+    options_.search.enable_playout_cap_randomization = false;
+    options_.search.dirichlet_epsilon = 0.0f;
+    options_.search.enable_trace = false;
+    options_.search.collect_stats = false;
+    int threads = options_.threads;
+    if (threads <= 0) {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    workers_.reserve(static_cast<std::size_t>(threads));
+    for (int t = 0; t < threads; ++t) {
+        workers_.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+AnalysisEngine::~AnalysisEngine() {
+    {
+        std::scoped_lock lock(mutex_);
+        stopping_ = true;
+    }
+    work_ready_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void AnalysisEngine::submit(std::string_view line) {
+    AnalysisQuery query;
+    try {
+        query = parse_query(line);
+    } catch (const std::invalid_argument& ex) {
+        respond_error(salvage_id(line), ex.what());
+        return;
+    }
+    submit(query);
+}
+
+void AnalysisEngine::submit(const AnalysisQuery& query) {
+    auto shared = std::make_shared<const AnalysisQuery>(query);
+    const int move_count = static_cast<int>(query.moves.size());
+    std::vector<int> turns = query.analyze_turns;
+    std::sort(turns.begin(), turns.end());
+    turns.erase(std::unique(turns.begin(), turns.end()), turns.end());
+    if (turns.empty() || turns.front() < 0 || turns.back() > move_count) {
+        respond_error(query.id, "analyzeTurns out of range");
+        return;
+    }
+
+    // Replay the game once, taking a board for every requested turn along the way.
+    go::Board board(query.rules);
+    const std::size_t area = query.rules.board_size * query.rules.board_size;
+    if (!query.initial_stones.empty()) {
+        std::vector<go::PointState> points(area, go::PointState::Empty);
+        for (const auto& [player, move] : query.initial_stones) {
+            if (!move.is_pass()) {
+                points[static_cast<std::size_t>(move.vertex)] = go::to_point(player);
+            }
+        }
+        board.set_position(points, query.initial_player);
+    }
+    board.set_to_play(query.initial_player);
+
+    std::vector<Task> tasks;
+    tasks.reserve(turns.size());
+    go::Player to_play = query.initial_player;
+    std::size_t next = 0;
+    for (int turn = 0; turn <= move_count && next < turns.size(); ++turn) {
+        if (turns[next] == turn) {
+            tasks.push_back(Task{shared, turn, board, to_play});
+            ++next;
+        }
+        if (turn == move_count) {
+            break;
+        }
+        const auto& [player, move] = query.moves[static_cast<std::size_t>(turn)];
+        if (!board.play_move(player, move)) {
+            respond_error(query.id, "Illegal move " + std::to_string(turn + 1) + ": " +
+                                        vertex_name(move.is_pass() ? -1 : move.vertex, query.rules.board_size));
+            return;
+        }
+        to_play = go::other(player);
+    }
+
+    {
+        std::scoped_lock lock(mutex_);
+        for (Task& task : tasks) {
+            queue_.push_back(std::move(task));
+        }
+    }
+    work_ready_.notify_all();
+}
+
+void AnalysisEngine::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return queue_.empty() && busy_ == 0; });
+}
+
+AnalysisEngine::Counters AnalysisEngine::counters() const {
+    std::scoped_lock lock(mutex_);
+    return counters_;
+}
+
+void AnalysisEngine::worker_loop() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_ready_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            task = std::move(queue_.front());
+            queue_.pop_front();
+            ++busy_;
+        }
+        std::string line;
+        try {
+            line = analyze(task);
+        } catch (const std::exception& ex) {
+            respond_error(task.query->id, ex.what());
+        }
+        if (!line.empty()) {
+            respond(line);
+        }
+        {
+            std::scoped_lock lock(mutex_);
+            --busy_;
+            if (queue_.empty() && busy_ == 0) {
+                idle_.notify_all();
+            }
+        }
+    }
+}
+
+std::string AnalysisEngine::analyze(const Task& task) {
+    const AnalysisQuery& query = *task.query;
+    const std::size_t size = query.rules.board_size;
+    search::SearchConfig config = options_.search;
+    config.max_playouts = query.max_visits > 0 ? query.max_visits : options_.max_visits;
+    search::SearchAgent agent(config, evaluator_);
+    agent.search(task.board, task.to_play, task.turn);
+    const std::vector<search::MoveAnalysis> moves = agent.analysis_snapshot(options_.pv_length);
+
+    int visits = 0;
+    double value_sum = 0.0;
+    for (const search::MoveAnalysis& move : moves) {
+        visits += move.stats.visit_count;
+        value_sum += move.stats.value_sum;
+    }
+    const auto winrate = [](double value) { return std::clamp((1.0 + value) / 2.0, 0.0, 1.0); };
+
+    std::ostringstream out;
+    out << std::setprecision(6) << "{\"id\":";
+    write_json_string(out, query.id);
+    out << ",\"turnNumber\":" << task.turn << ",\"isDuringSearch\":false,\"rootInfo\":{\"visits\":" << visits
+        << ",\"winrate\":" << winrate(visits > 0 ? value_sum / visits : 0.0) << ",\"currentPlayer\":\""
+        << (task.to_play == go::Player::Black ? 'B' : 'W') << "\"},\"moveInfos\":[";
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const search::RootMoveStats& stats = moves[i].stats;
+        out << (i > 0 ? "," : "") << "{\"move\":\"" << vertex_name(stats.move, size) << "\",\"visits\":"
+            << stats.visit_count << ",\"winrate\":" << winrate(static_cast<double>(stats.value_sum) / stats.visit_count)
+            << ",\"prior\":" << stats.prior << ",\"order\":" << i << ",\"pv\":[";
+        for (std::size_t j = 0; j < moves[i].pv.size(); ++j) {
+            out << (j > 0 ? "," : "") << '"' << vertex_name(moves[i].pv[j], size) << '"';
+        }
+        out << "]}";
+    }
+    out << ']';
+    if (query.include_ownership) {
+        search::RolloutConfig rollout_config;
+        rollout_config.playouts = std::max(1, options_.ownership_playouts);
+        rollout_config.seed = config.seed ^ static_cast<std::uint64_t>(task.turn);
+        search::RolloutEvaluator playouts(rollout_config);
+        const std::vector<float> ownership = playouts.rollouts(task.board, task.to_play).ownership;
+        out << std::setprecision(4) << ",\"ownership\":[";
+        for (std::size_t v = 0; v < ownership.size(); ++v) {
+            out << (v > 0 ? "," : "") << ownership[v];
+        }
+        out << ']';
+    }
+    out << '}';
+
+    {
+        std::scoped_lock lock(mutex_);
+        counters_.positions += 1;
+        counters_.visits += static_cast<std::uint64_t>(visits);
+    }
+    return out.str();
+}
+
+void AnalysisEngine::respond(const std::string& line) {
+    std::scoped_lock lock(respond_mutex_);
+    if (respond_) {
+        respond_(line);
+    }
+}
+
+void AnalysisEngine::respond_error(const std::string& id, const std::string& message) {
+    std::ostringstream out;
+    out << "{\"id\":";
+    write_json_string(out, id);
+    out << ",\"error\":";
+    write_json_string(out, message);
+    out << '}';
+    respond(out.str());
+}
+
+} // namespace analysis
@@ -0,0 +1,423 @@
+#include "analysis/Json.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+namespace analysis {
+namespace {
+
+constexpr int kMaxDepth = 64;
+
+class Parser {
+public:
+    explicit Parser(std::string_view text) : text_(text) {}
+
+    JsonValue parse_document() {
+        JsonValue value = parse_value(0);
+        skip_whitespace();
+        if (pos_ != text_.size()) {
+            fail("trailing characters");
+        }
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const char* what) const {
+        throw std::invalid_argument("Invalid JSON at offset " + std::to_string(pos_) + ": " + what);
+    }
+
+    void skip_whitespace() noexcept {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) noexcept {
+        if (pos_ < text_.size() && text_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect_literal(std::string_view literal) {
+        if (text_.substr(pos_, literal.size()) != literal) {
+            fail("unexpected token");
+        }
+        pos_ += literal.size();
+    }
+
+    JsonValue parse_value(int depth) {
+        if (depth > kMaxDepth) {
+            fail("nested too deeply");
+        }
+        skip_whitespace();
+        if (pos_ >= text_.size()) {
+            fail("unexpected end");
+        }
+        switch (text_[pos_]) {
+        case '{':
+            return parse_object(depth);
+        case '[':
+            return parse_array(depth);
+        case '"':
+            return JsonValue::string(parse_string());
+        case 't':
+            expect_literal("true");
+            return JsonValue::boolean(true);
+        case 'f':
+            expect_literal("false");
+            return JsonValue::boolean(false);
+        case 'n':
+            expect_literal("null");
+            return JsonValue();
+        default:
+            return JsonValue::number(parse_number());
+        }
+    }
+
+    JsonValue parse_object(int depth) {
+        ++pos_;
+        std::vector<std::pair<std::string, JsonValue>> members;
+        skip_whitespace();
+        if (consume('}')) {
+            return JsonValue::object(std::move(members));
+        }
+        do {
+            skip_whitespace();
+            if (pos_ >= text_.size() || text_[pos_] != '"') {
+                fail("expected member name");
+            }
+            std::string key = parse_string();
+            skip_whitespace();
+            if (!consume(':')) {
+                fail("expected ':'");
+            }
+            JsonValue value = parse_value(depth + 1);
+            members.emplace_back(std::move(key), std::move(value));
+            skip_whitespace();
+        } while (consume(','));
+        if (!consume('}')) {
+            fail("expected ',' or '}'");
+        }
+        return JsonValue::object(std::move(members));
+    }
+
+    JsonValue parse_array(int depth) {
+        ++pos_;
+        std::vector<JsonValue> items;
+        skip_whitespace();
+        if (consume(']')) {
+            return JsonValue::array(std::move(items));
+        }
+        do {
+            items.push_back(parse_value(depth + 1));
+            skip_whitespace();
+        } while (consume(','));
+        if (!consume(']')) {
+            fail("expected ',' or ']'");
+        }
+        return JsonValue::array(std::move(items));
+    }
+
+    std::uint32_t parse_hex4() {
+        if (pos_ + 4 > text_.size()) {
+            fail("truncated \\u escape");
+        }
+        std::uint32_t code = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = text_[pos_++];
+            code <<= 4;
+            if (c >= '0' && c <= '9') {
+                code |= static_cast<std::uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                code |= static_cast<std::uint32_t>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                code |= static_cast<std::uint32_t>(c - 'A' + 10);
+            } else {
+                fail("bad \\u escape");
+            }
+        }
+        return code;
+    }
+
+    static void append_utf8(std::string& out, std::uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xc0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xe0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+    }
+
+    std::string parse_string() {
+        ++pos_;
+        std::string out;
+        while (true) {
+            if (pos_ >= text_.size()) {
+                fail("unterminated string");
+            }
+            const char c = text_[pos_++];
+            if (c == '"') {
+                return out;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                fail("control character in string");
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) {
+                fail("unterminated string");
+            }
+            const char escape = text_[pos_++];
+            switch (escape) {
+            case '"':
+            case '\\':
+            case '/':
+                out += escape;
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'n':
+                out += '\n';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'u': {
+                std::uint32_t code = parse_hex4();
+                if (code >= 0xd800 && code < 0xdc00) {
+                    if (text_.substr(pos_, 2) != "\\u") {
+                        fail("unpaired surrogate");
+                    }
+                    pos_ += 2;
+                    const std::uint32_t low = parse_hex4();
+                    if (low < 0xdc00 || low >= 0xe000) {
+                        fail("unpaired surrogate");
+                    }
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                } else if (code >= 0xdc00 && code < 0xe000) {
+                    fail("unpaired surrogate");
+                }
+                append_utf8(out, code);
+                break;
+            }
+            default:
+                fail("bad escape");
+            }
+        }
+    }
+
+    double parse_number() {
+        // Validate the JSON grammar first; strtod alone would also take hex, inf and nan.
+        const std::size_t start = pos_;
+        consume('-');
+        if (consume('0')) {
+        } else if (pos_ < text_.size() && text_[pos_] >= '1' && text_[pos_] <= '9') {
+            skip_digits();
+        } else {
+            fail("unexpected token");
+        }
+        if (consume('.')) {
+            if (!skip_digits()) {
+                fail("expected digits");
+            }
+        }
+        if (consume('e') || consume('E')) {
+            if (!consume('+')) {
+                consume('-');
+            }
+            if (!skip_digits()) {
+                fail("expected digits");
+            }
+        }
+        const std::string literal(text_.substr(start, pos_ - start));
+        return std::strtod(literal.c_str(), nullptr);
+    }
+
+    bool skip_digits() noexcept {
+        const std::size_t start = pos_;
+        while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+            ++pos_;
+        }
+        return pos_ > start;
+    }
+
+    std::string_view text_;
+    std::size_t pos_ = 0;
+};
+
+const char* type_name(JsonValue::Type type) {
+    switch (type) {
+    case JsonValue::Type::Null:
+        return "null";
+    case JsonValue::Type::Bool:
+        return "boolean";
+    case JsonValue::Type::Number:
+        return "number";
+    case JsonValue::Type::String:
+        return "string";
+    case JsonValue::Type::Array:
+        return "array";
+    case JsonValue::Type::Object:
+        return "object";
+    }
+    return "value";
+}
+
+[[noreturn]] void type_mismatch(JsonValue::Type expected, JsonValue::Type actual) {
+    throw std::invalid_argument(std::string("Expected JSON ") + type_name(expected) + ", got " + type_name(actual));
+}
+
+} // namespace
+
+JsonValue JsonValue::boolean(bool value) {
+    JsonValue result;
+    result.type_ = Type::Bool;
+    result.bool_ = value;
+    return result;
+}
+
+JsonValue JsonValue::number(double value) {
+    JsonValue result;
+    result.type_ = Type::Number;
+    result.number_ = value;
+    return result;
+}
+
+JsonValue JsonValue::string(std::string value) {
+    JsonValue result;
+    result.type_ = Type::String;
+    result.string_ = std::move(value);
+    return result;
+}
+
+JsonValue JsonValue::array(std::vector<JsonValue> items) {
+    JsonValue result;
+    result.type_ = Type::Array;
+    result.items_ = std::move(items);
+    return result;
+}
+
+JsonValue JsonValue::object(std::vector<std::pair<std::string, JsonValue>> members) {
+    JsonValue result;
+    result.type_ = Type::Object;
+    result.members_ = std::move(members);
+    return result;
+}
+
+bool JsonValue::as_bool() const {
+    if (type_ != Type::Bool) {
+        type_mismatch(Type::Bool, type_);
+    }
+    return bool_;
+}
+
+double JsonValue::as_number() const {
+    if (type_ != Type::Number) {
+        type_mismatch(Type::Number, type_);
+    }
+    return number_;
+}
+
+int JsonValue::as_int() const {
+    const double value = as_number();
+    if (value != std::floor(value) || value < std::numeric_limits<int>::min() ||
+        value > std::numeric_limits<int>::max()) {
+        throw std::invalid_argument("Expected JSON integer");
+    }
+    return static_cast<int>(value);
+}
+
+const std::string& JsonValue::as_string() const {
+    if (type_ != Type::String) {
+        type_mismatch(Type::String, type_);
+    }
+    return string_;
+}
+
+const std::vector<JsonValue>& JsonValue::as_array() const {
+    if (type_ != Type::Array) {
+        type_mismatch(Type::Array, type_);
+    }
+    return items_;
+}
+
+const std::vector<std::pair<std::string, JsonValue>>& JsonValue::as_object() const {
+    if (type_ != Type::Object) {
+        type_mismatch(Type::Object, type_);
+    }
+    return members_;
+}
+
+const JsonValue* JsonValue::find(std::string_view key) const {
+    const JsonValue* found = nullptr;
+    for (const auto& member : as_object()) {
+        if (member.first == key) {
+            found = &member.second;
+        }
+    }
+    return found;
+}
+
+JsonValue parse_json(std::string_view text) {
+    return Parser(text).parse_document();
+}
+
+void write_json_string(std::ostream& out, std::string_view text) {
+    out << '"';
+    for (const char c : text) {
+        switch (c) {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\r':
+            out << "\\r";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(c)));
+                out << escaped;
+            } else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
+
+} // namespace analysis
@@ -1,8 +1,10 @@
 #include "go/Board.hpp"
 
+#include "go/Pattern.hpp"
+#include "go/Scoring.hpp"
+
 #include <algorithm>
 #include <array>
-#include <queue>
 #include <stdexcept>
 
 namespace go {
@@ -10,27 +12,163 @@ namespace go {
 namespace {
 constexpr std::array<int, 4> kDx{1, -1, 0, 0};
 constexpr std::array<int, 4> kDy{0, 0, 1, -1};
+constexpr int kNoRecentMove = -2;
+constexpr std::size_t kMaxBoardSize = 25;
+
+const std::array<int, 4>* adjacency_table(std::size_t board_size) {
+    static const std::vector<std::vector<std::array<int, 4>>> tables = [] {
+        std::vector<std::vector<std::array<int, 4>>> all(kMaxBoardSize + 1);
+        for (int size = 1; size <= static_cast<int>(kMaxBoardSize); ++size) {
+            auto& table = all[static_cast<std::size_t>(size)];
+            table.resize(static_cast<std::size_t>(size * size));
+            for (int vertex = 0; vertex < size * size; ++vertex) {
+                const int x = vertex % size;
+                const int y = vertex / size;
+                for (std::size_t dir = 0; dir < 4; ++dir) {
+                    const int nx = x + kDx[dir];
+                    const int ny = y + kDy[dir];
+                    const bool inside = nx >= 0 && ny >= 0 && nx < size && ny < size;
+                    table[static_cast<std::size_t>(vertex)][dir] = inside ? ny * size + nx : -1;
+                }
+            }
+        }
+        return all;
+    }();
+    return tables[board_size].data();
+}
+
+const std::array<int, 8>* pattern_neighbor_table(std::size_t board_size) {
+    static const std::vector<std::vector<std::array<int, 8>>> tables = [] {
+        std::vector<std::vector<std::array<int, 8>>> all(kMaxBoardSize + 1);
+        for (int size = 1; size <= static_cast<int>(kMaxBoardSize); ++size) {
+            auto& table = all[static_cast<std::size_t>(size)];
+            table.resize(static_cast<std::size_t>(size * size));
+            for (int vertex = 0; vertex < size * size; ++vertex) {
+                for (std::size_t slot = 0; slot < kPatternOffsets.size(); ++slot) {
+                    const int nx = vertex % size + kPatternOffsets[slot][0];
+                    const int ny = vertex / size + kPatternOffsets[slot][1];
+                    const bool inside = nx >= 0 && ny >= 0 && nx < size && ny < size;
+                    table[static_cast<std::size_t>(vertex)][slot] = inside ? ny * size + nx : -1;
+                }
+            }
+        }
+        return all;
+    }();
+    return tables[board_size].data();
+}
+
+// Per-thread visit stamps so liberty counting neither allocates nor writes to the board.
+class VertexMarks {
+public:
+    void begin(std::size_t size) {
+        if (stamps_.size() < size) {
+            stamps_.resize(size, 0);
+        }
+        if (++epoch_ == 0) {
+            std::fill(stamps_.begin(), stamps_.end(), 0u);
+            epoch_ = 1;
+        }
+    }
+
+    bool mark(int vertex) {
+        std::uint32_t& stamp = stamps_[static_cast<std::size_t>(vertex)];
+        if (stamp == epoch_) {
+            return false;
+        }
+        stamp = epoch_;
+        return true;
+    }
+
+private:
+    std::vector<std::uint32_t> stamps_;
+    std::uint32_t epoch_ = 0;
+};
+
+VertexMarks& vertex_marks() {
+    thread_local VertexMarks marks;
+    return marks;
 }
 
+std::uint64_t stone_hash(const ZobristTable& zobrist, PointState color, int vertex) {
+    const std::size_t vertex_index = static_cast<std::size_t>(vertex);
+    return color == PointState::Black ? zobrist.black_stone_hash(vertex_index) : zobrist.white_stone_hash(vertex_index);
+}
+
+template <std::size_t N>
+bool contains(const std::array<int, N>& values, int count, int value) {
+    return std::find(values.begin(), values.begin() + count, value) != values.begin() + count;
+}
+
+} // namespace
+
 Board::Board(const Rules& rules) : rules_(rules) {
-    if (rules.board_size == 0 || rules.board_size > 25) {
+    if (rules.board_size == 0 || rules.board_size > kMaxBoardSize) {
         throw std::invalid_argument("Board size must be between 1 and 25");
     }
     board_len_ = rules_.board_size * rules_.board_size;
     board_.assign(board_len_, PointState::Empty);
-    zobrist_ = ZobristTable(rules_.board_size);
+    adjacency_ = adjacency_table(rules_.board_size);
+    chain_head_.assign(board_len_, -1);
+    chain_next_.assign(board_len_, -1);
+    chain_liberties_.assign(board_len_, 0);
+    chain_stones_.assign(board_len_, 0);
+    zobrist_ = &ZobristTable::for_board_size(rules_.board_size);
+    symmetry_ = symmetry_table(rules_.board_size);
+    pattern_neighbors_ = pattern_neighbor_table(rules_.board_size);
     clear();
 }
 
 void Board::clear() {
     std::fill(board_.begin(), board_.end(), PointState::Empty);
+    std::fill(chain_head_.begin(), chain_head_.end(), -1);
+    std::fill(chain_next_.begin(), chain_next_.end(), -1);
+    std::fill(chain_liberties_.begin(), chain_liberties_.end(), 0);
+    std::fill(chain_stones_.begin(), chain_stones_.end(), 0);
+    recent_moves_.fill(kNoRecentMove);
     to_play_ = Player::Black;
     set_ko(std::nullopt);
-    position_hash_ = 0;
+    hashes_.fill(0);
     position_history_.clear();
     history_stack_.clear();
-    position_history_.insert(position_hash_);
-    history_stack_.push_back(position_hash_);
+    position_history_.insert(hashes_[0]);
+    history_stack_.push_back(hashes_[0]);
+    undo_log_.clear();
+    undo_captures_.clear();
+    if (tracks_patterns()) {
+        rebuild_patterns();
+    }
+}
+
+void Board::set_position(const std::vector<PointState>& points, Player to_play, std::optional<int> ko_vertex) {
+    if (points.size() != board_len_) {
+        throw std::invalid_argument("position size does not match board size");
+    }
+    if (ko_vertex && (*ko_vertex < 0 || static_cast<std::size_t>(*ko_vertex) >= board_len_)) {
+        throw std::invalid_argument("ko vertex out of range");
+    }
+    clear();
+    for (std::size_t v = 0; v < board_len_; ++v) {
+        if (points[v] != PointState::Empty) {
+            place_stone(static_cast<int>(v), points[v]);
+        }
+    }
+    rebuild_chains();
+    if (tracks_patterns()) {
+        rebuild_patterns();
+    }
+    set_ko(ko_vertex);
+    to_play_ = to_play;
+    position_history_.clear();
+    history_stack_.clear();
+    position_history_.insert(hashes_[0]);
+    history_stack_.push_back(hashes_[0]);
+}
+
+void Board::set_rules(const Rules& rules) {
+    if (rules.board_size != rules_.board_size) {
+        throw std::invalid_argument("set_rules cannot change the board size");
+    }
+    rules_ = rules;
 }
 
 void Board::set_to_play(Player player) {
@@ -44,170 +182,210 @@ PointState Board::point_state(std::size_t vertex) const {
     return board_[vertex];
 }
 
+std::optional<Move> Board::recent_move(std::size_t age) const noexcept {
+    if (age >= kRecentMoves || recent_moves_[age] == kNoRecentMove) {
+        return std::nullopt;
+    }
+    return Move(recent_moves_[age]);
+}
+
 bool Board::play_move(Player player, Move move) {
     if (move.is_pass()) {
+        log_undo(player, Move::Pass().vertex);
         set_ko(std::nullopt);
         to_play_ = other(player);
-        history_stack_.push_back(position_hash_);
-        position_history_.insert(position_hash_);
+        record_move(Move::Pass().vertex);
+        history_stack_.push_back(hashes_[0]);
+        const bool new_position = position_history_.insert(hashes_[0]).second;
+        if (undo_enabled_) {
+            undo_log_.back().new_position = new_position;
+        }
         return true;
     }
 
-    if (move.vertex < 0 || static_cast<std::size_t>(move.vertex) >= board_len_) {
+    MoveEffect effect;
+    if (!analyze_move(player, move.vertex, effect)) {
         return false;
     }
+    log_undo(player, move.vertex);
 
+    const PointState stone = to_point(player);
     const std::size_t move_index = static_cast<std::size_t>(move.vertex);
-
-    if (board_[move_index] != PointState::Empty) {
-        return false;
-    }
-
-    if (ko_vertex_.has_value() && ko_vertex_.value() == move.vertex) {
-        return false;
-    }
-
-    PointState stone = to_point(player);
-    PointState opponent = to_point(other(player));
-
-    auto previous_ko = ko_vertex_;
     place_stone(move.vertex, stone);
 
-    std::vector<int> captured;
-    captured.reserve(4 * rules_.board_size);
-
-    for (int neighbor : neighbors(move.vertex)) {
-        const std::size_t neighbor_index = static_cast<std::size_t>(neighbor);
-        if (board_[neighbor_index] != opponent) {
+    // The new stone takes a liberty from every chain it touches, once per chain.
+    std::array<int, 4> touched{};
+    int touched_count = 0;
+    for (int neighbor : adjacency_[move_index]) {
+        if (neighbor < 0 || board_[static_cast<std::size_t>(neighbor)] == PointState::Empty) {
             continue;
         }
-        std::vector<int> group;
-        if (collect_group(neighbor, opponent, group) == 0) {
-            for (int v : group) {
-                remove_stone(v);
-                captured.push_back(v);
-            }
+        const int head = chain_head_[static_cast<std::size_t>(neighbor)];
+        if (!contains(touched, touched_count, head)) {
+            touched[static_cast<std::size_t>(touched_count++)] = head;
+            --chain_liberties_[static_cast<std::size_t>(head)];
         }
     }
-
-    std::vector<bool> visited(board_len_, false);
-    std::vector<bool> liberty_seen(board_len_, false);
-    int liberties = count_liberties(move.vertex, stone, visited, liberty_seen);
-    if (liberties == 0 && captured.empty() && !rules_.allow_suicide) {
-        remove_stone(move.vertex);
-        for (int v : captured) {
-            place_stone(v, opponent);
+    for (int neighbor : adjacency_[move_index]) {
+        if (neighbor >= 0 && board_[static_cast<std::size_t>(neighbor)] == stone &&
+            chain_head_[static_cast<std::size_t>(neighbor)] != chain_head_[move_index]) {
+            merge_chains(chain_head_[move_index], chain_head_[static_cast<std::size_t>(neighbor)]);
         }
-        set_ko(previous_ko);
-        return false;
     }
-
-    std::optional<int> new_ko;
-    if (captured.size() == 1) {
-        // Check for simple ko shape: newly placed stone must have exactly one liberty.
-        std::fill(visited.begin(), visited.end(), false);
-        std::fill(liberty_seen.begin(), liberty_seen.end(), false);
-        if (count_liberties(move.vertex, stone, visited, liberty_seen) == 1) {
-            new_ko = captured.front();
+    const int head = chain_head_[move_index];
+    chain_liberties_[static_cast<std::size_t>(head)] = count_chain_liberties(head);
+
+    for (int i = 0; i < effect.captured_chains; ++i) {
+        const int captured = effect.captured[static_cast<std::size_t>(i)];
+        if (undo_enabled_) {
+            int v = captured;
+            do {
+                undo_captures_.push_back(v);
+                v = chain_next_[static_cast<std::size_t>(v)];
+            } while (v != captured);
         }
+        remove_chain(captured);
     }
-    set_ko(new_ko);
-
-    if (violates_superko(position_hash_)) {
-        // Undo move
-        set_ko(previous_ko);
-        remove_stone(move.vertex);
-        for (int v : captured) {
-            place_stone(v, opponent);
+    set_ko(effect.ko);
+
+    if (tracks_patterns()) {
+        // Captures were refreshed as they freed liberties; what is left are opponent
+        // chains this stone put in atari and the stone's own chain.
+        for (int i = 0; i < touched_count; ++i) {
+            const std::size_t other_head = static_cast<std::size_t>(touched[static_cast<std::size_t>(i)]);
+            if (board_[other_head] != PointState::Empty && board_[other_head] != stone &&
+                chain_liberties_[other_head] == 1) {
+                refresh_atari_flags(static_cast<int>(other_head));
+            }
         }
-        return false;
+        refresh_atari_flags(chain_head_[move_index]);
     }
 
     to_play_ = other(player);
-    history_stack_.push_back(position_hash_);
-    position_history_.insert(position_hash_);
+    record_move(move.vertex);
+    history_stack_.push_back(hashes_[0]);
+    const bool new_position = position_history_.insert(hashes_[0]).second;
+    if (undo_enabled_) {
+        undo_log_.back().new_position = new_position;
+    }
     return true;
 }
 
-bool Board::is_legal(Player player, Move move) const {
-    Board copy(*this);
-    return copy.play_move(player, move);
+void Board::set_undo_log(bool enabled) {
+    undo_enabled_ = enabled;
+    undo_log_.clear();
+    undo_captures_.clear();
 }
 
-std::size_t Board::index(std::size_t x, std::size_t y) const noexcept {
-    return y * rules_.board_size + x;
-}
+bool Board::undo() {
+    if (undo_log_.empty()) {
+        return false;
+    }
+    const UndoRecord record = undo_log_.back();
+    undo_log_.pop_back();
 
-bool Board::in_bounds(int x, int y) const noexcept {
-    return x >= 0 && y >= 0 && x < static_cast<int>(rules_.board_size) && y < static_cast<int>(rules_.board_size);
+    if (record.new_position) {
+        position_history_.erase(hashes_[0]);
+    }
+    history_stack_.pop_back();
+    if (record.vertex >= 0) {
+        remove_stone(record.vertex);
+        const PointState captured = to_point(other(record.player));
+        for (std::size_t i = record.captures; i < undo_captures_.size(); ++i) {
+            place_stone(undo_captures_[i], captured);
+        }
+        undo_captures_.resize(record.captures);
+        relink_chains();
+        if (tracks_patterns()) {
+            rebuild_patterns();
+        }
+    }
+    set_ko(record.ko);
+    to_play_ = record.to_play;
+    std::copy(recent_moves_.begin() + 1, recent_moves_.end(), recent_moves_.begin());
+    recent_moves_.back() = record.dropped_recent;
+    return true;
 }
 
-std::vector<int> Board::neighbors(int vertex) const {
-    std::vector<int> result;
-    result.reserve(4);
-    const int board_size = static_cast<int>(rules_.board_size);
-    const int x = vertex % board_size;
-    const int y = vertex / board_size;
-    for (int dir = 0; dir < 4; ++dir) {
-        const std::size_t dir_index = static_cast<std::size_t>(dir);
-        const int nx = x + kDx[dir_index];
-        const int ny = y + kDy[dir_index];
-        if (in_bounds(nx, ny)) {
-            const std::size_t neighbor_index = index(static_cast<std::size_t>(nx), static_cast<std::size_t>(ny));
-            result.push_back(static_cast<int>(neighbor_index));
-        }
+bool Board::is_legal(Player player, Move move) const {
+    if (move.is_pass()) {
+        return true;
     }
-    return result;
+    MoveEffect effect;
+    return analyze_move(player, move.vertex, effect);
 }
 
-int Board::count_liberties(int vertex, PointState color, std::vector<bool>& visited, std::vector<bool>& liberty_visited) const {
-    std::queue<int> q;
-    q.push(vertex);
+bool Board::analyze_move(Player player, int vertex, MoveEffect& effect) const {
+    if (vertex < 0 || static_cast<std::size_t>(vertex) >= board_len_) {
+        return false;
+    }
     const std::size_t vertex_index = static_cast<std::size_t>(vertex);
-    visited[vertex_index] = true;
-    int liberties = 0;
+    if (board_[vertex_index] != PointState::Empty) {
+        return false;
+    }
+    if (ko_vertex_.has_value() && ko_vertex_.value() == vertex) {
+        return false;
+    }
 
-    while (!q.empty()) {
-        const int v = q.front();
-        q.pop();
-        for (int n : neighbors(v)) {
-            const std::size_t neighbor_index = static_cast<std::size_t>(n);
-            if (board_[neighbor_index] == PointState::Empty) {
-                if (!liberty_visited[neighbor_index]) {
-                    liberty_visited[neighbor_index] = true;
-                    ++liberties;
-                }
-            } else if (board_[neighbor_index] == color && !visited[neighbor_index]) {
-                visited[neighbor_index] = true;
-                q.push(n);
+    const PointState stone = to_point(player);
+    const PointState opponent = to_point(other(player));
+
+    // A liberty after the move is an empty neighbour or an own chain that keeps one
+    // besides this point; opponent chains on their last liberty are captured.
+    bool keeps_liberty = false;
+    std::array<int, 4> own{};
+    int own_count = 0;
+    for (int neighbor : adjacency_[vertex_index]) {
+        if (neighbor < 0) {
+            continue;
+        }
+        const PointState state = board_[static_cast<std::size_t>(neighbor)];
+        if (state == PointState::Empty) {
+            keeps_liberty = true;
+            continue;
+        }
+        const int head = chain_head_[static_cast<std::size_t>(neighbor)];
+        if (state == stone) {
+            if (chain_liberties_[static_cast<std::size_t>(head)] > 1) {
+                keeps_liberty = true;
+            }
+            if (!contains(own, own_count, head)) {
+                own[static_cast<std::size_t>(own_count++)] = head;
             }
+        } else if (chain_liberties_[static_cast<std::size_t>(head)] == 1 &&
+                   !contains(effect.captured, effect.captured_chains, head)) {
+            effect.captured[static_cast<std::size_t>(effect.captured_chains++)] = head;
+            effect.captured_stones += chain_stones_[static_cast<std::size_t>(head)];
         }
     }
-    return liberties;
-}
 
-int Board::collect_group(int vertex, PointState color, std::vector<int>& out_vertices) const {
-    std::queue<int> q;
-    std::vector<bool> visited(board_len_, false);
-    q.push(vertex);
-    visited[static_cast<std::size_t>(vertex)] = true;
-    int liberties = 0;
+    // Where suicide is allowed the stones stay on the board with no liberties.
+    if (!keeps_liberty && effect.captured_chains == 0 && !rules_.allow_suicide) {
+        return false;
+    }
 
-    while (!q.empty()) {
-        const int v = q.front();
-        q.pop();
-        out_vertices.push_back(v);
-        for (int n : neighbors(v)) {
-            const std::size_t neighbor_index = static_cast<std::size_t>(n);
-            if (board_[neighbor_index] == PointState::Empty) {
-                ++liberties;
-            } else if (board_[neighbor_index] == color && !visited[neighbor_index]) {
-                visited[neighbor_index] = true;
-                q.push(n);
-            }
-        }
+    std::uint64_t hash = hashes_[0] ^ stone_hash(*zobrist_, stone, vertex);
+    for (int i = 0; i < effect.captured_chains; ++i) {
+        const int head = effect.captured[static_cast<std::size_t>(i)];
+        int v = head;
+        do {
+            hash ^= stone_hash(*zobrist_, opponent, v);
+            v = chain_next_[static_cast<std::size_t>(v)];
+        } while (v != head);
     }
-    return liberties;
+    // Simple ko shape: a lone stone that captured a single stone and has that point as
+    // its only liberty. A stone joining a chain is never a ko, recapturing takes more.
+    if (effect.captured_stones == 1 && !keeps_liberty && own_count == 0) {
+        effect.ko = effect.captured[0];
+    }
+    if (ko_vertex_) {
+        hash ^= zobrist_->ko_hash(static_cast<std::size_t>(*ko_vertex_));
+    }
+    if (effect.ko) {
+        hash ^= zobrist_->ko_hash(static_cast<std::size_t>(*effect.ko));
+    }
+    effect.hash = hash;
+    return !violates_superko(hash);
 }
 
 bool Board::violates_superko(std::uint64_t prospective_hash) const {
@@ -220,79 +398,227 @@ bool Board::violates_superko(std::uint64_t prospective_hash) const {
 void Board::place_stone(int vertex, PointState color) {
     const std::size_t vertex_index = static_cast<std::size_t>(vertex);
     board_[vertex_index] = color;
-    if (color == PointState::Black) {
-        position_hash_ ^= zobrist_.black_stone_hash(vertex_index);
-    } else if (color == PointState::White) {
-        position_hash_ ^= zobrist_.white_stone_hash(vertex_index);
+    toggle_stone_hash(vertex, color);
+    chain_head_[vertex_index] = vertex;
+    chain_next_[vertex_index] = vertex;
+    chain_liberties_[vertex_index] = 0;
+    chain_stones_[vertex_index] = 1;
+    if (tracks_patterns()) {
+        set_pattern_color(vertex, static_cast<std::uint32_t>(color));
     }
 }
 
 void Board::remove_stone(int vertex) {
     const std::size_t vertex_index = static_cast<std::size_t>(vertex);
     PointState color = board_[vertex_index];
-    if (color == PointState::Black) {
-        position_hash_ ^= zobrist_.black_stone_hash(vertex_index);
-    } else if (color == PointState::White) {
-        position_hash_ ^= zobrist_.white_stone_hash(vertex_index);
+    if (color != PointState::Empty) {
+        toggle_stone_hash(vertex, color);
     }
     board_[vertex_index] = PointState::Empty;
+    chain_head_[vertex_index] = -1;
+    if (tracks_patterns()) {
+        set_pattern_color(vertex, static_cast<std::uint32_t>(PointState::Empty));
+    }
+}
+
+// Each removed stone becomes a new liberty of every distinct chain of the other colour
+// around it.
+void Board::remove_chain(int head) {
+    const PointState color = board_[static_cast<std::size_t>(head)];
+    int v = head;
+    do {
+        const int next = chain_next_[static_cast<std::size_t>(v)];
+        remove_stone(v);
+        std::array<int, 4> touched{};
+        int touched_count = 0;
+        for (int neighbor : adjacency_[static_cast<std::size_t>(v)]) {
+            if (neighbor < 0) {
+                continue;
+            }
+            const PointState state = board_[static_cast<std::size_t>(neighbor)];
+            if (state == PointState::Empty || state == color) {
+                continue;
+            }
+            const int other_head = chain_head_[static_cast<std::size_t>(neighbor)];
+            if (!contains(touched, touched_count, other_head)) {
+                touched[static_cast<std::size_t>(touched_count++)] = other_head;
+                const int liberties = ++chain_liberties_[static_cast<std::size_t>(other_head)];
+                // Reaching one liberty enters atari, reaching two leaves it.
+                if (tracks_patterns() && liberties <= 2) {
+                    refresh_atari_flags(other_head);
+                }
+            }
+        }
+        v = next;
+    } while (v != head);
+}
+
+// Relabels the smaller chain and splices the two circular lists; liberties are left
+// for the caller to recount.
+void Board::merge_chains(int head, int other_head) {
+    if (chain_stones_[static_cast<std::size_t>(head)] < chain_stones_[static_cast<std::size_t>(other_head)]) {
+        std::swap(head, other_head);
+    }
+    int v = other_head;
+    do {
+        chain_head_[static_cast<std::size_t>(v)] = head;
+        v = chain_next_[static_cast<std::size_t>(v)];
+    } while (v != other_head);
+    std::swap(chain_next_[static_cast<std::size_t>(head)], chain_next_[static_cast<std::size_t>(other_head)]);
+    chain_stones_[static_cast<std::size_t>(head)] += chain_stones_[static_cast<std::size_t>(other_head)];
+}
+
+int Board::count_chain_liberties(int head) const {
+    VertexMarks& marks = vertex_marks();
+    marks.begin(board_len_);
+    int liberties = 0;
+    int v = head;
+    do {
+        for (int neighbor : adjacency_[static_cast<std::size_t>(v)]) {
+            if (neighbor >= 0 && board_[static_cast<std::size_t>(neighbor)] == PointState::Empty && marks.mark(neighbor)) {
+                ++liberties;
+            }
+        }
+        v = chain_next_[static_cast<std::size_t>(v)];
+    } while (v != head);
+    return liberties;
+}
+
+// Links every stone to its right and lower neighbours of the same colour, then counts
+// liberties once per chain; used when a position is set without replaying moves.
+void Board::rebuild_chains() {
+    const std::size_t board_size = rules_.board_size;
+    for (std::size_t v = 0; v < board_len_; ++v) {
+        if (board_[v] == PointState::Empty) {
+            continue;
+        }
+        const std::array<std::size_t, 2> forward{v % board_size + 1 < board_size ? v + 1 : v,
+                                                 v + board_size < board_len_ ? v + board_size : v};
+        for (std::size_t neighbor : forward) {
+            if (neighbor != v && board_[neighbor] == board_[v] && chain_head_[neighbor] != chain_head_[v]) {
+                merge_chains(chain_head_[v], chain_head_[neighbor]);
+            }
+        }
+    }
+    for (std::size_t v = 0; v < board_len_; ++v) {
+        if (board_[v] != PointState::Empty && chain_head_[v] == static_cast<int>(v)) {
+            chain_liberties_[v] = count_chain_liberties(static_cast<int>(v));
+        }
+    }
 }
 
 void Board::set_ko(std::optional<int> vertex) {
     if (ko_vertex_) {
-        position_hash_ ^= zobrist_.ko_hash(static_cast<std::size_t>(*ko_vertex_));
+        toggle_ko_hash(*ko_vertex_);
     }
     ko_vertex_ = vertex;
     if (ko_vertex_) {
-        position_hash_ ^= zobrist_.ko_hash(static_cast<std::size_t>(*ko_vertex_));
+        toggle_ko_hash(*ko_vertex_);
     }
 }
 
-ScoreResult Board::tromp_taylor_score() const {
-    ScoreResult result;
-    std::vector<bool> visited(board_len_, false);
-
-    for (int v = 0; v < static_cast<int>(board_len_); ++v) {
-        const std::size_t vertex_index = static_cast<std::size_t>(v);
-        if (board_[vertex_index] == PointState::Black) {
-            result.black_points += 1.0;
-        } else if (board_[vertex_index] == PointState::White) {
-            result.white_points += 1.0;
-        } else if (!visited[vertex_index]) {
-            std::queue<int> q;
-            q.push(v);
-            visited[vertex_index] = true;
-            bool borders_black = false;
-            bool borders_white = false;
-            int region_size = 0;
-
-            while (!q.empty()) {
-                int cur = q.front();
-                q.pop();
-                ++region_size;
-                for (int n : neighbors(cur)) {
-                    const std::size_t neighbor_index = static_cast<std::size_t>(n);
-                    if (board_[neighbor_index] == PointState::Empty && !visited[neighbor_index]) {
-                        visited[neighbor_index] = true;
-                        q.push(n);
-                    } else if (board_[neighbor_index] == PointState::Black) {
-                        borders_black = true;
-                    } else if (board_[neighbor_index] == PointState::White) {
-                        borders_white = true;
-                    }
-                }
-            }
+// Every symmetric key moves with the position: key s hashes the image of each point
+// under symmetry s.
+void Board::toggle_stone_hash(int vertex, PointState color) {
+    const SymmetryMap& images = symmetry_[static_cast<std::size_t>(vertex)];
+    for (std::size_t s = 0; s < static_cast<std::size_t>(kSymmetries); ++s) {
+        hashes_[s] ^= stone_hash(*zobrist_, color, images[s]);
+    }
+}
+
+void Board::toggle_ko_hash(int vertex) {
+    const SymmetryMap& images = symmetry_[static_cast<std::size_t>(vertex)];
+    for (std::size_t s = 0; s < static_cast<std::size_t>(kSymmetries); ++s) {
+        hashes_[s] ^= zobrist_->ko_hash(static_cast<std::size_t>(images[s]));
+    }
+}
+
+void Board::set_pattern_tracking(bool enabled) {
+    if (!enabled) {
+        patterns_.clear();
+        patterns_.shrink_to_fit();
+        return;
+    }
+    if (!tracks_patterns()) {
+        patterns_.assign(board_len_, 0);
+        rebuild_patterns();
+    }
+}
+
+void Board::rebuild_patterns() {
+    for (std::size_t v = 0; v < board_len_; ++v) {
+        patterns_[v] = compute_pattern(*this, v);
+    }
+}
 
-            if (borders_black && !borders_white) {
-                result.black_points += region_size;
-            } else if (borders_white && !borders_black) {
-                result.white_points += region_size;
+// Every neighbour sees vertex from the opposite slot; a new or vanished stone starts
+// out of atari there.
+void Board::set_pattern_color(int vertex, std::uint32_t color) {
+    const PatternNeighbors& neighbors = pattern_neighbors_[static_cast<std::size_t>(vertex)];
+    for (int slot = 0; slot < kPatternSlots; ++slot) {
+        const int neighbor = neighbors[static_cast<std::size_t>(slot)];
+        if (neighbor < 0) {
+            continue;
+        }
+        const int seen_from = opposite_slot(slot);
+        std::uint32_t& code = patterns_[static_cast<std::size_t>(neighbor)];
+        code = (code & ~(3u << (2 * seen_from))) | (color << (2 * seen_from));
+        if (seen_from < 4) {
+            code &= ~(1u << (16 + seen_from));
+        }
+    }
+}
+
+void Board::refresh_atari_flags(int head) {
+    const bool atari = chain_liberties_[static_cast<std::size_t>(head)] == 1;
+    int v = head;
+    do {
+        const PatternNeighbors& neighbors = pattern_neighbors_[static_cast<std::size_t>(v)];
+        for (int slot = 0; slot < 4; ++slot) {
+            const int neighbor = neighbors[static_cast<std::size_t>(slot)];
+            if (neighbor < 0) {
+                continue;
             }
+            const std::uint32_t bit = 1u << (16 + opposite_slot(slot));
+            std::uint32_t& code = patterns_[static_cast<std::size_t>(neighbor)];
+            code = atari ? code | bit : code & ~bit;
         }
+        v = chain_next_[static_cast<std::size_t>(v)];
+    } while (v != head);
+}
+
+void Board::log_undo(Player player, int vertex) {
+    if (!undo_enabled_) {
+        return;
     }
+    UndoRecord record;
+    record.vertex = vertex;
+    record.player = player;
+    record.to_play = to_play_;
+    record.ko = ko_vertex_;
+    record.dropped_recent = recent_moves_.back();
+    record.captures = static_cast<std::uint32_t>(undo_captures_.size());
+    undo_log_.push_back(record);
+}
 
-    result.white_points += rules_.komi;
-    return result;
+void Board::relink_chains() {
+    for (std::size_t v = 0; v < board_len_; ++v) {
+        const bool stone = board_[v] != PointState::Empty;
+        chain_head_[v] = stone ? static_cast<int>(v) : -1;
+        chain_next_[v] = stone ? static_cast<int>(v) : -1;
+        chain_liberties_[v] = 0;
+        chain_stones_[v] = stone ? 1 : 0;
+    }
+    rebuild_chains();
+}
+
+void Board::record_move(int vertex) {
+    std::copy_backward(recent_moves_.begin(), recent_moves_.end() - 1, recent_moves_.end());
+    recent_moves_[0] = vertex;
+}
+
+ScoreResult Board::tromp_taylor_score() const {
+    return score_area(*this);
 }
 
 Player other(Player p) {
@@ -308,11 +634,44 @@ Player to_player(PointState state) {
 }
 
 std::uint64_t Board::state_key() const noexcept {
-    std::uint64_t key = position_hash_;
+    std::uint64_t key = hashes_[0];
     if (to_play_ == Player::White) {
-        key ^= zobrist_.side_to_move_hash();
+        key ^= zobrist_->side_to_move_hash();
     }
     return key;
 }
 
+CanonicalKey Board::canonical_state_key(Player to_play) const noexcept {
+    CanonicalKey canonical{hashes_[0], 0};
+    for (int s = 1; s < kSymmetries; ++s) {
+        if (hashes_[static_cast<std::size_t>(s)] < canonical.key) {
+            canonical = {hashes_[static_cast<std::size_t>(s)], s};
+        }
+    }
+    if (to_play == Player::White) {
+        canonical.key ^= zobrist_->side_to_move_hash();
+    }
+    return canonical;
+}
+
+Board Board::transformed(int symmetry) const {
+    const std::size_t s = static_cast<std::size_t>(symmetry);
+    std::vector<PointState> points(board_len_, PointState::Empty);
+    for (std::size_t v = 0; v < board_len_; ++v) {
+        points[static_cast<std::size_t>(symmetry_[v][s])] = board_[v];
+    }
+    std::optional<int> ko;
+    if (ko_vertex_) {
+        ko = symmetry_[static_cast<std::size_t>(*ko_vertex_)][s];
+    }
+    Board result(rules_);
+    result.set_pattern_tracking(tracks_patterns());
+    result.set_position(points, to_play_, ko);
+    for (std::size_t age = 0; age < kRecentMoves; ++age) {
+        const int vertex = recent_moves_[age];
+        result.recent_moves_[age] = vertex >= 0 ? symmetry_[static_cast<std::size_t>(vertex)][s] : vertex;
+    }
+    return result;
+}
+
 } // namespace go
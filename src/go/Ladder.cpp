@@ -0,0 +1,344 @@
+#include "go/Ladder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace go {
+
+namespace {
+
+// Ladders run at most corner to corner; anything deeper is not a ladder.
+constexpr int kMaxDepth = 4 * static_cast<int>(LadderReader::kMaxSize) * static_cast<int>(LadderReader::kMaxSize);
+// Capturing attacker chains adjacent to the prey considered per move.
+constexpr std::size_t kMaxCaptureOptions = 16;
+constexpr std::size_t kMaxAdjacentStones = 64;
+
+} // namespace
+
+void LadderReader::reset(const Board& board) {
+    if (board.board_size() == 0 || board.board_size() > kMaxSize) {
+        throw std::invalid_argument("ladder reader supports sizes 1-25");
+    }
+    size_ = board.board_size();
+    stride_ = size_ + 2;
+    const std::ptrdiff_t stride = static_cast<std::ptrdiff_t>(stride_);
+    offsets_ = {1, -1, stride, -stride};
+    color_.fill(Off);
+    for (std::size_t vertex = 0; vertex < size_ * size_; ++vertex) {
+        color_[padded(vertex)] = static_cast<std::uint8_t>(board.point_state(vertex));
+    }
+    ko_ = board.ko_vertex() ? static_cast<int>(padded(static_cast<std::size_t>(*board.ko_vertex()))) : -1;
+    log_size_ = 0;
+    total_nodes_ = 0;
+}
+
+bool LadderReader::captured(std::size_t vertex, Player to_move) {
+    const std::size_t prey = padded(vertex);
+    const std::uint8_t color = color_[prey];
+    if (color != Black && color != White) {
+        return false;
+    }
+    std::array<std::size_t, 3> libs{};
+    const int count = liberties(prey, libs.data(), 3);
+    start_query();
+    bool result = false;
+    if (color == color_of(to_move)) {
+        result = count == 1 && defender_loses(prey, 0);
+    } else {
+        result = count > 0 && count <= 2 && attacker_wins(prey, 0);
+    }
+    total_nodes_ += static_cast<std::uint64_t>(nodes_);
+    return result;
+}
+
+bool LadderReader::is_capture_move(Player attacker, std::size_t vertex) {
+    const std::size_t point = padded(vertex);
+    const std::uint8_t own = color_of(attacker);
+    start_query();
+    if (color_[point] != Empty) {
+        return false;
+    }
+    // Opponent chains this move puts in atari.
+    std::array<std::size_t, 4> targets{};
+    std::size_t target_count = 0;
+    std::array<std::size_t, 3> libs{};
+    for (const std::ptrdiff_t offset : offsets_) {
+        const std::size_t n = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(point) + offset);
+        if (color_[n] == opponent_of(own) && liberties(n, libs.data(), 3) == 2) {
+            targets[target_count++] = n;
+        }
+    }
+    if (target_count == 0) {
+        return false;
+    }
+    const int ko = ko_;
+    const std::size_t mark = log_size_;
+    if (!play(point, own)) {
+        return false;
+    }
+    bool result = false;
+    for (std::size_t i = 0; i < target_count && !result; ++i) {
+        result = color_[targets[i]] != Empty && liberties(targets[i], libs.data(), 2) == 1 &&
+                 defender_loses(targets[i], 0);
+    }
+    total_nodes_ += static_cast<std::uint64_t>(nodes_);
+    undo_to(mark, ko);
+    return result;
+}
+
+bool LadderReader::is_failed_escape(Player defender, std::size_t vertex) {
+    const std::size_t point = padded(vertex);
+    const std::uint8_t own = color_of(defender);
+    start_query();
+    if (color_[point] != Empty) {
+        return false;
+    }
+    std::array<std::size_t, 3> libs{};
+    bool extends_atari = false;
+    for (const std::ptrdiff_t offset : offsets_) {
+        const std::size_t n = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(point) + offset);
+        extends_atari = extends_atari || (color_[n] == own && liberties(n, libs.data(), 2) == 1);
+    }
+    if (!extends_atari) {
+        return false;
+    }
+    const int ko = ko_;
+    const std::size_t mark = log_size_;
+    if (!play(point, own)) {
+        return false;
+    }
+    const int count = liberties(point, libs.data(), 3);
+    const bool result = count <= 2 && attacker_wins(point, 0);
+    total_nodes_ += static_cast<std::uint64_t>(nodes_);
+    undo_to(mark, ko);
+    return result;
+}
+
+int LadderReader::liberties(std::size_t point, std::size_t* libs, int limit) {
+    if (++epoch_ == 0) {
+        mark_.fill(0);
+        epoch_ = 1;
+    }
+    const std::uint8_t color = color_[point];
+    int count = 0;
+    std::size_t top = 0;
+    stack_[top++] = static_cast<std::uint16_t>(point);
+    mark_[point] = epoch_;
+    while (top > 0) {
+        const std::size_t p = stack_[--top];
+        for (const std::ptrdiff_t offset : offsets_) {
+            const std::size_t n = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(p) + offset);
+            if (mark_[n] == epoch_) {
+                continue;
+            }
+            if (color_[n] == Empty) {
+                mark_[n] = epoch_;
+                libs[count++] = n;
+                if (count == limit) {
+                    return count;
+                }
+            } else if (color_[n] == color) {
+                mark_[n] = epoch_;
+                stack_[top++] = static_cast<std::uint16_t>(n);
+            }
+        }
+    }
+    return count;
+}
+
+bool LadderReader::play(std::size_t point, std::uint8_t color) {
+    if (log_size_ + kMaxPoints > log_limit_) {
+        aborted_ = true;
+        return false;
+    }
+    if (color_[point] != Empty || static_cast<int>(point) == ko_) {
+        return false;
+    }
+    const std::size_t mark = log_size_;
+    const int ko = ko_;
+    const std::uint8_t opponent = opponent_of(color);
+    set(point, color);
+
+    std::size_t lib = 0;
+    int captured = 0;
+    std::size_t captured_point = 0;
+    for (const std::ptrdiff_t offset : offsets_) {
+        const std::size_t n = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(point) + offset);
+        if (color_[n] != opponent || liberties(n, &lib, 1) > 0) {
+            continue;
+        }
+        // Lift the chain; clearing each stone as it is reached doubles as the visit mark.
+        std::size_t top = 0;
+        set(n, Empty);
+        stack_[top++] = static_cast<std::uint16_t>(n);
+        while (top > 0) {
+            const std::size_t p = stack_[--top];
+            ++captured;
+            captured_point = p;
+            for (const std::ptrdiff_t next : offsets_) {
+                const std::size_t q = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(p) + next);
+                if (color_[q] == opponent) {
+                    set(q, Empty);
+                    stack_[top++] = static_cast<std::uint16_t>(q);
+                }
+            }
+        }
+    }
+
+    std::array<std::size_t, 2> libs{};
+    const int own_liberties = liberties(point, libs.data(), 2);
+    if (own_liberties == 0) {
+        undo_to(mark, ko);
+        return false;
+    }
+    bool alone = true;
+    for (const std::ptrdiff_t offset : offsets_) {
+        alone = alone && color_[static_cast<std::size_t>(static_cast<std::ptrdiff_t>(point) + offset)] != color;
+    }
+    ko_ = captured == 1 && alone && own_liberties == 1 ? static_cast<int>(captured_point) : -1;
+    return true;
+}
+
+void LadderReader::set(std::size_t point, std::uint8_t color) noexcept {
+    log_[log_size_++] = Change{static_cast<std::uint16_t>(point), color_[point]};
+    color_[point] = color;
+}
+
+void LadderReader::undo_to(std::size_t log_size, int ko) noexcept {
+    while (log_size_ > log_size) {
+        const Change& change = log_[--log_size_];
+        color_[change.point] = change.color;
+    }
+    ko_ = ko;
+}
+
+// The prey is in atari and its owner moves: escape by capturing an attacker chain in
+// atari next to it or by extending; the prey dies if every option still gets caught.
+bool LadderReader::defender_loses(std::size_t prey, int depth) {
+    if (over_budget() || depth > kMaxDepth) {
+        return false;
+    }
+    const std::uint8_t own = color_[prey];
+    const std::uint8_t attacker = opponent_of(own);
+
+    // Attacker stones around the prey, then the liberties of those in atari.
+    std::array<std::uint16_t, kMaxAdjacentStones> adjacent{};
+    std::size_t adjacent_count = 0;
+    std::size_t escape = 0;
+    {
+        if (++epoch_ == 0) {
+            mark_.fill(0);
+            epoch_ = 1;
+        }
+        std::size_t top = 0;
+        stack_[top++] = static_cast<std::uint16_t>(prey);
+        mark_[prey] = epoch_;
+        while (top > 0) {
+            const std::size_t p = stack_[--top];
+            for (const std::ptrdiff_t offset : offsets_) {
+                const std::size_t n = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(p) + offset);
+                if (mark_[n] == epoch_) {
+                    continue;
+                }
+                mark_[n] = epoch_;
+                if (color_[n] == own) {
+                    stack_[top++] = static_cast<std::uint16_t>(n);
+                } else if (color_[n] == Empty) {
+                    escape = n;
+                } else if (color_[n] == attacker && adjacent_count < adjacent.size()) {
+                    adjacent[adjacent_count++] = static_cast<std::uint16_t>(n);
+                }
+            }
+        }
+    }
+    std::array<std::size_t, kMaxCaptureOptions> captures{};
+    std::size_t capture_count = 0;
+    std::array<std::size_t, 3> libs{};
+    for (std::size_t i = 0; i < adjacent_count; ++i) {
+        if (liberties(adjacent[i], libs.data(), 2) == 1 && capture_count < captures.size() &&
+            std::find(captures.begin(), captures.begin() + static_cast<std::ptrdiff_t>(capture_count), libs[0]) ==
+                captures.begin() + static_cast<std::ptrdiff_t>(capture_count)) {
+            captures[capture_count++] = libs[0];
+        }
+    }
+
+    const int ko = ko_;
+    const std::size_t mark = log_size_;
+    for (std::size_t i = 0; i <= capture_count; ++i) {
+        // The capturing moves first, extending last; a move may be both.
+        const std::size_t move = i < capture_count ? captures[i] : escape;
+        if (i == capture_count &&
+            std::find(captures.begin(), captures.begin() + static_cast<std::ptrdiff_t>(capture_count), escape) !=
+                captures.begin() + static_cast<std::ptrdiff_t>(capture_count)) {
+            break;
+        }
+        if (!play(move, own)) {
+            if (aborted_) {
+                return false; // unread, so not proven lost
+            }
+            continue;
+        }
+        const int count = liberties(prey, libs.data(), 3);
+        const bool escaped = count >= 3 || !attacker_wins(prey, depth + 1);
+        undo_to(mark, ko);
+        if (escaped) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The attacker moves against a prey with one or two liberties: take it, or atari it
+// from either side and read on.
+bool LadderReader::attacker_wins(std::size_t prey, int depth) {
+    if (over_budget() || depth > kMaxDepth) {
+        return false;
+    }
+    std::array<std::size_t, 3> libs{};
+    const int count = liberties(prey, libs.data(), 3);
+    if (count == 1) {
+        return static_cast<int>(libs[0]) != ko_;
+    }
+    if (count != 2) {
+        return false;
+    }
+    const std::uint8_t attacker = opponent_of(color_[prey]);
+    const int ko = ko_;
+    const std::size_t mark = log_size_;
+    for (std::size_t i = 0; i < 2; ++i) {
+        if (!play(libs[i], attacker)) {
+            continue;
+        }
+        std::array<std::size_t, 2> left{};
+        const bool wins = liberties(prey, left.data(), 2) == 1 && defender_loses(prey, depth + 1);
+        undo_to(mark, ko);
+        if (wins) {
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+LadderReader& thread_reader(const Board& board) {
+    thread_local LadderReader reader;
+    reader.reset(board);
+    return reader;
+}
+
+} // namespace
+
+bool ladder_captured(const Board& board, std::size_t vertex, Player to_move) {
+    return thread_reader(board).captured(vertex, to_move);
+}
+
+bool is_ladder_capture(const Board& board, Player attacker, std::size_t vertex) {
+    return thread_reader(board).is_capture_move(attacker, vertex);
+}
+
+bool is_failed_ladder_escape(const Board& board, Player defender, std::size_t vertex) {
+    return thread_reader(board).is_failed_escape(defender, vertex);
+}
+
+} // namespace go
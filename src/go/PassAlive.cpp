@@ -0,0 +1,191 @@
+#include "go/PassAlive.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace go {
+
+void PassAliveMap::update(const Board& board) {
+    if (valid_ && board.board_size() == size_ && board.position_hash() == hash_) {
+        return;
+    }
+    size_ = board.board_size();
+    hash_ = board.position_hash();
+    const std::size_t area = size_ * size_;
+    owner_.assign(area, 0);
+    dead_.assign(area, 0);
+    compute(board, PointState::Black);
+    compute(board, PointState::White);
+    settled_count_ = static_cast<std::size_t>(std::count_if(owner_.begin(), owner_.end(), [](std::int8_t o) { return o != 0; }));
+    valid_ = true;
+    ++computations_;
+}
+
+void PassAliveMap::compute(const Board& board, PointState color) {
+    const std::size_t size = size_;
+    const std::size_t area = size * size;
+    const std::int8_t sign = color == PointState::Black ? 1 : -1;
+    const auto neighbors = [size](std::size_t v, std::array<int, 4>& out) {
+        const std::size_t x = v % size;
+        const std::size_t y = v / size;
+        out[0] = x > 0 ? static_cast<int>(v - 1) : -1;
+        out[1] = x + 1 < size ? static_cast<int>(v + 1) : -1;
+        out[2] = y > 0 ? static_cast<int>(v - size) : -1;
+        out[3] = y + 1 < size ? static_cast<int>(v + size) : -1;
+    };
+    std::array<int, 4> adjacent{};
+
+    // Chains of color, then the maximal regions of everything else; a region's points
+    // end up contiguous in stack_ so its borders can be gathered in one go.
+    chain_of_.assign(area, -1);
+    region_of_.assign(area, -1);
+    stack_.resize(area);
+    int chains = 0;
+    for (std::size_t v = 0; v < area; ++v) {
+        if (board.point_state(v) != color || chain_of_[v] >= 0) {
+            continue;
+        }
+        std::size_t top = 0;
+        stack_[top++] = static_cast<int>(v);
+        chain_of_[v] = chains;
+        while (top > 0) {
+            neighbors(static_cast<std::size_t>(stack_[--top]), adjacent);
+            for (const int n : adjacent) {
+                if (n >= 0 && board.point_state(static_cast<std::size_t>(n)) == color && chain_of_[static_cast<std::size_t>(n)] < 0) {
+                    chain_of_[static_cast<std::size_t>(n)] = chains;
+                    stack_[top++] = n;
+                }
+            }
+        }
+        ++chains;
+    }
+
+    region_empty_.clear();
+    region_enclosed_.clear();
+    borders_.clear();
+    border_stamp_.assign(static_cast<std::size_t>(chains), -1);
+    std::vector<int>& members = stack_;
+    std::size_t member_count = 0;
+    int regions = 0;
+    for (std::size_t v = 0; v < area; ++v) {
+        if (board.point_state(v) == color || region_of_[v] >= 0) {
+            continue;
+        }
+        // Breadth-first over the region, the visited prefix of members doubling as queue.
+        const std::size_t begin = member_count;
+        members[member_count++] = static_cast<int>(v);
+        region_of_[v] = regions;
+        int empty = 0;
+        bool enclosed = true;
+        for (std::size_t i = begin; i < member_count; ++i) {
+            const std::size_t p = static_cast<std::size_t>(members[i]);
+            const bool is_empty = board.point_state(p) == PointState::Empty;
+            neighbors(p, adjacent);
+            bool touches = false;
+            std::array<int, 4> seen_chains{-1, -1, -1, -1};
+            for (std::size_t k = 0; k < adjacent.size(); ++k) {
+                const int n = adjacent[k];
+                if (n < 0) {
+                    continue;
+                }
+                const std::size_t q = static_cast<std::size_t>(n);
+                if (board.point_state(q) != color) {
+                    if (region_of_[q] < 0) {
+                        region_of_[q] = regions;
+                        members[member_count++] = n;
+                    }
+                    continue;
+                }
+                touches = true;
+                const int chain = chain_of_[q];
+                if (std::find(seen_chains.begin(), seen_chains.end(), chain) != seen_chains.end()) {
+                    continue;
+                }
+                seen_chains[k] = chain;
+                int& stamp = border_stamp_[static_cast<std::size_t>(chain)];
+                if (stamp < 0 || borders_[static_cast<std::size_t>(stamp)].region != regions) {
+                    stamp = static_cast<int>(borders_.size());
+                    borders_.push_back(Border{regions, chain, 0});
+                }
+                borders_[static_cast<std::size_t>(stamp)].empty_neighbors += is_empty ? 1 : 0;
+            }
+            if (is_empty) {
+                ++empty;
+                enclosed = enclosed && touches;
+            }
+        }
+        region_empty_.push_back(empty);
+        region_enclosed_.push_back(enclosed ? 1 : 0);
+        ++regions;
+    }
+
+    // Benson's pruning: drop chains with fewer than two vital regions, then regions
+    // touching a dropped chain, until nothing changes.
+    chain_live_.assign(static_cast<std::size_t>(chains), 1);
+    region_live_.assign(static_cast<std::size_t>(regions), 1);
+    vital_count_.resize(static_cast<std::size_t>(chains));
+    for (;;) {
+        std::fill(vital_count_.begin(), vital_count_.end(), 0);
+        for (const Border& border : borders_) {
+            const std::size_t r = static_cast<std::size_t>(border.region);
+            if (region_live_[r] && region_empty_[r] > 0 && border.empty_neighbors == region_empty_[r]) {
+                ++vital_count_[static_cast<std::size_t>(border.chain)];
+            }
+        }
+        bool dropped = false;
+        for (std::size_t c = 0; c < chain_live_.size(); ++c) {
+            if (chain_live_[c] && vital_count_[c] < 2) {
+                chain_live_[c] = 0;
+                dropped = true;
+            }
+        }
+        if (!dropped) {
+            break;
+        }
+        for (const Border& border : borders_) {
+            if (!chain_live_[static_cast<std::size_t>(border.chain)]) {
+                region_live_[static_cast<std::size_t>(border.region)] = 0;
+            }
+        }
+    }
+
+    // A region with no border at all (no stones of color on the board) is never
+    // enclosed, so live enclosed regions are bordered by pass-alive chains only.
+    for (std::size_t v = 0; v < area; ++v) {
+        if (owner_[v] != 0) {
+            continue;
+        }
+        if (chain_of_[v] >= 0) {
+            owner_[v] = chain_live_[static_cast<std::size_t>(chain_of_[v])] ? sign : 0;
+            continue;
+        }
+        const std::size_t r = static_cast<std::size_t>(region_of_[v]);
+        if (region_live_[r] && region_enclosed_[r]) {
+            owner_[v] = sign;
+        }
+    }
+    // Dead stones mark their whole territory.
+    for (std::size_t begin = 0; begin < member_count;) {
+        const std::size_t r = static_cast<std::size_t>(region_of_[static_cast<std::size_t>(members[begin])]);
+        std::size_t end = begin;
+        bool has_stones = false;
+        while (end < member_count && region_of_[static_cast<std::size_t>(members[end])] == static_cast<int>(r)) {
+            has_stones = has_stones || board.point_state(static_cast<std::size_t>(members[end])) != PointState::Empty;
+            ++end;
+        }
+        if (has_stones && region_live_[r] && region_enclosed_[r]) {
+            for (std::size_t i = begin; i < end; ++i) {
+                dead_[static_cast<std::size_t>(members[i])] = 1;
+            }
+        }
+        begin = end;
+    }
+}
+
+const PassAliveMap& pass_alive_map(const Board& board) {
+    thread_local PassAliveMap map;
+    map.update(board);
+    return map;
+}
+
+} // namespace go
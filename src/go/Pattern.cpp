@@ -0,0 +1,92 @@
+#include "go/Pattern.hpp"
+
+#include <utility>
+
+namespace go {
+
+namespace {
+
+int slot_of(int dx, int dy) {
+    for (int slot = 0; slot < kPatternSlots; ++slot) {
+        if (kPatternOffsets[static_cast<std::size_t>(slot)][0] == dx &&
+            kPatternOffsets[static_cast<std::size_t>(slot)][1] == dy) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+// image[s][slot] is where slot lands under symmetry s.
+using SlotImages = std::array<std::array<int, kPatternSlots>, kSymmetries>;
+
+const SlotImages& slot_images() {
+    static const SlotImages images = [] {
+        SlotImages table{};
+        for (int s = 0; s < kSymmetries; ++s) {
+            for (int slot = 0; slot < kPatternSlots; ++slot) {
+                int dx = kPatternOffsets[static_cast<std::size_t>(slot)][0];
+                int dy = kPatternOffsets[static_cast<std::size_t>(slot)][1];
+                if (s & 4) {
+                    std::swap(dx, dy);
+                }
+                if (s & 1) {
+                    dx = -dx;
+                }
+                if (s & 2) {
+                    dy = -dy;
+                }
+                table[static_cast<std::size_t>(s)][static_cast<std::size_t>(slot)] = slot_of(dx, dy);
+            }
+        }
+        return table;
+    }();
+    return images;
+}
+
+} // namespace
+
+std::uint32_t compute_pattern(const Board& board, std::size_t vertex) {
+    const int size = static_cast<int>(board.board_size());
+    const int x = static_cast<int>(vertex) % size;
+    const int y = static_cast<int>(vertex) / size;
+    std::uint32_t code = 0;
+    for (int slot = 0; slot < kPatternSlots; ++slot) {
+        const int nx = x + kPatternOffsets[static_cast<std::size_t>(slot)][0];
+        const int ny = y + kPatternOffsets[static_cast<std::size_t>(slot)][1];
+        if (nx < 0 || ny < 0 || nx >= size || ny >= size) {
+            code |= kPatternOff << (2 * slot);
+            continue;
+        }
+        const std::size_t neighbor = static_cast<std::size_t>(ny * size + nx);
+        code |= static_cast<std::uint32_t>(board.point_state(neighbor)) << (2 * slot);
+        if (slot < 4 && board.liberties(neighbor) == 1) {
+            code |= 1u << (16 + slot);
+        }
+    }
+    return code;
+}
+
+std::uint32_t pattern_for_player(std::uint32_t code, Player player) {
+    if (player == Player::Black) {
+        return code;
+    }
+    // Swap 01 and 10 in every colour pair; empty (00) and off (11) stay.
+    const std::uint32_t colors = code & 0xffffu;
+    const std::uint32_t differ = (colors ^ (colors >> 1)) & 0x5555u;
+    return code ^ (differ | (differ << 1));
+}
+
+std::uint32_t transform_pattern(std::uint32_t code, int symmetry) {
+    const auto& image = slot_images()[static_cast<std::size_t>(symmetry)];
+    std::uint32_t result = 0;
+    for (int slot = 0; slot < kPatternSlots; ++slot) {
+        const int target = image[static_cast<std::size_t>(slot)];
+        result |= pattern_color(code, slot) << (2 * target);
+        if (slot < 4 && pattern_atari(code, slot)) {
+            result |= 1u << (16 + target);
+        }
+    }
+    return result;
+}
+
+} // namespace go
@@ -0,0 +1,338 @@
+#include "go/PlayoutBoard.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace go {
+
+void PlayoutBoard::reset(const Board& board, Player to_play) {
+    if (board.board_size() == 0 || board.board_size() > kMaxSize) {
+        throw std::invalid_argument("playout board supports sizes 1-25");
+    }
+    size_ = board.board_size();
+    stride_ = size_ + 2;
+    const int stride = static_cast<int>(stride_);
+    offsets_ = {1, -1, stride, -stride};
+    to_play_ = to_play;
+    komi_ = static_cast<float>(board.rules().komi);
+    ko_ = board.ko_vertex() ? padded(static_cast<std::size_t>(*board.ko_vertex())) : -1;
+
+    const std::size_t points = stride_ * stride_;
+    empty_count_ = 0;
+    for (std::size_t point = 0; point < points; ++point) {
+        color_[point] = Off;
+        settled_[point] = 0;
+    }
+    for (std::size_t vertex = 0; vertex < size_ * size_; ++vertex) {
+        const int point = padded(vertex);
+        const std::size_t p = static_cast<std::size_t>(point);
+        const PointState state = board.point_state(vertex);
+        color_[p] = state == PointState::Black ? Black : state == PointState::White ? White : Empty;
+        head_[p] = static_cast<std::uint16_t>(point);
+        next_[p] = static_cast<std::uint16_t>(point);
+        stones_[p] = 1;
+        libs_[p] = 0;
+        lib_sum_[p] = 0;
+        lib_sum_sq_[p] = 0;
+        if (color_[p] == Empty) {
+            add_empty(point);
+        }
+    }
+
+    for (std::size_t vertex = 0; vertex < size_ * size_; ++vertex) {
+        const int point = padded(vertex);
+        const std::uint8_t color = color_[static_cast<std::size_t>(point)];
+        if (color != Black && color != White) {
+            continue;
+        }
+        for (const int offset : offsets_) {
+            const std::size_t n = static_cast<std::size_t>(point + offset);
+            if (color_[n] == color && head_[n] != head_[static_cast<std::size_t>(point)]) {
+                merge_chains(head_[static_cast<std::size_t>(point)], head_[n]);
+            }
+        }
+    }
+    for (std::size_t vertex = 0; vertex < size_ * size_; ++vertex) {
+        const int point = padded(vertex);
+        const std::size_t p = static_cast<std::size_t>(point);
+        if (color_[p] != Empty) {
+            continue;
+        }
+        for (const int offset : offsets_) {
+            const std::size_t n = static_cast<std::size_t>(point + offset);
+            if (color_[n] == Black || color_[n] == White) {
+                add_liberty(head_[n], point);
+            }
+        }
+    }
+}
+
+void PlayoutBoard::settle(const std::int8_t* owners) noexcept {
+    for (std::size_t vertex = 0; vertex < size_ * size_; ++vertex) {
+        const std::size_t p = static_cast<std::size_t>(padded(vertex));
+        if (owners[vertex] == 0 || settled_[p] != 0) {
+            continue;
+        }
+        settled_[p] = owners[vertex];
+        // Nothing inside a settled area is ever captured, so its empty points stay out
+        // of the candidate list for good.
+        if (color_[p] == Empty) {
+            remove_empty(static_cast<int>(p));
+        }
+    }
+}
+
+PointState PlayoutBoard::point_state(std::size_t vertex) const noexcept {
+    const std::uint8_t color = color_[static_cast<std::size_t>(padded(vertex))];
+    return color == Black ? PointState::Black : color == White ? PointState::White : PointState::Empty;
+}
+
+bool PlayoutBoard::is_legal(int point, Player player) const noexcept {
+    const std::size_t p = static_cast<std::size_t>(point);
+    if (color_[p] != Empty || point == ko_) {
+        return false;
+    }
+    const std::uint8_t own = color_of(player);
+    for (const int offset : offsets_) {
+        if (color_[static_cast<std::size_t>(point + offset)] == Empty) {
+            return true;
+        }
+    }
+    // Every neighbour is a stone or the edge: legal if it joins a chain with another
+    // liberty or takes the last liberty of an opponent chain.
+    for (const int offset : offsets_) {
+        const std::size_t n = static_cast<std::size_t>(point + offset);
+        const std::uint8_t color = color_[n];
+        if (color == Off) {
+            continue;
+        }
+        if ((color == own) != in_atari(head_[n])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PlayoutBoard::is_eye(int point, Player player) const noexcept {
+    const std::uint8_t own = color_of(player);
+    for (const int offset : offsets_) {
+        const std::uint8_t color = color_[static_cast<std::size_t>(point + offset)];
+        if (color != own && color != Off) {
+            return false;
+        }
+    }
+    const int stride = static_cast<int>(stride_);
+    const std::array<int, 4> diagonals{stride + 1, stride - 1, 1 - stride, -1 - stride};
+    int bad = 0;
+    bool edge = false;
+    for (const int offset : diagonals) {
+        const std::uint8_t color = color_[static_cast<std::size_t>(point + offset)];
+        if (color == Off) {
+            edge = true;
+        } else if (color != own && color != Empty) {
+            ++bad;
+        }
+    }
+    return bad + (edge ? 1 : 0) < 2;
+}
+
+void PlayoutBoard::play(int point) {
+    const std::size_t p = static_cast<std::size_t>(point);
+    const std::uint8_t own = color_of(to_play_);
+    const std::uint8_t opponent = own == Black ? White : Black;
+
+    color_[p] = own;
+    head_[p] = static_cast<std::uint16_t>(point);
+    next_[p] = static_cast<std::uint16_t>(point);
+    stones_[p] = 1;
+    libs_[p] = 0;
+    lib_sum_[p] = 0;
+    lib_sum_sq_[p] = 0;
+    remove_empty(point);
+
+    for (const int offset : offsets_) {
+        const int n = point + offset;
+        const std::uint8_t color = color_[static_cast<std::size_t>(n)];
+        if (color == Empty) {
+            add_liberty(point, n);
+        } else if (color != Off) {
+            remove_liberty(head_[static_cast<std::size_t>(n)], point);
+        }
+    }
+    for (const int offset : offsets_) {
+        const std::size_t n = static_cast<std::size_t>(point + offset);
+        if (color_[n] == own && head_[n] != head_[p]) {
+            merge_chains(head_[p], head_[n]);
+        }
+    }
+
+    int captured = 0;
+    int captured_point = -1;
+    for (const int offset : offsets_) {
+        const std::size_t n = static_cast<std::size_t>(point + offset);
+        if (color_[n] == opponent && libs_[head_[n]] == 0) {
+            captured += remove_chain(head_[n]);
+            captured_point = point + offset;
+        }
+    }
+
+    const std::size_t head = head_[p];
+    ko_ = captured == 1 && stones_[head] == 1 && libs_[head] == 1 ? captured_point : -1;
+    to_play_ = to_play_ == Player::Black ? Player::White : Player::Black;
+}
+
+void PlayoutBoard::pass() noexcept {
+    ko_ = -1;
+    to_play_ = to_play_ == Player::Black ? Player::White : Player::Black;
+}
+
+int PlayoutBoard::play_random(PlayoutRng& rng) {
+    if (empty_count_ > 0) {
+        const std::size_t start = rng.below(static_cast<std::uint32_t>(empty_count_));
+        for (std::size_t i = 0; i < empty_count_; ++i) {
+            std::size_t index = start + i;
+            if (index >= empty_count_) {
+                index -= empty_count_;
+            }
+            const int point = empty_[index];
+            if (is_legal(point, to_play_) && !is_eye(point, to_play_)) {
+                play(point);
+                return point;
+            }
+        }
+    }
+    pass();
+    return -1;
+}
+
+float PlayoutBoard::score(std::int8_t* ownership) const {
+    // Empty regions are flood filled with a fixed stack; a region belongs to the single
+    // colour it touches.
+    std::array<std::uint16_t, kMaxPoints> stack;
+    std::array<std::uint16_t, kMaxPoints> region;
+    std::array<std::int8_t, kMaxPoints> owner{};
+    std::array<bool, kMaxPoints> seen{};
+    int black = 0;
+    int white = 0;
+    for (std::size_t vertex = 0; vertex < size_ * size_; ++vertex) {
+        const std::size_t p = static_cast<std::size_t>(padded(vertex));
+        if (settled_[p] != 0) {
+            owner[p] = settled_[p];
+            (settled_[p] > 0 ? black : white) += 1;
+        } else if (color_[p] == Black) {
+            ++black;
+            owner[p] = 1;
+        } else if (color_[p] == White) {
+            ++white;
+            owner[p] = -1;
+        } else if (!seen[p]) {
+            std::size_t top = 0;
+            std::size_t count = 0;
+            bool touches_black = false;
+            bool touches_white = false;
+            stack[top++] = static_cast<std::uint16_t>(p);
+            seen[p] = true;
+            while (top > 0) {
+                const std::uint16_t point = stack[--top];
+                region[count++] = point;
+                for (const int offset : offsets_) {
+                    const std::size_t n = static_cast<std::size_t>(point + offset);
+                    if (color_[n] == Empty && !seen[n] && settled_[n] == 0) {
+                        seen[n] = true;
+                        stack[top++] = static_cast<std::uint16_t>(n);
+                    } else if (color_[n] == Black) {
+                        touches_black = true;
+                    } else if (color_[n] == White) {
+                        touches_white = true;
+                    }
+                }
+            }
+            const std::int8_t region_owner = touches_black == touches_white ? 0 : touches_black ? 1 : -1;
+            if (region_owner > 0) {
+                black += static_cast<int>(count);
+            } else if (region_owner < 0) {
+                white += static_cast<int>(count);
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                owner[region[i]] = region_owner;
+            }
+        }
+    }
+    if (ownership) {
+        for (std::size_t vertex = 0; vertex < size_ * size_; ++vertex) {
+            ownership[vertex] = owner[static_cast<std::size_t>(padded(vertex))];
+        }
+    }
+    return static_cast<float>(black - white) - komi_;
+}
+
+void PlayoutBoard::add_liberty(int head, int point) noexcept {
+    const std::size_t h = static_cast<std::size_t>(head);
+    const std::uint32_t value = static_cast<std::uint32_t>(point);
+    ++libs_[h];
+    lib_sum_[h] += value;
+    lib_sum_sq_[h] += static_cast<std::uint64_t>(value) * value;
+}
+
+void PlayoutBoard::remove_liberty(int head, int point) noexcept {
+    const std::size_t h = static_cast<std::size_t>(head);
+    const std::uint32_t value = static_cast<std::uint32_t>(point);
+    --libs_[h];
+    lib_sum_[h] -= value;
+    lib_sum_sq_[h] -= static_cast<std::uint64_t>(value) * value;
+}
+
+void PlayoutBoard::add_empty(int point) noexcept {
+    empty_index_[static_cast<std::size_t>(point)] = static_cast<std::uint16_t>(empty_count_);
+    empty_[empty_count_++] = static_cast<std::uint16_t>(point);
+}
+
+void PlayoutBoard::remove_empty(int point) noexcept {
+    const std::size_t index = empty_index_[static_cast<std::size_t>(point)];
+    const std::uint16_t last = empty_[--empty_count_];
+    empty_[index] = last;
+    empty_index_[last] = static_cast<std::uint16_t>(index);
+}
+
+void PlayoutBoard::merge_chains(int keep, int other) noexcept {
+    std::size_t a = static_cast<std::size_t>(keep);
+    std::size_t b = static_cast<std::size_t>(other);
+    if (stones_[a] < stones_[b]) {
+        std::swap(a, b);
+    }
+    // Relabel the smaller chain, then splice the two circular lists.
+    std::size_t point = b;
+    do {
+        head_[point] = static_cast<std::uint16_t>(a);
+        point = next_[point];
+    } while (point != b);
+    std::swap(next_[a], next_[b]);
+    stones_[a] = static_cast<std::uint16_t>(stones_[a] + stones_[b]);
+    libs_[a] += libs_[b];
+    lib_sum_[a] += lib_sum_[b];
+    lib_sum_sq_[a] += lib_sum_sq_[b];
+}
+
+int PlayoutBoard::remove_chain(int head) noexcept {
+    const std::size_t h = static_cast<std::size_t>(head);
+    const int count = stones_[h];
+    std::size_t point = h;
+    do {
+        color_[point] = Empty;
+        add_empty(static_cast<int>(point));
+        point = next_[point];
+    } while (point != h);
+    // Every neighbouring stone regains the freed points as liberties.
+    do {
+        for (const int offset : offsets_) {
+            const std::size_t n = static_cast<std::size_t>(static_cast<int>(point) + offset);
+            if (color_[n] == Black || color_[n] == White) {
+                add_liberty(head_[n], static_cast<int>(point));
+            }
+        }
+        point = next_[point];
+    } while (point != h);
+    return count;
+}
+
+} // namespace go
@@ -0,0 +1,511 @@
+#include "go/PlayoutLanes.hpp"
+
+#include <bit>
+#include <stdexcept>
+
+namespace go {
+
+namespace {
+
+// Population count without a multiply, so the loops over lanes vectorize on plain SSE2.
+inline std::uint32_t count_bits(std::uint32_t x) noexcept {
+    x -= (x >> 1) & 0x55555555u;
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    x = (x + (x >> 4)) & 0x0f0f0f0fu;
+    x += x >> 8;
+    x += x >> 16;
+    return x & 0x3fu;
+}
+
+} // namespace
+
+template <std::size_t Lanes>
+void PlayoutLanes<Lanes>::reset(const Board& board, Player to_play, std::uint64_t seed) {
+    if (board.board_size() == 0 || board.board_size() > kMaxSize) {
+        throw std::invalid_argument("playout lanes support sizes 1-25");
+    }
+    size_ = board.board_size();
+    row_mask_ = (1u << size_) - 1u;
+    komi_ = static_cast<float>(board.rules().komi);
+    player_ = to_play;
+
+    for (std::size_t y = 0; y < kMaxSize; ++y) {
+        std::uint32_t black = 0;
+        std::uint32_t white = 0;
+        for (std::size_t x = 0; y < size_ && x < size_; ++x) {
+            const PointState state = board.point_state(y * size_ + x);
+            black |= state == PointState::Black ? 1u << x : 0u;
+            white |= state == PointState::White ? 1u << x : 0u;
+        }
+        black_[y].fill(black);
+        white_[y].fill(white);
+    }
+    suicide_ = {};
+    witnesses_ = {};
+
+    const int ko = board.ko_vertex() ? *board.ko_vertex() : -1;
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        ko_[lane] = ko;
+        passes_[lane] = 0;
+        moves_[lane] = 0;
+        last_move_[lane] = kNoMove;
+        running_[lane] = true;
+        to_play_[lane] = to_play;
+        rng_[lane] = PlayoutRng(seed + 0x9e3779b97f4a7c15ull * (lane + 1));
+    }
+}
+
+template <std::size_t Lanes>
+std::size_t PlayoutLanes<Lanes>::play_random_moves(int moves) {
+    std::size_t running = 0;
+    for (int move = 0;; ++move) {
+        running = 0;
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            running += running_[lane] ? 1u : 0u;
+        }
+        if (running == 0 || move == moves) {
+            return running;
+        }
+        step();
+    }
+}
+
+template <std::size_t Lanes>
+void PlayoutLanes<Lanes>::step() {
+    const std::size_t size = size_;
+    const std::uint32_t mask = row_mask_;
+    const std::uint32_t last_column = 1u << (size - 1);
+    const std::uint32_t side_columns = 1u | last_column;
+    Rows& own = player_ == Player::Black ? black_ : white_;
+    Rows& opponent = player_ == Player::Black ? white_ : black_;
+    Rows& known_suicide = suicide_[static_cast<std::size_t>(player_)];
+    Rows& witnesses = witnesses_[static_cast<std::size_t>(player_)];
+    Row full;
+    full.fill(mask);
+    const Row zero{};
+
+    // Empty points minus the mover's eyes and known suicides in every lane. An eye has own
+    // stones or the edge on all four sides, and fewer than two opponent diagonals, the
+    // edge counting as one.
+    for (std::size_t y = 0; y < size; ++y) {
+        const Row& own_up = y > 0 ? own[y - 1] : full;
+        const Row& own_down = y + 1 < size ? own[y + 1] : full;
+        const Row& opponent_up = y > 0 ? opponent[y - 1] : zero;
+        const Row& opponent_down = y + 1 < size ? opponent[y + 1] : zero;
+        const std::uint32_t edge = y == 0 || y + 1 == size ? mask : side_columns;
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            const std::uint32_t stones = own[y][lane];
+            const std::uint32_t empty = ~(stones | opponent[y][lane]) & mask;
+            const std::uint32_t surrounded =
+                (stones << 1 | 1u) & (stones >> 1 | last_column) & own_up[lane] & own_down[lane];
+            const std::uint32_t up_left = opponent_up[lane] << 1;
+            const std::uint32_t up_right = opponent_up[lane] >> 1;
+            const std::uint32_t down_left = opponent_down[lane] << 1;
+            const std::uint32_t down_right = opponent_down[lane] >> 1;
+            const std::uint32_t two = (up_left & up_right) | (down_left & down_right) |
+                                      ((up_left | up_right) & (down_left | down_right));
+            const std::uint32_t one = up_left | up_right | down_left | down_right;
+            candidates_[y][lane] = empty & ~(surrounded & ~(two | (edge & one))) & ~known_suicide[y][lane];
+        }
+    }
+
+    std::array<int, Lanes> moves;
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        moves[lane] = running_[lane] ? -1 : kNoMove;
+        if (running_[lane] && ko_[lane] >= 0) {
+            const std::size_t ko = static_cast<std::size_t>(ko_[lane]);
+            candidates_[ko / size][lane] &= ~(1u << ko % size);
+        }
+    }
+    Rows row_counts;
+    Row counts{};
+    for (std::size_t y = 0; y < size; ++y) {
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            row_counts[y][lane] = count_bits(candidates_[y][lane]);
+            counts[lane] += row_counts[y][lane];
+        }
+    }
+
+    // Every lane places its stone. Opponent stones next to it that kept no other liberty
+    // of their own go into the lane's next free seed slot, to be flooded below. A move with
+    // no liberty in sight is checked on its own; if it is suicide it is struck, and kept
+    // out of later steps together with the liberties that proved it.
+    std::array<Rows, 4> seeds;
+    std::array<Row, 4> seeded{};
+    std::size_t slots = 0;
+    std::array<bool, Lanes> own_adjacent{};
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        while (running_[lane] && counts[lane] > 0) {
+            std::uint32_t index = rng_[lane].below(counts[lane]);
+            std::size_t y = 0;
+            for (; index >= row_counts[y][lane]; ++y) {
+                index -= row_counts[y][lane];
+            }
+            std::uint32_t row = candidates_[y][lane];
+            for (; index > 0; --index) {
+                row &= row - 1;
+            }
+            const std::uint32_t bit = row & (0u - row);
+            const std::size_t vertex = y * size + static_cast<std::size_t>(std::countr_zero(bit));
+
+            // An empty point next to a stone, the move aside, is a liberty of its chain.
+            const auto open = [&](std::size_t r, std::uint32_t bits) {
+                const std::uint32_t empty = ~(own[r][lane] | opponent[r][lane]) & mask & ~(r == y ? bit : 0u);
+                return (empty & bits) != 0;
+            };
+            const auto has_liberty = [&](std::size_t r, std::uint32_t b) {
+                return open(r, b << 1 | b >> 1) || (r > 0 && open(r - 1, b)) || (r + 1 < size && open(r + 1, b));
+            };
+            const std::array<bool, 4> on_board{bit != 1u, bit != last_column, y > 0, y + 1 < size};
+            const std::array<std::size_t, 4> rows{y, y, y - 1, y + 1};
+            const std::array<std::uint32_t, 4> bits{bit >> 1, bit << 1, bit, bit};
+            bool safe = false;
+            bool adjacent = false;
+            std::array<bool, 4> atari{};
+            for (std::size_t side = 0; side < 4; ++side) {
+                if (!on_board[side]) {
+                    continue;
+                }
+                const std::size_t r = rows[side];
+                const std::uint32_t b = bits[side];
+                if ((own[r][lane] & b) != 0) {
+                    adjacent = true;
+                    safe = safe || has_liberty(r, b);
+                } else if ((opponent[r][lane] & b) == 0) {
+                    safe = true;
+                } else {
+                    atari[side] = !has_liberty(r, b);
+                }
+            }
+            if (!safe) {
+                // Legal only by taking the last liberty of an opponent chain or joining an
+                // own chain with a liberty further away.
+                std::array<int, 4> proof;
+                proof.fill(-1);
+                for (std::size_t side = 0; side < 4 && !safe; ++side) {
+                    if (on_board[side]) {
+                        const bool mine = (own[rows[side]][lane] & bits[side]) != 0;
+                        proof[side] = liberty(lane, mine ? own : opponent, rows[side], bits[side], y, bit, !adjacent);
+                        safe = mine ? proof[side] >= 0 : proof[side] < 0;
+                    }
+                }
+                if (!safe) {
+                    candidates_[y][lane] &= ~bit;
+                    --row_counts[y][lane];
+                    --counts[lane];
+                    // With only opponent stones around, the point stays suicide while those
+                    // liberties stay empty and the stones stay on the board.
+                    if (!adjacent) {
+                        known_suicide[y][lane] |= bit;
+                        for (const int point : proof) {
+                            if (point >= 0) {
+                                const std::size_t p = static_cast<std::size_t>(point);
+                                witnesses[p / size][lane] |= 1u << p % size;
+                            }
+                        }
+                    }
+                    continue;
+                }
+            }
+
+            own[y][lane] |= bit;
+            own_adjacent[lane] = adjacent;
+            for (std::size_t p = 0; p < 2; ++p) {
+                if ((witnesses_[p][y][lane] & bit) != 0) {
+                    forget(p, lane);
+                }
+            }
+            moves[lane] = static_cast<int>(vertex);
+            std::size_t slot = 0;
+            for (std::size_t side = 0; side < 4; ++side) {
+                if (!atari[side]) {
+                    continue;
+                }
+                if (slot == slots) {
+                    seeds[slots++] = Rows{};
+                }
+                seeds[slot][rows[side]][lane] |= bits[side];
+                seeded[slot++][lane] = ~0u;
+            }
+            break;
+        }
+    }
+
+    // The chains behind the seeds are flooded in all lanes together; those that reach no
+    // empty point are captured.
+    Rows captured;
+    Row captures{};
+    if (slots > 0) {
+        Rows open;
+        for (std::size_t y = 0; y < size; ++y) {
+            for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                open[y][lane] = ~(own[y][lane] | opponent[y][lane]) & mask;
+            }
+        }
+        bool capturing = false;
+        for (std::size_t slot = 0; slot < slots; ++slot) {
+            const Row found = find_liberties(seeds[slot], opponent, open);
+            Row dead;
+            std::uint32_t any_dead = 0;
+            for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                dead[lane] = seeded[slot][lane] & ~found[lane];
+                any_dead |= dead[lane];
+            }
+            if (any_dead == 0) {
+                continue;
+            }
+            if (!capturing) {
+                captured = Rows{};
+                capturing = true;
+            }
+            for (std::size_t y = 0; y < size; ++y) {
+                for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                    captured[y][lane] |= seeds[slot][y][lane] & dead[lane];
+                }
+            }
+        }
+        if (capturing) {
+            for (std::size_t y = 0; y < size; ++y) {
+                const Row& up = y > 0 ? captured[y - 1] : zero;
+                const Row& down = y + 1 < size ? captured[y + 1] : zero;
+                for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                    const std::uint32_t row = captured[y][lane];
+                    captures[lane] += count_bits(row);
+                    opponent[y][lane] &= ~row;
+                    // Points next to the captured stones have lost their opponent neighbour.
+                    known_suicide[y][lane] &= ~(row << 1 | row >> 1 | up[lane] | down[lane]);
+                }
+            }
+        }
+    }
+
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        // Simple ko: a lone stone that took a lone stone and has the taken point as its
+        // only liberty.
+        ko_[lane] = -1;
+        if (captures[lane] != 1 || own_adjacent[lane]) {
+            continue;
+        }
+        const std::size_t move = static_cast<std::size_t>(moves[lane]);
+        const std::size_t y = move / size;
+        const std::uint32_t bit = 1u << move % size;
+        const auto empty = [&](std::size_t r) { return ~(own[r][lane] | opponent[r][lane]) & mask; };
+        const int liberties = std::popcount(empty(y) & (bit << 1 | bit >> 1)) +
+                              (y > 0 && (empty(y - 1) & bit) != 0 ? 1 : 0) +
+                              (y + 1 < size && (empty(y + 1) & bit) != 0 ? 1 : 0);
+        for (std::size_t r = 0; liberties == 1 && r < size; ++r) {
+            if (captured[r][lane] != 0) {
+                ko_[lane] = static_cast<int>(r * size + static_cast<std::size_t>(std::countr_zero(captured[r][lane])));
+            }
+        }
+    }
+
+    const int limit = max_moves_ > 0 ? max_moves_ : 3 * static_cast<int>(size * size);
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        last_move_[lane] = moves[lane];
+        if (!running_[lane]) {
+            continue;
+        }
+        if (moves[lane] >= 0) {
+            passes_[lane] = 0;
+        } else {
+            ko_[lane] = -1;
+            ++passes_[lane];
+        }
+        to_play_[lane] = other(to_play_[lane]);
+        ++moves_[lane];
+        running_[lane] = passes_[lane] < 2 && moves_[lane] < limit;
+    }
+    player_ = other(player_);
+}
+
+template <std::size_t Lanes>
+typename PlayoutLanes<Lanes>::Row PlayoutLanes<Lanes>::find_liberties(Rows& chain, const Rows& passable,
+                                                                      const Rows& open) const noexcept {
+    const Row zero{};
+    Row found{};
+    // Sweeps alternate between downward and upward, so a chain spreads through many rows
+    // in one pass either way.
+    for (bool downward = true;; downward = !downward) {
+        Row changed{};
+        for (std::size_t i = 0; i < size_; ++i) {
+            const std::size_t y = downward ? i : size_ - 1 - i;
+            const Row& up = y > 0 ? chain[y - 1] : zero;
+            const Row& down = y + 1 < size_ ? chain[y + 1] : zero;
+            Row& row = chain[y];
+            for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                const std::uint32_t reach = row[lane] | row[lane] << 1 | row[lane] >> 1 | up[lane] | down[lane];
+                const std::uint32_t grown = (reach & passable[y][lane]) | row[lane];
+                found[lane] |= reach & open[y][lane];
+                changed[lane] |= grown ^ row[lane];
+                row[lane] = grown;
+            }
+        }
+        bool growing = false;
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            growing = growing || (changed[lane] != 0 && found[lane] == 0);
+        }
+        if (!growing) {
+            break;
+        }
+    }
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        found[lane] = found[lane] != 0 ? ~0u : 0u;
+    }
+    return found;
+}
+
+template <std::size_t Lanes>
+void PlayoutLanes<Lanes>::fill(Rows& reach, const Rows& passable) const noexcept {
+    const Row zero{};
+    for (bool downward = true;; downward = !downward) {
+        std::uint32_t changed = 0;
+        for (std::size_t i = 0; i < size_; ++i) {
+            const std::size_t y = downward ? i : size_ - 1 - i;
+            const Row& up = y > 0 ? reach[y - 1] : zero;
+            const Row& down = y + 1 < size_ ? reach[y + 1] : zero;
+            Row& row = reach[y];
+            for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                const std::uint32_t grown =
+                    (row[lane] | row[lane] << 1 | row[lane] >> 1 | up[lane] | down[lane]) & passable[y][lane];
+                changed |= grown ^ row[lane];
+                row[lane] = grown;
+            }
+        }
+        if (changed == 0) {
+            return;
+        }
+    }
+}
+
+template <std::size_t Lanes>
+void PlayoutLanes<Lanes>::score_all(float* scores, std::int8_t* ownership) const {
+    // Each colour floods its stones through the empty points of every lane at once; an
+    // empty point reached by one colour only is its territory.
+    Rows black_reach = black_;
+    Rows white_reach = white_;
+    Rows black_passable;
+    Rows white_passable;
+    for (std::size_t y = 0; y < size_; ++y) {
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            const std::uint32_t empty = ~(black_[y][lane] | white_[y][lane]) & row_mask_;
+            black_passable[y][lane] = black_[y][lane] | empty;
+            white_passable[y][lane] = white_[y][lane] | empty;
+        }
+    }
+    fill(black_reach, black_passable);
+    fill(white_reach, white_passable);
+
+    const std::size_t area = size_ * size_;
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        int total = 0;
+        for (std::size_t y = 0; y < size_; ++y) {
+            const std::uint32_t black_area = black_reach[y][lane] & ~white_reach[y][lane];
+            const std::uint32_t white_area = white_reach[y][lane] & ~black_reach[y][lane];
+            total += std::popcount(black_area) - std::popcount(white_area);
+            if (ownership) {
+                std::int8_t* out = ownership + lane * area + y * size_;
+                for (std::size_t x = 0; x < size_; ++x) {
+                    out[x] = static_cast<std::int8_t>(static_cast<int>((black_area >> x) & 1u) -
+                                                      static_cast<int>((white_area >> x) & 1u));
+                }
+            }
+        }
+        scores[lane] = static_cast<float>(total) - komi_;
+    }
+}
+
+template <std::size_t Lanes>
+PointState PlayoutLanes<Lanes>::point_state(std::size_t lane, std::size_t vertex) const noexcept {
+    const std::uint32_t bit = 1u << vertex % size_;
+    const std::size_t y = vertex / size_;
+    return (black_[y][lane] & bit) != 0   ? PointState::Black
+           : (white_[y][lane] & bit) != 0 ? PointState::White
+                                          : PointState::Empty;
+}
+
+template <std::size_t Lanes>
+bool PlayoutLanes<Lanes>::is_legal(std::size_t lane, std::size_t vertex, Player player) const noexcept {
+    const std::size_t y = vertex / size_;
+    const std::uint32_t bit = 1u << vertex % size_;
+    if (point_state(lane, vertex) != PointState::Empty || static_cast<int>(vertex) == ko_[lane]) {
+        return false;
+    }
+    const Rows& own = player == Player::Black ? black_ : white_;
+    const Rows& opponent = player == Player::Black ? white_ : black_;
+    // Legal when it touches an empty point, takes the last liberty of an opponent chain
+    // or joins an own chain that keeps another liberty.
+    const std::array<bool, 4> on_board{bit != 1u, bit != 1u << (size_ - 1), y > 0, y + 1 < size_};
+    const std::array<std::size_t, 4> rows{y, y, y - 1, y + 1};
+    const std::array<std::uint32_t, 4> bits{bit >> 1, bit << 1, bit, bit};
+    for (std::size_t side = 0; side < 4; ++side) {
+        if (!on_board[side]) {
+            continue;
+        }
+        const std::size_t r = rows[side];
+        const std::uint32_t b = bits[side];
+        if ((own[r][lane] & b) != 0 ? liberty(lane, own, r, b, y, bit) >= 0
+                                    : (opponent[r][lane] & b) == 0 || liberty(lane, opponent, r, b, y, bit) < 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <std::size_t Lanes>
+int PlayoutLanes<Lanes>::liberty(std::size_t lane, const Rows& stones, std::size_t y, std::uint32_t bit,
+                                 std::size_t skip_y, std::uint32_t skip_bit, bool eye_first) const noexcept {
+    // One lane's flood, kept to the rows next to what the chain covers so far.
+    std::array<std::uint32_t, kMaxSize + 1> chain{};
+    chain[y] = bit;
+    std::size_t first = y;
+    std::size_t last = y;
+    int found = -1;
+    for (;;) {
+        bool changed = false;
+        const std::size_t from = first > 0 ? first - 1 : 0;
+        const std::size_t to = last + 1 < size_ ? last + 1 : last;
+        for (std::size_t r = from; r <= to; ++r) {
+            const std::uint32_t reach =
+                chain[r] | chain[r] << 1 | chain[r] >> 1 | (r > 0 ? chain[r - 1] : 0u) | chain[r + 1];
+            const std::uint32_t empty =
+                ~(black_[r][lane] | white_[r][lane]) & row_mask_ & ~(r == skip_y ? skip_bit : 0u);
+            const std::uint32_t liberties = reach & empty;
+            if (liberties != 0) {
+                const std::uint32_t row = stones[r][lane];
+                const std::uint32_t eyes = liberties & (row << 1 | 1u) & (row >> 1 | 1u << (size_ - 1)) &
+                                           (r > 0 ? stones[r - 1][lane] : row_mask_) &
+                                           (r + 1 < size_ ? stones[r + 1][lane] : row_mask_);
+                const std::uint32_t pick = eyes != 0 ? eyes : liberties;
+                const int point = static_cast<int>(r * size_ + static_cast<std::size_t>(std::countr_zero(pick)));
+                if (!eye_first || eyes != 0) {
+                    return point;
+                }
+                found = found < 0 ? point : found;
+            }
+            const std::uint32_t grown = (reach & stones[r][lane]) | chain[r];
+            if (grown != chain[r]) {
+                chain[r] = grown;
+                changed = true;
+                first = r < first ? r : first;
+                last = r > last ? r : last;
+            }
+        }
+        if (!changed) {
+            return found;
+        }
+    }
+}
+
+template <std::size_t Lanes>
+void PlayoutLanes<Lanes>::forget(std::size_t player, std::size_t lane) noexcept {
+    for (std::size_t y = 0; y < size_; ++y) {
+        suicide_[player][y][lane] = 0;
+        witnesses_[player][y][lane] = 0;
+    }
+}
+
+template class PlayoutLanes<8>;
+template class PlayoutLanes<16>;
+
+} // namespace go
@@ -1,4 +1,51 @@
 #include "go/Rules.hpp"
 
-// Rules data structure currently implemented as a header-only struct.
+#include <bit>
+#include <stdexcept>
+#include <string>
 
+namespace go {
+
+namespace {
+
+std::uint64_t mix(std::uint64_t bits) noexcept {
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdull;
+    bits ^= bits >> 33;
+    bits *= 0xc4ceb9fe1a85ec53ull;
+    return bits ^ (bits >> 33);
+}
+
+} // namespace
+
+std::uint64_t rules_hash(const Rules& rules) noexcept {
+    // +0.0 and -0.0 compare equal, so they must hash equal too.
+    const double komi = rules.komi == 0.0 ? 0.0 : rules.komi;
+    std::uint64_t hash = mix(std::bit_cast<std::uint64_t>(komi));
+    const std::uint64_t flags = static_cast<std::uint64_t>(rules.board_size) << 8 |
+                                static_cast<std::uint64_t>(rules.allow_suicide) << 4 |
+                                static_cast<std::uint64_t>(rules.ko_rule) << 2 |
+                                static_cast<std::uint64_t>(rules.scoring_rule);
+    hash = mix(hash ^ mix(flags + 0x9e3779b97f4a7c15ull));
+    return hash == 0 ? 1 : hash;
+}
+
+void apply_rules_name(Rules& rules, std::string_view name) {
+    if (name == "tromp-taylor") {
+        rules.ko_rule = KoRule::PositionalSuperko;
+        rules.allow_suicide = true;
+        rules.scoring_rule = ScoringRule::TrompTaylorArea;
+    } else if (name == "chinese") {
+        rules.ko_rule = KoRule::PositionalSuperko;
+        rules.allow_suicide = false;
+        rules.scoring_rule = ScoringRule::TrompTaylorArea;
+    } else if (name == "japanese") {
+        rules.ko_rule = KoRule::SimpleKo;
+        rules.allow_suicide = false;
+        rules.scoring_rule = ScoringRule::Territory;
+    } else {
+        throw std::invalid_argument("Unknown rules: " + std::string(name));
+    }
+}
+
+} // namespace go
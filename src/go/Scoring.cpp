@@ -0,0 +1,108 @@
+#include "go/Scoring.hpp"
+
+#include <array>
+#include <bit>
+
+namespace go {
+
+namespace {
+
+constexpr std::size_t kMaxRows = 25;
+using Rows = std::array<std::uint32_t, kMaxRows>;
+
+// Grows seeds sideways within the runs of passable bits they touch.
+std::uint32_t fill_row(std::uint32_t seeds, std::uint32_t passable) noexcept {
+    std::uint32_t row = seeds & passable;
+    for (;;) {
+        const std::uint32_t next = (row | (row << 1) | (row >> 1)) & passable;
+        if (next == row) {
+            return row;
+        }
+        row = next;
+    }
+}
+
+// Floods reach through passable, alternating downward and upward sweeps so that a
+// region is usually covered in one or two rounds.
+void flood(Rows& reach, const Rows& passable, std::size_t size) noexcept {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (std::size_t y = 0; y < size; ++y) {
+            const std::uint32_t seeds = reach[y] | (y > 0 ? reach[y - 1] : 0u);
+            const std::uint32_t row = fill_row(seeds, passable[y]);
+            changed = changed || row != reach[y];
+            reach[y] = row;
+        }
+        for (std::size_t y = size; y-- > 0;) {
+            const std::uint32_t seeds = reach[y] | (y + 1 < size ? reach[y + 1] : 0u);
+            const std::uint32_t row = fill_row(seeds, passable[y]);
+            changed = changed || row != reach[y];
+            reach[y] = row;
+        }
+    }
+}
+
+} // namespace
+
+ScoreResult score_area(const Board& board, std::int8_t* ownership) {
+    const std::size_t size = board.board_size();
+    const std::vector<PointState>& points = board.points();
+    Rows black{};
+    Rows white{};
+    Rows empty{};
+    for (std::size_t y = 0; y < size; ++y) {
+        const PointState* row = points.data() + y * size;
+        for (std::size_t x = 0; x < size; ++x) {
+            const std::uint32_t bit = 1u << x;
+            black[y] |= row[x] == PointState::Black ? bit : 0u;
+            white[y] |= row[x] == PointState::White ? bit : 0u;
+            empty[y] |= row[x] == PointState::Empty ? bit : 0u;
+        }
+    }
+
+    // Each colour floods its own stones and the empty points; passing through its own
+    // stones only links regions that touch that colour anyway.
+    Rows black_reach = black;
+    Rows white_reach = white;
+    Rows black_passable{};
+    Rows white_passable{};
+    for (std::size_t y = 0; y < size; ++y) {
+        black_passable[y] = black[y] | empty[y];
+        white_passable[y] = white[y] | empty[y];
+    }
+    flood(black_reach, black_passable, size);
+    flood(white_reach, white_passable, size);
+
+    int black_points = 0;
+    int white_points = 0;
+    for (std::size_t y = 0; y < size; ++y) {
+        const std::uint32_t black_area = black[y] | (empty[y] & black_reach[y] & ~white_reach[y]);
+        const std::uint32_t white_area = white[y] | (empty[y] & white_reach[y] & ~black_reach[y]);
+        black_points += std::popcount(black_area);
+        white_points += std::popcount(white_area);
+        if (ownership) {
+            std::int8_t* out = ownership + y * size;
+            for (std::size_t x = 0; x < size; ++x) {
+                out[x] = static_cast<std::int8_t>(static_cast<int>((black_area >> x) & 1u) -
+                                                  static_cast<int>((white_area >> x) & 1u));
+            }
+        }
+    }
+
+    ScoreResult result;
+    result.black_points = black_points;
+    result.white_points = white_points + board.rules().komi;
+    return result;
+}
+
+void score_area_batch(const Board* const* boards, std::size_t count, ScoreResult* scores, std::int8_t* ownership) {
+    for (std::size_t i = 0; i < count; ++i) {
+        scores[i] = score_area(*boards[i], ownership);
+        if (ownership) {
+            ownership += boards[i]->board_size() * boards[i]->board_size();
+        }
+    }
+}
+
+} // namespace go
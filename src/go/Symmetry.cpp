@@ -0,0 +1,55 @@
+#include "go/Symmetry.hpp"
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace go {
+
+namespace {
+
+constexpr std::size_t kMaxBoardSize = 25;
+
+int apply_symmetry(int vertex, int symmetry, int size) {
+    int x = vertex % size;
+    int y = vertex / size;
+    if (symmetry & 4) {
+        std::swap(x, y);
+    }
+    if (symmetry & 1) {
+        x = size - 1 - x;
+    }
+    if (symmetry & 2) {
+        y = size - 1 - y;
+    }
+    return y * size + x;
+}
+
+} // namespace
+
+const SymmetryMap* symmetry_table(std::size_t board_size) {
+    static const std::vector<std::vector<SymmetryMap>> tables = [] {
+        std::vector<std::vector<SymmetryMap>> all(kMaxBoardSize + 1);
+        for (int size = 1; size <= static_cast<int>(kMaxBoardSize); ++size) {
+            auto& table = all[static_cast<std::size_t>(size)];
+            table.resize(static_cast<std::size_t>(size * size));
+            for (int vertex = 0; vertex < size * size; ++vertex) {
+                for (int symmetry = 0; symmetry < kSymmetries; ++symmetry) {
+                    table[static_cast<std::size_t>(vertex)][static_cast<std::size_t>(symmetry)] =
+                        apply_symmetry(vertex, symmetry, size);
+                }
+            }
+        }
+        return all;
+    }();
+    if (board_size == 0 || board_size > kMaxBoardSize) {
+        throw std::invalid_argument("no symmetry table for this board size");
+    }
+    return tables[board_size].data();
+}
+
+int transform_vertex(int vertex, int symmetry, std::size_t board_size) {
+    return symmetry_table(board_size)[static_cast<std::size_t>(vertex)][static_cast<std::size_t>(symmetry)];
+}
+
+} // namespace go
@@ -1,17 +1,19 @@
 #include "go/Zobrist.hpp"
 
-#include <random>
+#include <memory>
+#include <stdexcept>
 
 namespace {
 
-std::mt19937_64& rng() {
-    static std::mt19937_64 gen(0x5eedbadull);
-    return gen;
-}
+constexpr std::size_t kMaxBoardSize = 25;
 
-std::uint64_t random_uint64() {
-    static std::uniform_int_distribution<std::uint64_t> dist;
-    return dist(rng());
+// SplitMix64: every table is a pure function of its board size, so keys agree across
+// boards, threads and processes.
+std::uint64_t next_random(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
 }
 
 } // namespace
@@ -22,13 +24,28 @@ ZobristTable::ZobristTable(std::size_t board_size) : board_size_(board_size) {
     white_hashes_.resize(total);
     ko_hashes_.resize(total);
 
+    std::uint64_t state = 0x5eedbadull ^ (static_cast<std::uint64_t>(board_size) << 32);
     for (std::size_t i = 0; i < total; ++i) {
-        black_hashes_[i] = random_uint64();
-        white_hashes_[i] = random_uint64();
-        ko_hashes_[i] = random_uint64();
+        black_hashes_[i] = next_random(state);
+        white_hashes_[i] = next_random(state);
+        ko_hashes_[i] = next_random(state);
     }
 
-    side_to_move_ = random_uint64();
+    side_to_move_ = next_random(state);
+}
+
+const ZobristTable& ZobristTable::for_board_size(std::size_t board_size) {
+    static const auto tables = [] {
+        auto all = std::make_unique<ZobristTable[]>(kMaxBoardSize + 1);
+        for (std::size_t size = 1; size <= kMaxBoardSize; ++size) {
+            all[size] = ZobristTable(size);
+        }
+        return all;
+    }();
+    if (board_size == 0 || board_size > kMaxBoardSize) {
+        throw std::invalid_argument("no Zobrist table for this board size");
+    }
+    return tables[board_size];
 }
 
 std::uint64_t ZobristTable::black_stone_hash(std::size_t vertex) const {
@@ -42,4 +59,3 @@ std::uint64_t ZobristTable::white_stone_hash(std::size_t vertex) const {
 std::uint64_t ZobristTable::ko_hash(std::size_t vertex) const {
     return ko_hashes_.at(vertex);
 }
-
@@ -1,11 +1,17 @@
 #include "gtp/GTP.hpp"
 
+#include "search/Options.hpp"
+
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <cmath>
+#include <fstream>
 #include <iomanip>
+#include <limits>
 #include <optional>
 #include <sstream>
+#include <stdexcept>
 
 namespace {
 
@@ -63,6 +69,14 @@ bool try_parse_double(const std::string& s, double& out) {
 
 namespace gtp {
 
+void SessionMetrics::add(const SessionMetrics& other) {
+    searches += other.searches;
+    search_time += other.search_time;
+    max_search_time = std::max(max_search_time, other.max_search_time);
+    queue_wait += other.queue_wait;
+    max_queue_wait = std::max(max_queue_wait, other.max_queue_wait);
+}
+
 Server::Server(go::Board board,
                std::istream& in,
                std::ostream& out,
@@ -73,13 +87,21 @@ Server::Server(go::Board board,
       out_(out),
       search_agent_(std::make_unique<search::SearchAgent>(search_config, std::move(evaluator))),
       search_config_(search_config) {
+    board_.set_undo_log(true);
     register_handlers();
     reset_search();
 }
 
+Server::~Server() {
+    stop_analysis();
+}
+
 void Server::run() {
     std::string line;
     while (std::getline(in_, line)) {
+        // Any input line ends a running analysis, a blank one included: GUIs such as
+        // Lizzie stop lz-analyze by sending just a newline.
+        stop_analysis();
         auto comment_pos = line.find('#');
         if (comment_pos != std::string::npos) {
             line = line.substr(0, comment_pos);
@@ -118,6 +140,10 @@ void Server::run() {
             result = {false, "unknown_command"};
         }
 
+        if (result.first && analysis_request_) {
+            start_analysis(id);
+            continue;
+        }
         out_ << (result.first ? format_success(id, result.second) : format_failure(id, result.second));
         out_.flush();
 
@@ -125,6 +151,20 @@ void Server::run() {
             break;
         }
     }
+    stop_analysis();
+}
+
+void Server::set_root_contributor(std::shared_ptr<search::RootSearchContributor> contributor) {
+    search_agent_->set_root_contributor(std::move(contributor));
+}
+
+void Server::set_scheduler(std::shared_ptr<search::SearchScheduler> scheduler) {
+    search_agent_->set_scheduler(std::move(scheduler));
+}
+
+SessionMetrics Server::metrics() const {
+    std::scoped_lock lock(metrics_mutex_);
+    return metrics_;
 }
 
 Server::HandlerResult Server::handle_protocol_version(const std::string&) {
@@ -152,7 +192,7 @@ Server::HandlerResult Server::handle_boardsize(const std::string& args) {
     }
     go::Rules rules = board_.rules();
     rules.board_size = static_cast<std::size_t>(size);
-    board_ = go::Board(rules);
+    board_ = fresh_board(rules);
     reset_search();
     return {true, ""};
 }
@@ -174,8 +214,21 @@ Server::HandlerResult Server::handle_komi(const std::string& args) {
     }
     go::Rules rules = board_.rules();
     rules.komi = komi;
-    board_ = go::Board(rules);
-    reset_search();
+    change_rules(rules);
+    return {true, ""};
+}
+
+Server::HandlerResult Server::handle_kgs_rules(const std::string& args) {
+    if (args.empty()) {
+        return {false, "kgs-rules requires value"};
+    }
+    go::Rules rules = board_.rules();
+    try {
+        go::apply_rules_name(rules, to_lower_copy(args));
+    } catch (const std::invalid_argument&) {
+        return {false, "unknown rules"};
+    }
+    change_rules(rules);
     return {true, ""};
 }
 
@@ -210,6 +263,7 @@ Server::HandlerResult Server::handle_play(const std::string& args) {
     if (!board_.play_move(color, move)) {
         return {false, "illegal move"};
     }
+    history_.push_back({color, move});
     ++move_number_;
     search_agent_->notify_move(move, board_, board_.to_play());
     return {true, ""};
@@ -230,11 +284,23 @@ Server::HandlerResult Server::handle_genmove(const std::string& args) {
 
     board_.set_to_play(color);
 
+    const auto search_start = std::chrono::steady_clock::now();
     go::Move move = search_agent_->select_move(board_, color, move_number_);
+    {
+        SessionMetrics sample;
+        sample.searches = 1;
+        sample.search_time = std::chrono::steady_clock::now() - search_start;
+        sample.max_search_time = sample.search_time;
+        sample.queue_wait = search_agent_->last_job().queue_wait;
+        sample.max_queue_wait = sample.queue_wait;
+        std::scoped_lock lock(metrics_mutex_);
+        metrics_.add(sample);
+    }
     if (!board_.play_move(color, move)) {
         return {false, "genmove failed"};
     }
 
+    history_.push_back({color, move});
     ++move_number_;
     search_agent_->notify_move(move, board_, board_.to_play());
 
@@ -302,6 +368,270 @@ Server::HandlerResult Server::handle_quit(const std::string&) {
     return {true, ""};
 }
 
+Server::HandlerResult Server::handle_tenuki_stats(const std::string&) {
+    if (!search_agent_->config().collect_stats) {
+        return {false, "search stats disabled"};
+    }
+    return {true, search::format_search_stats(search_agent_->stats())};
+}
+
+Server::HandlerResult Server::handle_tenuki_session_stats(const std::string&) {
+    const SessionMetrics metrics = this->metrics();
+    const auto ms = [](std::chrono::nanoseconds time) { return std::chrono::duration<double, std::milli>(time).count(); };
+    const double searches = static_cast<double>(std::max<std::uint64_t>(1, metrics.searches));
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << "searches " << metrics.searches << " mean_ms " << ms(metrics.search_time) / searches << " max_ms " << ms(metrics.max_search_time)
+        << " mean_wait_ms " << ms(metrics.queue_wait) / searches << " max_wait_ms " << ms(metrics.max_queue_wait);
+    return {true, oss.str()};
+}
+
+Server::HandlerResult Server::handle_tenuki_set(const std::string& args) {
+    std::istringstream iss(args);
+    std::string name;
+    iss >> name;
+    std::string value;
+    std::getline(iss, value);
+    value = trim_copy(value);
+
+    search::EngineOptions options;
+    options.search = search_config_;
+    if (name.empty()) {
+        std::ostringstream oss;
+        for (const std::string& option : search::option_names()) {
+            if (search::is_search_option(option)) {
+                oss << (oss.tellp() > 0 ? "\n" : "") << option << ' ' << search::get_option(options, option);
+            }
+        }
+        return {true, oss.str()};
+    }
+    if (!search::is_search_option(name)) {
+        return {false, search::is_option(name) ? "cannot change at runtime" : "unknown option"};
+    }
+    if (value.empty()) {
+        return {true, search::get_option(options, name)};
+    }
+    try {
+        search::set_option(options, name, value);
+    } catch (const std::invalid_argument&) {
+        return {false, "invalid value"};
+    }
+    search_config_ = options.search;
+    search_agent_->set_config(search_config_);
+    return {true, ""};
+}
+
+Server::HandlerResult Server::handle_loadsgf(const std::string& args) {
+    std::istringstream iss(args);
+    std::string path;
+    if (!(iss >> path)) {
+        return {false, "loadsgf requires file"};
+    }
+    // GTP's move_number names the first move not to play; without it the whole game is loaded.
+    std::size_t move_limit = std::numeric_limits<std::size_t>::max();
+    std::string move_token;
+    if (iss >> move_token) {
+        int move_number = 0;
+        if (!try_parse_int(move_token, move_number) || move_number < 1) {
+            return {false, "invalid move number"};
+        }
+        move_limit = static_cast<std::size_t>(move_number - 1);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return {false, "cannot load file"};
+    }
+    sgf::GameTree game;
+    try {
+        game = sgf::load(file);
+    } catch (const std::invalid_argument&) {
+        return {false, "cannot load file"};
+    }
+    if (game.board_size == 0 || game.board_size > 25) {
+        return {false, "cannot load file"};
+    }
+
+    // Replay into a board of our own so a bad game leaves the current one untouched.
+    go::Rules rules = board_.rules();
+    rules.board_size = game.board_size;
+    if (game.komi) {
+        rules.komi = *game.komi; // otherwise the komi the controller set stays
+    }
+    go::Board board = fresh_board(rules);
+    sgf::apply_setup(game, board);
+    const std::size_t count = std::min(move_limit, game.moves.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        const sgf::MoveRecord& record = game.moves[i];
+        board.set_to_play(record.player);
+        if (!board.play_move(record.player, record.move)) {
+            return {false, "illegal move " + std::to_string(i + 1)};
+        }
+    }
+
+    // The old tree does not lead here; the next search starts from a fresh root.
+    board_ = std::move(board);
+    reset_search();
+    game.moves.erase(game.moves.begin() + static_cast<std::ptrdiff_t>(count), game.moves.end());
+    history_ = std::move(game.moves);
+    setup_ = std::move(game.setup);
+    move_number_ = static_cast<int>(count);
+
+    const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::ostringstream oss;
+    oss << count << " moves in " << std::fixed << std::setprecision(2) << elapsed << " ms";
+    return {true, oss.str()};
+}
+
+Server::HandlerResult Server::handle_printsgf(const std::string& args) {
+    sgf::GameTree game;
+    game.board_size = board_.board_size();
+    game.komi = board_.rules().komi;
+    game.setup = setup_;
+    game.moves = history_;
+    if (args.empty()) {
+        std::ostringstream oss;
+        sgf::save(game, oss);
+        return {true, oss.str()};
+    }
+    std::ofstream file(args, std::ios::binary);
+    if (file) {
+        sgf::save(game, file);
+    }
+    if (!file) {
+        return {false, "cannot write file"};
+    }
+    return {true, ""};
+}
+
+Server::HandlerResult Server::handle_tenuki_trace(const std::string& args) {
+    if (args.empty()) {
+        return {false, "tenuki-trace requires file"};
+    }
+    if (!search_agent_->config().enable_trace) {
+        return {false, "search trace disabled"};
+    }
+    std::ofstream file(args);
+    if (!file || !search_agent_->write_trace(file)) {
+        return {false, "cannot write trace"};
+    }
+    return {true, ""};
+}
+
+Server::HandlerResult Server::handle_lz_analyze(const std::string& args) {
+    return parse_analysis_request(args, false);
+}
+
+Server::HandlerResult Server::handle_kata_analyze(const std::string& args) {
+    return parse_analysis_request(args, true);
+}
+
+// Accepts [color] [interval] followed by "interval N" and "maxmoves N" pairs, the
+// interval in centiseconds as in Leela Zero and KataGo.
+Server::HandlerResult Server::parse_analysis_request(const std::string& args, bool kata) {
+    std::istringstream iss(args);
+    std::vector<std::string> tokens;
+    for (std::string token; iss >> token;) {
+        tokens.push_back(to_lower_copy(token));
+    }
+
+    AnalysisRequest request;
+    request.color = board_.to_play();
+    request.kata = kata;
+    std::size_t pos = 0;
+    if (pos < tokens.size() && (tokens[pos] == "b" || tokens[pos] == "black")) {
+        request.color = go::Player::Black;
+        ++pos;
+    } else if (pos < tokens.size() && (tokens[pos] == "w" || tokens[pos] == "white")) {
+        request.color = go::Player::White;
+        ++pos;
+    }
+    int value = 0;
+    if (pos < tokens.size() && try_parse_int(tokens[pos], value)) {
+        if (value < 0) {
+            return {false, "invalid interval"};
+        }
+        request.interval_centiseconds = value;
+        ++pos;
+    }
+    while (pos < tokens.size()) {
+        const std::string& key = tokens[pos];
+        if (key != "interval" && key != "maxmoves") {
+            return {false, "unknown analyze argument " + key};
+        }
+        if (pos + 1 >= tokens.size() || !try_parse_int(tokens[pos + 1], value) || value < 0) {
+            return {false, "invalid " + key};
+        }
+        if (key == "interval") {
+            request.interval_centiseconds = value;
+        } else {
+            request.max_moves = static_cast<std::size_t>(value);
+        }
+        pos += 2;
+    }
+    analysis_request_ = request;
+    return {true, ""};
+}
+
+void Server::start_analysis(const std::string& id) {
+    const AnalysisRequest request = *analysis_request_;
+    analysis_request_.reset();
+    // The response stays open: info lines follow until stop_analysis() ends it.
+    out_ << '=' << id << '\n';
+    out_.flush();
+
+    go::Board board = board_;
+    board.set_to_play(request.color);
+    analysis_stop_.store(false, std::memory_order_relaxed);
+    const auto interval = std::chrono::milliseconds(10 * std::max(1, request.interval_centiseconds));
+    analysis_thread_ = std::thread([this, board = std::move(board), request, interval]() {
+        search_agent_->analyze(board, request.color, move_number_, analysis_stop_, interval,
+                               [this, &request](const std::vector<search::MoveAnalysis>& moves) {
+                                   if (!moves.empty()) {
+                                       out_ << format_analysis(moves, request);
+                                       out_.flush();
+                                   }
+                               });
+    });
+}
+
+void Server::stop_analysis() {
+    if (!analysis_thread_.joinable()) {
+        return;
+    }
+    analysis_stop_.store(true, std::memory_order_relaxed);
+    analysis_thread_.join();
+    out_ << '\n';
+    out_.flush();
+}
+
+std::string Server::format_analysis(const std::vector<search::MoveAnalysis>& moves, const AnalysisRequest& request) const {
+    const auto vertex = [this](int move) { return move < 0 ? std::string("pass") : vertex_to_string(move); };
+    const std::size_t count = request.max_moves > 0 ? std::min(request.max_moves, moves.size()) : moves.size();
+    std::ostringstream oss;
+    for (std::size_t i = 0; i < count; ++i) {
+        const search::RootMoveStats& stats = moves[i].stats;
+        const double value = stats.value_sum / static_cast<double>(stats.visit_count);
+        const double winrate = std::clamp((1.0 + value) / 2.0, 0.0, 1.0);
+        if (i > 0) {
+            oss << ' ';
+        }
+        oss << "info move " << vertex(stats.move) << " visits " << stats.visit_count;
+        if (request.kata) {
+            oss << std::fixed << std::setprecision(6) << " winrate " << winrate << " prior " << stats.prior;
+        } else {
+            // Leela Zero reports both in hundredths of a percent.
+            oss << " winrate " << std::lround(winrate * 10000.0) << " prior " << std::lround(stats.prior * 10000.0);
+        }
+        oss << " order " << i << " pv";
+        for (const int move : moves[i].pv) {
+            oss << ' ' << vertex(move);
+        }
+    }
+    oss << '\n';
+    return oss.str();
+}
+
 std::pair<bool, go::Move> Server::parse_vertex(const std::string& vertex) const {
     if (vertex.empty()) {
         return {false, go::Move::Pass()};
@@ -390,15 +720,72 @@ void Server::register_handlers() {
     handlers_["boardsize"] = [this](const std::string& args) { return handle_boardsize(args); };
     handlers_["clear_board"] = [this](const std::string& args) { return handle_clear_board(args); };
     handlers_["komi"] = [this](const std::string& args) { return handle_komi(args); };
+    handlers_["kgs-rules"] = [this](const std::string& args) { return handle_kgs_rules(args); };
     handlers_["play"] = [this](const std::string& args) { return handle_play(args); };
     handlers_["genmove"] = [this](const std::string& args) { return handle_genmove(args); };
     handlers_["final_score"] = [this](const std::string& args) { return handle_final_score(args); };
     handlers_["showboard"] = [this](const std::string& args) { return handle_showboard(args); };
     handlers_["quit"] = [this](const std::string& args) { return handle_quit(args); };
+    handlers_["tenuki-stats"] = [this](const std::string& args) { return handle_tenuki_stats(args); };
+    handlers_["tenuki-trace"] = [this](const std::string& args) { return handle_tenuki_trace(args); };
+    handlers_["tenuki-session-stats"] = [this](const std::string& args) { return handle_tenuki_session_stats(args); };
+    handlers_["tenuki-set"] = [this](const std::string& args) { return handle_tenuki_set(args); };
+    handlers_["loadsgf"] = [this](const std::string& args) { return handle_loadsgf(args); };
+    handlers_["printsgf"] = [this](const std::string& args) { return handle_printsgf(args); };
+    handlers_["undo"] = [this](const std::string& args) { return handle_undo(args); };
+    handlers_["gg-undo"] = [this](const std::string& args) { return handle_gg_undo(args); };
+    handlers_["lz-analyze"] = [this](const std::string& args) { return handle_lz_analyze(args); };
+    handlers_["kata-analyze"] = [this](const std::string& args) { return handle_kata_analyze(args); };
+}
+
+void Server::change_rules(const go::Rules& rules) {
+    if (rules == board_.rules()) {
+        return;
+    }
+    board_.set_rules(rules);
+    search_agent_->notify_position(board_, board_.to_play());
+}
+
+go::Board Server::fresh_board(const go::Rules& rules) const {
+    go::Board board(rules);
+    board.set_pattern_tracking(board_.tracks_patterns());
+    board.set_undo_log(true);
+    return board;
+}
+
+Server::HandlerResult Server::undo_moves(std::size_t count) {
+    if (count == 0 || board_.undo_depth() < count || history_.size() < count) {
+        return {false, "cannot undo"};
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        board_.undo();
+        history_.pop_back();
+        --move_number_;
+    }
+    // The tree we leave is kept, and the one searched here before, if still retained, comes back.
+    search_agent_->notify_position(board_, board_.to_play());
+    return {true, ""};
+}
+
+Server::HandlerResult Server::handle_undo(const std::string&) {
+    return undo_moves(1);
+}
+
+Server::HandlerResult Server::handle_gg_undo(const std::string& args) {
+    int count = 1;
+    if (!args.empty() && (!try_parse_int(args, count) || count < 0)) {
+        return {false, "invalid number of moves"};
+    }
+    if (count == 0) {
+        return {true, ""};
+    }
+    return undo_moves(static_cast<std::size_t>(count));
 }
 
 void Server::reset_search() {
     move_number_ = 0;
+    history_.clear();
+    setup_ = {};
     if (search_agent_) {
         search_agent_->reset();
     } else {
@@ -0,0 +1,232 @@
+#include "gtp/SessionServer.hpp"
+
+#include "search/Distributed.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace gtp {
+namespace {
+
+// Buffered stream over a connected socket. Writes never raise SIGPIPE; a peer that hung
+// up turns into a failed stream, which ends the session like end of input.
+class SocketStreamBuf : public std::streambuf {
+public:
+    explicit SocketStreamBuf(int fd) : fd_(fd) {
+        setg(input_.data(), input_.data(), input_.data());
+        setp(output_.data(), output_.data() + output_.size());
+    }
+
+    ~SocketStreamBuf() override { flush(); }
+
+    SocketStreamBuf(const SocketStreamBuf&) = delete;
+    SocketStreamBuf& operator=(const SocketStreamBuf&) = delete;
+
+protected:
+    int_type underflow() override {
+        while (true) {
+            const ssize_t received = ::recv(fd_, input_.data(), input_.size(), 0);
+            if (received > 0) {
+                setg(input_.data(), input_.data(), input_.data() + received);
+                return traits_type::to_int_type(*gptr());
+            }
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            return traits_type::eof();
+        }
+    }
+
+    int_type overflow(int_type ch) override {
+        if (!flush()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override { return flush() ? 0 : -1; }
+
+private:
+    bool flush() {
+#ifdef MSG_NOSIGNAL
+        constexpr int kFlags = MSG_NOSIGNAL;
+#else
+        constexpr int kFlags = 0;
+#endif
+        const char* data = pbase();
+        std::size_t size = static_cast<std::size_t>(pptr() - pbase());
+        bool ok = true;
+        while (size > 0) {
+            const ssize_t written = ::send(fd_, data, size, kFlags);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                ok = false;
+                break;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        setp(output_.data(), output_.data() + output_.size());
+        return ok;
+    }
+
+    int fd_;
+    std::array<char, 4096> input_{};
+    std::array<char, 4096> output_{};
+};
+
+} // namespace
+
+SessionServer::SessionServer(std::string endpoint,
+                             SessionServerOptions options,
+                             std::shared_ptr<search::SearchScheduler> scheduler,
+                             std::shared_ptr<search::Evaluator> evaluator)
+    : endpoint_(std::move(endpoint)),
+      options_(std::move(options)),
+      scheduler_(std::move(scheduler)),
+      evaluator_(std::move(evaluator)) {
+    if (!scheduler_) {
+        throw std::invalid_argument("session server requires a scheduler");
+    }
+    if (!evaluator_) {
+        evaluator_ = search::make_uniform_evaluator();
+    }
+}
+
+SessionServer::~SessionServer() {
+    stop();
+    reap(true);
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        search::remove_endpoint_file(endpoint_);
+    }
+}
+
+void SessionServer::listen() {
+    listen_fd_ = search::listen_on_endpoint(endpoint_, options_.backlog);
+    if (listen_fd_ < 0) {
+        throw std::runtime_error("unable to listen on " + endpoint_);
+    }
+}
+
+void SessionServer::serve() {
+    if (listen_fd_ < 0) {
+        listen();
+    }
+    while (!stopping_.load()) {
+        const int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        reap(false);
+
+        std::scoped_lock lock(sessions_mutex_);
+        if (stopping_.load()) {
+            ::close(fd);
+            break;
+        }
+        auto session = std::make_shared<Session>();
+        session->fd = fd;
+        session->thread = std::thread([this, session]() { run_session(*session); });
+        sessions_.push_back(std::move(session));
+        ++sessions_started_;
+    }
+    reap(true);
+}
+
+void SessionServer::stop() {
+    stopping_.store(true);
+    // shutdown() wakes a thread blocked in accept() or recv() on the descriptor, unlike
+    // close(), and leaves it open so it cannot be reused before its owner closes it.
+    if (listen_fd_ >= 0) {
+        ::shutdown(listen_fd_, SHUT_RDWR);
+    }
+    std::scoped_lock lock(sessions_mutex_);
+    for (const auto& session : sessions_) {
+        ::shutdown(session->fd, SHUT_RDWR);
+    }
+}
+
+SessionServer::Stats SessionServer::stats() const {
+    Stats stats;
+    std::scoped_lock lock(sessions_mutex_);
+    stats.sessions_started = sessions_started_;
+    stats.searches = retired_;
+    for (const auto& session : sessions_) {
+        if (!session->finished.load()) {
+            ++stats.sessions_active;
+        }
+        std::scoped_lock session_lock(session->mutex);
+        stats.searches.add(session->server ? session->server->metrics() : session->metrics);
+    }
+    return stats;
+}
+
+void SessionServer::run_session(Session& session) {
+    SocketStreamBuf buffer(session.fd);
+    std::istream in(&buffer);
+    std::ostream out(&buffer);
+    try {
+        go::Board board(options_.rules);
+        board.set_pattern_tracking(options_.track_patterns);
+        Server server(std::move(board), in, out, options_.search, evaluator_);
+        server.set_scheduler(scheduler_);
+        {
+            std::scoped_lock lock(session.mutex);
+            session.server = &server;
+        }
+        try {
+            server.run();
+        } catch (const std::exception&) {
+            // A failing session only hangs up its own client.
+        }
+        std::scoped_lock lock(session.mutex);
+        session.metrics = server.metrics();
+        session.server = nullptr;
+    } catch (const std::exception&) {
+        // The session could not be set up; hanging up is all the client will see.
+    }
+    out.flush();
+    // Hang up now; the descriptor itself is closed once reap() has joined this thread.
+    ::shutdown(session.fd, SHUT_RDWR);
+    session.finished.store(true);
+}
+
+void SessionServer::reap(bool all) {
+    // Sessions stay listed while they are joined, so stop() can still hang them up.
+    std::vector<std::shared_ptr<Session>> done;
+    {
+        std::scoped_lock lock(sessions_mutex_);
+        for (const auto& session : sessions_) {
+            if (all || session->finished.load()) {
+                done.push_back(session);
+            }
+        }
+    }
+    for (const auto& session : done) {
+        session->thread.join();
+        std::scoped_lock lock(sessions_mutex_);
+        ::close(session->fd);
+        retired_.add(session->metrics);
+        sessions_.erase(std::find(sessions_.begin(), sessions_.end(), session));
+    }
+}
+
+} // namespace gtp
@@ -1,11 +1,31 @@
 #include "gtp/GTP.hpp"
+#include "gtp/SessionServer.hpp"
 #include "go/Rules.hpp"
+#include "nn/EvalServer.hpp"
+#include "nn/NeuralEvaluator.hpp"
+#include "search/BatchingEvaluator.hpp"
+#include "search/Distributed.hpp"
+#include "search/EvalCache.hpp"
+#include "search/Options.hpp"
+#include "search/PatternEvaluator.hpp"
+#include "search/RolloutEvaluator.hpp"
+#include "search/Scheduler.hpp"
 #include "search/Search.hpp"
+#include "search/SymmetricEvaluator.hpp"
+#include "search/Topology.hpp"
 
+#include <algorithm>
 #include <cerrno>
 #include <cstdlib>
+#include <exception>
+#include <iomanip>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace {
 
@@ -55,26 +75,273 @@ void apply_env_overrides(search::SearchConfig& config) {
         }
         config.enable_playout_cap_randomization = true;
     }
+
+    int flag = 0;
+    if (read_env_int("TENUKI_PIN_THREADS", flag)) {
+        config.pin_threads = flag != 0;
+    }
+    if (read_env_int("TENUKI_NUMA_LOCAL_TREES", flag)) {
+        config.numa_local_trees = flag != 0;
+    }
+    if (read_env_int("TENUKI_COLLECT_STATS", flag)) {
+        config.collect_stats = flag != 0;
+    }
+    if (read_env_int("TENUKI_TRACE", flag)) {
+        config.enable_trace = flag != 0;
+    }
+    if (read_env_int("TENUKI_READ_LADDERS", flag)) {
+        config.read_ladders = flag != 0;
+    }
+    if (read_env_int("TENUKI_PASS_ALIVE", flag)) {
+        config.prune_pass_alive = flag != 0;
+    }
+}
+
+// Environment variables that predate the options, applied after the config file.
+void apply_env_options(search::EngineOptions& options) {
+    static constexpr std::pair<const char*, const char*> kEnvOptions[] = {
+        {"TENUKI_WEIGHTS", "weights"},
+        {"TENUKI_EVAL_SERVER", "eval_server"},
+        {"TENUKI_NN_THREADS", "nn_threads"},
+        {"TENUKI_NN_CONV", "nn_conv"},
+        {"TENUKI_NN_PRECISION", "nn_precision"},
+        {"TENUKI_NN_CALIBRATION", "nn_calibration"},
+        {"TENUKI_NN_SYMMETRY", "nn_symmetry"},
+        {"TENUKI_NN_CACHE", "eval_cache"},
+        {"TENUKI_ROLLOUTS", "rollouts"},
+        {"TENUKI_ROLLOUT_AMAF", "rollout_amaf"},
+        {"TENUKI_PATTERNS", "patterns"},
+        {"TENUKI_POOL_THREADS", "pool_threads"},
+        {"TENUKI_SESSION_THREADS", "session_threads"},
+        {"TENUKI_EVAL_BATCH", "eval_batch"},
+    };
+    for (const auto& [variable, option] : kEnvOptions) {
+        if (const char* value = std::getenv(variable); value && *value != '\0') {
+            search::set_option(options, option, value);
+        }
+    }
+    apply_env_overrides(options.search);
+}
+
+void print_usage() {
+    std::cerr << "Usage: tenuki_cli [--config FILE] [--NAME VALUE | --NAME=VALUE ...] [--autotune] [--print-config]\n"
+              << "                  [--worker ENDPOINT | --workers ENDPOINT[,ENDPOINT...] | --serve ENDPOINT]\n"
+              << "  --config FILE        Read \"name = value\" option lines (also read from TENUKI_CONFIG)\n"
+              << "  --NAME VALUE         Set an option, overriding the config file and environment;\n"
+              << "                       --print-config lists them all with their values. Among them:\n"
+              << "    --num-threads N      search threads (also settable in GTP via tenuki-set)\n"
+              << "    --max-playouts N     exactly N playouts per move, turning playout cap\n"
+              << "                         randomization off as TENUKI_MAX_PLAYOUTS does; every\n"
+              << "                         other SearchConfig field likewise\n"
+              << "    --weights FILE       evaluate with this network (TENUKI_WEIGHTS), with\n"
+              << "                         --nn-threads, --nn-conv im2col|winograd,\n"
+              << "                         --nn-precision fp32|int8 and --nn-calibration FILE,\n"
+              << "                         --nn-symmetry none|random|average, --eval-cache N positions\n"
+              << "    --eval-server NAME   evaluate through a tenuki_eval_server shared memory segment\n"
+              << "                         (TENUKI_EVAL_SERVER; symmetry and cache apply)\n"
+              << "    --rollouts N         without a network, value leaves by N light random playouts\n"
+              << "                         (TENUKI_ROLLOUTS; --rollout-amaf true also derives priors)\n"
+              << "    --prune-pass-alive true  skip moves inside pass-alive areas\n"
+              << "    --patterns FILE      without a network, take move priors from a 3x3 pattern table\n"
+              << "  --autotune           Time searches at 1, 2, 4, ... threads and keep the fastest\n"
+              << "  --print-config       Print every option as a config file and exit\n"
+              << "  --worker ENDPOINT    Serve root searches for a coordinator (unix:/path or tcp:host:port)\n"
+              << "  --workers LIST       Run GTP and merge root statistics from these workers\n"
+              << "                       (also read from TENUKI_WORKERS)\n"
+              << "  --serve ENDPOINT     Serve a GTP session to every client of this endpoint, all\n"
+              << "                       searching on one pool of --pool-threads workers (default:\n"
+              << "                       hardware threads), --session-threads at most per search\n"
+              << "                       (default 1), --eval-batch N batching evaluations across sessions\n"
+              << "Environment variables such as TENUKI_MAX_PLAYOUTS still apply, between the config\n"
+              << "file and the command line.\n";
 }
 
 } // namespace
 
-int main() {
+int main(int argc, char** argv) {
+    std::string worker_endpoint;
+    std::string worker_list;
+    std::string serve_endpoint;
+    std::string config_path;
+    bool autotune = false;
+    bool print_config = false;
+    std::vector<std::pair<std::string, std::string>> flag_options;
+    if (const char* env_workers = std::getenv("TENUKI_WORKERS")) {
+        worker_list = env_workers;
+    }
+    if (const char* env_config = std::getenv("TENUKI_CONFIG")) {
+        config_path = env_config;
+    }
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--worker" && i + 1 < argc) {
+            worker_endpoint = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            worker_list = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serve_endpoint = argv[++i];
+        } else if (arg == "--config" && i + 1 < argc) {
+            config_path = argv[++i];
+        } else if (arg == "--autotune") {
+            autotune = true;
+        } else if (arg == "--print-config") {
+            print_config = true;
+        } else if (arg.rfind("--", 0) == 0 && search::is_option(arg.substr(2, arg.find('=') - 2))) {
+            const std::size_t equals = arg.find('=');
+            if (equals != std::string::npos) {
+                flag_options.emplace_back(arg.substr(2, equals - 2), arg.substr(equals + 1));
+            } else if (i + 1 < argc) {
+                flag_options.emplace_back(arg.substr(2), argv[++i]);
+            } else {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+        } else {
+            print_usage();
+            return arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    // Later sources win: defaults, config file, environment, command line.
+    search::EngineOptions options;
+    options.search.max_playouts = 160;
+    options.search.random_playouts_min = 128;
+    options.search.random_playouts_max = 256;
+    options.search.dirichlet_epsilon = 0.1f;
+    try {
+        if (!config_path.empty()) {
+            search::load_options_file(options, config_path);
+        }
+        apply_env_options(options);
+        search::set_options(options, flag_options);
+        if (options.board_size < 1 || options.board_size > 25) {
+            throw std::invalid_argument("board_size must be between 1 and 25");
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    if (print_config) {
+        std::cout << search::format_options(options);
+        return EXIT_SUCCESS;
+    }
+    search::SearchConfig& search_config = options.search;
+
     go::Rules rules;
-    rules.board_size = 19;
+    rules.board_size = options.board_size;
+    rules.komi = options.komi;
     go::Board board(rules);
 
-    search::SearchConfig search_config;
-    search_config.max_playouts = 160;
-    search_config.random_playouts_min = 128;
-    search_config.random_playouts_max = 256;
-    search_config.dirichlet_epsilon = 0.1f;
+    auto evaluator = search::make_uniform_evaluator();
+    if (options.rollouts > 0) {
+        search::RolloutConfig rollout_config;
+        rollout_config.playouts = options.rollouts;
+        rollout_config.seed = search_config.seed;
+        rollout_config.amaf_policy = options.rollout_amaf;
+        rollout_config.settle_pass_alive = search_config.prune_pass_alive;
+        evaluator = std::make_shared<search::RolloutEvaluator>(rollout_config);
+    }
+    if (!options.patterns.empty()) {
+        try {
+            evaluator = std::make_shared<search::PatternEvaluator>(search::load_pattern_weights_file(options.patterns),
+                                                                   evaluator);
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return EXIT_FAILURE;
+        }
+        board.set_pattern_tracking(true);
+    }
+    if (!options.weights.empty() || !options.eval_server.empty()) {
+        nn::NeuralEvaluatorOptions nn_options;
+        nn_options.threads = options.nn_threads;
+        try {
+            nn_options.conv = nn::parse_conv_algorithm(options.nn_conv);
+            nn_options.precision = nn::parse_precision(options.nn_precision);
+            nn_options.calibration_path = options.nn_calibration;
+            if (!options.eval_server.empty()) {
+                evaluator = std::make_shared<nn::SharedMemoryEvaluator>(options.eval_server);
+            } else {
+                evaluator = nn::make_neural_evaluator(options.weights, nn_options);
+            }
+            if (options.nn_symmetry != "none") {
+                evaluator = std::make_shared<search::SymmetricEvaluator>(
+                    evaluator, search::parse_symmetry_mode(options.nn_symmetry), search_config.seed);
+            }
+            if (options.eval_cache > 0) {
+                evaluator = std::make_shared<search::CachingEvaluator>(evaluator,
+                                                                       static_cast<std::size_t>(options.eval_cache));
+            }
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return EXIT_FAILURE;
+        }
+    }
 
-    apply_env_overrides(search_config);
+    if (autotune) {
+        const search::AutotuneResult tuned = search::autotune_threads(search_config, evaluator, board);
+        for (const search::ThreadTiming& timing : tuned.timings) {
+            std::cerr << "autotune: threads " << timing.threads << ", " << std::fixed << std::setprecision(0)
+                      << timing.playouts_per_second << " playouts/s\n";
+        }
+        std::cerr << "autotune: using " << tuned.threads << " threads\n";
+        search_config.num_threads = tuned.threads;
+    }
 
-    auto evaluator = search::make_uniform_evaluator();
+    if (search_config.numa_local_trees) {
+        const search::CpuTopology topology = search::detect_topology();
+        if (topology.is_numa()) {
+            std::cerr << "numa_local_trees: one root-parallel tree per NUMA node (" << topology.numa_nodes.size()
+                      << " nodes), overriding parallel_mode and root_parallel_groups\n";
+        }
+    }
+
+    if (!worker_endpoint.empty()) {
+        try {
+            search::SearchWorker worker(worker_endpoint, search_config, evaluator);
+            worker.serve();
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return EXIT_FAILURE;
+        }
+        return 0;
+    }
+
+    if (!serve_endpoint.empty()) {
+        search::SchedulerOptions pool_options;
+        pool_options.threads = options.pool_threads;
+        if (options.eval_batch > 1) {
+            evaluator = std::make_shared<search::BatchingEvaluator>(evaluator, options.eval_batch);
+        }
+        gtp::SessionServerOptions session_options;
+        session_options.rules = board.rules();
+        session_options.track_patterns = board.tracks_patterns();
+        session_options.search = search_config;
+        session_options.search.num_threads = std::max(0, options.session_threads);
+        try {
+            gtp::SessionServer session_server(serve_endpoint, session_options,
+                                              std::make_shared<search::SearchScheduler>(pool_options), evaluator);
+            session_server.serve();
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return EXIT_FAILURE;
+        }
+        return 0;
+    }
 
     gtp::Server server(std::move(board), std::cin, std::cout, search_config, evaluator);
+
+    std::shared_ptr<search::DistributedCoordinator> coordinator;
+    const auto endpoints = search::parse_endpoint_list(worker_list);
+    if (!endpoints.empty()) {
+        try {
+            coordinator = std::make_shared<search::DistributedCoordinator>(endpoints);
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return EXIT_FAILURE;
+        }
+        server.set_root_contributor(coordinator);
+    }
+
     server.run();
     return 0;
 }
@@ -0,0 +1,486 @@
+#include "nn/EvalServer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace nn {
+
+struct SharedSegment {
+    std::atomic<std::uint32_t> magic; // written last, once everything else is initialised
+    std::uint32_t version;
+    std::uint32_t slot_count;
+    std::uint32_t max_board_size;
+    std::uint32_t input_planes;
+    std::uint32_t shutdown;
+    std::uint64_t total_bytes;
+    std::uint64_t ring_offset;
+    std::uint64_t slots_offset;
+    std::uint64_t slot_stride;
+    std::uint64_t input_offset;  // within a slot
+    std::uint64_t policy_offset; // within a slot
+    pid_t server_pid;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_ready; // the server waits here for queued slots
+    pthread_cond_t slot_free;  // clients wait here when every slot is taken
+    std::uint32_t ring_head;
+    std::uint32_t ring_count;
+};
+
+namespace {
+
+constexpr std::uint32_t kMagic = 0x454b4e54u; // "TNKE" little-endian
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kAlignment = 64;
+constexpr std::size_t kMaxBoardSize = 25;
+constexpr auto kPollInterval = std::chrono::milliseconds(100);
+
+enum SlotState : std::uint32_t {
+    Free = 0,
+    Claimed = 1, // a client is encoding into it
+    Queued = 2,
+    Running = 3,
+    Done = 4
+};
+
+struct SlotHeader {
+    pthread_cond_t done;
+    std::uint32_t state;
+    std::uint32_t failed;
+    std::uint32_t board_size;
+    float value;
+    pid_t owner; // 0 once the owner gave up on the slot
+};
+
+std::size_t round_up(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+unsigned char* base_of(SharedSegment* segment) {
+    return reinterpret_cast<unsigned char*>(segment);
+}
+
+std::uint32_t* ring_of(SharedSegment* segment) {
+    return reinterpret_cast<std::uint32_t*>(base_of(segment) + segment->ring_offset);
+}
+
+SlotHeader* slot_of(SharedSegment* segment, std::uint32_t index) {
+    return reinterpret_cast<SlotHeader*>(base_of(segment) + segment->slots_offset + index * segment->slot_stride);
+}
+
+float* slot_input(SharedSegment* segment, std::uint32_t index) {
+    return reinterpret_cast<float*>(reinterpret_cast<unsigned char*>(slot_of(segment, index)) + segment->input_offset);
+}
+
+float* slot_policy(SharedSegment* segment, std::uint32_t index) {
+    return reinterpret_cast<float*>(reinterpret_cast<unsigned char*>(slot_of(segment, index)) + segment->policy_offset);
+}
+
+void lock_segment(SharedSegment* segment) {
+    // The mutex is robust: if a client died holding it, the state it guards is still
+    // consistent because every critical section only flips slot states and ring entries.
+    if (pthread_mutex_lock(&segment->mutex) == EOWNERDEAD) {
+        pthread_mutex_consistent(&segment->mutex);
+    }
+}
+
+class SegmentLock {
+public:
+    explicit SegmentLock(SharedSegment* segment) : segment_(segment) { lock_segment(segment_); }
+    ~SegmentLock() { pthread_mutex_unlock(&segment_->mutex); }
+
+    SegmentLock(const SegmentLock&) = delete;
+    SegmentLock& operator=(const SegmentLock&) = delete;
+
+private:
+    SharedSegment* segment_;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// Waits on a CLOCK_MONOTONIC condition variable; false once the deadline has passed.
+bool wait_until(pthread_cond_t* cond, SharedSegment* segment, Clock::time_point deadline) {
+    const auto remaining = deadline - Clock::now();
+    if (remaining <= Clock::duration::zero()) {
+        return false;
+    }
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() + now.tv_nsec;
+    timespec until{};
+    until.tv_sec = now.tv_sec + static_cast<time_t>(nanos / 1000000000);
+    until.tv_nsec = static_cast<long>(nanos % 1000000000);
+    const int rc = pthread_cond_timedwait(cond, &segment->mutex, &until);
+    if (rc == EOWNERDEAD) {
+        pthread_mutex_consistent(&segment->mutex);
+    }
+    return rc != ETIMEDOUT;
+}
+
+bool process_alive(pid_t pid) {
+    return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+}
+
+void init_cond(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+void init_mutex(pthread_mutex_t* mutex) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+SharedSegment* map_segment(int fd, std::size_t bytes) {
+    void* memory = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    return static_cast<SharedSegment*>(memory);
+}
+
+// Throws if the server went away; called whenever a client wakes up.
+void check_server(SharedSegment* segment, const std::string& name) {
+    if (segment->shutdown != 0) {
+        throw std::runtime_error("evaluation server " + name + " shut down");
+    }
+    if (!process_alive(segment->server_pid)) {
+        throw std::runtime_error("evaluation server " + name + " is not running");
+    }
+}
+
+} // namespace
+
+EvalServer::EvalServer(std::string name, std::shared_ptr<NeuralEvaluator> evaluator, EvalServerOptions options)
+    : name_(std::move(name)), evaluator_(std::move(evaluator)), options_(options) {
+    if (!evaluator_) {
+        throw std::invalid_argument("evaluation server needs an evaluator");
+    }
+    if (name_.size() < 2 || name_.front() != '/' || name_.find('/', 1) != std::string::npos) {
+        throw std::invalid_argument("shared memory name must look like /name: " + name_);
+    }
+    if (options_.slots <= 0 || options_.max_batch <= 0 || options_.max_board_size <= 0 ||
+        static_cast<std::size_t>(options_.max_board_size) > kMaxBoardSize) {
+        throw std::invalid_argument("invalid evaluation server options");
+    }
+
+    const std::size_t slots = static_cast<std::size_t>(options_.slots);
+    const std::size_t area = static_cast<std::size_t>(options_.max_board_size) *
+                             static_cast<std::size_t>(options_.max_board_size);
+    const std::size_t planes = static_cast<std::size_t>(feature_planes(evaluator_->feature_set()));
+    const std::size_t ring_offset = round_up(sizeof(SharedSegment), kAlignment);
+    const std::size_t slots_offset = round_up(ring_offset + slots * sizeof(std::uint32_t), kAlignment);
+    const std::size_t input_offset = round_up(sizeof(SlotHeader), kAlignment);
+    const std::size_t policy_offset = round_up(input_offset + planes * area * sizeof(float), kAlignment);
+    const std::size_t slot_stride = round_up(policy_offset + (area + 1) * sizeof(float), kAlignment);
+    mapped_bytes_ = slots_offset + slots * slot_stride;
+
+    ::shm_unlink(name_.c_str());
+    const int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("cannot create shared memory " + name_ + ": " + std::strerror(errno));
+    }
+    if (::ftruncate(fd, static_cast<off_t>(mapped_bytes_)) != 0) {
+        const int error = errno;
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("cannot size shared memory " + name_ + ": " + std::strerror(error));
+    }
+    segment_ = map_segment(fd, mapped_bytes_);
+    if (!segment_) {
+        ::shm_unlink(name_.c_str());
+        throw std::runtime_error("cannot map shared memory " + name_);
+    }
+
+    // ftruncate zero-fills, so every slot starts Free with an empty ring.
+    segment_->version = kVersion;
+    segment_->slot_count = static_cast<std::uint32_t>(slots);
+    segment_->max_board_size = static_cast<std::uint32_t>(options_.max_board_size);
+    segment_->input_planes = static_cast<std::uint32_t>(planes);
+    segment_->total_bytes = mapped_bytes_;
+    segment_->ring_offset = ring_offset;
+    segment_->slots_offset = slots_offset;
+    segment_->slot_stride = slot_stride;
+    segment_->input_offset = input_offset;
+    segment_->policy_offset = policy_offset;
+    segment_->server_pid = ::getpid();
+    init_mutex(&segment_->mutex);
+    init_cond(&segment_->work_ready);
+    init_cond(&segment_->slot_free);
+    for (std::uint32_t slot = 0; slot < segment_->slot_count; ++slot) {
+        init_cond(&slot_of(segment_, slot)->done);
+    }
+    segment_->magic.store(kMagic, std::memory_order_release);
+}
+
+EvalServer::~EvalServer() {
+    {
+        SegmentLock lock(segment_);
+        segment_->shutdown = 1;
+        pthread_cond_broadcast(&segment_->slot_free);
+        for (std::uint32_t slot = 0; slot < segment_->slot_count; ++slot) {
+            pthread_cond_broadcast(&slot_of(segment_, slot)->done);
+        }
+    }
+    ::munmap(segment_, mapped_bytes_);
+    ::shm_unlink(name_.c_str());
+}
+
+EvalServer::Stats EvalServer::stats() const noexcept {
+    Stats stats;
+    stats.batches = batches_.load(std::memory_order_relaxed);
+    stats.positions = positions_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void EvalServer::serve() {
+    const std::size_t max_batch = static_cast<std::size_t>(options_.max_batch);
+    std::vector<std::uint32_t> batch;
+    batch.reserve(max_batch);
+    while (!stop_requested_.load(std::memory_order_relaxed)) {
+        batch.clear();
+        {
+            SegmentLock lock(segment_);
+            while (segment_->ring_count == 0 && !stop_requested_.load(std::memory_order_relaxed)) {
+                wait_until(&segment_->work_ready, segment_, Clock::now() + kPollInterval);
+            }
+            if (segment_->ring_count == 0) {
+                break;
+            }
+            // Give the other engines max_wait to top up a partial batch.
+            const auto deadline = Clock::now() + options_.max_wait;
+            while (segment_->ring_count < max_batch && wait_until(&segment_->work_ready, segment_, deadline)) {
+            }
+            std::uint32_t* ring = ring_of(segment_);
+            while (segment_->ring_count > 0 && batch.size() < max_batch) {
+                const std::uint32_t slot = ring[segment_->ring_head];
+                segment_->ring_head = (segment_->ring_head + 1) % segment_->slot_count;
+                --segment_->ring_count;
+                slot_of(segment_, slot)->state = Running;
+                batch.push_back(slot);
+            }
+        }
+
+        bool failed = false;
+        try {
+            run_batch(batch);
+        } catch (...) {
+            failed = true;
+        }
+        {
+            SegmentLock lock(segment_);
+            for (const std::uint32_t slot : batch) {
+                SlotHeader* header = slot_of(segment_, slot);
+                header->state = Done;
+                header->failed = failed ? 1u : 0u;
+                pthread_cond_signal(&header->done);
+            }
+        }
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        positions_.fetch_add(batch.size(), std::memory_order_relaxed);
+    }
+}
+
+void EvalServer::run_batch(const std::vector<std::uint32_t>& slots) {
+    // A forward pass needs one board size, so mixed batches run one pass per size.
+    std::vector<std::uint32_t> order(slots);
+    std::stable_sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+        return slot_of(segment_, a)->board_size < slot_of(segment_, b)->board_size;
+    });
+    const std::size_t planes = segment_->input_planes;
+    for (std::size_t begin = 0; begin < order.size();) {
+        const std::size_t board_size = slot_of(segment_, order[begin])->board_size;
+        std::size_t end = begin;
+        while (end < order.size() && slot_of(segment_, order[end])->board_size == board_size) {
+            ++end;
+        }
+        const std::size_t count = end - begin;
+        const std::size_t area = board_size * board_size;
+        const std::size_t stride = planes * area;
+        inputs_.resize(count * stride);
+        policies_.resize(count * (area + 1));
+        values_.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const float* input = slot_input(segment_, order[begin + i]);
+            std::copy(input, input + stride, inputs_.begin() + static_cast<std::ptrdiff_t>(i * stride));
+        }
+        evaluator_->evaluate_encoded(inputs_.data(), count, board_size, policies_.data(), values_.data());
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::uint32_t slot = order[begin + i];
+            const auto policy = policies_.begin() + static_cast<std::ptrdiff_t>(i * (area + 1));
+            std::copy(policy, policy + static_cast<std::ptrdiff_t>(area + 1), slot_policy(segment_, slot));
+            slot_of(segment_, slot)->value = values_[i];
+        }
+        begin = end;
+    }
+}
+
+SharedMemoryEvaluator::SharedMemoryEvaluator(std::string name, std::chrono::milliseconds timeout)
+    : name_(std::move(name)), timeout_(timeout) {
+    const int fd = ::shm_open(name_.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open evaluation server " + name_ + ": " + std::strerror(errno));
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(SharedSegment)) {
+        ::close(fd);
+        throw std::runtime_error("evaluation server " + name_ + " is not ready");
+    }
+    mapped_bytes_ = static_cast<std::size_t>(info.st_size);
+    segment_ = map_segment(fd, mapped_bytes_);
+    if (!segment_) {
+        throw std::runtime_error("cannot map evaluation server " + name_);
+    }
+    try {
+        if (segment_->magic.load(std::memory_order_acquire) != kMagic || segment_->version != kVersion ||
+            segment_->total_bytes != mapped_bytes_) {
+            throw std::runtime_error("evaluation server " + name_ + " is not ready or has an incompatible version");
+        }
+        feature_set_ = feature_set_for_planes(static_cast<int>(segment_->input_planes));
+        check_server(segment_, name_);
+    } catch (...) {
+        ::munmap(segment_, mapped_bytes_);
+        throw;
+    }
+}
+
+SharedMemoryEvaluator::~SharedMemoryEvaluator() {
+    ::munmap(segment_, mapped_bytes_);
+}
+
+std::size_t SharedMemoryEvaluator::max_board_size() const noexcept {
+    return segment_->max_board_size;
+}
+
+search::EvaluationResult SharedMemoryEvaluator::evaluate(const go::Board& board, go::Player to_play) {
+    return std::move(evaluate_batch({search::EvaluationRequest{&board, to_play}}).front());
+}
+
+std::vector<search::EvaluationResult> SharedMemoryEvaluator::evaluate_batch(
+    const std::vector<search::EvaluationRequest>& requests) {
+    for (const search::EvaluationRequest& request : requests) {
+        if (request.board->board_size() > segment_->max_board_size) {
+            throw std::invalid_argument("board is larger than the evaluation server's slots");
+        }
+    }
+
+    const pid_t self = ::getpid();
+    std::vector<search::EvaluationResult> results(requests.size());
+    std::vector<std::uint32_t> claimed;
+    for (std::size_t next = 0; next < requests.size(); next += claimed.size()) {
+        const std::size_t wanted = requests.size() - next;
+        const auto deadline = Clock::now() + timeout_;
+        claimed.clear();
+        try {
+            {
+                SegmentLock lock(segment_);
+                while (true) {
+                    check_server(segment_, name_);
+                    for (std::uint32_t slot = 0; slot < segment_->slot_count && claimed.size() < wanted; ++slot) {
+                        if (slot_of(segment_, slot)->state == Free) {
+                            claimed.push_back(slot);
+                        }
+                    }
+                    if (claimed.empty()) {
+                        // Only look for slots stranded by dead clients when nothing is free.
+                        for (std::uint32_t slot = 0; slot < segment_->slot_count && claimed.size() < wanted; ++slot) {
+                            const SlotHeader* header = slot_of(segment_, slot);
+                            if ((header->state == Claimed || header->state == Done) && !process_alive(header->owner)) {
+                                claimed.push_back(slot);
+                            }
+                        }
+                    }
+                    if (!claimed.empty()) {
+                        break;
+                    }
+                    if (Clock::now() >= deadline) {
+                        throw std::runtime_error("timed out waiting for a slot on evaluation server " + name_);
+                    }
+                    wait_until(&segment_->slot_free, segment_, std::min(deadline, Clock::now() + kPollInterval));
+                }
+                for (const std::uint32_t slot : claimed) {
+                    SlotHeader* header = slot_of(segment_, slot);
+                    header->state = Claimed;
+                    header->owner = self;
+                }
+            }
+
+            // The claimed slots are ours alone until queued, so encode without the lock.
+            for (std::size_t i = 0; i < claimed.size(); ++i) {
+                const search::EvaluationRequest& request = requests[next + i];
+                encode_features(*request.board, request.to_play, feature_set_, TensorLayout::NCHW,
+                                slot_input(segment_, claimed[i]));
+                slot_of(segment_, claimed[i])->board_size = static_cast<std::uint32_t>(request.board->board_size());
+            }
+
+            SegmentLock lock(segment_);
+            std::uint32_t* ring = ring_of(segment_);
+            for (const std::uint32_t slot : claimed) {
+                slot_of(segment_, slot)->state = Queued;
+                ring[(segment_->ring_head + segment_->ring_count) % segment_->slot_count] = slot;
+                ++segment_->ring_count;
+            }
+            pthread_cond_signal(&segment_->work_ready);
+
+            for (std::size_t i = 0; i < claimed.size(); ++i) {
+                SlotHeader* header = slot_of(segment_, claimed[i]);
+                while (header->state != Done) {
+                    check_server(segment_, name_);
+                    if (Clock::now() >= deadline) {
+                        throw std::runtime_error("timed out waiting for evaluation server " + name_);
+                    }
+                    wait_until(&header->done, segment_, std::min(deadline, Clock::now() + kPollInterval));
+                }
+                if (header->failed != 0) {
+                    throw std::runtime_error("evaluation server " + name_ + " failed to evaluate a batch");
+                }
+                const std::size_t moves = header->board_size * header->board_size + 1;
+                const float* policy = slot_policy(segment_, claimed[i]);
+                results[next + i].policy.assign(policy, policy + moves);
+                results[next + i].value = header->value;
+            }
+            for (const std::uint32_t slot : claimed) {
+                SlotHeader* header = slot_of(segment_, slot);
+                header->state = Free;
+                header->owner = 0;
+            }
+            pthread_cond_broadcast(&segment_->slot_free);
+        } catch (...) {
+            // Hand back what the server is not working on; queued slots are abandoned
+            // and reclaimed once done.
+            SegmentLock lock(segment_);
+            for (const std::uint32_t slot : claimed) {
+                SlotHeader* header = slot_of(segment_, slot);
+                header->owner = 0;
+                if (header->state == Claimed || header->state == Done) {
+                    header->state = Free;
+                }
+            }
+            pthread_cond_broadcast(&segment_->slot_free);
+            throw;
+        }
+    }
+    return results;
+}
+
+} // namespace nn
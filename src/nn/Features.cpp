@@ -0,0 +1,230 @@
+#include "nn/Features.hpp"
+
+#include "go/Ladder.hpp"
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+namespace nn {
+
+namespace {
+
+// Index of plane p at point v for a position with `planes` planes over `area` points.
+template <TensorLayout Layout>
+struct PlaneIndex {
+    std::size_t area;
+    std::size_t planes;
+
+    std::size_t operator()(std::size_t plane, std::size_t vertex) const noexcept {
+        if constexpr (Layout == TensorLayout::NCHW) {
+            return plane * area + vertex;
+        } else {
+            return vertex * planes + plane;
+        }
+    }
+};
+
+template <TensorLayout Layout>
+void fill_plane(float* out, PlaneIndex<Layout> at, std::size_t plane, float value) {
+    if constexpr (Layout == TensorLayout::NCHW) {
+        std::fill(out + plane * at.area, out + (plane + 1) * at.area, value);
+    } else {
+        for (std::size_t vertex = 0; vertex < at.area; ++vertex) {
+            out[at(plane, vertex)] = value;
+        }
+    }
+}
+
+template <TensorLayout Layout>
+void encode_basic(const go::Board& board, go::Player to_play, float* out) {
+    const std::size_t area = board.board_size() * board.board_size();
+    const PlaneIndex<Layout> at{area, static_cast<std::size_t>(kBasicInputPlanes)};
+    std::fill(out, out + area * kBasicInputPlanes, 0.0f);
+    const go::PointState own = go::to_point(to_play);
+    const std::vector<go::PointState>& points = board.points();
+    for (std::size_t vertex = 0; vertex < area; ++vertex) {
+        const go::PointState state = points[vertex];
+        const std::size_t plane = state == go::PointState::Empty ? 2 : (state == own ? 0 : 1);
+        out[at(plane, vertex)] = 1.0f;
+    }
+    if (const auto ko = board.ko_vertex()) {
+        out[at(3, static_cast<std::size_t>(*ko))] = 1.0f;
+    }
+    fill_plane(out, at, 4, 1.0f);
+}
+
+template <TensorLayout Layout>
+void encode_extended(const go::Board& board, go::Player to_play, int planes, float* out) {
+    const std::size_t area = board.board_size() * board.board_size();
+    const PlaneIndex<Layout> at{area, static_cast<std::size_t>(planes)};
+    std::fill(out, out + area * static_cast<std::size_t>(planes), 0.0f);
+    const go::PointState own = go::to_point(to_play);
+    const std::vector<go::PointState>& points = board.points();
+    for (std::size_t vertex = 0; vertex < area; ++vertex) {
+        const go::PointState state = points[vertex];
+        if (state == go::PointState::Empty) {
+            out[at(2, vertex)] = 1.0f;
+            if (board.is_legal(to_play, go::Move(static_cast<int>(vertex)))) {
+                out[at(7, vertex)] = 1.0f;
+            }
+            continue;
+        }
+        out[at(state == own ? 0 : 1, vertex)] = 1.0f;
+        const int liberties = board.liberties(vertex);
+        if (liberties > 0) {
+            out[at(static_cast<std::size_t>(2 + std::min(liberties, 3)), vertex)] = 1.0f;
+        }
+    }
+    if (const auto ko = board.ko_vertex()) {
+        out[at(6, static_cast<std::size_t>(*ko))] = 1.0f;
+    }
+    for (std::size_t age = 0; age < static_cast<std::size_t>(kHistoryPlanes); ++age) {
+        const auto move = board.recent_move(age);
+        if (move && !move->is_pass()) {
+            out[at(8 + age, static_cast<std::size_t>(move->vertex))] = 1.0f;
+        }
+    }
+    if (to_play == go::Player::Black) {
+        fill_plane(out, at, 13, 1.0f);
+    }
+    const double komi = to_play == go::Player::White ? board.rules().komi : -board.rules().komi;
+    fill_plane(out, at, 14, static_cast<float>(std::clamp((komi / 15.0 + 1.0) / 2.0, 0.0, 1.0)));
+    fill_plane(out, at, 15, 1.0f);
+}
+
+// Only chains with at most two liberties can be in a ladder, so most points skip the
+// reader entirely.
+template <TensorLayout Layout>
+void encode_ladders(const go::Board& board, go::Player to_play, float* out) {
+    const std::size_t size = board.board_size();
+    const std::size_t area = size * size;
+    const PlaneIndex<Layout> at{area, static_cast<std::size_t>(kLadderInputPlanes)};
+    thread_local go::LadderReader reader;
+    bool reset = false;
+    const auto ready = [&]() -> go::LadderReader& {
+        if (!reset) {
+            reader.reset(board);
+            reset = true;
+        }
+        return reader;
+    };
+    const go::PointState opponent = go::to_point(go::other(to_play));
+    const auto threatened = [&](std::size_t n) {
+        return board.point_state(n) == opponent && board.liberties(n) == 2;
+    };
+    for (std::size_t vertex = 0; vertex < area; ++vertex) {
+        const go::PointState state = board.point_state(vertex);
+        if (state != go::PointState::Empty) {
+            const int liberties = board.liberties(vertex);
+            if (liberties > 0 && liberties <= 2 && ready().captured(vertex, to_play)) {
+                out[at(16, vertex)] = 1.0f;
+            }
+            continue;
+        }
+        const std::size_t x = vertex % size;
+        const std::size_t y = vertex / size;
+        const bool ataris = (x > 0 && threatened(vertex - 1)) || (x + 1 < size && threatened(vertex + 1)) ||
+                            (y > 0 && threatened(vertex - size)) || (y + 1 < size && threatened(vertex + size));
+        if (ataris && ready().is_capture_move(to_play, vertex)) {
+            out[at(17, vertex)] = 1.0f;
+        }
+    }
+}
+
+} // namespace
+
+int feature_planes(FeatureSet set) {
+    switch (set) {
+    case FeatureSet::Basic:
+        return kBasicInputPlanes;
+    case FeatureSet::Ladder:
+        return kLadderInputPlanes;
+    default:
+        return kExtendedInputPlanes;
+    }
+}
+
+const char* feature_set_name(FeatureSet set) {
+    switch (set) {
+    case FeatureSet::Basic:
+        return "basic";
+    case FeatureSet::Ladder:
+        return "ladder";
+    default:
+        return "extended";
+    }
+}
+
+FeatureSet parse_feature_set(const std::string& name) {
+    if (name == "basic") {
+        return FeatureSet::Basic;
+    }
+    if (name == "extended") {
+        return FeatureSet::Extended;
+    }
+    if (name == "ladder") {
+        return FeatureSet::Ladder;
+    }
+    throw std::invalid_argument("unknown feature set: " + name);
+}
+
+FeatureSet feature_set_for_planes(int planes) {
+    if (planes == kBasicInputPlanes) {
+        return FeatureSet::Basic;
+    }
+    if (planes == kExtendedInputPlanes) {
+        return FeatureSet::Extended;
+    }
+    if (planes == kLadderInputPlanes) {
+        return FeatureSet::Ladder;
+    }
+    throw std::invalid_argument("no feature set produces " + std::to_string(planes) + " input planes");
+}
+
+const char* tensor_layout_name(TensorLayout layout) {
+    return layout == TensorLayout::NCHW ? "nchw" : "nhwc";
+}
+
+void encode_features(const go::Board& board, go::Player to_play, FeatureSet set, TensorLayout layout, float* out) {
+    if (set == FeatureSet::Basic) {
+        layout == TensorLayout::NCHW ? encode_basic<TensorLayout::NCHW>(board, to_play, out)
+                                     : encode_basic<TensorLayout::NHWC>(board, to_play, out);
+    } else if (layout == TensorLayout::NCHW) {
+        encode_extended<TensorLayout::NCHW>(board, to_play, feature_planes(set), out);
+        if (set == FeatureSet::Ladder) {
+            encode_ladders<TensorLayout::NCHW>(board, to_play, out);
+        }
+    } else {
+        encode_extended<TensorLayout::NHWC>(board, to_play, feature_planes(set), out);
+        if (set == FeatureSet::Ladder) {
+            encode_ladders<TensorLayout::NHWC>(board, to_play, out);
+        }
+    }
+}
+
+void encode_basic_features(const go::Board& board, go::Player to_play, float* planes) {
+    encode_basic<TensorLayout::NCHW>(board, to_play, planes);
+}
+
+void FeatureBatch::AlignedDelete::operator()(float* data) const {
+    ::operator delete[](data, std::align_val_t{kAlignment});
+}
+
+FeatureBatch::FeatureBatch(FeatureSet set, TensorLayout layout, std::size_t board_size, std::size_t capacity) {
+    reserve(set, layout, board_size, capacity);
+}
+
+void FeatureBatch::reserve(FeatureSet set, TensorLayout layout, std::size_t board_size, std::size_t capacity) {
+    set_ = set;
+    layout_ = layout;
+    stride_ = static_cast<std::size_t>(feature_planes(set)) * board_size * board_size;
+    capacity_ = capacity;
+    const std::size_t needed = stride_ * capacity;
+    if (needed > allocated_) {
+        data_.reset(static_cast<float*>(::operator new[](needed * sizeof(float), std::align_val_t{kAlignment})));
+        allocated_ = needed;
+    }
+}
+
+} // namespace nn
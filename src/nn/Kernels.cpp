@@ -0,0 +1,362 @@
+#include "nn/Kernels.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TENUKI_NN_X86 1
+#include <immintrin.h>
+#else
+#define TENUKI_NN_X86 0
+#endif
+
+namespace nn {
+
+namespace {
+
+using GemmFn = void (*)(std::size_t, std::size_t, std::size_t, const float*, const float*, float*);
+
+struct GemmImpl {
+    GemmFn fn;
+    const char* name;
+};
+
+// i-k-j order keeps the innermost loop a contiguous axpy, which compilers vectorize
+// with whatever instruction set the build targets.
+void gemm_generic(std::size_t m, std::size_t n, std::size_t k, const float* a, const float* b, float* c) {
+    for (std::size_t i = 0; i < m; ++i) {
+        float* c_row = c + i * n;
+        const float* a_row = a + i * k;
+        for (std::size_t p = 0; p < k; ++p) {
+            const float scale = a_row[p];
+            if (scale == 0.0f) {
+                continue;
+            }
+            const float* b_row = b + p * n;
+            for (std::size_t j = 0; j < n; ++j) {
+                c_row[j] += scale * b_row[j];
+            }
+        }
+    }
+}
+
+// Scalar fallback for the right-hand columns a vector tile does not cover.
+void gemm_tail_columns(std::size_t rows, std::size_t n, std::size_t k, std::size_t j_begin,
+                       const float* a, const float* b, float* c) {
+    for (std::size_t r = 0; r < rows; ++r) {
+        for (std::size_t j = j_begin; j < n; ++j) {
+            float sum = c[r * n + j];
+            for (std::size_t p = 0; p < k; ++p) {
+                sum += a[r * k + p] * b[p * n + j];
+            }
+            c[r * n + j] = sum;
+        }
+    }
+}
+
+#if TENUKI_NN_X86
+
+// 4 rows x 16 columns register tile: eight independent FMA chains hide the FMA latency.
+__attribute__((target("avx2,fma"))) void gemm_avx2(std::size_t m, std::size_t n, std::size_t k,
+                                                   const float* a, const float* b, float* c) {
+    std::size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        const float* a0 = a + i * k;
+        const float* a1 = a0 + k;
+        const float* a2 = a1 + k;
+        const float* a3 = a2 + k;
+        float* c0 = c + i * n;
+        float* c1 = c0 + n;
+        float* c2 = c1 + n;
+        float* c3 = c2 + n;
+        std::size_t j = 0;
+        for (; j + 16 <= n; j += 16) {
+            __m256 acc00 = _mm256_loadu_ps(c0 + j);
+            __m256 acc01 = _mm256_loadu_ps(c0 + j + 8);
+            __m256 acc10 = _mm256_loadu_ps(c1 + j);
+            __m256 acc11 = _mm256_loadu_ps(c1 + j + 8);
+            __m256 acc20 = _mm256_loadu_ps(c2 + j);
+            __m256 acc21 = _mm256_loadu_ps(c2 + j + 8);
+            __m256 acc30 = _mm256_loadu_ps(c3 + j);
+            __m256 acc31 = _mm256_loadu_ps(c3 + j + 8);
+            for (std::size_t p = 0; p < k; ++p) {
+                const float* b_row = b + p * n + j;
+                const __m256 b0 = _mm256_loadu_ps(b_row);
+                const __m256 b1 = _mm256_loadu_ps(b_row + 8);
+                __m256 s = _mm256_set1_ps(a0[p]);
+                acc00 = _mm256_fmadd_ps(s, b0, acc00);
+                acc01 = _mm256_fmadd_ps(s, b1, acc01);
+                s = _mm256_set1_ps(a1[p]);
+                acc10 = _mm256_fmadd_ps(s, b0, acc10);
+                acc11 = _mm256_fmadd_ps(s, b1, acc11);
+                s = _mm256_set1_ps(a2[p]);
+                acc20 = _mm256_fmadd_ps(s, b0, acc20);
+                acc21 = _mm256_fmadd_ps(s, b1, acc21);
+                s = _mm256_set1_ps(a3[p]);
+                acc30 = _mm256_fmadd_ps(s, b0, acc30);
+                acc31 = _mm256_fmadd_ps(s, b1, acc31);
+            }
+            _mm256_storeu_ps(c0 + j, acc00);
+            _mm256_storeu_ps(c0 + j + 8, acc01);
+            _mm256_storeu_ps(c1 + j, acc10);
+            _mm256_storeu_ps(c1 + j + 8, acc11);
+            _mm256_storeu_ps(c2 + j, acc20);
+            _mm256_storeu_ps(c2 + j + 8, acc21);
+            _mm256_storeu_ps(c3 + j, acc30);
+            _mm256_storeu_ps(c3 + j + 8, acc31);
+        }
+        for (; j + 8 <= n; j += 8) {
+            __m256 acc0 = _mm256_loadu_ps(c0 + j);
+            __m256 acc1 = _mm256_loadu_ps(c1 + j);
+            __m256 acc2 = _mm256_loadu_ps(c2 + j);
+            __m256 acc3 = _mm256_loadu_ps(c3 + j);
+            for (std::size_t p = 0; p < k; ++p) {
+                const __m256 bv = _mm256_loadu_ps(b + p * n + j);
+                acc0 = _mm256_fmadd_ps(_mm256_set1_ps(a0[p]), bv, acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_set1_ps(a1[p]), bv, acc1);
+                acc2 = _mm256_fmadd_ps(_mm256_set1_ps(a2[p]), bv, acc2);
+                acc3 = _mm256_fmadd_ps(_mm256_set1_ps(a3[p]), bv, acc3);
+            }
+            _mm256_storeu_ps(c0 + j, acc0);
+            _mm256_storeu_ps(c1 + j, acc1);
+            _mm256_storeu_ps(c2 + j, acc2);
+            _mm256_storeu_ps(c3 + j, acc3);
+        }
+        gemm_tail_columns(4, n, k, j, a0, b, c0);
+    }
+    if (i < m) {
+        gemm_generic(m - i, n, k, a + i * k, b, c + i * n);
+    }
+}
+
+// Same tile shape with 16-wide vectors; the column tail is handled with a lane mask.
+__attribute__((target("avx512f"))) void gemm_avx512(std::size_t m, std::size_t n, std::size_t k,
+                                                    const float* a, const float* b, float* c) {
+    std::size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        const float* a0 = a + i * k;
+        const float* a1 = a0 + k;
+        const float* a2 = a1 + k;
+        const float* a3 = a2 + k;
+        float* c0 = c + i * n;
+        float* c1 = c0 + n;
+        float* c2 = c1 + n;
+        float* c3 = c2 + n;
+        std::size_t j = 0;
+        for (; j + 32 <= n; j += 32) {
+            __m512 acc00 = _mm512_loadu_ps(c0 + j);
+            __m512 acc01 = _mm512_loadu_ps(c0 + j + 16);
+            __m512 acc10 = _mm512_loadu_ps(c1 + j);
+            __m512 acc11 = _mm512_loadu_ps(c1 + j + 16);
+            __m512 acc20 = _mm512_loadu_ps(c2 + j);
+            __m512 acc21 = _mm512_loadu_ps(c2 + j + 16);
+            __m512 acc30 = _mm512_loadu_ps(c3 + j);
+            __m512 acc31 = _mm512_loadu_ps(c3 + j + 16);
+            for (std::size_t p = 0; p < k; ++p) {
+                const float* b_row = b + p * n + j;
+                const __m512 b0 = _mm512_loadu_ps(b_row);
+                const __m512 b1 = _mm512_loadu_ps(b_row + 16);
+                __m512 s = _mm512_set1_ps(a0[p]);
+                acc00 = _mm512_fmadd_ps(s, b0, acc00);
+                acc01 = _mm512_fmadd_ps(s, b1, acc01);
+                s = _mm512_set1_ps(a1[p]);
+                acc10 = _mm512_fmadd_ps(s, b0, acc10);
+                acc11 = _mm512_fmadd_ps(s, b1, acc11);
+                s = _mm512_set1_ps(a2[p]);
+                acc20 = _mm512_fmadd_ps(s, b0, acc20);
+                acc21 = _mm512_fmadd_ps(s, b1, acc21);
+                s = _mm512_set1_ps(a3[p]);
+                acc30 = _mm512_fmadd_ps(s, b0, acc30);
+                acc31 = _mm512_fmadd_ps(s, b1, acc31);
+            }
+            _mm512_storeu_ps(c0 + j, acc00);
+            _mm512_storeu_ps(c0 + j + 16, acc01);
+            _mm512_storeu_ps(c1 + j, acc10);
+            _mm512_storeu_ps(c1 + j + 16, acc11);
+            _mm512_storeu_ps(c2 + j, acc20);
+            _mm512_storeu_ps(c2 + j + 16, acc21);
+            _mm512_storeu_ps(c3 + j, acc30);
+            _mm512_storeu_ps(c3 + j + 16, acc31);
+        }
+        for (; j < n; j += 16) {
+            const std::size_t remaining = std::min<std::size_t>(16, n - j);
+            const __mmask16 mask = static_cast<__mmask16>((1u << remaining) - 1u);
+            __m512 acc0 = _mm512_maskz_loadu_ps(mask, c0 + j);
+            __m512 acc1 = _mm512_maskz_loadu_ps(mask, c1 + j);
+            __m512 acc2 = _mm512_maskz_loadu_ps(mask, c2 + j);
+            __m512 acc3 = _mm512_maskz_loadu_ps(mask, c3 + j);
+            for (std::size_t p = 0; p < k; ++p) {
+                const __m512 bv = _mm512_maskz_loadu_ps(mask, b + p * n + j);
+                acc0 = _mm512_fmadd_ps(_mm512_set1_ps(a0[p]), bv, acc0);
+                acc1 = _mm512_fmadd_ps(_mm512_set1_ps(a1[p]), bv, acc1);
+                acc2 = _mm512_fmadd_ps(_mm512_set1_ps(a2[p]), bv, acc2);
+                acc3 = _mm512_fmadd_ps(_mm512_set1_ps(a3[p]), bv, acc3);
+            }
+            _mm512_mask_storeu_ps(c0 + j, mask, acc0);
+            _mm512_mask_storeu_ps(c1 + j, mask, acc1);
+            _mm512_mask_storeu_ps(c2 + j, mask, acc2);
+            _mm512_mask_storeu_ps(c3 + j, mask, acc3);
+        }
+    }
+    if (i < m) {
+        gemm_generic(m - i, n, k, a + i * k, b, c + i * n);
+    }
+}
+
+#endif
+
+GemmImpl select_gemm() {
+    // TENUKI_NN_KERNEL=generic|avx2 caps the instruction set, e.g. to compare backends.
+    const char* requested = std::getenv("TENUKI_NN_KERNEL");
+    const bool allow_avx512 = !requested || std::strcmp(requested, "avx512") == 0;
+    const bool allow_avx2 = allow_avx512 || std::strcmp(requested, "avx2") == 0;
+#if TENUKI_NN_X86
+    __builtin_cpu_init();
+    if (allow_avx512 && __builtin_cpu_supports("avx512f")) {
+        return {gemm_avx512, "avx512"};
+    }
+    if (allow_avx2 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {gemm_avx2, "avx2"};
+    }
+#else
+    (void)allow_avx2;
+#endif
+    return {gemm_generic, "generic"};
+}
+
+const GemmImpl& active_gemm() {
+    static const GemmImpl impl = select_gemm();
+    return impl;
+}
+
+void fill_bias(float* out, const float* bias, std::size_t channels, std::size_t spatial) {
+    for (std::size_t c = 0; c < channels; ++c) {
+        std::fill(out + c * spatial, out + (c + 1) * spatial, bias ? bias[c] : 0.0f);
+    }
+}
+
+} // namespace
+
+void gemm(int m, int n, int k, const float* a, const float* b, float* c) {
+    if (m <= 0 || n <= 0 || k <= 0) {
+        return;
+    }
+    active_gemm().fn(static_cast<std::size_t>(m), static_cast<std::size_t>(n), static_cast<std::size_t>(k), a, b, c);
+}
+
+const char* gemm_backend() {
+    return active_gemm().name;
+}
+
+void im2col_3x3(const float* input, int channels, int height, int width, float* columns) {
+    const std::size_t spatial = static_cast<std::size_t>(height) * static_cast<std::size_t>(width);
+    float* out = columns;
+    for (int c = 0; c < channels; ++c) {
+        const float* plane = input + static_cast<std::size_t>(c) * spatial;
+        for (int ky = -1; ky <= 1; ++ky) {
+            for (int kx = -1; kx <= 1; ++kx) {
+                for (int y = 0; y < height; ++y) {
+                    const int sy = y + ky;
+                    if (sy < 0 || sy >= height) {
+                        std::fill(out, out + width, 0.0f);
+                        out += width;
+                        continue;
+                    }
+                    const float* row = plane + static_cast<std::size_t>(sy) * static_cast<std::size_t>(width);
+                    for (int x = 0; x < width; ++x) {
+                        const int sx = x + kx;
+                        *out++ = (sx < 0 || sx >= width) ? 0.0f : row[sx];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void conv3x3(const float* input, int in_channels, int out_channels, int height, int width,
+             const float* weights, const float* bias, float* columns, float* out) {
+    const int spatial = height * width;
+    fill_bias(out, bias, static_cast<std::size_t>(out_channels), static_cast<std::size_t>(spatial));
+    im2col_3x3(input, in_channels, height, width, columns);
+    gemm(out_channels, spatial, in_channels * 9, weights, columns, out);
+}
+
+void conv1x1(const float* input, int in_channels, int out_channels, int spatial,
+             const float* weights, const float* bias, float* out) {
+    fill_bias(out, bias, static_cast<std::size_t>(out_channels), static_cast<std::size_t>(spatial));
+    gemm(out_channels, spatial, in_channels, weights, input, out);
+}
+
+void conv_reference(const float* input, int in_channels, int out_channels, int height, int width,
+                    int kernel, const float* weights, const float* bias, float* out) {
+    const int radius = kernel / 2;
+    const std::size_t spatial = static_cast<std::size_t>(height) * static_cast<std::size_t>(width);
+    for (int o = 0; o < out_channels; ++o) {
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                double sum = bias ? bias[o] : 0.0;
+                for (int i = 0; i < in_channels; ++i) {
+                    for (int ky = 0; ky < kernel; ++ky) {
+                        const int sy = y + ky - radius;
+                        if (sy < 0 || sy >= height) {
+                            continue;
+                        }
+                        for (int kx = 0; kx < kernel; ++kx) {
+                            const int sx = x + kx - radius;
+                            if (sx < 0 || sx >= width) {
+                                continue;
+                            }
+                            const std::size_t w_index = ((static_cast<std::size_t>(o) * static_cast<std::size_t>(in_channels) + static_cast<std::size_t>(i)) * static_cast<std::size_t>(kernel) + static_cast<std::size_t>(ky)) * static_cast<std::size_t>(kernel) + static_cast<std::size_t>(kx);
+                            const std::size_t in_index = static_cast<std::size_t>(i) * spatial + static_cast<std::size_t>(sy * width + sx);
+                            sum += static_cast<double>(weights[w_index]) * static_cast<double>(input[in_index]);
+                        }
+                    }
+                }
+                out[static_cast<std::size_t>(o) * spatial + static_cast<std::size_t>(y * width + x)] = static_cast<float>(sum);
+            }
+        }
+    }
+}
+
+void relu(float* data, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        data[i] = std::max(data[i], 0.0f);
+    }
+}
+
+void add_relu(float* data, const float* residual, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        data[i] = std::max(data[i] + residual[i], 0.0f);
+    }
+}
+
+void global_pool(const float* input, int channels, int spatial, float* pooled) {
+    const std::size_t n = static_cast<std::size_t>(spatial);
+    for (int c = 0; c < channels; ++c) {
+        const float* plane = input + static_cast<std::size_t>(c) * n;
+        float sum = 0.0f;
+        float maximum = -std::numeric_limits<float>::infinity();
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += plane[i];
+            maximum = std::max(maximum, plane[i]);
+        }
+        pooled[c] = n > 0 ? sum / static_cast<float>(n) : 0.0f;
+        pooled[channels + c] = n > 0 ? maximum : 0.0f;
+    }
+}
+
+void dense(const float* input, int inputs, int outputs, const float* weights, const float* bias, float* out) {
+    const std::size_t n_in = static_cast<std::size_t>(inputs);
+    for (std::size_t o = 0; o < static_cast<std::size_t>(outputs); ++o) {
+        float sum = bias ? bias[o] : 0.0f;
+        const float* row = weights + o * n_in;
+        for (std::size_t i = 0; i < n_in; ++i) {
+            sum += row[i] * input[i];
+        }
+        out[o] = sum;
+    }
+}
+
+} // namespace nn
@@ -0,0 +1,430 @@
+#include "nn/Network.hpp"
+
+#include "nn/Kernels.hpp"
+#include "nn/Winograd.hpp"
+#include "search/Scheduler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace nn {
+
+namespace {
+
+constexpr std::array<char, 4> kMagic{'T', 'N', 'K', 'N'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kMaxChannels = 4096;
+constexpr std::uint32_t kMaxBlocks = 256;
+
+std::uint32_t read_u32(std::istream& in) {
+    std::array<unsigned char, 4> bytes{};
+    if (!in.read(reinterpret_cast<char*>(bytes.data()), 4)) {
+        throw std::runtime_error("network weights truncated");
+    }
+    return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+           (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+void write_u32(std::ostream& out, std::uint32_t value) {
+    const std::array<char, 4> bytes{static_cast<char>(value & 0xffu), static_cast<char>((value >> 8) & 0xffu),
+                                    static_cast<char>((value >> 16) & 0xffu), static_cast<char>((value >> 24) & 0xffu)};
+    out.write(bytes.data(), 4);
+}
+
+void read_floats(std::istream& in, std::vector<float>& out, std::size_t count) {
+    out.resize(count);
+    for (float& value : out) {
+        const std::uint32_t bits = read_u32(in);
+        std::memcpy(&value, &bits, sizeof(value));
+        if (!std::isfinite(value)) {
+            throw std::runtime_error("network weights contain a non-finite value");
+        }
+    }
+}
+
+void write_floats(std::ostream& out, const std::vector<float>& values) {
+    for (const float value : values) {
+        std::uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        write_u32(out, bits);
+    }
+}
+
+ConvLayer make_conv(int in_channels, int out_channels, int kernel) {
+    ConvLayer layer;
+    layer.in_channels = in_channels;
+    layer.out_channels = out_channels;
+    layer.kernel = kernel;
+    layer.weights.assign(static_cast<std::size_t>(out_channels) * static_cast<std::size_t>(in_channels) *
+                             static_cast<std::size_t>(kernel * kernel),
+                         0.0f);
+    layer.bias.assign(static_cast<std::size_t>(out_channels), 0.0f);
+    return layer;
+}
+
+DenseLayer make_dense(int inputs, int outputs) {
+    DenseLayer layer;
+    layer.inputs = inputs;
+    layer.outputs = outputs;
+    layer.weights.assign(static_cast<std::size_t>(inputs) * static_cast<std::size_t>(outputs), 0.0f);
+    layer.bias.assign(static_cast<std::size_t>(outputs), 0.0f);
+    return layer;
+}
+
+// Builds zero-filled layers with the sizes implied by the shape.
+NetworkWeights allocate(const NetworkShape& shape) {
+    NetworkWeights weights;
+    weights.shape = shape;
+    weights.input = make_conv(shape.input_planes, shape.trunk_channels, 3);
+    weights.blocks.resize(static_cast<std::size_t>(shape.blocks));
+    for (ResidualBlock& block : weights.blocks) {
+        block.first = make_conv(shape.trunk_channels, shape.trunk_channels, 3);
+        block.second = make_conv(shape.trunk_channels, shape.trunk_channels, 3);
+    }
+    weights.policy_conv = make_conv(shape.trunk_channels, shape.policy_channels, 1);
+    weights.policy_board = make_conv(shape.policy_channels, 1, 1);
+    weights.policy_pass = make_dense(2 * shape.policy_channels, 1);
+    weights.value_conv = make_conv(shape.trunk_channels, shape.value_channels, 1);
+    weights.value_hidden = make_dense(2 * shape.value_channels, shape.value_hidden);
+    weights.value_output = make_dense(shape.value_hidden, 1);
+    return weights;
+}
+
+void validate_shape(const NetworkShape& shape) {
+    const auto in_range = [](int value, std::uint32_t low, std::uint32_t high) {
+        return value >= static_cast<int>(low) && value <= static_cast<int>(high);
+    };
+    if (!in_range(shape.input_planes, 1, kMaxChannels) || !in_range(shape.trunk_channels, 1, kMaxChannels) ||
+        !in_range(shape.blocks, 0, kMaxBlocks) || !in_range(shape.policy_channels, 1, kMaxChannels) ||
+        !in_range(shape.value_channels, 1, kMaxChannels) || !in_range(shape.value_hidden, 1, kMaxChannels)) {
+        throw std::invalid_argument("network shape out of range");
+    }
+}
+
+// Visits (weights, bias) of every layer in file order; Weights may be const.
+template <typename Weights, typename Visit>
+void for_each_layer(Weights& weights, Visit&& visit) {
+    visit(weights.input.weights, weights.input.bias);
+    for (auto& block : weights.blocks) {
+        visit(block.first.weights, block.first.bias);
+        visit(block.second.weights, block.second.bias);
+    }
+    visit(weights.policy_conv.weights, weights.policy_conv.bias);
+    visit(weights.policy_board.weights, weights.policy_board.bias);
+    visit(weights.policy_pass.weights, weights.policy_pass.bias);
+    visit(weights.value_conv.weights, weights.value_conv.bias);
+    visit(weights.value_hidden.weights, weights.value_hidden.bias);
+    visit(weights.value_output.weights, weights.value_output.bias);
+}
+
+} // namespace
+
+NetworkWeights load_weights(std::istream& in) {
+    std::array<char, 4> magic{};
+    if (!in.read(magic.data(), 4) || magic != kMagic) {
+        throw std::runtime_error("not a tenuki network weights file");
+    }
+    const std::uint32_t version = read_u32(in);
+    if (version != kVersion) {
+        throw std::runtime_error("unsupported network weights version " + std::to_string(version));
+    }
+
+    std::array<std::uint32_t, 6> header{};
+    for (std::uint32_t& field : header) {
+        field = read_u32(in);
+        if (field > kMaxChannels) {
+            throw std::runtime_error("network shape out of range");
+        }
+    }
+    NetworkShape shape;
+    shape.input_planes = static_cast<int>(header[0]);
+    shape.trunk_channels = static_cast<int>(header[1]);
+    shape.blocks = static_cast<int>(header[2]);
+    shape.policy_channels = static_cast<int>(header[3]);
+    shape.value_channels = static_cast<int>(header[4]);
+    shape.value_hidden = static_cast<int>(header[5]);
+    try {
+        validate_shape(shape);
+    } catch (const std::invalid_argument& ex) {
+        throw std::runtime_error(ex.what());
+    }
+
+    NetworkWeights weights = allocate(shape);
+    for_each_layer(weights, [&](std::vector<float>& w, std::vector<float>& b) {
+        read_floats(in, w, w.size());
+        read_floats(in, b, b.size());
+    });
+    if (in.peek() != std::char_traits<char>::eof()) {
+        throw std::runtime_error("network weights have trailing data");
+    }
+    return weights;
+}
+
+NetworkWeights load_weights_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open network weights: " + path);
+    }
+    return load_weights(in);
+}
+
+void save_weights(const NetworkWeights& weights, std::ostream& out) {
+    out.write(kMagic.data(), 4);
+    write_u32(out, kVersion);
+    const NetworkShape& shape = weights.shape;
+    for (const int field : {shape.input_planes, shape.trunk_channels, shape.blocks, shape.policy_channels,
+                            shape.value_channels, shape.value_hidden}) {
+        write_u32(out, static_cast<std::uint32_t>(field));
+    }
+    for_each_layer(weights, [&](const std::vector<float>& w, const std::vector<float>& b) {
+        write_floats(out, w);
+        write_floats(out, b);
+    });
+}
+
+NetworkWeights make_random_weights(const NetworkShape& shape, std::uint32_t seed) {
+    validate_shape(shape);
+    NetworkWeights weights = allocate(shape);
+    std::mt19937 rng(seed);
+    const auto fill = [&](std::vector<float>& values, std::size_t fan_in, float gain) {
+        std::normal_distribution<float> dist(0.0f, gain * std::sqrt(2.0f / static_cast<float>(std::max<std::size_t>(fan_in, 1))));
+        for (float& value : values) {
+            value = dist(rng);
+        }
+    };
+    for_each_layer(weights, [&](std::vector<float>& w, const std::vector<float>& b) {
+        fill(w, w.size() / std::max<std::size_t>(b.size(), 1), 1.0f);
+    });
+    // Damp the residual branches so activations stay bounded in deep random nets.
+    for (ResidualBlock& block : weights.blocks) {
+        for (float& value : block.second.weights) {
+            value *= 0.25f;
+        }
+    }
+    return weights;
+}
+
+const char* conv_algorithm_name(ConvAlgorithm algorithm) {
+    return algorithm == ConvAlgorithm::Winograd ? "winograd" : "im2col";
+}
+
+ConvAlgorithm parse_conv_algorithm(const std::string& name) {
+    if (name == "winograd") {
+        return ConvAlgorithm::Winograd;
+    }
+    if (name == "im2col") {
+        return ConvAlgorithm::Im2col;
+    }
+    throw std::invalid_argument("unknown convolution algorithm: " + name);
+}
+
+struct Network::Workspace {
+    std::vector<float> trunk;
+    std::vector<float> mid;
+    std::vector<float> out;
+    std::vector<float> columns;
+    std::vector<float> winograd_in;
+    std::vector<float> winograd_out;
+    std::vector<std::uint8_t> codes;
+    std::vector<std::uint8_t> packed;
+    std::vector<std::int32_t> accum;
+    std::vector<float> head;
+    std::vector<float> pooled;
+    std::vector<float> hidden;
+    float* activation_max = nullptr; // set while calibrating
+
+    void reserve(const NetworkShape& shape, int board_size, ConvAlgorithm algorithm, Precision precision) {
+        const std::size_t spatial = static_cast<std::size_t>(board_size) * static_cast<std::size_t>(board_size);
+        const std::size_t trunk_size = static_cast<std::size_t>(shape.trunk_channels) * spatial;
+        const std::size_t widest_input = static_cast<std::size_t>(std::max(shape.input_planes, shape.trunk_channels));
+        const std::size_t head_channels = static_cast<std::size_t>(std::max(shape.policy_channels, shape.value_channels));
+        trunk.resize(trunk_size);
+        mid.resize(trunk_size);
+        out.resize(trunk_size);
+        if (algorithm == ConvAlgorithm::Winograd) {
+            const std::size_t tiles = winograd_tile_count(board_size, board_size);
+            winograd_in.resize(static_cast<std::size_t>(kWinogradPoints) * widest_input * tiles);
+            winograd_out.resize(static_cast<std::size_t>(kWinogradPoints) * static_cast<std::size_t>(shape.trunk_channels) * tiles);
+        }
+        if (algorithm == ConvAlgorithm::Im2col) {
+            columns.resize(widest_input * 9 * spatial);
+        }
+        if (precision == Precision::Int8) {
+            codes.resize(widest_input * spatial);
+            const std::size_t widest_output = std::max(static_cast<std::size_t>(shape.trunk_channels), head_channels);
+            packed.resize(static_cast<std::size_t>(quantized_depth(static_cast<int>(widest_input) * 9)) * spatial);
+            accum.resize(widest_output * spatial);
+        }
+        head.resize(head_channels * spatial);
+        pooled.resize(2 * head_channels);
+        hidden.resize(static_cast<std::size_t>(shape.value_hidden));
+    }
+};
+
+Network::Network(NetworkWeights weights, ConvAlgorithm algorithm)
+    : weights_(std::move(weights)), algorithm_(algorithm) {
+    validate_shape(weights_.shape);
+    if (algorithm_ != ConvAlgorithm::Winograd) {
+        return;
+    }
+    const auto transform = [this](const ConvLayer& conv) {
+        std::vector<float> transformed(winograd_weights_size(conv.in_channels, conv.out_channels));
+        winograd_transform_weights(conv.weights.data(), conv.in_channels, conv.out_channels, transformed.data());
+        winograd_weights_.push_back(std::move(transformed));
+    };
+    transform(weights_.input);
+    for (const ResidualBlock& block : weights_.blocks) {
+        transform(block.first);
+        transform(block.second);
+    }
+}
+
+std::size_t Network::quantizable_layer_count() const noexcept {
+    return 2 * weights_.blocks.size() + 3;
+}
+
+void Network::quantize(const CalibrationTable& table) {
+    if (table.activation_max.size() != quantizable_layer_count()) {
+        throw std::invalid_argument("calibration table has " + std::to_string(table.activation_max.size()) +
+                                    " layers, network has " + std::to_string(quantizable_layer_count()));
+    }
+    quantized_.clear();
+    std::size_t layer = 0;
+    quantized_.push_back(quantize_conv(weights_.input, table.activation_max[layer++]));
+    for (const ResidualBlock& block : weights_.blocks) {
+        quantized_.push_back(quantize_conv(block.first, table.activation_max[layer++]));
+        quantized_.push_back(quantize_conv(block.second, table.activation_max[layer++]));
+    }
+    quantized_.push_back(quantize_conv(weights_.policy_conv, table.activation_max[layer++]));
+    quantized_.push_back(quantize_conv(weights_.value_conv, table.activation_max[layer++]));
+    precision_ = Precision::Int8;
+}
+
+void Network::calibrate(const float* inputs, int batch, int board_size, CalibrationTable& table) const {
+    table.activation_max.resize(quantizable_layer_count(), 0.0f);
+    const std::size_t spatial = static_cast<std::size_t>(board_size) * static_cast<std::size_t>(board_size);
+    const std::size_t input_stride = static_cast<std::size_t>(weights_.shape.input_planes) * spatial;
+    Workspace workspace;
+    workspace.reserve(weights_.shape, board_size, algorithm_, Precision::Float32);
+    workspace.activation_max = table.activation_max.data();
+    std::vector<float> policy(spatial + 1);
+    float value = 0.0f;
+    for (std::size_t b = 0; b < static_cast<std::size_t>(std::max(batch, 0)); ++b) {
+        forward_position(inputs + b * input_stride, board_size, workspace, policy.data(), &value);
+    }
+}
+
+void Network::conv_layer(const float* input, const ConvLayer& conv, std::size_t layer, int board_size,
+                         Workspace& ws, float* out) const {
+    const int spatial = board_size * board_size;
+    if (ws.activation_max) {
+        const float* end = input + static_cast<std::size_t>(conv.in_channels) * static_cast<std::size_t>(spatial);
+        ws.activation_max[layer] = std::max(ws.activation_max[layer], *std::max_element(input, end));
+    } else if (precision_ == Precision::Int8) {
+        quantized_conv(input, quantized_[layer], board_size, board_size, ws.codes.data(), ws.packed.data(),
+                       ws.accum.data(), out);
+        return;
+    }
+    if (conv.kernel == 1) {
+        conv1x1(input, conv.in_channels, conv.out_channels, spatial, conv.weights.data(), conv.bias.data(), out);
+    } else if (algorithm_ == ConvAlgorithm::Winograd) {
+        conv3x3_winograd(input, conv.in_channels, conv.out_channels, board_size, board_size,
+                         winograd_weights_[layer].data(), conv.bias.data(), ws.winograd_in.data(),
+                         ws.winograd_out.data(), out);
+    } else {
+        conv3x3(input, conv.in_channels, conv.out_channels, board_size, board_size, conv.weights.data(),
+                conv.bias.data(), ws.columns.data(), out);
+    }
+}
+
+void Network::forward_position(const float* input, int board_size, Workspace& ws, float* policy_logits,
+                               float* value) const {
+    const NetworkShape& shape = weights_.shape;
+    const int spatial = board_size * board_size;
+    const std::size_t trunk_size = static_cast<std::size_t>(shape.trunk_channels) * static_cast<std::size_t>(spatial);
+
+    conv_layer(input, weights_.input, 0, board_size, ws, ws.trunk.data());
+    relu(ws.trunk.data(), trunk_size);
+
+    std::size_t layer = 1;
+    for (const ResidualBlock& block : weights_.blocks) {
+        conv_layer(ws.trunk.data(), block.first, layer++, board_size, ws, ws.mid.data());
+        relu(ws.mid.data(), trunk_size);
+        conv_layer(ws.mid.data(), block.second, layer++, board_size, ws, ws.out.data());
+        add_relu(ws.out.data(), ws.trunk.data(), trunk_size);
+        std::swap(ws.trunk, ws.out);
+    }
+
+    const std::size_t policy_size = static_cast<std::size_t>(shape.policy_channels) * static_cast<std::size_t>(spatial);
+    conv_layer(ws.trunk.data(), weights_.policy_conv, layer++, board_size, ws, ws.head.data());
+    relu(ws.head.data(), policy_size);
+    conv1x1(ws.head.data(), shape.policy_channels, 1, spatial, weights_.policy_board.weights.data(),
+            weights_.policy_board.bias.data(), policy_logits);
+    global_pool(ws.head.data(), shape.policy_channels, spatial, ws.pooled.data());
+    dense(ws.pooled.data(), 2 * shape.policy_channels, 1, weights_.policy_pass.weights.data(),
+          weights_.policy_pass.bias.data(), policy_logits + spatial);
+
+    const std::size_t value_size = static_cast<std::size_t>(shape.value_channels) * static_cast<std::size_t>(spatial);
+    conv_layer(ws.trunk.data(), weights_.value_conv, layer, board_size, ws, ws.head.data());
+    relu(ws.head.data(), value_size);
+    global_pool(ws.head.data(), shape.value_channels, spatial, ws.pooled.data());
+    dense(ws.pooled.data(), 2 * shape.value_channels, shape.value_hidden, weights_.value_hidden.weights.data(),
+          weights_.value_hidden.bias.data(), ws.hidden.data());
+    relu(ws.hidden.data(), ws.hidden.size());
+    float raw_value = 0.0f;
+    dense(ws.hidden.data(), shape.value_hidden, 1, weights_.value_output.weights.data(),
+          weights_.value_output.bias.data(), &raw_value);
+    *value = std::tanh(raw_value);
+}
+
+void Network::forward(const float* inputs, int batch, int board_size, float* policy_logits, float* values,
+                      search::SearchScheduler* pool) const {
+    if (batch <= 0) {
+        return;
+    }
+    if (board_size <= 0) {
+        throw std::invalid_argument("board size must be positive");
+    }
+    const std::size_t spatial = static_cast<std::size_t>(board_size) * static_cast<std::size_t>(board_size);
+    const std::size_t input_stride = static_cast<std::size_t>(weights_.shape.input_planes) * spatial;
+    const std::size_t policy_stride = spatial + 1;
+
+    const auto run = [&](int b) {
+        // Pool workers and search threads live as long as the engine, so their scratch
+        // buffers are allocated once and only resized when the board size changes.
+        thread_local Workspace workspace;
+        workspace.reserve(weights_.shape, board_size, algorithm_, precision_);
+        const std::size_t index = static_cast<std::size_t>(b);
+        forward_position(inputs + index * input_stride, board_size, workspace, policy_logits + index * policy_stride,
+                         values + index);
+    };
+
+    if (!pool || pool->threads() <= 1 || batch == 1) {
+        for (int b = 0; b < batch; ++b) {
+            run(b);
+        }
+        return;
+    }
+    std::atomic<int> next{0};
+    pool->run(
+        [&](int) {
+            const int b = next.fetch_add(1, std::memory_order_relaxed);
+            if (b >= batch) {
+                return false;
+            }
+            run(b);
+            return b + 1 < batch;
+        },
+        std::min(pool->threads(), batch));
+}
+
+} // namespace nn
@@ -0,0 +1,110 @@
+#include "nn/NeuralEvaluator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace nn {
+
+namespace {
+
+void softmax(float* logits, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    const float maximum = *std::max_element(logits, logits + count);
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+        logits[i] = std::exp(logits[i] - maximum);
+        sum += logits[i];
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        logits[i] /= sum;
+    }
+}
+
+} // namespace
+
+NeuralEvaluator::NeuralEvaluator(std::shared_ptr<const Network> network, int threads)
+    : network_(std::move(network)), feature_set_(FeatureSet::Extended) {
+    if (!network_) {
+        throw std::invalid_argument("neural evaluator needs a network");
+    }
+    feature_set_ = feature_set_for_planes(network_->shape().input_planes);
+    if (threads > 1) {
+        search::SchedulerOptions pool_options;
+        pool_options.threads = threads;
+        pool_options.slice_steps = 1; // a step is a whole position
+        pool_ = std::make_unique<search::SearchScheduler>(pool_options);
+    }
+}
+
+search::EvaluationResult NeuralEvaluator::evaluate(const go::Board& board, go::Player to_play) {
+    return std::move(evaluate_batch({search::EvaluationRequest{&board, to_play}}).front());
+}
+
+std::vector<search::EvaluationResult> NeuralEvaluator::evaluate_batch(
+    const std::vector<search::EvaluationRequest>& requests) {
+    std::vector<search::EvaluationResult> results(requests.size());
+
+    // The trunk is size-agnostic but a forward pass needs one board size, so mixed
+    // batches run as one pass per size.
+    std::map<std::size_t, std::vector<std::size_t>> by_size;
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        by_size[requests[i].board->board_size()].push_back(i);
+    }
+
+    // Encoded in place into a per-thread buffer that only grows.
+    thread_local FeatureBatch inputs;
+    std::vector<float> policies;
+    std::vector<float> values;
+    for (const auto& [board_size, indices] : by_size) {
+        const std::size_t moves = board_size * board_size + 1;
+        inputs.reserve(feature_set_, TensorLayout::NCHW, board_size, indices.size());
+        policies.resize(indices.size() * moves);
+        values.resize(indices.size());
+        for (std::size_t slot = 0; slot < indices.size(); ++slot) {
+            const search::EvaluationRequest& request = requests[indices[slot]];
+            inputs.encode(slot, *request.board, request.to_play);
+        }
+
+        evaluate_encoded(inputs.data(), indices.size(), board_size, policies.data(), values.data());
+
+        for (std::size_t slot = 0; slot < indices.size(); ++slot) {
+            search::EvaluationResult& result = results[indices[slot]];
+            const auto begin = policies.begin() + static_cast<std::ptrdiff_t>(slot * moves);
+            result.policy.assign(begin, begin + static_cast<std::ptrdiff_t>(moves));
+            result.value = values[slot];
+        }
+    }
+    return results;
+}
+
+void NeuralEvaluator::evaluate_encoded(const float* inputs, std::size_t batch, std::size_t board_size, float* policies,
+                                       float* values) {
+    network_->forward(inputs, static_cast<int>(batch), static_cast<int>(board_size), policies, values, pool_.get());
+    const std::size_t moves = board_size * board_size + 1;
+    for (std::size_t position = 0; position < batch; ++position) {
+        softmax(policies + position * moves, moves);
+    }
+}
+
+std::shared_ptr<Network> load_network(const std::string& weights_path, const NeuralEvaluatorOptions& options) {
+    auto network = std::make_shared<Network>(load_weights_file(weights_path), options.conv);
+    if (options.precision == Precision::Int8) {
+        if (options.calibration_path.empty()) {
+            throw std::runtime_error("int8 inference needs a calibration table");
+        }
+        network->quantize(load_calibration_file(options.calibration_path));
+    }
+    return network;
+}
+
+std::shared_ptr<search::Evaluator> make_neural_evaluator(const std::string& weights_path,
+                                                         const NeuralEvaluatorOptions& options) {
+    return std::make_shared<NeuralEvaluator>(load_network(weights_path, options), options.threads);
+}
+
+} // namespace nn
@@ -0,0 +1,459 @@
+#include "nn/Quantization.hpp"
+
+#include "nn/Network.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TENUKI_NN_X86 1
+#include <immintrin.h>
+#else
+#define TENUKI_NN_X86 0
+#endif
+
+namespace nn {
+
+namespace {
+
+constexpr std::array<char, 4> kMagic{'T', 'N', 'K', 'Q'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::uint32_t kMaxLayers = 1024;
+
+std::uint32_t read_u32(std::istream& in) {
+    std::array<unsigned char, 4> bytes{};
+    if (!in.read(reinterpret_cast<char*>(bytes.data()), 4)) {
+        throw std::runtime_error("calibration table truncated");
+    }
+    return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+           (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+void write_u32(std::ostream& out, std::uint32_t value) {
+    const std::array<char, 4> bytes{static_cast<char>(value & 0xffu), static_cast<char>((value >> 8) & 0xffu),
+                                    static_cast<char>((value >> 16) & 0xffu), static_cast<char>((value >> 24) & 0xffu)};
+    out.write(bytes.data(), 4);
+}
+
+using Int8GemmFn = void (*)(std::size_t, std::size_t, std::size_t, const std::int8_t*, const std::uint8_t*, std::int32_t*);
+
+struct Int8GemmImpl {
+    Int8GemmFn fn;
+    const char* name;
+};
+
+// Dot product of row `a` with packed column j, over k (a multiple of 4) depth.
+std::int32_t dot_column(std::size_t n, std::size_t k, const std::int8_t* a, const std::uint8_t* b, std::size_t j) {
+    std::int32_t sum = 0;
+    for (std::size_t group = 0; group < k / 4; ++group) {
+        const std::uint8_t* column = b + group * n * 4 + j * 4;
+        const std::int8_t* row = a + group * 4;
+        for (std::size_t t = 0; t < 4; ++t) {
+            sum += static_cast<std::int32_t>(row[t]) * static_cast<std::int32_t>(column[t]);
+        }
+    }
+    return sum;
+}
+
+void gemm_u8s8_generic(std::size_t m, std::size_t n, std::size_t k, const std::int8_t* a, const std::uint8_t* b,
+                       std::int32_t* c) {
+    for (std::size_t i = 0; i < m; ++i) {
+        for (std::size_t j = 0; j < n; ++j) {
+            c[i * n + j] = dot_column(n, k, a + i * k, b, j);
+        }
+    }
+}
+
+#if TENUKI_NN_X86
+
+std::int32_t load_group(const std::int8_t* row) {
+    std::int32_t value = 0;
+    std::memcpy(&value, row, sizeof(value));
+    return value;
+}
+
+// maddubs multiplies u8 activations by s8 weights into int16 pair sums; madd against
+// ones widens them to the four-deep int32 dot product of each lane.
+__attribute__((target("avx2"))) inline __m256i dot4_avx2(__m256i acc, __m256i activations, const std::int8_t* weights) {
+    const __m256i products = _mm256_maddubs_epi16(activations, _mm256_set1_epi32(load_group(weights)));
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(products, _mm256_set1_epi16(1)));
+}
+
+// 4 rows x 16 columns: eight independent accumulators, then an 8-column pass and a
+// scalar tail.
+__attribute__((target("avx2"))) void gemm_u8s8_avx2(std::size_t m, std::size_t n, std::size_t k,
+                                                    const std::int8_t* a, const std::uint8_t* b, std::int32_t* c) {
+    const std::size_t groups = k / 4;
+    std::size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        const std::int8_t* a0 = a + i * k;
+        const std::int8_t* a1 = a0 + k;
+        const std::int8_t* a2 = a1 + k;
+        const std::int8_t* a3 = a2 + k;
+        std::int32_t* c0 = c + i * n;
+        std::int32_t* c1 = c0 + n;
+        std::int32_t* c2 = c1 + n;
+        std::int32_t* c3 = c2 + n;
+        std::size_t j = 0;
+        for (; j + 16 <= n; j += 16) {
+            __m256i acc00 = _mm256_setzero_si256();
+            __m256i acc01 = _mm256_setzero_si256();
+            __m256i acc10 = _mm256_setzero_si256();
+            __m256i acc11 = _mm256_setzero_si256();
+            __m256i acc20 = _mm256_setzero_si256();
+            __m256i acc21 = _mm256_setzero_si256();
+            __m256i acc30 = _mm256_setzero_si256();
+            __m256i acc31 = _mm256_setzero_si256();
+            for (std::size_t g = 0; g < groups; ++g) {
+                const std::uint8_t* column = b + g * n * 4 + j * 4;
+                const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column));
+                const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + 32));
+                acc00 = dot4_avx2(acc00, b0, a0 + g * 4);
+                acc01 = dot4_avx2(acc01, b1, a0 + g * 4);
+                acc10 = dot4_avx2(acc10, b0, a1 + g * 4);
+                acc11 = dot4_avx2(acc11, b1, a1 + g * 4);
+                acc20 = dot4_avx2(acc20, b0, a2 + g * 4);
+                acc21 = dot4_avx2(acc21, b1, a2 + g * 4);
+                acc30 = dot4_avx2(acc30, b0, a3 + g * 4);
+                acc31 = dot4_avx2(acc31, b1, a3 + g * 4);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c0 + j), acc00);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c0 + j + 8), acc01);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c1 + j), acc10);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c1 + j + 8), acc11);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c2 + j), acc20);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c2 + j + 8), acc21);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c3 + j), acc30);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c3 + j + 8), acc31);
+        }
+        for (; j + 8 <= n; j += 8) {
+            __m256i acc0 = _mm256_setzero_si256();
+            __m256i acc1 = _mm256_setzero_si256();
+            __m256i acc2 = _mm256_setzero_si256();
+            __m256i acc3 = _mm256_setzero_si256();
+            for (std::size_t g = 0; g < groups; ++g) {
+                const __m256i bv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + g * n * 4 + j * 4));
+                acc0 = dot4_avx2(acc0, bv, a0 + g * 4);
+                acc1 = dot4_avx2(acc1, bv, a1 + g * 4);
+                acc2 = dot4_avx2(acc2, bv, a2 + g * 4);
+                acc3 = dot4_avx2(acc3, bv, a3 + g * 4);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c0 + j), acc0);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c1 + j), acc1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c2 + j), acc2);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(c3 + j), acc3);
+        }
+        for (; j < n; ++j) {
+            for (std::size_t r = 0; r < 4; ++r) {
+                c[(i + r) * n + j] = dot_column(n, k, a + (i + r) * k, b, j);
+            }
+        }
+    }
+    if (i < m) {
+        gemm_u8s8_generic(m - i, n, k, a + i * k, b, c + i * n);
+    }
+}
+
+// 4 rows x 32 columns with vpdpbusd, which accumulates the four-deep u8 x s8 products
+// straight into int32 lanes; the column tail runs 16 masked lanes at a time.
+__attribute__((target("avx512f,avx512vnni"))) void gemm_u8s8_vnni(std::size_t m, std::size_t n, std::size_t k,
+                                                                   const std::int8_t* a, const std::uint8_t* b,
+                                                                   std::int32_t* c) {
+    const std::size_t groups = k / 4;
+    std::size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        const std::int8_t* a0 = a + i * k;
+        const std::int8_t* a1 = a0 + k;
+        const std::int8_t* a2 = a1 + k;
+        const std::int8_t* a3 = a2 + k;
+        std::int32_t* c0 = c + i * n;
+        std::int32_t* c1 = c0 + n;
+        std::int32_t* c2 = c1 + n;
+        std::int32_t* c3 = c2 + n;
+        std::size_t j = 0;
+        for (; j + 32 <= n; j += 32) {
+            __m512i acc00 = _mm512_setzero_si512();
+            __m512i acc01 = _mm512_setzero_si512();
+            __m512i acc10 = _mm512_setzero_si512();
+            __m512i acc11 = _mm512_setzero_si512();
+            __m512i acc20 = _mm512_setzero_si512();
+            __m512i acc21 = _mm512_setzero_si512();
+            __m512i acc30 = _mm512_setzero_si512();
+            __m512i acc31 = _mm512_setzero_si512();
+            for (std::size_t g = 0; g < groups; ++g) {
+                const std::uint8_t* column = b + g * n * 4 + j * 4;
+                const __m512i b0 = _mm512_loadu_si512(column);
+                const __m512i b1 = _mm512_loadu_si512(column + 64);
+                __m512i w = _mm512_set1_epi32(load_group(a0 + g * 4));
+                acc00 = _mm512_dpbusd_epi32(acc00, b0, w);
+                acc01 = _mm512_dpbusd_epi32(acc01, b1, w);
+                w = _mm512_set1_epi32(load_group(a1 + g * 4));
+                acc10 = _mm512_dpbusd_epi32(acc10, b0, w);
+                acc11 = _mm512_dpbusd_epi32(acc11, b1, w);
+                w = _mm512_set1_epi32(load_group(a2 + g * 4));
+                acc20 = _mm512_dpbusd_epi32(acc20, b0, w);
+                acc21 = _mm512_dpbusd_epi32(acc21, b1, w);
+                w = _mm512_set1_epi32(load_group(a3 + g * 4));
+                acc30 = _mm512_dpbusd_epi32(acc30, b0, w);
+                acc31 = _mm512_dpbusd_epi32(acc31, b1, w);
+            }
+            _mm512_storeu_si512(c0 + j, acc00);
+            _mm512_storeu_si512(c0 + j + 16, acc01);
+            _mm512_storeu_si512(c1 + j, acc10);
+            _mm512_storeu_si512(c1 + j + 16, acc11);
+            _mm512_storeu_si512(c2 + j, acc20);
+            _mm512_storeu_si512(c2 + j + 16, acc21);
+            _mm512_storeu_si512(c3 + j, acc30);
+            _mm512_storeu_si512(c3 + j + 16, acc31);
+        }
+        for (; j < n; j += 16) {
+            const std::size_t remaining = std::min<std::size_t>(16, n - j);
+            const __mmask16 mask = static_cast<__mmask16>((1u << remaining) - 1u);
+            __m512i acc0 = _mm512_setzero_si512();
+            __m512i acc1 = _mm512_setzero_si512();
+            __m512i acc2 = _mm512_setzero_si512();
+            __m512i acc3 = _mm512_setzero_si512();
+            for (std::size_t g = 0; g < groups; ++g) {
+                const __m512i bv = _mm512_maskz_loadu_epi32(mask, b + g * n * 4 + j * 4);
+                acc0 = _mm512_dpbusd_epi32(acc0, bv, _mm512_set1_epi32(load_group(a0 + g * 4)));
+                acc1 = _mm512_dpbusd_epi32(acc1, bv, _mm512_set1_epi32(load_group(a1 + g * 4)));
+                acc2 = _mm512_dpbusd_epi32(acc2, bv, _mm512_set1_epi32(load_group(a2 + g * 4)));
+                acc3 = _mm512_dpbusd_epi32(acc3, bv, _mm512_set1_epi32(load_group(a3 + g * 4)));
+            }
+            _mm512_mask_storeu_epi32(c0 + j, mask, acc0);
+            _mm512_mask_storeu_epi32(c1 + j, mask, acc1);
+            _mm512_mask_storeu_epi32(c2 + j, mask, acc2);
+            _mm512_mask_storeu_epi32(c3 + j, mask, acc3);
+        }
+    }
+    if (i < m) {
+        gemm_u8s8_generic(m - i, n, k, a + i * k, b, c + i * n);
+    }
+}
+
+#endif
+
+Int8GemmImpl select_int8_gemm() {
+    // Shares TENUKI_NN_KERNEL with the float gemm: "avx2" or "generic" cap the instruction set.
+    const char* requested = std::getenv("TENUKI_NN_KERNEL");
+    const bool allow_vnni = !requested || std::strcmp(requested, "avx512") == 0;
+    const bool allow_avx2 = allow_vnni || std::strcmp(requested, "avx2") == 0;
+#if TENUKI_NN_X86
+    __builtin_cpu_init();
+    if (allow_vnni && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vnni")) {
+        return {gemm_u8s8_vnni, "avx512vnni"};
+    }
+    if (allow_avx2 && __builtin_cpu_supports("avx2")) {
+        return {gemm_u8s8_avx2, "avx2"};
+    }
+#else
+    (void)allow_avx2;
+#endif
+    return {gemm_u8s8_generic, "generic"};
+}
+
+const Int8GemmImpl& active_int8_gemm() {
+    static const Int8GemmImpl impl = select_int8_gemm();
+    return impl;
+}
+
+} // namespace
+
+const char* precision_name(Precision precision) {
+    return precision == Precision::Int8 ? "int8" : "fp32";
+}
+
+Precision parse_precision(const std::string& name) {
+    if (name == "fp32") {
+        return Precision::Float32;
+    }
+    if (name == "int8") {
+        return Precision::Int8;
+    }
+    throw std::invalid_argument("unknown precision: " + name);
+}
+
+CalibrationTable load_calibration(std::istream& in) {
+    std::array<char, 4> magic{};
+    if (!in.read(magic.data(), 4) || magic != kMagic) {
+        throw std::runtime_error("not a tenuki calibration table");
+    }
+    const std::uint32_t version = read_u32(in);
+    if (version != kVersion) {
+        throw std::runtime_error("unsupported calibration table version " + std::to_string(version));
+    }
+    const std::uint32_t count = read_u32(in);
+    if (count > kMaxLayers) {
+        throw std::runtime_error("calibration table too large");
+    }
+    CalibrationTable table;
+    table.activation_max.resize(count);
+    for (float& value : table.activation_max) {
+        const std::uint32_t bits = read_u32(in);
+        std::memcpy(&value, &bits, sizeof(value));
+        if (!std::isfinite(value) || value < 0.0f) {
+            throw std::runtime_error("calibration table contains an invalid range");
+        }
+    }
+    return table;
+}
+
+CalibrationTable load_calibration_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open calibration table: " + path);
+    }
+    return load_calibration(in);
+}
+
+void save_calibration(const CalibrationTable& table, std::ostream& out) {
+    out.write(kMagic.data(), 4);
+    write_u32(out, kVersion);
+    write_u32(out, static_cast<std::uint32_t>(table.activation_max.size()));
+    for (const float value : table.activation_max) {
+        std::uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        write_u32(out, bits);
+    }
+}
+
+int quantized_depth(int depth) {
+    return (depth + 3) / 4 * 4;
+}
+
+QuantizedConv quantize_conv(const ConvLayer& conv, float activation_max) {
+    QuantizedConv quantized;
+    quantized.in_channels = conv.in_channels;
+    quantized.out_channels = conv.out_channels;
+    quantized.kernel = conv.kernel;
+    const int depth = conv.in_channels * conv.kernel * conv.kernel;
+    quantized.depth = quantized_depth(depth);
+    quantized.bias = conv.bias;
+    // A layer whose inputs were always zero during calibration still needs a usable step.
+    quantized.input_scale = activation_max > 0.0f ? activation_max / static_cast<float>(kActivationLevels) : 1.0f;
+
+    const std::size_t row = static_cast<std::size_t>(quantized.depth);
+    quantized.weights.assign(static_cast<std::size_t>(conv.out_channels) * row, 0);
+    quantized.output_scales.resize(static_cast<std::size_t>(conv.out_channels));
+    for (std::size_t o = 0; o < static_cast<std::size_t>(conv.out_channels); ++o) {
+        const float* source = conv.weights.data() + o * static_cast<std::size_t>(depth);
+        float largest = 0.0f;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(depth); ++i) {
+            largest = std::max(largest, std::fabs(source[i]));
+        }
+        const float weight_scale = largest > 0.0f ? largest / static_cast<float>(kWeightLevels) : 1.0f;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(depth); ++i) {
+            const float code = std::round(source[i] / weight_scale);
+            quantized.weights[o * row + i] = static_cast<std::int8_t>(std::clamp(code, -static_cast<float>(kWeightLevels), static_cast<float>(kWeightLevels)));
+        }
+        quantized.output_scales[o] = weight_scale * quantized.input_scale;
+    }
+    return quantized;
+}
+
+void quantize_pack(const float* columns, int depth, int padded_depth, int n, float input_scale, std::uint8_t* packed) {
+    const std::size_t width = static_cast<std::size_t>(n);
+    const float inverse = 1.0f / input_scale;
+    for (std::size_t k = 0; k < static_cast<std::size_t>(padded_depth); ++k) {
+        std::uint8_t* out = packed + (k / 4) * width * 4 + k % 4;
+        if (k >= static_cast<std::size_t>(depth)) {
+            for (std::size_t j = 0; j < width; ++j) {
+                out[j * 4] = 0;
+            }
+            continue;
+        }
+        const float* row = columns + k * width;
+        for (std::size_t j = 0; j < width; ++j) {
+            const float code = std::min(row[j] * inverse + 0.5f, static_cast<float>(kActivationLevels));
+            out[j * 4] = code > 0.0f ? static_cast<std::uint8_t>(code) : 0;
+        }
+    }
+}
+
+void gemm_u8s8(int m, int n, int k, const std::int8_t* a, const std::uint8_t* b_packed, std::int32_t* c) {
+    if (m <= 0 || n <= 0 || k <= 0) {
+        return;
+    }
+    if (k % 4 != 0) {
+        throw std::invalid_argument("int8 gemm depth must be a multiple of 4");
+    }
+    active_int8_gemm().fn(static_cast<std::size_t>(m), static_cast<std::size_t>(n), static_cast<std::size_t>(k), a,
+                          b_packed, c);
+}
+
+const char* int8_gemm_backend() {
+    return active_int8_gemm().name;
+}
+
+void quantize_im2col_pack_3x3(const float* input, int channels, int height, int width, int padded_depth,
+                              float input_scale, std::uint8_t* codes, std::uint8_t* packed) {
+    const std::size_t spatial = static_cast<std::size_t>(height) * static_cast<std::size_t>(width);
+    const std::size_t total = static_cast<std::size_t>(channels) * spatial;
+    const float inverse = 1.0f / input_scale;
+    for (std::size_t i = 0; i < total; ++i) {
+        const float code = std::min(input[i] * inverse + 0.5f, static_cast<float>(kActivationLevels));
+        codes[i] = code > 0.0f ? static_cast<std::uint8_t>(code) : 0;
+    }
+
+    const std::size_t depth = static_cast<std::size_t>(channels) * 9;
+    for (std::size_t k = 0; k < static_cast<std::size_t>(padded_depth); ++k) {
+        std::uint8_t* out = packed + (k / 4) * spatial * 4 + k % 4;
+        if (k >= depth) {
+            for (std::size_t j = 0; j < spatial; ++j) {
+                out[j * 4] = 0;
+            }
+            continue;
+        }
+        const std::uint8_t* plane = codes + (k / 9) * spatial;
+        const int dy = static_cast<int>(k % 9) / 3 - 1;
+        const int dx = static_cast<int>(k % 9) % 3 - 1;
+        for (int y = 0; y < height; ++y) {
+            const int sy = y + dy;
+            std::uint8_t* row_out = out + static_cast<std::size_t>(y * width) * 4;
+            if (sy < 0 || sy >= height) {
+                for (int x = 0; x < width; ++x) {
+                    row_out[x * 4] = 0;
+                }
+                continue;
+            }
+            const std::uint8_t* row = plane + static_cast<std::size_t>(sy * width);
+            for (int x = 0; x < width; ++x) {
+                const int sx = x + dx;
+                row_out[x * 4] = (sx < 0 || sx >= width) ? 0 : row[sx];
+            }
+        }
+    }
+}
+
+void quantized_conv(const float* input, const QuantizedConv& conv, int height, int width, std::uint8_t* codes,
+                    std::uint8_t* packed, std::int32_t* accum, float* out) {
+    const int spatial = height * width;
+    if (conv.kernel == 3) {
+        quantize_im2col_pack_3x3(input, conv.in_channels, height, width, conv.depth, conv.input_scale, codes, packed);
+    } else if (conv.kernel == 1) {
+        quantize_pack(input, conv.in_channels, conv.depth, spatial, conv.input_scale, packed);
+    } else {
+        throw std::invalid_argument("quantized convolutions support 1x1 and 3x3 kernels");
+    }
+    gemm_u8s8(conv.out_channels, spatial, conv.depth, conv.weights.data(), packed, accum);
+
+    const std::size_t n = static_cast<std::size_t>(spatial);
+    for (std::size_t o = 0; o < static_cast<std::size_t>(conv.out_channels); ++o) {
+        const float scale = conv.output_scales[o];
+        const float bias = conv.bias[o];
+        const std::int32_t* source = accum + o * n;
+        float* target = out + o * n;
+        for (std::size_t j = 0; j < n; ++j) {
+            target[j] = static_cast<float>(source[j]) * scale + bias;
+        }
+    }
+}
+
+} // namespace nn
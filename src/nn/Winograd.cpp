@@ -0,0 +1,203 @@
+#include "nn/Winograd.hpp"
+
+#include "nn/Kernels.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace nn {
+
+namespace {
+
+constexpr int kIn = kWinogradInputTile;
+constexpr int kOut = kWinogradOutputTile;
+
+constexpr float kG[kIn][3] = {
+    {1.0f / 4.0f, 0.0f, 0.0f},
+    {-1.0f / 6.0f, -1.0f / 6.0f, -1.0f / 6.0f},
+    {-1.0f / 6.0f, 1.0f / 6.0f, -1.0f / 6.0f},
+    {1.0f / 24.0f, 1.0f / 12.0f, 1.0f / 6.0f},
+    {1.0f / 24.0f, -1.0f / 12.0f, 1.0f / 6.0f},
+    {0.0f, 0.0f, 1.0f},
+};
+
+// B^T and A^T are applied through the factored 1-D transforms below; the matrices are
+// kept here as their specification.
+[[maybe_unused]] constexpr float kBT[kIn][kIn] = {
+    {4.0f, 0.0f, -5.0f, 0.0f, 1.0f, 0.0f},
+    {0.0f, -4.0f, -4.0f, 1.0f, 1.0f, 0.0f},
+    {0.0f, 4.0f, -4.0f, -1.0f, 1.0f, 0.0f},
+    {0.0f, -2.0f, -1.0f, 2.0f, 1.0f, 0.0f},
+    {0.0f, 2.0f, -1.0f, -2.0f, 1.0f, 0.0f},
+    {0.0f, 4.0f, 0.0f, -5.0f, 0.0f, 1.0f},
+};
+
+[[maybe_unused]] constexpr float kAT[kOut][kIn] = {
+    {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f},
+    {0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.0f},
+    {0.0f, 1.0f, 1.0f, 4.0f, 4.0f, 0.0f},
+    {0.0f, 1.0f, -1.0f, 8.0f, -8.0f, 1.0f},
+};
+
+using InputTile = std::array<float, kWinogradPoints>;
+
+// One B^T pass over six values read and written with the given strides. The products
+// are factored so the zero entries of B^T cost nothing.
+inline void input_transform_1d(const float* d, int in_stride, float* t, int out_stride) {
+    const float d0 = d[0];
+    const float d1 = d[in_stride];
+    const float d2 = d[2 * in_stride];
+    const float d3 = d[3 * in_stride];
+    const float d4 = d[4 * in_stride];
+    const float d5 = d[5 * in_stride];
+    t[0] = 4.0f * d0 - 5.0f * d2 + d4;
+    t[out_stride] = (d3 + d4) - 4.0f * (d1 + d2);
+    t[2 * out_stride] = (d4 - d3) + 4.0f * (d1 - d2);
+    t[3 * out_stride] = (d4 - d2) + 2.0f * (d3 - d1);
+    t[4 * out_stride] = (d4 - d2) - 2.0f * (d3 - d1);
+    t[5 * out_stride] = 4.0f * d1 - 5.0f * d3 + d5;
+}
+
+inline void output_transform_1d(const float* m, int in_stride, float* y, int out_stride) {
+    const float m0 = m[0];
+    const float m1 = m[in_stride];
+    const float m2 = m[2 * in_stride];
+    const float m3 = m[3 * in_stride];
+    const float m4 = m[4 * in_stride];
+    const float m5 = m[5 * in_stride];
+    y[0] = m0 + (m1 + m2) + (m3 + m4);
+    y[out_stride] = (m1 - m2) + 2.0f * (m3 - m4);
+    y[2 * out_stride] = (m1 + m2) + 4.0f * (m3 + m4);
+    y[3 * out_stride] = (m1 - m2) + 8.0f * (m3 - m4) + m5;
+}
+
+// V = B^T d B
+void transform_input_tile(const InputTile& d, InputTile& v) {
+    InputTile tmp{};
+    for (int j = 0; j < kIn; ++j) {
+        input_transform_1d(d.data() + j, kIn, tmp.data() + j, kIn);
+    }
+    for (int i = 0; i < kIn; ++i) {
+        input_transform_1d(tmp.data() + i * kIn, 1, v.data() + i * kIn, 1);
+    }
+}
+
+// Y = A^T m A
+void transform_output_tile(const InputTile& m, std::array<float, kOut * kOut>& y) {
+    std::array<float, kOut * kIn> tmp{};
+    for (int j = 0; j < kIn; ++j) {
+        output_transform_1d(m.data() + j, kIn, tmp.data() + j, kIn);
+    }
+    for (int i = 0; i < kOut; ++i) {
+        output_transform_1d(tmp.data() + i * kIn, 1, y.data() + i * kOut, 1);
+    }
+}
+
+int tiles_along(int extent) {
+    return (extent + kOut - 1) / kOut;
+}
+
+} // namespace
+
+std::size_t winograd_tile_count(int height, int width) {
+    return static_cast<std::size_t>(tiles_along(height)) * static_cast<std::size_t>(tiles_along(width));
+}
+
+std::size_t winograd_weights_size(int in_channels, int out_channels) {
+    return static_cast<std::size_t>(kWinogradPoints) * static_cast<std::size_t>(in_channels) *
+           static_cast<std::size_t>(out_channels);
+}
+
+void winograd_transform_weights(const float* weights, int in_channels, int out_channels, float* transformed) {
+    const std::size_t plane = static_cast<std::size_t>(out_channels) * static_cast<std::size_t>(in_channels);
+    for (int o = 0; o < out_channels; ++o) {
+        for (int i = 0; i < in_channels; ++i) {
+            const float* g = weights + (static_cast<std::size_t>(o) * static_cast<std::size_t>(in_channels) + static_cast<std::size_t>(i)) * 9;
+            // U = G g G^T
+            float tmp[kIn][3];
+            for (int r = 0; r < kIn; ++r) {
+                for (int c = 0; c < 3; ++c) {
+                    tmp[r][c] = kG[r][0] * g[c] + kG[r][1] * g[3 + c] + kG[r][2] * g[6 + c];
+                }
+            }
+            const std::size_t offset = static_cast<std::size_t>(o) * static_cast<std::size_t>(in_channels) + static_cast<std::size_t>(i);
+            for (int r = 0; r < kIn; ++r) {
+                for (int c = 0; c < kIn; ++c) {
+                    const float value = tmp[r][0] * kG[c][0] + tmp[r][1] * kG[c][1] + tmp[r][2] * kG[c][2];
+                    transformed[static_cast<std::size_t>(r * kIn + c) * plane + offset] = value;
+                }
+            }
+        }
+    }
+}
+
+void conv3x3_winograd(const float* input, int in_channels, int out_channels, int height, int width,
+                      const float* transformed_weights, const float* bias, float* input_scratch,
+                      float* output_scratch, float* out) {
+    const int tiles_y = tiles_along(height);
+    const int tiles_x = tiles_along(width);
+    const std::size_t tiles = static_cast<std::size_t>(tiles_y) * static_cast<std::size_t>(tiles_x);
+    const std::size_t spatial = static_cast<std::size_t>(height) * static_cast<std::size_t>(width);
+    const std::size_t in_stride = static_cast<std::size_t>(in_channels) * tiles;
+    const std::size_t out_stride = static_cast<std::size_t>(out_channels) * tiles;
+
+    // Scatter every transformed 6x6 input tile into V[point][channel][tile]. Tiles
+    // overlap by two rows/columns and read zeros outside the plane.
+    InputTile d{};
+    InputTile v{};
+    for (int c = 0; c < in_channels; ++c) {
+        const float* plane = input + static_cast<std::size_t>(c) * spatial;
+        for (int ty = 0; ty < tiles_y; ++ty) {
+            for (int tx = 0; tx < tiles_x; ++tx) {
+                const int y0 = ty * kOut - 1;
+                const int x0 = tx * kOut - 1;
+                for (int r = 0; r < kIn; ++r) {
+                    const int y = y0 + r;
+                    for (int s = 0; s < kIn; ++s) {
+                        const int x = x0 + s;
+                        const bool inside = y >= 0 && y < height && x >= 0 && x < width;
+                        d[static_cast<std::size_t>(r * kIn + s)] = inside ? plane[y * width + x] : 0.0f;
+                    }
+                }
+                transform_input_tile(d, v);
+                const std::size_t column = static_cast<std::size_t>(c) * tiles + static_cast<std::size_t>(ty * tiles_x + tx);
+                for (std::size_t point = 0; point < static_cast<std::size_t>(kWinogradPoints); ++point) {
+                    input_scratch[point * in_stride + column] = v[point];
+                }
+            }
+        }
+    }
+
+    // M[point] = U[point] (out x in) * V[point] (in x tiles)
+    std::fill(output_scratch, output_scratch + static_cast<std::size_t>(kWinogradPoints) * out_stride, 0.0f);
+    const std::size_t weight_stride = static_cast<std::size_t>(out_channels) * static_cast<std::size_t>(in_channels);
+    for (std::size_t point = 0; point < static_cast<std::size_t>(kWinogradPoints); ++point) {
+        gemm(out_channels, static_cast<int>(tiles), in_channels, transformed_weights + point * weight_stride,
+             input_scratch + point * in_stride, output_scratch + point * out_stride);
+    }
+
+    InputTile m{};
+    std::array<float, kOut * kOut> y{};
+    for (int o = 0; o < out_channels; ++o) {
+        float* plane = out + static_cast<std::size_t>(o) * spatial;
+        const float b = bias ? bias[o] : 0.0f;
+        for (int ty = 0; ty < tiles_y; ++ty) {
+            for (int tx = 0; tx < tiles_x; ++tx) {
+                const std::size_t column = static_cast<std::size_t>(o) * tiles + static_cast<std::size_t>(ty * tiles_x + tx);
+                for (std::size_t point = 0; point < static_cast<std::size_t>(kWinogradPoints); ++point) {
+                    m[point] = output_scratch[point * out_stride + column];
+                }
+                transform_output_tile(m, y);
+                const int rows = std::min(kOut, height - ty * kOut);
+                const int cols = std::min(kOut, width - tx * kOut);
+                for (int r = 0; r < rows; ++r) {
+                    for (int s = 0; s < cols; ++s) {
+                        plane[(ty * kOut + r) * width + tx * kOut + s] = y[static_cast<std::size_t>(r * kOut + s)] + b;
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace nn
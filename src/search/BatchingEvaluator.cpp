@@ -0,0 +1,86 @@
+#include "search/BatchingEvaluator.hpp"
+
+#include "search/Trace.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace search {
+
+BatchingEvaluator::BatchingEvaluator(std::shared_ptr<Evaluator> inner, int max_batch,
+                                     std::chrono::microseconds max_wait)
+    : inner_(std::move(inner)), max_batch_(max_batch), max_wait_(max_wait) {
+    if (!inner_) {
+        throw std::invalid_argument("batching evaluator needs an inner evaluator");
+    }
+    if (max_batch_ <= 0) {
+        throw std::invalid_argument("batch size must be positive");
+    }
+}
+
+EvaluationResult BatchingEvaluator::evaluate(const go::Board& board, go::Player to_play) {
+    Pending pending;
+    pending.request = EvaluationRequest{&board, to_play};
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_.push_back(&pending);
+    if (queue_.size() >= static_cast<std::size_t>(max_batch_)) {
+        dispatch(lock);
+    } else {
+        const auto deadline = std::chrono::steady_clock::now() + max_wait_;
+        if (!ready_.wait_until(lock, deadline, [&] { return pending.taken; })) {
+            dispatch(lock);
+        }
+    }
+    ready_.wait(lock, [&] { return pending.done; });
+    if (pending.error) {
+        std::rethrow_exception(pending.error);
+    }
+    return std::move(pending.result);
+}
+
+// Takes up to max_batch queued requests, evaluates them without holding the lock and
+// wakes their owners.
+void BatchingEvaluator::dispatch(std::unique_lock<std::mutex>& lock) {
+    const std::size_t count = std::min(queue_.size(), static_cast<std::size_t>(max_batch_));
+    std::vector<Pending*> batch(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(count));
+    queue_.erase(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(count));
+    std::vector<EvaluationRequest> requests;
+    requests.reserve(count);
+    for (Pending* pending : batch) {
+        pending->taken = true;
+        requests.push_back(pending->request);
+    }
+    lock.unlock();
+
+    std::vector<EvaluationResult> results;
+    std::exception_ptr error;
+    {
+        TraceSpan span(TraceEvent::BatchDispatch);
+        try {
+            results = inner_->evaluate_batch(requests);
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+
+    lock.lock();
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        if (error) {
+            batch[i]->error = error;
+        } else {
+            batch[i]->result = std::move(results[i]);
+        }
+        batch[i]->done = true;
+    }
+    ready_.notify_all();
+}
+
+std::vector<EvaluationResult> BatchingEvaluator::evaluate_batch(const std::vector<EvaluationRequest>& requests) {
+    TraceSpan span(TraceEvent::BatchDispatch);
+    return inner_->evaluate_batch(requests);
+}
+
+} // namespace search
@@ -0,0 +1,655 @@
+#include "search/Distributed.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace search {
+namespace {
+
+constexpr std::uint32_t kMagic = 0x444b4e54u; // "TNKD" little-endian
+constexpr std::uint16_t kVersion = 2;
+constexpr std::size_t kHeaderSize = 12;
+constexpr std::uint32_t kMaxPayload = 64u * 1024u * 1024u;
+
+class ByteWriter {
+public:
+    void put_u8(std::uint8_t value) { bytes_.push_back(value); }
+
+    void put_u16(std::uint16_t value) {
+        for (int shift = 0; shift < 16; shift += 8) {
+            bytes_.push_back(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    void put_u32(std::uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            bytes_.push_back(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    void put_u64(std::uint64_t value) {
+        for (int shift = 0; shift < 64; shift += 8) {
+            bytes_.push_back(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    void put_i32(int value) { put_u32(static_cast<std::uint32_t>(value)); }
+
+    void put_f32(float value) {
+        std::uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        put_u32(bits);
+    }
+
+    void put_f64(double value) {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        put_u64(bits);
+    }
+
+    std::vector<std::uint8_t>& bytes() { return bytes_; }
+
+private:
+    std::vector<std::uint8_t> bytes_;
+};
+
+class ByteReader {
+public:
+    ByteReader(const std::uint8_t* data, std::size_t size) : data_(data), size_(size) {}
+
+    std::uint8_t get_u8() {
+        require(1);
+        return data_[pos_++];
+    }
+
+    std::uint16_t get_u16() {
+        require(2);
+        std::uint16_t value = 0;
+        for (int i = 0; i < 2; ++i) {
+            value = static_cast<std::uint16_t>(value | (static_cast<std::uint16_t>(data_[pos_++]) << (8 * i)));
+        }
+        return value;
+    }
+
+    std::uint32_t get_u32() {
+        require(4);
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<std::uint32_t>(data_[pos_++]) << (8 * i);
+        }
+        return value;
+    }
+
+    std::uint64_t get_u64() {
+        require(8);
+        std::uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<std::uint64_t>(data_[pos_++]) << (8 * i);
+        }
+        return value;
+    }
+
+    int get_i32() { return static_cast<int>(get_u32()); }
+
+    float get_f32() {
+        const std::uint32_t bits = get_u32();
+        float value = 0.0f;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    double get_f64() {
+        const std::uint64_t bits = get_u64();
+        double value = 0.0;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::size_t remaining() const noexcept { return size_ - pos_; }
+
+private:
+    void require(std::size_t count) const {
+        if (size_ - pos_ < count) {
+            throw std::runtime_error("truncated distributed search message");
+        }
+    }
+
+    const std::uint8_t* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+};
+
+struct Endpoint {
+    bool is_unix = true;
+    std::string path;
+    std::string host;
+    std::string port;
+};
+
+Endpoint parse_endpoint(const std::string& text) {
+    Endpoint endpoint;
+    if (text.rfind("unix:", 0) == 0) {
+        endpoint.path = text.substr(5);
+    } else if (text.rfind("tcp:", 0) == 0) {
+        const std::string rest = text.substr(4);
+        const auto colon = rest.rfind(':');
+        if (colon == std::string::npos || colon + 1 >= rest.size()) {
+            throw std::runtime_error("tcp endpoint requires host:port: " + text);
+        }
+        endpoint.is_unix = false;
+        endpoint.host = rest.substr(0, colon);
+        endpoint.port = rest.substr(colon + 1);
+    } else {
+        throw std::runtime_error("endpoint must start with unix: or tcp: : " + text);
+    }
+    if (endpoint.is_unix && (endpoint.path.empty() || endpoint.path.size() >= sizeof(sockaddr_un::sun_path))) {
+        throw std::runtime_error("invalid unix socket path: " + text);
+    }
+    return endpoint;
+}
+
+void disable_sigpipe(int fd) {
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#else
+    (void)fd;
+#endif
+}
+
+sockaddr_un unix_address(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+int open_listener(const Endpoint& endpoint, int backlog = 4) {
+    if (endpoint.is_unix) {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        ::unlink(endpoint.path.c_str());
+        sockaddr_un addr = unix_address(endpoint.path);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, backlog) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* results = nullptr;
+    const char* host = endpoint.host.empty() || endpoint.host == "*" ? nullptr : endpoint.host.c_str();
+    if (::getaddrinfo(host, endpoint.port.c_str(), &hints, &results) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo* ai = results; ai != nullptr; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, backlog) == 0) {
+            break;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(results);
+    return fd;
+}
+
+int open_connection(const Endpoint& endpoint) {
+    if (endpoint.is_unix) {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        sockaddr_un addr = unix_address(endpoint.path);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        disable_sigpipe(fd);
+        return fd;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* results = nullptr;
+    if (::getaddrinfo(endpoint.host.c_str(), endpoint.port.c_str(), &hints, &results) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo* ai = results; ai != nullptr; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            disable_sigpipe(fd);
+            break;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(results);
+    return fd;
+}
+
+bool write_all(int fd, const std::uint8_t* data, std::size_t size) {
+#ifdef MSG_NOSIGNAL
+    constexpr int kFlags = MSG_NOSIGNAL;
+#else
+    constexpr int kFlags = 0;
+#endif
+    while (size > 0) {
+        const ssize_t written = ::send(fd, data, size, kFlags);
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+using Deadline = std::optional<std::chrono::steady_clock::time_point>;
+
+// Waits until fd has data or the deadline passes; without a deadline it does not wait.
+bool wait_readable(int fd, const Deadline& deadline) {
+    if (!deadline) {
+        return true;
+    }
+    while (true) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+        pollfd entry{fd, POLLIN, 0};
+        const int ready = ::poll(&entry, 1, static_cast<int>(std::max<std::chrono::milliseconds::rep>(0, remaining.count())));
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        return ready > 0;
+    }
+}
+
+bool read_all(int fd, std::uint8_t* data, std::size_t size, const Deadline& deadline = std::nullopt) {
+    while (size > 0) {
+        if (!wait_readable(fd, deadline)) {
+            return false;
+        }
+        const ssize_t received = ::recv(fd, data, size, 0);
+        if (received <= 0) {
+            return false;
+        }
+        data += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+bool send_message(int fd, MessageType type, const std::vector<std::uint8_t>& payload) {
+    ByteWriter header;
+    header.put_u32(kMagic);
+    header.put_u16(kVersion);
+    header.put_u16(static_cast<std::uint16_t>(type));
+    header.put_u32(static_cast<std::uint32_t>(payload.size()));
+    return write_all(fd, header.bytes().data(), header.bytes().size()) &&
+           write_all(fd, payload.data(), payload.size());
+}
+
+bool receive_message(int fd, MessageType& type, std::vector<std::uint8_t>& payload, const Deadline& deadline = std::nullopt) {
+    std::uint8_t header_bytes[kHeaderSize];
+    if (!read_all(fd, header_bytes, kHeaderSize, deadline)) {
+        return false;
+    }
+    ByteReader header(header_bytes, kHeaderSize);
+    if (header.get_u32() != kMagic || header.get_u16() != kVersion) {
+        return false;
+    }
+    type = static_cast<MessageType>(header.get_u16());
+    const std::uint32_t size = header.get_u32();
+    if (size > kMaxPayload) {
+        return false;
+    }
+    payload.resize(size);
+    return read_all(fd, payload.data(), payload.size(), deadline);
+}
+
+} // namespace
+
+std::vector<std::uint8_t> encode_search_request(const SearchRequest& request) {
+    ByteWriter writer;
+    writer.put_u32(static_cast<std::uint32_t>(request.rules.board_size));
+    writer.put_f64(request.rules.komi);
+    writer.put_u8(request.rules.allow_suicide ? 1 : 0);
+    writer.put_u8(static_cast<std::uint8_t>(request.rules.ko_rule));
+    writer.put_u8(static_cast<std::uint8_t>(request.rules.scoring_rule));
+    writer.put_u8(static_cast<std::uint8_t>(request.to_play));
+    writer.put_i32(request.ko_vertex);
+    writer.put_i32(request.move_number);
+    writer.put_i32(request.playouts);
+    writer.put_u32(request.seed);
+    for (go::PointState point : request.points) {
+        writer.put_u8(static_cast<std::uint8_t>(point));
+    }
+    return std::move(writer.bytes());
+}
+
+SearchRequest decode_search_request(const std::vector<std::uint8_t>& payload) {
+    ByteReader reader(payload.data(), payload.size());
+    SearchRequest request;
+    request.rules.board_size = reader.get_u32();
+    if (request.rules.board_size == 0 || request.rules.board_size > 25) {
+        throw std::runtime_error("invalid board size in search request");
+    }
+    request.rules.komi = reader.get_f64();
+    request.rules.allow_suicide = reader.get_u8() != 0;
+    request.rules.ko_rule = reader.get_u8() == 0 ? go::KoRule::PositionalSuperko : go::KoRule::SimpleKo;
+    request.rules.scoring_rule = reader.get_u8() == 0 ? go::ScoringRule::TrompTaylorArea : go::ScoringRule::Territory;
+    request.to_play = reader.get_u8() == 0 ? go::Player::Black : go::Player::White;
+    request.ko_vertex = reader.get_i32();
+    request.move_number = reader.get_i32();
+    request.playouts = reader.get_i32();
+    request.seed = reader.get_u32();
+    const std::size_t area = request.rules.board_size * request.rules.board_size;
+    if (reader.remaining() != area) {
+        throw std::runtime_error("search request board does not match board size");
+    }
+    request.points.resize(area);
+    for (go::PointState& point : request.points) {
+        const std::uint8_t raw = reader.get_u8();
+        if (raw > 2) {
+            throw std::runtime_error("invalid point state in search request");
+        }
+        point = static_cast<go::PointState>(raw);
+    }
+    return request;
+}
+
+std::vector<std::uint8_t> encode_search_result(const std::vector<RootMoveStats>& stats) {
+    ByteWriter writer;
+    writer.put_u32(static_cast<std::uint32_t>(stats.size()));
+    for (const RootMoveStats& entry : stats) {
+        writer.put_i32(entry.move);
+        writer.put_f32(entry.prior);
+        writer.put_i32(entry.visit_count);
+        writer.put_f32(entry.value_sum);
+    }
+    return std::move(writer.bytes());
+}
+
+std::vector<RootMoveStats> decode_search_result(const std::vector<std::uint8_t>& payload) {
+    ByteReader reader(payload.data(), payload.size());
+    const std::uint32_t count = reader.get_u32();
+    if (reader.remaining() != static_cast<std::size_t>(count) * 16u) {
+        throw std::runtime_error("search result size mismatch");
+    }
+    std::vector<RootMoveStats> stats(count);
+    for (RootMoveStats& entry : stats) {
+        entry.move = reader.get_i32();
+        entry.prior = reader.get_f32();
+        entry.visit_count = reader.get_i32();
+        entry.value_sum = reader.get_f32();
+    }
+    return stats;
+}
+
+SearchWorker::SearchWorker(std::string endpoint, SearchConfig config, std::shared_ptr<Evaluator> evaluator)
+    : endpoint_(std::move(endpoint)), config_(config), evaluator_(std::move(evaluator)) {
+    if (!evaluator_) {
+        evaluator_ = make_uniform_evaluator();
+    }
+}
+
+SearchWorker::~SearchWorker() {
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        const Endpoint endpoint = parse_endpoint(endpoint_);
+        if (endpoint.is_unix) {
+            ::unlink(endpoint.path.c_str());
+        }
+    }
+}
+
+void SearchWorker::listen() {
+    const Endpoint endpoint = parse_endpoint(endpoint_);
+    listen_fd_ = open_listener(endpoint);
+    if (listen_fd_ < 0) {
+        throw std::runtime_error("unable to listen on " + endpoint_);
+    }
+}
+
+void SearchWorker::serve() {
+    if (listen_fd_ < 0) {
+        listen();
+    }
+    while (true) {
+        const int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            return;
+        }
+        disable_sigpipe(fd);
+        const bool keep_serving = handle_connection(fd);
+        ::close(fd);
+        if (!keep_serving) {
+            return;
+        }
+    }
+}
+
+bool SearchWorker::handle_connection(int fd) {
+    MessageType type = MessageType::SearchRequest;
+    std::vector<std::uint8_t> payload;
+    while (receive_message(fd, type, payload)) {
+        if (type == MessageType::Shutdown) {
+            return false;
+        }
+        if (type != MessageType::SearchRequest) {
+            return true;
+        }
+        std::vector<RootMoveStats> stats;
+        try {
+            stats = run_request(decode_search_request(payload));
+        } catch (const std::exception&) {
+            // Malformed request: answer with no statistics so the coordinator is not left waiting.
+            stats.clear();
+        }
+        ++requests_served_;
+        if (!send_message(fd, MessageType::SearchResult, encode_search_result(stats))) {
+            return true;
+        }
+    }
+    return true;
+}
+
+std::vector<RootMoveStats> SearchWorker::run_request(const SearchRequest& request) {
+    go::Board board(request.rules);
+    std::optional<int> ko;
+    if (request.ko_vertex >= 0) {
+        ko = request.ko_vertex;
+    }
+    board.set_position(request.points, request.to_play, ko);
+
+    SearchConfig config = config_;
+    config.max_playouts = std::max(1, request.playouts);
+    config.enable_playout_cap_randomization = false;
+    config.seed = request.seed;
+    SearchAgent agent(config, evaluator_);
+    return agent.search(board, request.to_play, request.move_number);
+}
+
+DistributedCoordinator::DistributedCoordinator(std::vector<std::string> endpoints,
+                                               int connect_timeout_ms,
+                                               int result_timeout_ms)
+    : result_timeout_(std::max(0, result_timeout_ms)) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(connect_timeout_ms);
+    for (std::string& text : endpoints) {
+        const Endpoint endpoint = parse_endpoint(text);
+        int fd = open_connection(endpoint);
+        // Workers may still be starting up; retry until the deadline.
+        while (fd < 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            fd = open_connection(endpoint);
+        }
+        if (fd < 0) {
+            throw std::runtime_error("unable to connect to search worker " + text);
+        }
+        Connection connection;
+        connection.endpoint = std::move(text);
+        connection.fd = fd;
+        connections_.push_back(std::move(connection));
+    }
+}
+
+DistributedCoordinator::~DistributedCoordinator() {
+    for (Connection& connection : connections_) {
+        drop(connection);
+    }
+}
+
+void DistributedCoordinator::begin(const go::Board& board, go::Player to_play, int move_number, int playouts) {
+    SearchRequest request;
+    request.rules = board.rules();
+    request.to_play = to_play;
+    request.ko_vertex = board.ko_vertex().value_or(-1);
+    request.move_number = move_number;
+    request.playouts = playouts;
+    const std::size_t area = board.board_size() * board.board_size();
+    request.points.resize(area);
+    for (std::size_t v = 0; v < area; ++v) {
+        request.points[v] = board.point_state(v);
+    }
+
+    for (std::size_t i = 0; i < connections_.size(); ++i) {
+        Connection& connection = connections_[i];
+        if (connection.fd < 0) {
+            continue;
+        }
+        request.seed = seed_ ^ (static_cast<unsigned int>(i + 1) * 0x9e3779b9u) ^ static_cast<unsigned int>(move_number);
+        connection.pending = send_message(connection.fd, MessageType::SearchRequest, encode_search_request(request));
+        if (!connection.pending) {
+            drop(connection);
+        }
+    }
+}
+
+std::vector<RootMoveStats> DistributedCoordinator::finish() {
+    std::vector<RootMoveStats> merged;
+    // One deadline for all workers; a late reply would arrive out of step with the next
+    // request, so a worker that misses it is dropped rather than read later.
+    const auto deadline = std::chrono::steady_clock::now() + result_timeout_;
+    for (Connection& connection : connections_) {
+        if (connection.fd < 0 || !connection.pending) {
+            continue;
+        }
+        connection.pending = false;
+        MessageType type = MessageType::SearchResult;
+        std::vector<std::uint8_t> payload;
+        if (!receive_message(connection.fd, type, payload, deadline) || type != MessageType::SearchResult) {
+            drop(connection);
+            continue;
+        }
+        std::vector<RootMoveStats> stats;
+        try {
+            stats = decode_search_result(payload);
+        } catch (const std::exception&) {
+            drop(connection);
+            continue;
+        }
+        if (merged.empty()) {
+            merged = std::move(stats);
+        } else {
+            // Workers may disagree about legality; keep the union so the local merge can filter.
+            for (const RootMoveStats& entry : stats) {
+                auto it = std::find_if(merged.begin(), merged.end(), [&](const RootMoveStats& m) { return m.move == entry.move; });
+                if (it == merged.end()) {
+                    merged.push_back(entry);
+                } else {
+                    it->visit_count += entry.visit_count;
+                    it->value_sum += entry.value_sum;
+                }
+            }
+        }
+    }
+    return merged;
+}
+
+std::size_t DistributedCoordinator::worker_count() const noexcept {
+    std::size_t count = 0;
+    for (const Connection& connection : connections_) {
+        if (connection.fd >= 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void DistributedCoordinator::shutdown_workers() {
+    for (Connection& connection : connections_) {
+        if (connection.fd >= 0) {
+            send_message(connection.fd, MessageType::Shutdown, {});
+            drop(connection);
+        }
+    }
+}
+
+void DistributedCoordinator::drop(Connection& connection) {
+    if (connection.fd >= 0) {
+        ::close(connection.fd);
+    }
+    connection.fd = -1;
+    connection.pending = false;
+}
+
+int listen_on_endpoint(const std::string& endpoint, int backlog) {
+    return open_listener(parse_endpoint(endpoint), backlog);
+}
+
+int connect_to_endpoint(const std::string& endpoint) {
+    return open_connection(parse_endpoint(endpoint));
+}
+
+void remove_endpoint_file(const std::string& endpoint) {
+    const Endpoint parsed = parse_endpoint(endpoint);
+    if (parsed.is_unix) {
+        ::unlink(parsed.path.c_str());
+    }
+}
+
+std::vector<std::string> parse_endpoint_list(const std::string& text) {
+    std::vector<std::string> endpoints;
+    std::istringstream ss(text);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        if (!token.empty()) {
+            endpoints.push_back(token);
+        }
+    }
+    return endpoints;
+}
+
+} // namespace search
@@ -0,0 +1,141 @@
+#include "search/EvalCache.hpp"
+
+#include "go/Symmetry.hpp"
+
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+namespace search {
+
+namespace {
+
+struct CacheKey {
+    std::uint64_t key = 0;
+    int symmetry = 0;
+};
+
+CacheKey cache_key(const EvaluationRequest& request) {
+    const go::CanonicalKey canonical = request.board->canonical_state_key(request.to_play);
+    return {canonical.key ^ go::rules_hash(request.board->rules()), canonical.symmetry};
+}
+
+// canonical[T_s(v)] = policy[v]; the pass entry is shared by every orientation.
+EvaluationResult to_canonical(const EvaluationResult& result, std::size_t board_size, int symmetry) {
+    const std::size_t area = board_size * board_size;
+    const go::SymmetryMap* table = go::symmetry_table(board_size);
+    EvaluationResult canonical;
+    canonical.policy.resize(area + 1);
+    for (std::size_t vertex = 0; vertex < area; ++vertex) {
+        canonical.policy[static_cast<std::size_t>(table[vertex][static_cast<std::size_t>(symmetry)])] =
+            result.policy[vertex];
+    }
+    canonical.policy[area] = result.policy[area];
+    canonical.value = result.value;
+    return canonical;
+}
+
+EvaluationResult from_canonical(const EvaluationResult& canonical, std::size_t board_size, int symmetry) {
+    const std::size_t area = board_size * board_size;
+    const go::SymmetryMap* table = go::symmetry_table(board_size);
+    EvaluationResult result;
+    result.policy.resize(area + 1);
+    for (std::size_t vertex = 0; vertex < area; ++vertex) {
+        result.policy[vertex] =
+            canonical.policy[static_cast<std::size_t>(table[vertex][static_cast<std::size_t>(symmetry)])];
+    }
+    result.policy[area] = canonical.policy[area];
+    result.value = canonical.value;
+    return result;
+}
+
+} // namespace
+
+CachingEvaluator::CachingEvaluator(std::shared_ptr<Evaluator> inner, std::size_t capacity) : inner_(std::move(inner)) {
+    if (!inner_) {
+        throw std::invalid_argument("caching evaluator needs an inner evaluator");
+    }
+    if (capacity == 0) {
+        throw std::invalid_argument("evaluation cache capacity must be positive");
+    }
+    shard_capacity_ = (capacity + kShards - 1) / kShards;
+    for (Shard& shard : shards_) {
+        shard.entries.resize(shard_capacity_);
+    }
+}
+
+CachingEvaluator::Entry& CachingEvaluator::slot_for(std::uint64_t key) {
+    return shard_for(key).entries[static_cast<std::size_t>(key % shard_capacity_)];
+}
+
+EvaluationResult CachingEvaluator::evaluate(const go::Board& board, go::Player to_play) {
+    return std::move(evaluate_batch({EvaluationRequest{&board, to_play}}).front());
+}
+
+std::vector<EvaluationResult> CachingEvaluator::evaluate_batch(const std::vector<EvaluationRequest>& requests) {
+    std::vector<EvaluationResult> results(requests.size());
+    std::vector<CacheKey> keys(requests.size());
+    constexpr std::size_t kHit = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> miss_of(requests.size(), kHit);
+    std::vector<EvaluationRequest> misses;
+    std::vector<std::size_t> miss_request;
+    std::unordered_map<std::uint64_t, std::size_t> pending;
+    std::uint64_t hits = 0;
+
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        keys[i] = cache_key(requests[i]);
+        const std::size_t board_size = requests[i].board->board_size();
+        {
+            Shard& shard = shard_for(keys[i].key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const Entry& entry = slot_for(keys[i].key);
+            if (entry.used && entry.key == keys[i].key && entry.result.policy.size() == board_size * board_size + 1) {
+                results[i] = from_canonical(entry.result, board_size, keys[i].symmetry);
+                ++hits;
+                continue;
+            }
+        }
+        const auto [it, inserted] = pending.try_emplace(keys[i].key, misses.size());
+        if (inserted) {
+            misses.push_back(requests[i]);
+            miss_request.push_back(i);
+        } else {
+            ++hits; // another orientation of a position already queued in this batch
+        }
+        miss_of[i] = it->second;
+    }
+    hits_.fetch_add(hits, std::memory_order_relaxed);
+    misses_.fetch_add(misses.size(), std::memory_order_relaxed);
+    if (misses.empty()) {
+        return results;
+    }
+
+    const std::vector<EvaluationResult> evaluated = inner_->evaluate_batch(misses);
+    std::vector<EvaluationResult> canonical(misses.size());
+    for (std::size_t m = 0; m < misses.size(); ++m) {
+        const std::size_t board_size = misses[m].board->board_size();
+        if (evaluated[m].policy.size() != board_size * board_size + 1) {
+            throw std::runtime_error("evaluator returned a policy of the wrong size");
+        }
+        const CacheKey& key = keys[miss_request[m]];
+        canonical[m] = to_canonical(evaluated[m], board_size, key.symmetry);
+        Shard& shard = shard_for(key.key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry& entry = slot_for(key.key);
+        entry.key = key.key;
+        entry.used = true;
+        entry.result = canonical[m];
+    }
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        if (miss_of[i] != kHit) {
+            results[i] = from_canonical(canonical[miss_of[i]], requests[i].board->board_size(), keys[i].symmetry);
+        }
+    }
+    return results;
+}
+
+CachingEvaluator::Stats CachingEvaluator::stats() const noexcept {
+    return Stats{hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed)};
+}
+
+} // namespace search
@@ -0,0 +1,52 @@
+#include "search/MockEvaluator.hpp"
+
+#include <thread>
+#include <utility>
+
+namespace search {
+
+LatencyEvaluator::LatencyEvaluator(LatencyModel model) : model_(model) {}
+
+EvaluationResult LatencyEvaluator::evaluate(const go::Board& board, go::Player to_play) {
+    return std::move(evaluate_batch({EvaluationRequest{&board, to_play}}).front());
+}
+
+std::vector<EvaluationResult> LatencyEvaluator::evaluate_batch(const std::vector<EvaluationRequest>& requests) {
+    std::vector<EvaluationResult> results(requests.size());
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        const std::size_t board_size = requests[i].board->board_size();
+        results[i].policy.assign(board_size * board_size + 1, 1.0f);
+    }
+
+    std::lock_guard<std::mutex> lock(device_mutex_);
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline =
+        start + model_.batch_latency + model_.position_cost * static_cast<std::int64_t>(requests.size());
+    if (model_.spin) {
+        while (std::chrono::steady_clock::now() < deadline) {
+        }
+    } else {
+        std::this_thread::sleep_until(deadline);
+    }
+
+    ++stats_.batches;
+    stats_.positions += requests.size();
+    if (stats_.batch_sizes.size() <= requests.size()) {
+        stats_.batch_sizes.resize(requests.size() + 1, 0);
+    }
+    ++stats_.batch_sizes[requests.size()];
+    stats_.busy_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return results;
+}
+
+LatencyEvaluator::Stats LatencyEvaluator::stats() const {
+    std::lock_guard<std::mutex> lock(device_mutex_);
+    return stats_;
+}
+
+void LatencyEvaluator::reset_stats() {
+    std::lock_guard<std::mutex> lock(device_mutex_);
+    stats_ = Stats{};
+}
+
+} // namespace search
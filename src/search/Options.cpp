@@ -0,0 +1,392 @@
+#include "search/Options.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace search {
+
+namespace {
+
+std::string trim(const std::string& text) {
+    const auto begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return {};
+    }
+    const auto end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::string normalize_name(std::string name) {
+    std::replace(name.begin(), name.end(), '-', '_');
+    return name;
+}
+
+bool parse(const std::string& text, long long& out) {
+    if (text.empty()) {
+        return false;
+    }
+    std::size_t used = 0;
+    try {
+        out = std::stoll(text, &used);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return used == text.size();
+}
+
+bool parse(const std::string& text, int& out) {
+    long long value = 0;
+    if (!parse(text, value) || value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+bool parse(const std::string& text, unsigned int& out) {
+    long long value = 0;
+    if (!parse(text, value) || value < 0 || value > std::numeric_limits<unsigned int>::max()) {
+        return false;
+    }
+    out = static_cast<unsigned int>(value);
+    return true;
+}
+
+bool parse(const std::string& text, std::size_t& out) {
+    long long value = 0;
+    if (!parse(text, value) || value < 0) {
+        return false;
+    }
+    out = static_cast<std::size_t>(value);
+    return true;
+}
+
+bool parse(const std::string& text, double& out) {
+    if (text.empty()) {
+        return false;
+    }
+    std::size_t used = 0;
+    try {
+        out = std::stod(text, &used);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return used == text.size() && std::isfinite(out);
+}
+
+bool parse(const std::string& text, float& out) {
+    double value = 0.0;
+    if (!parse(text, value) || std::abs(value) > std::numeric_limits<float>::max()) {
+        return false;
+    }
+    out = static_cast<float>(value);
+    return true;
+}
+
+bool parse(const std::string& text, bool& out) {
+    if (text == "1" || text == "true" || text == "on") {
+        out = true;
+    } else if (text == "0" || text == "false" || text == "off") {
+        out = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parse(const std::string& text, ParallelMode& out) {
+    if (text == "tree") {
+        out = ParallelMode::TreeParallel;
+    } else if (text == "root") {
+        out = ParallelMode::RootParallel;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parse(const std::string& text, std::string& out) {
+    out = text;
+    return true;
+}
+
+std::string format(bool value) {
+    return value ? "true" : "false";
+}
+
+std::string format(ParallelMode value) {
+    return value == ParallelMode::RootParallel ? "root" : "tree";
+}
+
+std::string format(const std::string& value) {
+    return value;
+}
+
+template <typename T>
+std::string format(T value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+struct OptionSpec {
+    const char* name;
+    bool search; // a SearchConfig field
+    std::function<bool(EngineOptions&, const std::string&)> set;
+    std::function<std::string(const EngineOptions&)> get;
+};
+
+// field(options) returns the option's member for both const and mutable options.
+template <typename Field>
+OptionSpec make_option(const char* name, bool search, Field field) {
+    return {name, search,
+            [field](EngineOptions& options, const std::string& text) { return parse(text, field(options)); },
+            [field](const EngineOptions& options) { return format(field(options)); }};
+}
+
+const std::vector<OptionSpec>& option_table() {
+    static const std::vector<OptionSpec> table = {
+        // A fixed playout count, as TENUKI_MAX_PLAYOUTS sets it: randomization settings
+        // that come after it turn the window back on.
+        {"max_playouts", true,
+         [](EngineOptions& options, const std::string& text) {
+             SearchConfig& config = options.search;
+             if (!parse(text, config.max_playouts)) {
+                 return false;
+             }
+             config.enable_playout_cap_randomization = false;
+             config.random_playouts_min = config.max_playouts;
+             config.random_playouts_max = config.max_playouts;
+             return true;
+         },
+         [](const EngineOptions& options) { return format(options.search.max_playouts); }},
+        make_option("cpuct", true, [](auto& o) -> auto& { return o.search.cpuct; }),
+        make_option("fpu_reduction", true, [](auto& o) -> auto& { return o.search.fpu_reduction; }),
+        make_option("dirichlet_alpha", true, [](auto& o) -> auto& { return o.search.dirichlet_alpha; }),
+        make_option("dirichlet_epsilon", true, [](auto& o) -> auto& { return o.search.dirichlet_epsilon; }),
+        make_option("temperature", true, [](auto& o) -> auto& { return o.search.temperature; }),
+        make_option("temperature_move_cutoff", true, [](auto& o) -> auto& { return o.search.temperature_move_cutoff; }),
+        make_option("enable_playout_cap_randomization", true,
+                    [](auto& o) -> auto& { return o.search.enable_playout_cap_randomization; }),
+        make_option("random_playouts_min", true, [](auto& o) -> auto& { return o.search.random_playouts_min; }),
+        make_option("random_playouts_max", true, [](auto& o) -> auto& { return o.search.random_playouts_max; }),
+        make_option("seed", true, [](auto& o) -> auto& { return o.search.seed; }),
+        make_option("num_threads", true, [](auto& o) -> auto& { return o.search.num_threads; }),
+        make_option("use_virtual_loss", true, [](auto& o) -> auto& { return o.search.use_virtual_loss; }),
+        make_option("virtual_loss", true, [](auto& o) -> auto& { return o.search.virtual_loss; }),
+        make_option("virtual_loss_visits", true, [](auto& o) -> auto& { return o.search.virtual_loss_visits; }),
+        make_option("parallel_mode", true, [](auto& o) -> auto& { return o.search.parallel_mode; }),
+        make_option("root_parallel_groups", true, [](auto& o) -> auto& { return o.search.root_parallel_groups; }),
+        make_option("pin_threads", true, [](auto& o) -> auto& { return o.search.pin_threads; }),
+        make_option("numa_local_trees", true, [](auto& o) -> auto& { return o.search.numa_local_trees; }),
+        make_option("collect_stats", true, [](auto& o) -> auto& { return o.search.collect_stats; }),
+        make_option("enable_trace", true, [](auto& o) -> auto& { return o.search.enable_trace; }),
+        make_option("trace_events_per_thread", true, [](auto& o) -> auto& { return o.search.trace_events_per_thread; }),
+        make_option("read_ladders", true, [](auto& o) -> auto& { return o.search.read_ladders; }),
+        make_option("ladder_escape_factor", true, [](auto& o) -> auto& { return o.search.ladder_escape_factor; }),
+        make_option("ladder_capture_factor", true, [](auto& o) -> auto& { return o.search.ladder_capture_factor; }),
+        make_option("prune_pass_alive", true, [](auto& o) -> auto& { return o.search.prune_pass_alive; }),
+        make_option("retained_trees", true, [](auto& o) -> auto& { return o.search.retained_trees; }),
+
+        make_option("board_size", false, [](auto& o) -> auto& { return o.board_size; }),
+        make_option("komi", false, [](auto& o) -> auto& { return o.komi; }),
+        make_option("weights", false, [](auto& o) -> auto& { return o.weights; }),
+        make_option("eval_server", false, [](auto& o) -> auto& { return o.eval_server; }),
+        make_option("nn_threads", false, [](auto& o) -> auto& { return o.nn_threads; }),
+        make_option("nn_conv", false, [](auto& o) -> auto& { return o.nn_conv; }),
+        make_option("nn_precision", false, [](auto& o) -> auto& { return o.nn_precision; }),
+        make_option("nn_calibration", false, [](auto& o) -> auto& { return o.nn_calibration; }),
+        make_option("nn_symmetry", false, [](auto& o) -> auto& { return o.nn_symmetry; }),
+        make_option("eval_cache", false, [](auto& o) -> auto& { return o.eval_cache; }),
+        make_option("eval_batch", false, [](auto& o) -> auto& { return o.eval_batch; }),
+        make_option("rollouts", false, [](auto& o) -> auto& { return o.rollouts; }),
+        make_option("rollout_amaf", false, [](auto& o) -> auto& { return o.rollout_amaf; }),
+        make_option("patterns", false, [](auto& o) -> auto& { return o.patterns; }),
+        make_option("pool_threads", false, [](auto& o) -> auto& { return o.pool_threads; }),
+        make_option("session_threads", false, [](auto& o) -> auto& { return o.session_threads; }),
+    };
+    return table;
+}
+
+const OptionSpec* find_option(const std::string& name) {
+    const std::string wanted = normalize_name(name);
+    for (const OptionSpec& spec : option_table()) {
+        if (wanted == spec.name) {
+            return &spec;
+        }
+    }
+    return nullptr;
+}
+
+// Sets one option without the checks across options, which set_options() and
+// load_options() make once every value is in.
+void assign_option(EngineOptions& options, const std::string& name, const std::string& value) {
+    const OptionSpec* spec = find_option(name);
+    if (!spec) {
+        throw std::invalid_argument("unknown option " + name);
+    }
+    if (!spec->set(options, trim(value))) {
+        throw std::invalid_argument("invalid value for " + std::string(spec->name) + ": " + value);
+    }
+}
+
+double measure_playout_rate(const SearchConfig& config,
+                            const std::shared_ptr<Evaluator>& evaluator,
+                            const go::Board& board,
+                            int rounds) {
+    SearchAgent agent(config, evaluator);
+    agent.search(board, board.to_play(), 0); // warm up threads, caches and allocator
+    std::chrono::nanoseconds elapsed{0};
+    for (int round = 0; round < rounds; ++round) {
+        agent.reset();
+        const auto start = std::chrono::steady_clock::now();
+        agent.search(board, board.to_play(), 0);
+        elapsed += std::chrono::steady_clock::now() - start;
+    }
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0.0 ? static_cast<double>(config.max_playouts) * rounds / seconds : 0.0;
+}
+
+} // namespace
+
+std::vector<std::string> option_names() {
+    std::vector<std::string> names;
+    for (const OptionSpec& spec : option_table()) {
+        names.emplace_back(spec.name);
+    }
+    return names;
+}
+
+bool is_option(const std::string& name) {
+    return find_option(name) != nullptr;
+}
+
+bool is_search_option(const std::string& name) {
+    const OptionSpec* spec = find_option(name);
+    return spec && spec->search;
+}
+
+void set_option(EngineOptions& options, const std::string& name, const std::string& value) {
+    set_options(options, {{name, value}});
+}
+
+void set_options(EngineOptions& options, const std::vector<std::pair<std::string, std::string>>& settings) {
+    EngineOptions updated = options;
+    for (const auto& [name, value] : settings) {
+        assign_option(updated, name, value);
+    }
+    validate_options(updated);
+    options = std::move(updated);
+}
+
+void validate_options(const EngineOptions& options) {
+    const SearchConfig& config = options.search;
+    if (config.max_playouts <= 0) {
+        throw std::invalid_argument("max_playouts must be positive");
+    }
+    for (const auto& [name, value] : {std::pair<const char*, int>{"virtual_loss_visits", config.virtual_loss_visits},
+                                      {"trace_events_per_thread", config.trace_events_per_thread},
+                                      {"retained_trees", config.retained_trees}}) {
+        if (value < 0) {
+            throw std::invalid_argument(std::string(name) + " must not be negative");
+        }
+    }
+    if (config.random_playouts_min > config.random_playouts_max) {
+        throw std::invalid_argument("random_playouts_min exceeds random_playouts_max");
+    }
+}
+
+std::string get_option(const EngineOptions& options, const std::string& name) {
+    const OptionSpec* spec = find_option(name);
+    if (!spec) {
+        throw std::invalid_argument("unknown option " + name);
+    }
+    return spec->get(options);
+}
+
+void load_options(EngineOptions& options, std::istream& in) {
+    EngineOptions updated = options;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        const auto equals = line.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument("line " + std::to_string(line_number) + ": expected name = value");
+        }
+        try {
+            assign_option(updated, trim(line.substr(0, equals)), line.substr(equals + 1));
+        } catch (const std::invalid_argument& ex) {
+            throw std::invalid_argument("line " + std::to_string(line_number) + ": " + ex.what());
+        }
+    }
+    validate_options(updated);
+    options = std::move(updated);
+}
+
+void load_options_file(EngineOptions& options, const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot read config file " + path);
+    }
+    try {
+        load_options(options, in);
+    } catch (const std::invalid_argument& ex) {
+        throw std::invalid_argument(path + ", " + ex.what());
+    }
+}
+
+std::string format_options(const EngineOptions& options) {
+    std::ostringstream out;
+    for (const OptionSpec& spec : option_table()) {
+        out << spec.name << " = " << spec.get(options) << "\n";
+    }
+    return out.str();
+}
+
+AutotuneResult autotune_threads(const SearchConfig& config,
+                                std::shared_ptr<Evaluator> evaluator,
+                                const go::Board& board,
+                                int max_threads,
+                                int playouts) {
+    if (max_threads <= 0) {
+        max_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    SearchConfig trial = config;
+    trial.max_playouts = std::max(1, playouts);
+    trial.enable_playout_cap_randomization = false;
+    trial.collect_stats = false;
+    trial.enable_trace = false;
+    trial.retained_trees = 0;
+
+    AutotuneResult result;
+    double best_rate = 0.0;
+    for (int threads = 1;; threads = std::min(threads * 2, max_threads)) {
+        trial.num_threads = threads;
+        const double rate = measure_playout_rate(trial, evaluator, board, 3);
+        result.timings.push_back({threads, rate});
+        if (rate > best_rate * 1.05) {
+            best_rate = rate;
+            result.threads = threads;
+        }
+        if (threads == max_threads) {
+            break;
+        }
+    }
+    return result;
+}
+
+} // namespace search
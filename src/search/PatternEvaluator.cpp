@@ -0,0 +1,201 @@
+#include "search/PatternEvaluator.hpp"
+
+#include "go/Pattern.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace search {
+
+namespace {
+
+constexpr std::array<char, 4> kMagic{'T', 'N', 'K', 'P'};
+constexpr std::uint32_t kVersion = 1;
+
+std::uint32_t read_u32(std::istream& in) {
+    std::array<unsigned char, 4> bytes{};
+    if (!in.read(reinterpret_cast<char*>(bytes.data()), 4)) {
+        throw std::runtime_error("pattern table truncated");
+    }
+    return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+           (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+float read_f32(std::istream& in) {
+    const std::uint32_t bits = read_u32(in);
+    float value = 0.0f;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void write_u32(std::ostream& out, std::uint32_t value) {
+    const std::array<char, 4> bytes{static_cast<char>(value & 0xffu), static_cast<char>((value >> 8) & 0xffu),
+                                    static_cast<char>((value >> 16) & 0xffu), static_cast<char>((value >> 24) & 0xffu)};
+    out.write(bytes.data(), 4);
+}
+
+void write_f32(std::ostream& out, float value) {
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    write_u32(out, bits);
+}
+
+std::uint32_t canonical_pattern(std::uint32_t code) {
+    std::uint32_t canonical = code;
+    for (int s = 1; s < go::kSymmetries; ++s) {
+        canonical = std::min(canonical, go::transform_pattern(code, s));
+    }
+    return canonical;
+}
+
+} // namespace
+
+PatternWeights::PatternWeights(const std::vector<std::pair<std::uint32_t, float>>& entries, float pass_weight)
+    : pass_weight_(pass_weight) {
+    if (!std::isfinite(pass_weight)) {
+        throw std::invalid_argument("pattern pass weight must be finite");
+    }
+    // Every orientation of every entry; the stable sort keeps later entries last.
+    std::vector<std::pair<std::uint32_t, float>> expanded;
+    expanded.reserve(entries.size() * static_cast<std::size_t>(go::kSymmetries));
+    for (const auto& [code, weight] : entries) {
+        if (code >= go::kPatternCount) {
+            throw std::invalid_argument("pattern code out of range");
+        }
+        if (!std::isfinite(weight)) {
+            throw std::invalid_argument("pattern weight must be finite");
+        }
+        for (int s = 0; s < go::kSymmetries; ++s) {
+            expanded.emplace_back(go::transform_pattern(code, s), weight);
+        }
+    }
+    std::stable_sort(expanded.begin(), expanded.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (std::size_t i = 0; i < expanded.size(); ++i) {
+        if (i + 1 < expanded.size() && expanded[i + 1].first == expanded[i].first) {
+            continue;
+        }
+        codes_.push_back(expanded[i].first);
+        weights_.push_back(expanded[i].second);
+    }
+}
+
+float PatternWeights::weight(std::uint32_t code) const noexcept {
+    const auto it = std::lower_bound(codes_.begin(), codes_.end(), code);
+    return it != codes_.end() && *it == code ? weights_[static_cast<std::size_t>(it - codes_.begin())] : 0.0f;
+}
+
+std::vector<std::pair<std::uint32_t, float>> PatternWeights::canonical_entries() const {
+    std::vector<std::pair<std::uint32_t, float>> entries;
+    for (std::size_t i = 0; i < codes_.size(); ++i) {
+        if (canonical_pattern(codes_[i]) == codes_[i]) {
+            entries.emplace_back(codes_[i], weights_[i]);
+        }
+    }
+    return entries;
+}
+
+PatternWeights load_pattern_weights(std::istream& in) {
+    std::array<char, 4> magic{};
+    if (!in.read(magic.data(), 4) || magic != kMagic) {
+        throw std::runtime_error("not a tenuki pattern table");
+    }
+    const std::uint32_t version = read_u32(in);
+    if (version != kVersion) {
+        throw std::runtime_error("unsupported pattern table version " + std::to_string(version));
+    }
+    const std::uint32_t count = read_u32(in);
+    if (count > go::kPatternCount) {
+        throw std::runtime_error("pattern table too large");
+    }
+    const float pass_weight = read_f32(in);
+    std::vector<std::pair<std::uint32_t, float>> entries(count);
+    for (auto& [code, weight] : entries) {
+        code = read_u32(in);
+        weight = read_f32(in);
+    }
+    try {
+        return PatternWeights(entries, pass_weight);
+    } catch (const std::invalid_argument& ex) {
+        throw std::runtime_error(std::string("invalid pattern table: ") + ex.what());
+    }
+}
+
+PatternWeights load_pattern_weights_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open pattern table: " + path);
+    }
+    return load_pattern_weights(in);
+}
+
+void save_pattern_weights(const PatternWeights& weights, std::ostream& out) {
+    const auto entries = weights.canonical_entries();
+    out.write(kMagic.data(), 4);
+    write_u32(out, kVersion);
+    write_u32(out, static_cast<std::uint32_t>(entries.size()));
+    write_f32(out, weights.pass_weight());
+    for (const auto& [code, weight] : entries) {
+        write_u32(out, code);
+        write_f32(out, weight);
+    }
+}
+
+PatternEvaluator::PatternEvaluator(PatternWeights weights, std::shared_ptr<Evaluator> value_source)
+    : weights_(std::move(weights)), value_source_(std::move(value_source)) {}
+
+EvaluationResult PatternEvaluator::evaluate(const go::Board& board, go::Player to_play) {
+    EvaluationResult result;
+    if (value_source_) {
+        result.value = value_source_->evaluate(board, to_play).value;
+    }
+    priors(board, to_play, result.policy);
+    return result;
+}
+
+std::vector<EvaluationResult> PatternEvaluator::evaluate_batch(const std::vector<EvaluationRequest>& requests) {
+    std::vector<EvaluationResult> results;
+    if (value_source_) {
+        results = value_source_->evaluate_batch(requests);
+    } else {
+        results.resize(requests.size());
+    }
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        priors(*requests[i].board, requests[i].to_play, results[i].policy);
+    }
+    return results;
+}
+
+void PatternEvaluator::priors(const go::Board& board, go::Player to_play, std::vector<float>& policy) const {
+    const std::size_t area = board.board_size() * board.board_size();
+    const bool tracked = board.tracks_patterns();
+    policy.assign(area + 1, 0.0f);
+    // Weights first, then exponentiate relative to the largest to stay in range.
+    float largest = weights_.pass_weight();
+    for (std::size_t vertex = 0; vertex < area; ++vertex) {
+        if (board.point_state(vertex) != go::PointState::Empty) {
+            continue;
+        }
+        const std::uint32_t code = tracked ? board.pattern(vertex) : go::compute_pattern(board, vertex);
+        policy[vertex] = weights_.weight(go::pattern_for_player(code, to_play));
+        largest = std::max(largest, policy[vertex]);
+    }
+    policy[area] = weights_.pass_weight();
+    float total = 0.0f;
+    for (std::size_t vertex = 0; vertex <= area; ++vertex) {
+        if (vertex < area && board.point_state(vertex) != go::PointState::Empty) {
+            continue;
+        }
+        policy[vertex] = std::exp(policy[vertex] - largest);
+        total += policy[vertex];
+    }
+    for (float& prior : policy) {
+        prior /= total;
+    }
+}
+
+} // namespace search
@@ -0,0 +1,145 @@
+#include "search/RolloutEvaluator.hpp"
+
+#include "go/PassAlive.hpp"
+#include "go/PlayoutBoard.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <stdexcept>
+
+namespace search {
+namespace {
+
+constexpr std::size_t kMaxVertices = go::PlayoutBoard::kMaxSize * go::PlayoutBoard::kMaxSize;
+
+// Evaluator ids start at 1, so a fresh scratch belongs to none. Addresses would not do:
+// an evaluator built where an old one lived would inherit its random stream.
+std::atomic<std::uint64_t> next_evaluator_id{1};
+
+// Per-thread playout state; reseeded when a thread starts serving another evaluator.
+struct PlayoutScratch {
+    std::uint64_t owner = 0;
+    go::PlayoutRng rng;
+    go::PlayoutBoard start;
+    go::PlayoutBoard board;
+    std::array<std::uint8_t, kMaxVertices> first_mover{}; // 0 none, 1 + go::Player
+    std::array<std::int8_t, kMaxVertices> ownership{};
+};
+
+} // namespace
+
+RolloutEvaluator::RolloutEvaluator(RolloutConfig config)
+    : config_(config), id_(next_evaluator_id.fetch_add(1, std::memory_order_relaxed)) {
+    if (config_.playouts <= 0) {
+        throw std::invalid_argument("rollout evaluator needs at least one playout");
+    }
+}
+
+EvaluationResult RolloutEvaluator::evaluate(const go::Board& board, go::Player to_play) {
+    const std::size_t area = board.board_size() * board.board_size();
+    EvaluationResult result;
+    if (!config_.amaf_policy) {
+        result.value = rollouts(board, to_play).value;
+        result.policy.assign(area + 1, 1.0f / static_cast<float>(area + 1));
+        return result;
+    }
+
+    // Laplace-smoothed AMAF win rate per point; points the side to move never reached
+    // keep an even prior and pass gets the weight of a point that always loses.
+    const Rollouts stats = rollouts(board, to_play);
+    result.value = stats.value;
+    result.policy.resize(area + 1);
+    float total = 0.0f;
+    for (std::size_t vertex = 0; vertex < area; ++vertex) {
+        result.policy[vertex] = (stats.amaf_wins[vertex] + 1.0f) / (stats.amaf_games[vertex] + 2.0f);
+        total += result.policy[vertex];
+    }
+    result.policy[area] = 1.0f / (static_cast<float>(config_.playouts) + 2.0f);
+    total += result.policy[area];
+    for (float& prior : result.policy) {
+        prior /= total;
+    }
+    return result;
+}
+
+RolloutEvaluator::Rollouts RolloutEvaluator::rollouts(const go::Board& board, go::Player to_play) {
+    thread_local PlayoutScratch scratch;
+    if (scratch.owner != id_) {
+        scratch.owner = id_;
+        const std::uint64_t stream = streams_.fetch_add(1, std::memory_order_relaxed);
+        scratch.rng = go::PlayoutRng(config_.seed + 0x9e3779b97f4a7c15ull * (stream + 1));
+    }
+
+    const std::size_t area = board.board_size() * board.board_size();
+    const int max_moves = config_.max_moves > 0 ? config_.max_moves : 3 * static_cast<int>(area);
+    const std::uint8_t mover = static_cast<std::uint8_t>(1 + static_cast<int>(to_play));
+    Rollouts out;
+    out.ownership.assign(area, 0.0f);
+    out.amaf_wins.assign(area, 0.0f);
+    out.amaf_games.assign(area, 0.0f);
+
+    scratch.start.reset(board, to_play);
+    if (config_.settle_pass_alive) {
+        const go::PassAliveMap& pass_alive = go::pass_alive_map(board);
+        if (pass_alive.settled_count() > 0) {
+            scratch.start.settle(pass_alive.owners());
+        }
+    }
+    double outcome_sum = 0.0;
+    double score_sum = 0.0;
+    for (int game = 0; game < config_.playouts; ++game) {
+        scratch.board = scratch.start;
+        std::fill(scratch.first_mover.begin(), scratch.first_mover.begin() + static_cast<std::ptrdiff_t>(area), 0);
+        int passes = 0;
+        int moves = 0;
+        while (passes < 2 && moves < max_moves) {
+            const go::Player player = scratch.board.to_play();
+            const int point = scratch.board.play_random(scratch.rng);
+            if (point < 0) {
+                ++passes;
+            } else {
+                passes = 0;
+                std::uint8_t& first = scratch.first_mover[scratch.board.unpadded(point)];
+                if (first == 0) {
+                    first = static_cast<std::uint8_t>(1 + static_cast<int>(player));
+                }
+            }
+            ++moves;
+        }
+        out.moves += moves;
+
+        const float score = scratch.board.score(scratch.ownership.data());
+        const float black_outcome = score > 0.0f ? 1.0f : score < 0.0f ? -1.0f : 0.0f;
+        const float outcome = to_play == go::Player::Black ? black_outcome : -black_outcome;
+        outcome_sum += outcome;
+        score_sum += score;
+        const float win = 0.5f * (outcome + 1.0f);
+        for (std::size_t vertex = 0; vertex < area; ++vertex) {
+            out.ownership[vertex] += static_cast<float>(scratch.ownership[vertex]);
+            if (scratch.first_mover[vertex] == mover) {
+                out.amaf_wins[vertex] += win;
+                out.amaf_games[vertex] += 1.0f;
+            }
+        }
+    }
+
+    const float games = static_cast<float>(config_.playouts);
+    out.value = static_cast<float>(outcome_sum / config_.playouts);
+    out.mean_score = static_cast<float>(score_sum / config_.playouts);
+    for (float& owner : out.ownership) {
+        owner /= games;
+    }
+    playouts_.fetch_add(static_cast<std::uint64_t>(config_.playouts), std::memory_order_relaxed);
+    moves_.fetch_add(static_cast<std::uint64_t>(out.moves), std::memory_order_relaxed);
+    return out;
+}
+
+RolloutEvaluator::Counters RolloutEvaluator::counters() const noexcept {
+    Counters counters;
+    counters.playouts = playouts_.load(std::memory_order_relaxed);
+    counters.moves = moves_.load(std::memory_order_relaxed);
+    return counters;
+}
+
+} // namespace search
@@ -0,0 +1,188 @@
+#include "search/Scheduler.hpp"
+
+#include <algorithm>
+
+namespace search {
+
+SearchScheduler::SearchScheduler(SchedulerOptions options) : options_(options) {
+    options_.slice_steps = std::max(1, options_.slice_steps);
+    int threads = options_.threads;
+    if (threads <= 0) {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    queues_.reserve(static_cast<std::size_t>(threads));
+    for (int t = 0; t < threads; ++t) {
+        queues_.push_back(std::make_unique<Worker>());
+    }
+    workers_.reserve(static_cast<std::size_t>(threads));
+    for (int t = 0; t < threads; ++t) {
+        workers_.emplace_back([this, t]() { worker_loop(t); });
+    }
+}
+
+SearchScheduler::~SearchScheduler() {
+    {
+        std::scoped_lock lock(idle_mutex_);
+        stopping_ = true;
+    }
+    idle_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+SearchScheduler::JobStats SearchScheduler::run(const std::function<bool(int)>& step, int max_parallel) {
+    Job job;
+    job.step = &step;
+    job.submitted = std::chrono::steady_clock::now();
+    const int tickets = std::clamp(max_parallel, 1, threads());
+    job.tickets = tickets;
+    jobs_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::scoped_lock lock(inject_mutex_);
+        for (int i = 0; i < tickets; ++i) {
+            injected_.push_back(&job);
+        }
+    }
+    queued_.fetch_add(tickets);
+    for (int i = 0; i < tickets; ++i) {
+        wake_one();
+    }
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(job.mutex);
+        job.finished.wait(lock, [&job]() { return job.tickets == 0; });
+        error = job.error;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    JobStats stats;
+    const auto end = std::chrono::steady_clock::now();
+    stats.wall = end - job.submitted;
+    stats.queue_wait = job.started.load() ? job.first_step - job.submitted : stats.wall;
+    stats.steps = job.steps.load(std::memory_order_relaxed);
+    stats.slices = job.slices.load(std::memory_order_relaxed);
+    return stats;
+}
+
+SearchScheduler::Counters SearchScheduler::counters() const noexcept {
+    Counters counters;
+    counters.jobs = jobs_.load(std::memory_order_relaxed);
+    counters.slices = slices_.load(std::memory_order_relaxed);
+    counters.steps = steps_.load(std::memory_order_relaxed);
+    counters.steals = steals_.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void SearchScheduler::worker_loop(int index) {
+    while (true) {
+        Job* job = take(index);
+        if (!job) {
+            std::unique_lock<std::mutex> lock(idle_mutex_);
+            sleeping_.fetch_add(1);
+            while (!stopping_ && queued_.load() == 0) {
+                idle_.wait(lock);
+            }
+            sleeping_.fetch_sub(1);
+            if (stopping_ && queued_.load() == 0) {
+                return;
+            }
+            continue;
+        }
+
+        if (!job->started.exchange(true)) {
+            job->first_step = std::chrono::steady_clock::now();
+        }
+        std::uint64_t ran = 0;
+        std::exception_ptr error;
+        try {
+            for (int i = 0; i < options_.slice_steps && !job->done.load(std::memory_order_relaxed); ++i) {
+                ++ran;
+                if (!(*job->step)(index)) {
+                    job->done.store(true, std::memory_order_relaxed);
+                }
+            }
+        } catch (...) {
+            error = std::current_exception();
+            job->done.store(true, std::memory_order_relaxed);
+        }
+        job->steps.fetch_add(ran, std::memory_order_relaxed);
+        job->slices.fetch_add(1, std::memory_order_relaxed);
+        steps_.fetch_add(ran, std::memory_order_relaxed);
+        slices_.fetch_add(1, std::memory_order_relaxed);
+
+        if (job->done.load(std::memory_order_relaxed)) {
+            release(job, error);
+        } else {
+            requeue(index, job);
+        }
+    }
+}
+
+SearchScheduler::Job* SearchScheduler::take(int index) {
+    Job* job = nullptr;
+    {
+        std::scoped_lock lock(inject_mutex_);
+        if (!injected_.empty()) {
+            job = injected_.front();
+            injected_.pop_front();
+        }
+    }
+    if (!job) {
+        Worker& own = *queues_[static_cast<std::size_t>(index)];
+        std::scoped_lock lock(own.mutex);
+        if (!own.tickets.empty()) {
+            job = own.tickets.front();
+            own.tickets.pop_front();
+        }
+    }
+    const std::size_t count = queues_.size();
+    for (std::size_t k = 1; !job && k < count; ++k) {
+        Worker& victim = *queues_[(static_cast<std::size_t>(index) + k) % count];
+        std::scoped_lock lock(victim.mutex);
+        if (!victim.tickets.empty()) {
+            job = victim.tickets.back();
+            victim.tickets.pop_back();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (job) {
+        queued_.fetch_sub(1);
+    }
+    return job;
+}
+
+void SearchScheduler::requeue(int index, Job* job) {
+    Worker& own = *queues_[static_cast<std::size_t>(index)];
+    {
+        std::scoped_lock lock(own.mutex);
+        own.tickets.push_back(job);
+    }
+    queued_.fetch_add(1);
+    wake_one();
+}
+
+void SearchScheduler::release(Job* job, std::exception_ptr error) {
+    // Notify under the lock: run() may destroy the job as soon as it can take it.
+    std::scoped_lock lock(job->mutex);
+    if (error && !job->error) {
+        job->error = error;
+    }
+    if (--job->tickets == 0) {
+        job->finished.notify_all();
+    }
+}
+
+void SearchScheduler::wake_one() {
+    // queued_ was raised before this check and sleepers raise sleeping_ before testing
+    // queued_, so a worker about to sleep either sees the ticket or gets the notify.
+    if (sleeping_.load() > 0) {
+        std::scoped_lock lock(idle_mutex_);
+        idle_.notify_one();
+    }
+}
+
+} // namespace search
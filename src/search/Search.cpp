@@ -1,8 +1,13 @@
 #include "search/Search.hpp"
 
+#include "go/Ladder.hpp"
+#include "go/PassAlive.hpp"
+
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cmath>
+#include <functional>
 #include <limits>
 #include <numeric>
 #include <random>
@@ -14,8 +19,104 @@ namespace {
 
 constexpr float kEpsilon = 1e-8f;
 
+#if TENUKI_SEARCH_STATS
+thread_local SearchStats* t_stats = nullptr;
+#endif
+
+// Whether vertex touches an own chain in atari (an escape) or an opponent chain with
+// two liberties (a ladder start); everything else needs no reading.
+bool ladder_candidate(const go::Board& board, go::Player player, std::size_t vertex) {
+    const std::size_t size = board.board_size();
+    const go::PointState own = go::to_point(player);
+    const auto touches = [&](std::size_t n) {
+        const go::PointState state = board.point_state(n);
+        const int liberties = board.liberties(n);
+        return state == own ? liberties == 1 : state != go::PointState::Empty && liberties == 2;
+    };
+    const std::size_t x = vertex % size;
+    const std::size_t y = vertex / size;
+    return (x > 0 && touches(vertex - 1)) || (x + 1 < size && touches(vertex + 1)) ||
+           (y > 0 && touches(vertex - size)) || (y + 1 < size && touches(vertex + size));
+}
+
+// Simulations copy the root board on every playout, so a board keeping the game's undo
+// log would copy that log each time and grow it by every simulated move. Returns the
+// board to search from: `board` itself, or a copy without the log held in `unlogged`.
+const go::Board& without_undo_log(const go::Board& board, std::optional<go::Board>& unlogged) {
+    if (!board.keeps_undo_log()) {
+        return board;
+    }
+    unlogged.emplace(board);
+    unlogged->set_undo_log(false);
+    return *unlogged;
+}
+
+SearchStats* current_stats() noexcept {
+#if TENUKI_SEARCH_STATS
+    return t_stats;
+#else
+    return nullptr;
+#endif
+}
+
+// Routes the calling thread's counters into `stats` for the lifetime of the scope.
+class StatsScope {
+public:
+    explicit StatsScope(SearchStats* stats) noexcept {
+#if TENUKI_SEARCH_STATS
+        t_stats = stats;
+#else
+        (void)stats;
+#endif
+    }
+
+    ~StatsScope() {
+#if TENUKI_SEARCH_STATS
+        t_stats = nullptr;
+#endif
+    }
+
+    StatsScope(const StatsScope&) = delete;
+    StatsScope& operator=(const StatsScope&) = delete;
+};
+
+// Locks a node mutex, timing and tracing the wait when it is contended and instrumentation is on.
+std::unique_lock<std::mutex> lock_node(std::mutex& mutex) {
+#if TENUKI_SEARCH_STATS || TENUKI_SEARCH_TRACE
+    SearchStats* stats = current_stats();
+    if (stats || trace_active()) {
+        std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            PhaseTimer timer(stats, SearchPhase::MutexWait);
+            TraceSpan span(TraceEvent::MutexWait);
+            lock.lock();
+        }
+        return lock;
+    }
+#endif
+    return std::unique_lock<std::mutex>(mutex);
+}
+
+void record_simulation(SearchStats* stats, std::size_t depth) noexcept {
+    if (!stats) {
+        return;
+    }
+    stats->simulations += 1;
+    stats->depth_sum += depth;
+    stats->max_depth = std::max<std::uint64_t>(stats->max_depth, depth);
+}
+
 } // namespace
 
+std::vector<EvaluationResult> Evaluator::evaluate_batch(const std::vector<EvaluationRequest>& requests) {
+    std::vector<EvaluationResult> results;
+    results.reserve(requests.size());
+    for (const EvaluationRequest& request : requests) {
+        results.push_back(evaluate(*request.board, request.to_play));
+    }
+    return results;
+}
+
 EvaluationResult UniformEvaluator::evaluate(const go::Board& board, go::Player /*to_play*/) {
     const std::size_t board_size = board.board_size();
     const std::size_t total_moves = board_size * board_size + 1; // include pass
@@ -30,56 +131,236 @@ SearchAgent::SearchAgent(SearchConfig config, std::shared_ptr<Evaluator> evaluat
     if (!evaluator_) {
         evaluator_ = std::make_shared<UniformEvaluator>();
     }
+    if (config_.pin_threads || config_.numa_local_trees) {
+        topology_ = detect_topology();
+    }
+    if (config_.enable_trace && TENUKI_SEARCH_TRACE) {
+        trace_ = std::make_unique<TraceRecorder>(static_cast<std::size_t>(std::max(16, config_.trace_events_per_thread)));
+    }
+}
+
+void SearchAgent::set_config(const SearchConfig& config) {
+    const bool reseed = config.seed != config_.seed;
+    const bool had_topology = config_.pin_threads || config_.numa_local_trees;
+    config_ = config;
+    if (reseed) {
+        rng_.seed(config_.seed);
+    }
+    if ((config_.pin_threads || config_.numa_local_trees) && !had_topology) {
+        topology_ = detect_topology();
+    }
+    if (config_.enable_trace && TENUKI_SEARCH_TRACE) {
+        if (!trace_) {
+            trace_ = std::make_unique<TraceRecorder>(
+                static_cast<std::size_t>(std::max(16, config_.trace_events_per_thread)));
+        }
+    } else {
+        trace_.reset();
+    }
+    const std::size_t keep = static_cast<std::size_t>(std::max(0, config_.retained_trees));
+    if (retained_.size() > keep) {
+        retained_.erase(retained_.begin(), retained_.end() - static_cast<std::ptrdiff_t>(keep));
+    }
 }
 
 std::shared_ptr<Evaluator> make_uniform_evaluator() {
     return std::make_shared<UniformEvaluator>();
 }
 
+std::vector<RootMoveStats> merge_tree_statistics(const std::vector<std::vector<RootMoveStats>>& trees) {
+    std::vector<RootMoveStats> stats;
+    std::vector<int> trees_with_move;
+    std::unordered_map<int, std::size_t> index;
+    for (const std::vector<RootMoveStats>& tree : trees) {
+        for (const RootMoveStats& child : tree) {
+            auto [it, inserted] = index.try_emplace(child.move, stats.size());
+            if (inserted) {
+                stats.push_back(child);
+                trees_with_move.push_back(1);
+                continue;
+            }
+            RootMoveStats& entry = stats[it->second];
+            entry.prior += child.prior;
+            entry.visit_count += child.visit_count;
+            entry.value_sum += child.value_sum;
+            trees_with_move[it->second] += 1;
+        }
+    }
+    for (std::size_t i = 0; i < stats.size(); ++i) {
+        stats[i].prior /= static_cast<float>(trees_with_move[i]);
+    }
+    return stats;
+}
+
+void merge_root_statistics(std::vector<RootMoveStats>& stats, const std::vector<RootMoveStats>& extra) {
+    if (extra.empty()) {
+        return;
+    }
+    std::unordered_map<int, std::size_t> index;
+    for (std::size_t i = 0; i < stats.size(); ++i) {
+        index[stats[i].move] = i;
+    }
+    for (const RootMoveStats& entry : extra) {
+        auto it = index.find(entry.move);
+        if (it == index.end()) {
+            continue;
+        }
+        stats[it->second].visit_count += entry.visit_count;
+        stats[it->second].value_sum += entry.value_sum;
+    }
+}
+
 void SearchAgent::ensure_root(const go::Board& board, go::Player to_play) {
     const std::uint64_t key = state_key(board, to_play);
-    if (!root_ || !root_ready_ || root_hash_ != key) {
-        root_ = std::make_unique<Node>();
-        root_->to_play = to_play;
-        root_->expanded = false;
-        root_->noise_applied = false;
-        root_->visit_count = 0;
-        root_->value_sum = 0.0f;
-        root_->children.clear();
-        root_->move_to_index.clear();
-        root_->virtual_loss_count = 0;
-        root_->expanding = false;
-        root_hash_ = key;
-        root_player_ = to_play;
-        root_ready_ = true;
-    } else {
+    if (root_ && root_ready_ && root_hash_ == key) {
         std::scoped_lock lock(root_->mutex);
         root_->to_play = to_play;
+    } else {
+        notify_position(board, to_play);
+        if (!root_) {
+            root_ = std::make_unique<Node>();
+            root_->to_play = to_play;
+            root_ready_ = true;
+        }
     }
 
     if (root_) {
-        if (!root_->expanded) {
-            float unused_value = 0.0f;
-            (void)try_expand(*root_, board, unused_value);
-        }
-
-        if (config_.dirichlet_epsilon > 0.0f) {
-            bool needs_noise = false;
-            {
-                std::unique_lock<std::mutex> lock(root_->mutex);
-                if (!root_->noise_applied && !root_->children.empty()) {
-                    root_->noise_applied = true;
-                    needs_noise = true;
-                }
-            }
-            if (needs_noise) {
-                apply_dirichlet_noise(*root_, rng_);
+        prepare_root(*root_, board, rng_);
+    }
+}
+
+void SearchAgent::retain_tree(std::uint64_t key,
+                              std::unique_ptr<Node> tree,
+                              std::optional<int> played_move,
+                              std::uint64_t played_key) {
+    if (!tree || config_.retained_trees <= 0 || tree->visit_count == 0) {
+        return;
+    }
+    std::erase_if(retained_, [key](const RetainedTree& entry) { return entry.key == key; });
+    retained_.push_back({key, std::move(tree), played_move, played_key});
+    const std::size_t limit = static_cast<std::size_t>(config_.retained_trees);
+    if (retained_.size() > limit) {
+        retained_.erase(retained_.begin(), retained_.end() - static_cast<std::ptrdiff_t>(limit));
+    }
+}
+
+std::unique_ptr<SearchAgent::Node> SearchAgent::restore_tree(std::uint64_t key) {
+    const auto take = [this](std::uint64_t wanted) -> std::optional<RetainedTree> {
+        auto it = std::find_if(retained_.begin(), retained_.end(),
+                               [wanted](const RetainedTree& entry) { return entry.key == wanted; });
+        if (it == retained_.end()) {
+            return std::nullopt;
+        }
+        RetainedTree entry = std::move(*it);
+        retained_.erase(it);
+        return entry;
+    };
+
+    std::optional<RetainedTree> entry = take(key);
+    if (!entry) {
+        return nullptr;
+    }
+    std::unique_ptr<Node> root = std::move(entry->root);
+    // Hang the retained trees of the line played from here back under their moves, so
+    // stepping forward again after several undos descends into them as usual.
+    Node* node = root.get();
+    std::optional<int> played_move = entry->played_move;
+    std::uint64_t played_key = entry->played_key;
+    while (played_move) {
+        auto it = node->move_to_index.find(*played_move);
+        if (it == node->move_to_index.end() || node->children[it->second].node) {
+            break;
+        }
+        std::optional<RetainedTree> next = take(played_key);
+        if (!next) {
+            break;
+        }
+        node->children[it->second].node = std::move(next->root);
+        node = node->children[it->second].node.get();
+        played_move = next->played_move;
+        played_key = next->played_key;
+    }
+    return root;
+}
+
+void SearchAgent::prepare_root(Node& root, const go::Board& board, std::mt19937& rng) {
+    if (!root.expanded) {
+        float unused_value = 0.0f;
+        (void)try_expand(root, board, unused_value);
+    }
+
+    if (config_.dirichlet_epsilon > 0.0f) {
+        bool needs_noise = false;
+        {
+            std::unique_lock<std::mutex> lock(root.mutex);
+            if (!root.noise_applied && !root.children.empty()) {
+                root.noise_applied = true;
+                needs_noise = true;
             }
         }
+        if (needs_noise) {
+            apply_dirichlet_noise(root, rng);
+        }
+    }
+}
+
+int SearchAgent::tree_group_count(int thread_count) const {
+    if (config_.numa_local_trees && topology_.is_numa() && thread_count > 1) {
+        // Each node grows its own tree so nodes are first touched by that node's workers.
+        return std::min(static_cast<int>(topology_.numa_nodes.size()), thread_count);
+    }
+    if (config_.parallel_mode != ParallelMode::RootParallel || thread_count <= 1) {
+        return 1;
+    }
+    if (config_.root_parallel_groups <= 0) {
+        return thread_count;
+    }
+    return std::min(config_.root_parallel_groups, thread_count);
+}
+
+int SearchAgent::worker_cpu(int worker_index, int group) const {
+    const bool numa_trees = config_.numa_local_trees && topology_.is_numa();
+    if (!config_.pin_threads && !numa_trees) {
+        return -1;
+    }
+    const int node_count = static_cast<int>(topology_.numa_nodes.size());
+    const int node = numa_trees ? group : worker_index % node_count;
+    return cpu_for_worker(topology_, static_cast<std::size_t>(node), worker_index / node_count);
+}
+
+void SearchAgent::ensure_group_roots(const go::Board& board, int group_count, int move_number) {
+    // Group 0 is root_ itself; the remaining groups each own an independent tree with its own noise.
+    const std::size_t extra = static_cast<std::size_t>(std::max(0, group_count - 1));
+    if (group_roots_.size() > extra) {
+        group_roots_.resize(extra);
+    }
+    while (group_roots_.size() < extra) {
+        group_roots_.push_back(nullptr);
+    }
+
+    for (std::size_t g = 0; g < group_roots_.size(); ++g) {
+        std::unique_ptr<Node>& group_root = group_roots_[g];
+        if (!group_root) {
+            group_root = std::make_unique<Node>();
+        }
+        group_root->to_play = root_player_;
+        const unsigned int seed = config_.seed ^ (static_cast<unsigned int>(g + 1) * 0x85ebca6bu) ^
+                                  static_cast<unsigned int>(move_number * 31);
+        std::mt19937 group_rng(seed);
+        prepare_root(*group_root, board, group_rng);
     }
 }
 
 go::Move SearchAgent::select_move(const go::Board& board, go::Player to_play, int move_number) {
+    const std::vector<RootMoveStats> stats = search(board, to_play, move_number);
+    return select_move_from_stats(stats, move_number, rng_);
+}
+
+std::vector<RootMoveStats> SearchAgent::search(const go::Board& game_board, go::Player to_play, int move_number) {
+    TraceThreadScope trace_scope(trace_.get(), 0);
+    TraceSpan search_span(TraceEvent::Search);
+    std::optional<go::Board> unlogged;
+    const go::Board& board = without_undo_log(game_board, unlogged);
     ensure_root(board, to_play);
 
     int playouts = std::max(1, config_.max_playouts);
@@ -88,10 +369,102 @@ go::Move SearchAgent::select_move(const go::Board& board, go::Player to_play, in
         playouts = dist(rng_);
     }
 
-    const int thread_count = std::max(1, config_.num_threads);
-    if (thread_count <= 1) {
-        for (int i = 0; i < playouts; ++i) {
-            run_simulation(board, rng_);
+    if (contributor_) {
+        contributor_->begin(board, to_play, move_number, playouts);
+    }
+
+    run_playouts(board, move_number, playouts, nullptr, nullptr);
+
+    std::vector<RootMoveStats> stats = root_statistics();
+    if (contributor_) {
+        merge_root_statistics(stats, contributor_->finish());
+    }
+    return stats;
+}
+
+std::vector<RootMoveStats> SearchAgent::analyze(const go::Board& game_board,
+                                                go::Player to_play,
+                                                int move_number,
+                                                const std::atomic<bool>& stop,
+                                                std::chrono::milliseconds interval,
+                                                const AnalysisCallback& report) {
+    TraceThreadScope trace_scope(trace_.get(), 0);
+    TraceSpan search_span(TraceEvent::Search);
+    std::optional<go::Board> unlogged;
+    const go::Board& board = without_undo_log(game_board, unlogged);
+    ensure_root(board, to_play);
+
+    // Sleeping in short slices keeps the answer to stop prompt whatever the interval.
+    constexpr auto kSlice = std::chrono::milliseconds(5);
+    const auto reporter = [&]() {
+        auto next_report = std::chrono::steady_clock::now() + interval;
+        while (!stop.load(std::memory_order_relaxed)) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= next_report) {
+                if (report) {
+                    report(analysis_snapshot());
+                }
+                next_report = now + interval;
+                continue;
+            }
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(kSlice, next_report - now));
+        }
+    };
+    run_playouts(board, move_number, std::numeric_limits<int>::max(), &stop, reporter);
+    return root_statistics();
+}
+
+void SearchAgent::run_playouts(const go::Board& board, int move_number, int playouts,
+                               const std::atomic<bool>* stop, const std::function<void()>& while_running) {
+    const int thread_count = scheduler_ ? (config_.num_threads > 0 ? std::min(config_.num_threads, scheduler_->threads())
+                                                                   : scheduler_->threads())
+                                        : std::max(1, config_.num_threads);
+    const int group_count = tree_group_count(thread_count);
+    ensure_group_roots(board, group_count, move_number);
+    const auto stopped = [stop]() { return stop && stop->load(std::memory_order_relaxed); };
+
+    stats_.clear();
+    const bool collect_stats = TENUKI_SEARCH_STATS && config_.collect_stats;
+    // Pool workers are indexed over the whole pool, not just the ones this search gets.
+    std::vector<SearchStats> worker_stats(
+        static_cast<std::size_t>(scheduler_ ? scheduler_->threads() : thread_count));
+    const auto search_start = std::chrono::steady_clock::now();
+
+    if (scheduler_) {
+        std::atomic<int> counter{0};
+        std::vector<std::mt19937> worker_rngs;
+        worker_rngs.reserve(worker_stats.size());
+        for (std::size_t w = 0; w < worker_stats.size(); ++w) {
+            const unsigned int seed_offset = static_cast<unsigned int>(w + 1) * 0x9e3779b9u;
+            worker_rngs.emplace_back(config_.seed ^ seed_offset ^
+                                     (static_cast<unsigned int>(move_number * 17) + static_cast<unsigned int>(playouts)));
+        }
+        const std::function<bool(int)> step = [&](int worker) {
+            if (stopped()) {
+                return false;
+            }
+            const int idx = counter.fetch_add(1, std::memory_order_relaxed);
+            if (idx >= playouts) {
+                return false;
+            }
+            const std::size_t w = static_cast<std::size_t>(worker);
+            StatsScope stats_scope(collect_stats ? &worker_stats[w] : nullptr);
+            const int group = idx % group_count;
+            Node* tree = group == 0 ? root_.get() : group_roots_[static_cast<std::size_t>(group - 1)].get();
+            run_simulation(board, *tree, worker_rngs[w]);
+            return true;
+        };
+        if (while_running) {
+            std::thread runner([&]() { last_job_ = scheduler_->run(step, thread_count); });
+            while_running();
+            runner.join();
+        } else {
+            last_job_ = scheduler_->run(step, thread_count);
+        }
+    } else if (thread_count <= 1 && !while_running) {
+        StatsScope stats_scope(collect_stats ? &worker_stats[0] : nullptr);
+        for (int i = 0; i < playouts && !stopped(); ++i) {
+            run_simulation(board, *root_, rng_);
         }
     } else {
         std::atomic<int> counter{0};
@@ -99,24 +472,43 @@ go::Move SearchAgent::select_move(const go::Board& board, go::Player to_play, in
         workers.reserve(static_cast<std::size_t>(thread_count));
         for (int t = 0; t < thread_count; ++t) {
             const unsigned int seed_offset = static_cast<unsigned int>(t + 1) * 0x9e3779b9u;
-            const unsigned int seed = config_.seed ^ seed_offset ^ static_cast<unsigned int>(move_number * 17 + playouts);
-            workers.emplace_back([this, &board, playouts, &counter, seed]() {
+            const unsigned int seed = config_.seed ^ seed_offset ^
+                                      (static_cast<unsigned int>(move_number * 17) + static_cast<unsigned int>(playouts));
+            const int group = t % group_count;
+            Node* tree = group == 0 ? root_.get() : group_roots_[static_cast<std::size_t>(group - 1)].get();
+            const int cpu = worker_cpu(t, group);
+            SearchStats* thread_stats = collect_stats ? &worker_stats[static_cast<std::size_t>(t)] : nullptr;
+            workers.emplace_back([this, &board, tree, playouts, &counter, &stopped, seed, cpu, thread_stats, t]() {
+                if (cpu >= 0 && !pin_current_thread(cpu)) {
+                    pin_failures_.fetch_add(1, std::memory_order_relaxed);
+                }
+                StatsScope stats_scope(thread_stats);
+                TraceThreadScope trace_scope(trace_.get(), t + 1);
                 std::mt19937 local_rng(seed);
-                while (true) {
+                while (!stopped()) {
                     const int idx = counter.fetch_add(1, std::memory_order_relaxed);
                     if (idx >= playouts) {
                         break;
                     }
-                    run_simulation(board, local_rng);
+                    run_simulation(board, *tree, local_rng);
                 }
             });
         }
+        if (while_running) {
+            while_running();
+        }
         for (auto& worker : workers) {
             worker.join();
         }
     }
 
-    return select_move_from_root(move_number, rng_);
+    if (collect_stats) {
+        for (const SearchStats& entry : worker_stats) {
+            stats_.merge(entry);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - search_start;
+        stats_.wall_nanoseconds = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
 }
 
 void SearchAgent::notify_move(go::Move move, const go::Board& board_after_move, go::Player to_play) {
@@ -126,46 +518,174 @@ void SearchAgent::notify_move(go::Move move, const go::Board& board_after_move,
         root_hash_ = new_hash;
         root_player_ = to_play;
         root_ready_ = false;
+        group_roots_.clear();
         return;
     }
 
+    TraceThreadScope trace_scope(trace_.get(), 0);
+    TraceSpan reuse_span(TraceEvent::TreeReuse);
     const int move_key = move.is_pass() ? -1 : move.vertex;
-    std::unique_ptr<Node> next_root;
+    auto descend = [move_key, to_play](Node& tree) {
+        std::unique_ptr<Node> next_root;
+        auto it = tree.move_to_index.find(move_key);
+        if (it != tree.move_to_index.end()) {
+            SearchAgent::Child& child = tree.children[it->second];
+            if (child.node) {
+                next_root = std::move(child.node);
+            }
+        }
+        if (next_root) {
+            next_root->to_play = to_play;
+            next_root->noise_applied = false;
+            next_root->virtual_loss_count = 0;
+            for (auto& child : next_root->children) {
+                child.virtual_loss_count = 0;
+            }
+        }
+        return next_root;
+    };
 
-    auto it = root_->move_to_index.find(move_key);
-    if (it != root_->move_to_index.end()) {
-        SearchAgent::Child& child = root_->children[it->second];
-        if (child.node) {
-            next_root = std::move(child.node);
+    std::unique_ptr<Node> parent = std::move(root_);
+    root_ = descend(*parent);
+    if (root_) {
+        std::erase_if(retained_, [new_hash](const RetainedTree& entry) { return entry.key == new_hash; });
+    } else {
+        root_ = restore_tree(new_hash);
+    }
+    retain_tree(root_hash_, std::move(parent), move_key, new_hash);
+    for (auto& group_root : group_roots_) {
+        if (group_root) {
+            group_root = descend(*group_root);
         }
     }
 
-    if (next_root) {
-        root_ = std::move(next_root);
+    root_hash_ = new_hash;
+    root_player_ = to_play;
+    root_ready_ = root_ != nullptr;
+    if (!root_ready_) {
+        group_roots_.clear();
+    }
+}
+
+void SearchAgent::notify_position(const go::Board& board, go::Player to_play) {
+    const std::uint64_t key = state_key(board, to_play);
+    if (root_ && root_ready_ && root_hash_ == key) {
+        return;
+    }
+    if (root_ && root_ready_) {
+        retain_tree(root_hash_, std::move(root_), std::nullopt, 0);
+    }
+    root_ = restore_tree(key);
+    if (root_) {
         root_->to_play = to_play;
-        root_->noise_applied = false;
-        root_->virtual_loss_count = 0;
-        for (auto& child : root_->children) {
-            child.virtual_loss_count = 0;
-        }
-        root_hash_ = new_hash;
-        root_player_ = to_play;
-        root_ready_ = true;
-    } else {
-        root_.reset();
-        root_hash_ = new_hash;
-        root_player_ = to_play;
-        root_ready_ = false;
     }
+    group_roots_.clear();
+    root_hash_ = key;
+    root_player_ = to_play;
+    root_ready_ = root_ != nullptr;
+}
+
+void SearchAgent::set_root_contributor(std::shared_ptr<RootSearchContributor> contributor) {
+    contributor_ = std::move(contributor);
+}
+
+void SearchAgent::set_scheduler(std::shared_ptr<SearchScheduler> scheduler) {
+    scheduler_ = std::move(scheduler);
+}
+
+bool SearchAgent::write_trace(std::ostream& out) const {
+    if (!trace_) {
+        return false;
+    }
+    trace_->write_chrome_trace(out);
+    return true;
 }
 
 void SearchAgent::reset() {
     root_.reset();
+    group_roots_.clear();
+    retained_.clear();
     root_hash_ = 0;
     root_player_ = go::Player::Black;
     root_ready_ = false;
 }
 
+std::vector<RootMoveStats> SearchAgent::root_statistics() const {
+    std::vector<std::vector<RootMoveStats>> trees = tree_statistics();
+    if (trees.size() == 1) {
+        return std::move(trees.front());
+    }
+    return merge_tree_statistics(trees);
+}
+
+std::vector<std::vector<RootMoveStats>> SearchAgent::tree_statistics() const {
+    std::vector<std::vector<RootMoveStats>> trees;
+    if (!root_) {
+        return trees;
+    }
+    const auto collect = [&trees](const Node& root) {
+        std::scoped_lock lock(root.mutex);
+        std::vector<RootMoveStats>& stats = trees.emplace_back();
+        stats.reserve(root.children.size());
+        for (const Child& child : root.children) {
+            RootMoveStats entry;
+            entry.move = child.move;
+            entry.prior = child.prior;
+            entry.visit_count = child.visit_count;
+            entry.value_sum = child.value_sum;
+            stats.push_back(entry);
+        }
+    };
+    collect(*root_);
+    for (const auto& group_root : group_roots_) {
+        if (group_root) {
+            collect(*group_root);
+        }
+    }
+    return trees;
+}
+
+std::vector<MoveAnalysis> SearchAgent::analysis_snapshot(std::size_t pv_length) const {
+    std::vector<MoveAnalysis> moves;
+    for (const RootMoveStats& entry : root_statistics()) {
+        if (entry.visit_count > 0) {
+            moves.push_back(MoveAnalysis{entry, {}});
+        }
+    }
+    std::stable_sort(moves.begin(), moves.end(), [](const MoveAnalysis& a, const MoveAnalysis& b) {
+        return a.stats.visit_count > b.stats.visit_count;
+    });
+
+    for (MoveAnalysis& analysis : moves) {
+        analysis.pv.push_back(analysis.stats.move);
+        // Nodes are only freed between searches, so the pointer stays good once the
+        // parent's lock is released; each step holds a single node lock.
+        const Node* node = nullptr;
+        {
+            std::scoped_lock lock(root_->mutex);
+            auto it = root_->move_to_index.find(analysis.stats.move);
+            if (it != root_->move_to_index.end()) {
+                node = root_->children[it->second].node.get();
+            }
+        }
+        while (node && analysis.pv.size() < pv_length) {
+            std::scoped_lock lock(node->mutex);
+            const Child* best = nullptr;
+            for (const Child& child : node->children) {
+                if (child.visit_count > 0 && (!best || child.visit_count > best->visit_count)) {
+                    best = &child;
+                }
+            }
+            if (!best) {
+                break;
+            }
+            analysis.pv.push_back(best->move);
+            node = best->node.get();
+        }
+    }
+    return moves;
+}
+
 void SearchAgent::apply_dirichlet_noise(Node& node, std::mt19937& rng) {
     std::unique_lock<std::mutex> lock(node.mutex);
     if (node.children.empty()) {
@@ -196,12 +716,14 @@ void SearchAgent::apply_dirichlet_noise(Node& node, std::mt19937& rng) {
     }
 }
 
-float SearchAgent::run_simulation(const go::Board& root_board, std::mt19937& rng) {
+float SearchAgent::run_simulation(const go::Board& root_board, Node& root, std::mt19937& rng) {
+    TraceSpan span(TraceEvent::Simulation);
     go::Board board_copy(root_board);
-    return simulate(std::move(board_copy), *root_, rng);
+    return simulate(std::move(board_copy), root, rng);
 }
 
 float SearchAgent::simulate(go::Board board_copy, Node& node, std::mt19937& rng) {
+    SearchStats* stats = current_stats();
     Node* current = &node;
     std::vector<Node*> path;
     std::vector<int> child_indices;
@@ -210,25 +732,32 @@ float SearchAgent::simulate(go::Board board_copy, Node& node, std::mt19937& rng)
     while (true) {
         float expansion_value = 0.0f;
         if (try_expand(*current, board_copy, expansion_value)) {
+            record_simulation(stats, child_indices.size());
             backpropagate(path, child_indices, expansion_value);
             return expansion_value;
         }
 
         {
-            std::unique_lock<std::mutex> lock(current->mutex);
+            std::unique_lock<std::mutex> lock = lock_node(current->mutex);
             if (current->children.empty()) {
                 lock.unlock();
+                record_simulation(stats, child_indices.size());
                 backpropagate(path, child_indices, 0.0f);
                 return 0.0f;
             }
         }
 
-        const int child_index = select_child(*current, rng);
+        int child_index = 0;
+        {
+            PhaseTimer timer(stats, SearchPhase::Selection);
+            TraceSpan span(TraceEvent::SelectChild);
+            child_index = select_child(*current, rng);
+        }
         const std::size_t child_pos = static_cast<std::size_t>(child_index);
 
         SearchAgent::Child* child_ptr = nullptr;
         {
-            std::unique_lock<std::mutex> lock(current->mutex);
+            std::unique_lock<std::mutex> lock = lock_node(current->mutex);
             child_ptr = &current->children[child_pos];
             if (!child_ptr->node) {
                 child_ptr->node = std::make_unique<Node>();
@@ -237,9 +766,13 @@ float SearchAgent::simulate(go::Board board_copy, Node& node, std::mt19937& rng)
         }
 
         go::Move move = child_ptr->move == -1 ? go::Move::Pass() : go::Move(child_ptr->move);
-        const bool legal = board_copy.play_move(current->to_play, move);
+        bool legal = false;
+        {
+            PhaseTimer timer(stats, SearchPhase::BoardPlay);
+            legal = board_copy.play_move(current->to_play, move);
+        }
         if (!legal) {
-            std::unique_lock<std::mutex> lock(current->mutex);
+            std::unique_lock<std::mutex> lock = lock_node(current->mutex);
             revert_virtual_loss(*current, child_pos);
             child_ptr->prior = 0.0f;
             child_ptr->visit_count = 0;
@@ -255,7 +788,7 @@ float SearchAgent::simulate(go::Board board_copy, Node& node, std::mt19937& rng)
 }
 
 int SearchAgent::select_child(Node& node, std::mt19937& rng) {
-    std::unique_lock<std::mutex> lock(node.mutex);
+    std::unique_lock<std::mutex> lock = lock_node(node.mutex);
     const float sqrt_total = std::sqrt(static_cast<float>(node.visit_count) + 1.0f);
     const float parent_q = node.visit_count > 0 ? node.value_sum / static_cast<float>(node.visit_count) : 0.0f;
     float best_score = -std::numeric_limits<float>::infinity();
@@ -281,8 +814,9 @@ int SearchAgent::select_child(Node& node, std::mt19937& rng) {
 }
 
 bool SearchAgent::try_expand(Node& node, const go::Board& board, float& value) {
+    SearchStats* stats = current_stats();
     {
-        std::unique_lock<std::mutex> lock(node.mutex);
+        std::unique_lock<std::mutex> lock = lock_node(node.mutex);
         if (node.expanded) {
             return false;
         }
@@ -295,7 +829,12 @@ bool SearchAgent::try_expand(Node& node, const go::Board& board, float& value) {
         node.expanding = true;
     }
 
-    EvaluationResult eval = evaluator_->evaluate(board, node.to_play);
+    EvaluationResult eval;
+    {
+        PhaseTimer timer(stats, SearchPhase::Evaluation);
+        TraceSpan span(TraceEvent::Evaluate);
+        eval = evaluator_->evaluate(board, node.to_play);
+    }
     const std::size_t board_area = board.board_size() * board.board_size();
     const std::size_t expected_policy_size = board_area + 1;
 
@@ -309,18 +848,38 @@ bool SearchAgent::try_expand(Node& node, const go::Board& board, float& value) {
     priors.reserve(board_area + 1);
 
     double prior_sum = 0.0;
-    for (std::size_t vertex = 0; vertex < board_area; ++vertex) {
-        if (board.point_state(vertex) != go::PointState::Empty) {
-            continue;
-        }
-        go::Move move(static_cast<int>(vertex));
-        if (!board.is_legal(node.to_play, move)) {
-            continue;
+    {
+        PhaseTimer timer(stats, SearchPhase::Legality);
+        thread_local go::LadderReader ladders;
+        bool ladders_ready = false;
+        const go::PassAliveMap* pass_alive = config_.prune_pass_alive ? &go::pass_alive_map(board) : nullptr;
+        for (std::size_t vertex = 0; vertex < board_area; ++vertex) {
+            if (board.point_state(vertex) != go::PointState::Empty) {
+                continue;
+            }
+            if (pass_alive && pass_alive->is_pointless(node.to_play, vertex)) {
+                continue;
+            }
+            go::Move move(static_cast<int>(vertex));
+            if (!board.is_legal(node.to_play, move)) {
+                continue;
+            }
+            float prior = std::max(eval.policy[vertex], 0.0f);
+            if (config_.read_ladders && ladder_candidate(board, node.to_play, vertex)) {
+                if (!ladders_ready) {
+                    ladders.reset(board);
+                    ladders_ready = true;
+                }
+                if (ladders.is_failed_escape(node.to_play, vertex)) {
+                    prior *= config_.ladder_escape_factor;
+                } else if (ladders.is_capture_move(node.to_play, vertex)) {
+                    prior *= config_.ladder_capture_factor;
+                }
+            }
+            legal_moves.push_back(static_cast<int>(vertex));
+            priors.push_back(prior);
+            prior_sum += prior;
         }
-        const float prior = std::max(eval.policy[vertex], 0.0f);
-        legal_moves.push_back(static_cast<int>(vertex));
-        priors.push_back(prior);
-        prior_sum += prior;
     }
 
     const float pass_prior = std::max(eval.policy.back(), 0.0f);
@@ -354,7 +913,7 @@ bool SearchAgent::try_expand(Node& node, const go::Board& board, float& value) {
     }
 
     {
-        std::unique_lock<std::mutex> lock(node.mutex);
+        std::unique_lock<std::mutex> lock = lock_node(node.mutex);
         node.children = std::move(children);
         node.move_to_index = std::move(move_to_index);
         node.expanded = true;
@@ -398,21 +957,23 @@ void SearchAgent::revert_virtual_loss(Node& node, std::size_t child_index) {
 }
 
 void SearchAgent::backpropagate(const std::vector<Node*>& path, const std::vector<int>& child_indices, float value) {
+    PhaseTimer timer(current_stats(), SearchPhase::Backprop);
     float current_value = value;
     for (std::size_t idx = path.size(); idx-- > 0;) {
         Node* node = path[idx];
         backpropagate_on_node(*node, current_value);
         if (idx > 0) {
+            // Edges hold values for the player choosing them, which select_child maximises.
             Node* parent = path[idx - 1];
             const std::size_t child_index = static_cast<std::size_t>(child_indices[idx - 1]);
-            backpropagate_on_edge(*parent, child_index, current_value);
+            backpropagate_on_edge(*parent, child_index, -current_value);
         }
         current_value = -current_value;
     }
 }
 
 void SearchAgent::backpropagate_on_node(Node& node, float value) {
-    std::unique_lock<std::mutex> lock(node.mutex);
+    std::unique_lock<std::mutex> lock = lock_node(node.mutex);
     if (config_.use_virtual_loss && node.virtual_loss_count > 0) {
         node.virtual_loss_count -= 1;
         node.visit_count = std::max(0, node.visit_count - config_.virtual_loss_visits);
@@ -423,7 +984,7 @@ void SearchAgent::backpropagate_on_node(Node& node, float value) {
 }
 
 void SearchAgent::backpropagate_on_edge(Node& parent, std::size_t child_index, float value) {
-    std::unique_lock<std::mutex> lock(parent.mutex);
+    std::unique_lock<std::mutex> lock = lock_node(parent.mutex);
     Child& child = parent.children[child_index];
     if (config_.use_virtual_loss && child.virtual_loss_count > 0) {
         child.virtual_loss_count -= 1;
@@ -434,8 +995,8 @@ void SearchAgent::backpropagate_on_edge(Node& parent, std::size_t child_index, f
     child.value_sum += value;
 }
 
-go::Move SearchAgent::select_move_from_root(int move_number, std::mt19937& rng) const {
-    if (!root_ || root_->children.empty()) {
+go::Move SearchAgent::select_move_from_stats(const std::vector<RootMoveStats>& stats, int move_number, std::mt19937& rng) const {
+    if (stats.empty()) {
         return go::Move::Pass();
     }
 
@@ -447,22 +1008,21 @@ go::Move SearchAgent::select_move_from_root(int move_number, std::mt19937& rng)
     if (temperature <= kEpsilon) {
         int best_index = 0;
         int best_visits = -1;
-        for (std::size_t idx = 0; idx < root_->children.size(); ++idx) {
-            const SearchAgent::Child& child = root_->children[idx];
-            if (child.visit_count > best_visits) {
-                best_visits = child.visit_count;
+        for (std::size_t idx = 0; idx < stats.size(); ++idx) {
+            if (stats[idx].visit_count > best_visits) {
+                best_visits = stats[idx].visit_count;
                 best_index = static_cast<int>(idx);
             }
         }
-        const SearchAgent::Child& best_child = root_->children[static_cast<std::size_t>(best_index)];
-        return best_child.move == -1 ? go::Move::Pass() : go::Move(best_child.move);
+        const RootMoveStats& best = stats[static_cast<std::size_t>(best_index)];
+        return best.move == -1 ? go::Move::Pass() : go::Move(best.move);
     }
 
     std::vector<float> weights;
-    weights.reserve(root_->children.size());
+    weights.reserve(stats.size());
     float sum = 0.0f;
-    for (const SearchAgent::Child& child : root_->children) {
-        const float visit = static_cast<float>(child.visit_count);
+    for (const RootMoveStats& entry : stats) {
+        const float visit = static_cast<float>(entry.visit_count);
         float weight = std::pow(visit + kEpsilon, 1.0f / temperature);
         weights.push_back(weight);
         sum += weight;
@@ -479,12 +1039,14 @@ go::Move SearchAgent::select_move_from_root(int move_number, std::mt19937& rng)
 
     std::discrete_distribution<int> dist(weights.begin(), weights.end());
     const int idx = dist(rng);
-    const SearchAgent::Child& choice = root_->children[static_cast<std::size_t>(idx)];
+    const RootMoveStats& choice = stats[static_cast<std::size_t>(idx)];
     return choice.move == -1 ? go::Move::Pass() : go::Move(choice.move);
 }
 
 std::uint64_t SearchAgent::state_key(const go::Board& board, go::Player) const {
-    return board.state_key();
+    // Values depend on komi and legal moves on the ko and suicide rules, so a tree is only
+    // reused under the rules it was searched with.
+    return board.state_key() ^ go::rules_hash(board.rules());
 }
 
 } // namespace search
@@ -0,0 +1,56 @@
+#include "search/SearchStats.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace search {
+
+void SearchStats::merge(const SearchStats& other) noexcept {
+    for (std::size_t i = 0; i < phases.size(); ++i) {
+        phases[i].count += other.phases[i].count;
+        phases[i].nanoseconds += other.phases[i].nanoseconds;
+    }
+    simulations += other.simulations;
+    depth_sum += other.depth_sum;
+    max_depth = std::max(max_depth, other.max_depth);
+    wall_nanoseconds = std::max(wall_nanoseconds, other.wall_nanoseconds);
+}
+
+const char* phase_name(SearchPhase phase) noexcept {
+    switch (phase) {
+    case SearchPhase::Selection:
+        return "selection";
+    case SearchPhase::BoardPlay:
+        return "board_play";
+    case SearchPhase::Legality:
+        return "legality";
+    case SearchPhase::Evaluation:
+        return "evaluation";
+    case SearchPhase::Backprop:
+        return "backprop";
+    case SearchPhase::MutexWait:
+        return "mutex_wait";
+    default:
+        return "unknown";
+    }
+}
+
+std::string format_search_stats(const SearchStats& stats) {
+    std::ostringstream oss;
+    oss << std::fixed;
+    for (std::size_t i = 0; i < stats.phases.size(); ++i) {
+        const PhaseStats& entry = stats.phases[i];
+        const double total_ms = static_cast<double>(entry.nanoseconds) / 1e6;
+        const double avg_us = entry.count > 0 ? static_cast<double>(entry.nanoseconds) / 1e3 / static_cast<double>(entry.count) : 0.0;
+        oss << phase_name(static_cast<SearchPhase>(i)) << ' ' << entry.count << ' '
+            << std::setprecision(3) << total_ms << "ms " << avg_us << "us\n";
+    }
+    const double mean_depth = stats.simulations > 0 ? static_cast<double>(stats.depth_sum) / static_cast<double>(stats.simulations) : 0.0;
+    oss << "simulations " << stats.simulations << '\n'
+        << "depth_mean " << std::setprecision(2) << mean_depth << " depth_max " << stats.max_depth << '\n'
+        << "wall " << std::setprecision(3) << static_cast<double>(stats.wall_nanoseconds) / 1e6 << "ms";
+    return oss.str();
+}
+
+} // namespace search
@@ -0,0 +1,97 @@
+#include "search/SymmetricEvaluator.hpp"
+
+#include "go/Symmetry.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace search {
+
+const char* symmetry_mode_name(SymmetryMode mode) {
+    return mode == SymmetryMode::Random ? "random" : "average";
+}
+
+SymmetryMode parse_symmetry_mode(const std::string& name) {
+    if (name == "random") {
+        return SymmetryMode::Random;
+    }
+    if (name == "average") {
+        return SymmetryMode::Average;
+    }
+    throw std::invalid_argument("unknown symmetry mode: " + name);
+}
+
+SymmetricEvaluator::SymmetricEvaluator(std::shared_ptr<Evaluator> inner, SymmetryMode mode, unsigned int seed)
+    : inner_(std::move(inner)), mode_(mode), rng_(seed) {
+    if (!inner_) {
+        throw std::invalid_argument("symmetric evaluator needs an inner evaluator");
+    }
+}
+
+EvaluationResult SymmetricEvaluator::evaluate(const go::Board& board, go::Player to_play) {
+    return std::move(evaluate_batch({EvaluationRequest{&board, to_play}}).front());
+}
+
+std::vector<EvaluationResult> SymmetricEvaluator::evaluate_batch(const std::vector<EvaluationRequest>& requests) {
+    const std::size_t copies = mode_ == SymmetryMode::Average ? static_cast<std::size_t>(go::kSymmetries) : 1;
+    std::vector<int> symmetries(requests.size() * copies);
+    if (mode_ == SymmetryMode::Average) {
+        for (std::size_t slot = 0; slot < symmetries.size(); ++slot) {
+            symmetries[slot] = static_cast<int>(slot % copies);
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(rng_mutex_);
+        std::uniform_int_distribution<int> dist(0, go::kSymmetries - 1);
+        for (int& symmetry : symmetries) {
+            symmetry = dist(rng_);
+        }
+    }
+
+    // The identity orientation is passed through; the others are evaluated on
+    // transformed copies, reserved up front so the request pointers stay valid.
+    std::vector<go::Board> boards;
+    boards.reserve(symmetries.size());
+    std::vector<EvaluationRequest> transformed(symmetries.size());
+    for (std::size_t slot = 0; slot < symmetries.size(); ++slot) {
+        const EvaluationRequest& request = requests[slot / copies];
+        if (symmetries[slot] == 0) {
+            transformed[slot] = request;
+        } else {
+            boards.push_back(request.board->transformed(symmetries[slot]));
+            transformed[slot] = {&boards.back(), request.to_play};
+        }
+    }
+    const std::vector<EvaluationResult> inner_results = inner_->evaluate_batch(transformed);
+
+    std::vector<EvaluationResult> results(requests.size());
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        const std::size_t board_size = requests[i].board->board_size();
+        const std::size_t area = board_size * board_size;
+        const go::SymmetryMap* table = go::symmetry_table(board_size);
+        EvaluationResult& result = results[i];
+        result.policy.assign(area + 1, 0.0f);
+        for (std::size_t copy = 0; copy < copies; ++copy) {
+            const std::size_t slot = i * copies + copy;
+            const EvaluationResult& inner = inner_results[slot];
+            if (inner.policy.size() != area + 1) {
+                throw std::runtime_error("evaluator returned a policy of the wrong size");
+            }
+            const std::size_t symmetry = static_cast<std::size_t>(symmetries[slot]);
+            for (std::size_t vertex = 0; vertex < area; ++vertex) {
+                result.policy[vertex] += inner.policy[static_cast<std::size_t>(table[vertex][symmetry])];
+            }
+            result.policy[area] += inner.policy[area];
+            result.value += inner.value;
+        }
+        if (copies > 1) {
+            const float scale = 1.0f / static_cast<float>(copies);
+            for (float& probability : result.policy) {
+                probability *= scale;
+            }
+            result.value *= scale;
+        }
+    }
+    return results;
+}
+
+} // namespace search
@@ -0,0 +1,153 @@
+#include "search/Topology.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace search {
+
+std::size_t CpuTopology::cpu_count() const noexcept {
+    std::size_t count = 0;
+    for (const auto& node : numa_nodes) {
+        count += node.size();
+    }
+    return count;
+}
+
+std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    std::istringstream ss(text);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        token.erase(std::remove_if(token.begin(), token.end(), [](unsigned char c) { return std::isspace(c) != 0; }), token.end());
+        if (token.empty()) {
+            continue;
+        }
+        try {
+            const auto dash = token.find('-');
+            if (dash == std::string::npos) {
+                cpus.push_back(std::stoi(token));
+            } else {
+                const int first = std::stoi(token.substr(0, dash));
+                const int last = std::stoi(token.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(cpu);
+                }
+            }
+        } catch (...) {
+            continue;
+        }
+    }
+    return cpus;
+}
+
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(static_cast<std::size_t>(cpu), &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+CpuTopology restrict_topology(const CpuTopology& topology, const std::vector<int>& allowed) {
+    if (allowed.empty()) {
+        return topology;
+    }
+    CpuTopology restricted;
+    for (const auto& node : topology.numa_nodes) {
+        std::vector<int> cpus;
+        std::copy_if(node.begin(), node.end(), std::back_inserter(cpus),
+                     [&allowed](int cpu) { return std::find(allowed.begin(), allowed.end(), cpu) != allowed.end(); });
+        if (!cpus.empty()) {
+            restricted.numa_nodes.push_back(std::move(cpus));
+        }
+    }
+    return restricted;
+}
+
+CpuTopology detect_topology() {
+    CpuTopology topology;
+#if defined(__linux__)
+    for (int node = 0; node < 1024; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) {
+            break;
+        }
+        std::string line;
+        std::getline(file, line);
+        std::vector<int> cpus = parse_cpu_list(line);
+        if (!cpus.empty()) {
+            topology.numa_nodes.push_back(std::move(cpus));
+        }
+    }
+#endif
+    const std::vector<int> allowed = allowed_cpus();
+    topology = restrict_topology(topology, allowed);
+    if (topology.numa_nodes.empty()) {
+        if (!allowed.empty()) {
+            topology.numa_nodes.push_back(allowed);
+            return topology;
+        }
+        const unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<int> cpus(hardware);
+        for (unsigned int i = 0; i < hardware; ++i) {
+            cpus[i] = static_cast<int>(i);
+        }
+        topology.numa_nodes.push_back(std::move(cpus));
+    }
+    return topology;
+}
+
+int cpu_for_worker(const CpuTopology& topology, std::size_t node, int worker_index) {
+    if (topology.numa_nodes.empty()) {
+        return -1;
+    }
+    const auto& cpus = topology.numa_nodes[node % topology.numa_nodes.size()];
+    if (cpus.empty()) {
+        return -1;
+    }
+    return cpus[static_cast<std::size_t>(worker_index) % cpus.size()];
+}
+
+bool pin_current_thread(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<std::size_t>(cpu), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+std::string describe_topology(const CpuTopology& topology) {
+    std::ostringstream oss;
+    oss << "nodes=" << topology.numa_nodes.size() << " cpus=" << topology.cpu_count();
+    for (std::size_t node = 0; node < topology.numa_nodes.size(); ++node) {
+        const auto& cpus = topology.numa_nodes[node];
+        oss << " node" << node << '[' << cpus.size() << ']';
+    }
+    return oss.str();
+}
+
+} // namespace search
@@ -0,0 +1,174 @@
+#include "search/Trace.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+namespace search {
+
+// Entries pack the timestamp (ns since the recorder epoch) into the upper 56 bits,
+// the event id into 7 bits and begin/end into the lowest bit.
+struct TraceRecorder::Ring {
+    Ring(int slot_id, std::size_t capacity_events, std::chrono::steady_clock::time_point start)
+        : slot(slot_id), capacity(capacity_events), epoch(start), entries(new std::atomic<std::uint64_t>[capacity_events]) {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            entries[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void push(TraceEvent event, bool begin) noexcept {
+        const auto elapsed = std::chrono::steady_clock::now() - epoch;
+        const auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        const std::uint64_t packed = (ns << 8) | (static_cast<std::uint64_t>(event) << 1) | (begin ? 1u : 0u);
+        const std::uint64_t h = head.load(std::memory_order_relaxed);
+        entries[h % capacity].store(packed, std::memory_order_relaxed);
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    int slot;
+    std::size_t capacity;
+    std::chrono::steady_clock::time_point epoch;
+    std::atomic<std::uint64_t> head{0};
+    std::unique_ptr<std::atomic<std::uint64_t>[]> entries;
+};
+
+namespace {
+
+#if TENUKI_SEARCH_TRACE
+thread_local TraceRecorder::Ring* t_ring = nullptr;
+#endif
+
+} // namespace
+
+const char* trace_event_name(TraceEvent event) noexcept {
+    switch (event) {
+    case TraceEvent::Search:
+        return "search";
+    case TraceEvent::Simulation:
+        return "simulation";
+    case TraceEvent::SelectChild:
+        return "select_child";
+    case TraceEvent::MutexWait:
+        return "mutex_wait";
+    case TraceEvent::Evaluate:
+        return "evaluate";
+    case TraceEvent::BatchDispatch:
+        return "batch_dispatch";
+    case TraceEvent::TreeReuse:
+        return "tree_reuse";
+    default:
+        return "unknown";
+    }
+}
+
+TraceRecorder::TraceRecorder(std::size_t events_per_thread)
+    : capacity_(std::max<std::size_t>(16, events_per_thread)), epoch_(std::chrono::steady_clock::now()) {}
+
+TraceRecorder::~TraceRecorder() = default;
+
+TraceRecorder::Ring* TraceRecorder::ring(int slot) {
+    std::scoped_lock lock(mutex_);
+    auto& entry = rings_[slot];
+    if (!entry) {
+        entry = std::make_unique<Ring>(slot, capacity_, epoch_);
+    }
+    return entry.get();
+}
+
+void TraceRecorder::clear() {
+    std::scoped_lock lock(mutex_);
+    for (auto& [slot, ring] : rings_) {
+        ring->head.store(0, std::memory_order_release);
+    }
+}
+
+void TraceRecorder::write_chrome_trace(std::ostream& out) const {
+    std::scoped_lock lock(mutex_);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    out << std::fixed << std::setprecision(3);
+    for (const auto& [slot, ring] : rings_) {
+        const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+        const std::uint64_t start = head > ring->capacity ? head - ring->capacity : 0;
+        // Events overwritten in a wrapped ring can leave unmatched ends; drop them per event kind.
+        std::vector<int> depth(static_cast<std::size_t>(TraceEvent::Count), 0);
+        for (std::uint64_t i = start; i < head; ++i) {
+            const std::uint64_t packed = ring->entries[i % ring->capacity].load(std::memory_order_relaxed);
+            const bool begin = (packed & 1u) != 0;
+            const auto event_id = static_cast<std::size_t>((packed >> 1) & 0x7fu);
+            if (event_id >= depth.size()) {
+                continue;
+            }
+            if (!begin && depth[event_id] == 0) {
+                continue;
+            }
+            depth[event_id] += begin ? 1 : -1;
+            const double ts_us = static_cast<double>(packed >> 8) / 1000.0;
+            if (!first) {
+                out << ',';
+            }
+            first = false;
+            out << "{\"name\":\"" << trace_event_name(static_cast<TraceEvent>(event_id))
+                << "\",\"cat\":\"search\",\"ph\":\"" << (begin ? 'B' : 'E')
+                << "\",\"ts\":" << ts_us << ",\"pid\":1,\"tid\":" << slot << '}';
+        }
+    }
+    for (const auto& [slot, ring] : rings_) {
+        out << (first ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << slot
+            << ",\"args\":{\"name\":\"" << (slot == 0 ? std::string("search caller") : "slot " + std::to_string(slot)) << "\"}}";
+        first = false;
+    }
+    out << "]}\n";
+}
+
+TraceThreadScope::TraceThreadScope(TraceRecorder* recorder, int slot) noexcept {
+#if TENUKI_SEARCH_TRACE
+    if (recorder) {
+        previous_ = t_ring;
+        t_ring = recorder->ring(slot);
+        attached_ = true;
+    }
+#else
+    (void)recorder;
+    (void)slot;
+#endif
+}
+
+TraceThreadScope::~TraceThreadScope() {
+#if TENUKI_SEARCH_TRACE
+    if (attached_) {
+        t_ring = previous_;
+    }
+#endif
+}
+
+bool trace_active() noexcept {
+#if TENUKI_SEARCH_TRACE
+    return t_ring != nullptr;
+#else
+    return false;
+#endif
+}
+
+void trace_begin(TraceEvent event) noexcept {
+#if TENUKI_SEARCH_TRACE
+    if (TraceRecorder::Ring* ring = t_ring) {
+        ring->push(event, true);
+    }
+#else
+    (void)event;
+#endif
+}
+
+void trace_end(TraceEvent event) noexcept {
+#if TENUKI_SEARCH_TRACE
+    if (TraceRecorder::Ring* ring = t_ring) {
+        ring->push(event, false);
+    }
+#else
+    (void)event;
+#endif
+}
+
+} // namespace search
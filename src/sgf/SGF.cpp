@@ -5,6 +5,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -14,22 +15,99 @@ std::string read_all(std::istream& input) {
     return oss.str();
 }
 
-std::string extract_property(const std::string& data, const std::string& prop) {
-    auto pos = data.find(prop + "[");
-    if (pos == std::string::npos) {
-        return {};
-    }
-    pos += prop.size() + 1;
-    std::string value;
-    while (pos < data.size() && data[pos] != ']') {
-        char c = data[pos++];
-        if (c == '\\' && pos < data.size()) {
-            value.push_back(data[pos++]);
-        } else {
-            value.push_back(c);
+struct Property {
+    std::string id;
+    std::vector<std::string> values;
+};
+
+using Node = std::vector<Property>;
+
+bool is_space(char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+// One node's properties, from just past its ';'. Identifiers keep their upper-case
+// letters only, so the FF[3] spelling AddBlack reads as AB; a value left open at the
+// end of the data ends there.
+Node read_node(const std::string& data, std::size_t& pos) {
+    Node node;
+    while (pos < data.size()) {
+        const char c = data[pos];
+        if (c == ';' || c == '(' || c == ')') {
+            break;
+        }
+        if (is_space(c)) {
+            ++pos;
+            continue;
+        }
+        std::string id;
+        while (pos < data.size() && std::isalpha(static_cast<unsigned char>(data[pos])) != 0) {
+            if (std::isupper(static_cast<unsigned char>(data[pos])) != 0) {
+                id.push_back(data[pos]);
+            }
+            ++pos;
+        }
+        Property property{id, {}};
+        for (;;) {
+            while (pos < data.size() && is_space(data[pos])) {
+                ++pos;
+            }
+            if (pos >= data.size() || data[pos] != '[') {
+                break;
+            }
+            ++pos;
+            std::string value;
+            while (pos < data.size() && data[pos] != ']') {
+                if (data[pos] == '\\' && pos + 1 < data.size()) {
+                    ++pos;
+                }
+                value.push_back(data[pos++]);
+            }
+            ++pos; // skip ']'
+            property.values.push_back(std::move(value));
+        }
+        if (id.empty() && property.values.empty()) {
+            ++pos; // a stray character
+            continue;
+        }
+        node.push_back(std::move(property));
+    }
+    return node;
+}
+
+// The nodes of the first game's main line. A tree's nodes are on it if the tree is the
+// first game or the first variation of a tree on it.
+std::vector<Node> main_line(const std::string& data) {
+    std::vector<Node> line;
+    std::vector<bool> on_line;       // per open tree
+    std::vector<bool> has_variation; // per open tree: a variation has been opened in it
+    bool game_seen = false;
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        const char c = data[pos++];
+        if (c == '(') {
+            bool follow = !game_seen;
+            if (!on_line.empty()) {
+                follow = on_line.back() && !has_variation.back();
+                has_variation.back() = true;
+            }
+            game_seen = true;
+            on_line.push_back(follow);
+            has_variation.push_back(false);
+        } else if (c == ')') {
+            if (!on_line.empty()) {
+                on_line.pop_back();
+                has_variation.pop_back();
+            }
+        } else if (c == ';') {
+            Node node = read_node(data, pos);
+            const bool follow = on_line.empty() ? !game_seen : on_line.back() && !has_variation.back();
+            if (follow) {
+                line.push_back(std::move(node));
+            }
         }
     }
-    return value;
+    return line;
 }
 
 int decode_coord(char c) {
@@ -82,60 +160,103 @@ namespace sgf {
 
 GameTree load(std::istream& input) {
     GameTree game;
-    std::string data = read_all(input);
-    if (data.empty()) {
+    const std::vector<Node> nodes = main_line(read_all(input));
+    if (nodes.empty()) {
         return game;
     }
 
-    auto stripped = data;
-    stripped.erase(std::remove_if(stripped.begin(), stripped.end(), [](unsigned char c) { return std::isspace(c) != 0; }), stripped.end());
-
-    std::string sz_value = extract_property(stripped, "SZ");
-    std::size_t parsed_size = 0;
-    if (!sz_value.empty() && try_parse_size_t(sz_value, parsed_size)) {
-        game.board_size = parsed_size;
-    }
-    std::string km_value = extract_property(stripped, "KM");
-    double parsed_komi = 0.0;
-    if (!km_value.empty() && try_parse_double(km_value, parsed_komi)) {
-        game.komi = parsed_komi;
+    // The root's size decides how its points decode, wherever SZ sits in it.
+    for (const Property& property : nodes.front()) {
+        if (property.values.empty()) {
+            continue;
+        }
+        std::size_t parsed_size = 0;
+        double parsed_komi = 0.0;
+        if (property.id == "SZ" && try_parse_size_t(property.values.front(), parsed_size)) {
+            game.board_size = parsed_size;
+        } else if (property.id == "KM" && try_parse_double(property.values.front(), parsed_komi)) {
+            game.komi = parsed_komi;
+        }
     }
 
-    std::size_t pos = 0;
-    while (pos < stripped.size()) {
-        if (stripped[pos] == ';' && pos + 4 < stripped.size()) {
-            char color_char = stripped[pos + 1];
-            pos += 2;
-            if (stripped[pos] != '[') {
-                ++pos;
-                continue;
-            }
-            ++pos;
-            std::string value;
-            while (pos < stripped.size() && stripped[pos] != ']') {
-                value.push_back(stripped[pos++]);
-            }
-            ++pos; // skip ']'
-
-            go::Player player;
-            if (color_char == 'B' || color_char == 'b') {
-                player = go::Player::Black;
-            } else if (color_char == 'W' || color_char == 'w') {
-                player = go::Player::White;
-            } else {
-                continue;
+    const auto decode_point = [&game](const std::string& value) {
+        const int x = decode_coord(value[0]);
+        const int y = decode_coord(value[1]);
+        if (static_cast<std::size_t>(x) >= game.board_size || static_cast<std::size_t>(y) >= game.board_size) {
+            throw std::invalid_argument("SGF point off the board");
+        }
+        return y * static_cast<int>(game.board_size) + x;
+    };
+    // A point list value is one point or, compressed, the rectangle "aa:cc".
+    const auto decode_points = [&decode_point, &game](const std::string& value) {
+        std::vector<int> points;
+        if (value.empty()) {
+            return points;
+        }
+        if (value.size() == 2u) {
+            points.push_back(decode_point(value));
+        } else if (value.size() == 5u && value[2] == ':') {
+            const int first = decode_point(value.substr(0, 2));
+            const int last = decode_point(value.substr(3, 2));
+            const int size = static_cast<int>(game.board_size);
+            for (int y = std::min(first, last) / size; y <= std::max(first, last) / size; ++y) {
+                for (int x = std::min(first % size, last % size); x <= std::max(first % size, last % size); ++x) {
+                    points.push_back(y * size + x);
+                }
             }
+        } else {
+            throw std::invalid_argument("Invalid SGF point");
+        }
+        return points;
+    };
+    const auto place = [](std::vector<int>& stones, std::vector<int>& others, int vertex) {
+        others.erase(std::remove(others.begin(), others.end(), vertex), others.end());
+        if (std::find(stones.begin(), stones.end(), vertex) == stones.end()) {
+            stones.push_back(vertex);
+        }
+    };
 
-            go::Move move = go::Move::Pass();
-            if (value.size() == 2u) {
-                int x = decode_coord(value[0]);
-                int y = decode_coord(value[1]);
-                int vertex = y * static_cast<int>(game.board_size) + x;
-                move = go::Move(vertex);
+    Setup& setup = game.setup;
+    for (const Node& node : nodes) {
+        for (const Property& property : node) {
+            const std::string& id = property.id;
+            if (id == "AB" || id == "AW" || id == "AE") {
+                if (!game.moves.empty()) {
+                    throw std::invalid_argument("SGF setup stones after the first move");
+                }
+                for (const std::string& value : property.values) {
+                    for (int vertex : decode_points(value)) {
+                        if (id == "AB") {
+                            place(setup.black, setup.white, vertex);
+                        } else if (id == "AW") {
+                            place(setup.white, setup.black, vertex);
+                        } else {
+                            setup.black.erase(std::remove(setup.black.begin(), setup.black.end(), vertex), setup.black.end());
+                            setup.white.erase(std::remove(setup.white.begin(), setup.white.end(), vertex), setup.white.end());
+                        }
+                    }
+                }
+            } else if (id == "PL" && !property.values.empty() && game.moves.empty()) {
+                const std::string& value = property.values.front();
+                if (value == "B" || value == "b") {
+                    setup.to_play = go::Player::Black;
+                } else if (value == "W" || value == "w") {
+                    setup.to_play = go::Player::White;
+                }
+            } else if (id == "HA" && !property.values.empty()) {
+                std::size_t handicap = 0;
+                if (try_parse_size_t(property.values.front(), handicap) && handicap <= game.board_size * game.board_size) {
+                    setup.handicap = static_cast<int>(handicap);
+                }
+            } else if ((id == "B" || id == "W") && !property.values.empty()) {
+                const std::string& value = property.values.front();
+                go::Move move = go::Move::Pass();
+                // "tt" is the FF[3] spelling of a pass on boards up to 19x19.
+                if (value.size() == 2u && !(value == "tt" && game.board_size <= 19)) {
+                    move = go::Move(decode_point(value));
+                }
+                game.moves.push_back({id == "B" ? go::Player::Black : go::Player::White, move});
             }
-            game.moves.push_back({player, move});
-        } else {
-            ++pos;
         }
     }
 
@@ -145,7 +266,27 @@ GameTree load(std::istream& input) {
 void save(const GameTree& game, std::ostream& output) {
     output << "(;";
     output << "SZ[" << game.board_size << "]";
-    output << "KM[" << game.komi << "]";
+    if (game.komi) {
+        output << "KM[" << *game.komi << "]";
+    }
+    const auto write_points = [&game, &output](const char* id, const std::vector<int>& stones) {
+        if (stones.empty()) {
+            return;
+        }
+        const int size = static_cast<int>(game.board_size);
+        output << id;
+        for (int vertex : stones) {
+            output << '[' << encode_coord(vertex % size) << encode_coord(vertex / size) << ']';
+        }
+    };
+    if (game.setup.handicap > 0) {
+        output << "HA[" << game.setup.handicap << "]";
+    }
+    write_points("AB", game.setup.black);
+    write_points("AW", game.setup.white);
+    if (game.setup.to_play) {
+        output << "PL[" << (*game.setup.to_play == go::Player::Black ? 'B' : 'W') << "]";
+    }
     for (const auto& record : game.moves) {
         output << ';';
         output << (record.player == go::Player::Black ? 'B' : 'W');
@@ -161,4 +302,25 @@ void save(const GameTree& game, std::ostream& output) {
     output << ")";
 }
 
+void apply_setup(const GameTree& game, go::Board& board) {
+    const Setup& setup = game.setup;
+    if (setup.empty() && !setup.to_play) {
+        return;
+    }
+    std::vector<go::PointState> points(board.points().size(), go::PointState::Empty);
+    for (int vertex : setup.black) {
+        points[static_cast<std::size_t>(vertex)] = go::PointState::Black;
+    }
+    for (int vertex : setup.white) {
+        points[static_cast<std::size_t>(vertex)] = go::PointState::White;
+    }
+    go::Player to_play = setup.white.empty() && !setup.black.empty() ? go::Player::White : go::Player::Black;
+    if (setup.to_play) {
+        to_play = *setup.to_play;
+    } else if (!game.moves.empty()) {
+        to_play = game.moves.front().player;
+    }
+    board.set_position(points, to_play);
+}
+
 } // namespace sgf
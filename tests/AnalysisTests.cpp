@@ -0,0 +1,180 @@
+#include "TestUtils.hpp"
+#include "analysis/AnalysisEngine.hpp"
+#include "analysis/Json.hpp"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using analysis::JsonValue;
+
+namespace {
+
+bool parse_fails(const std::string& text) {
+    try {
+        analysis::parse_json(text);
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+void test_json_parses_and_rejects() {
+    const JsonValue value = analysis::parse_json(
+        R"( {"id":"a\"b\\c\u00e9\ud83d\ude00","n":[1,-2.5e2,0,true,false,null],"o":{},"e":[]} )");
+    TENUKI_EXPECT_EQ(value.find("id")->as_string(), std::string("a\"b\\c\xc3\xa9\xf0\x9f\x98\x80"));
+    const std::vector<JsonValue>& n = value.find("n")->as_array();
+    TENUKI_EXPECT_EQ(n.size(), 6u);
+    TENUKI_EXPECT_EQ(n[0].as_int(), 1);
+    TENUKI_EXPECT_EQ(n[1].as_number(), -250.0);
+    TENUKI_EXPECT(n[3].as_bool());
+    TENUKI_EXPECT(n[5].is_null());
+    TENUKI_EXPECT(value.find("o")->as_object().empty());
+    TENUKI_EXPECT(value.find("missing") == nullptr);
+
+    for (const char* bad : {"", "{", "[1,]", "{\"a\" 1}", "01", "1.", "+1", "0x10", "nan", "\"\\x\"",
+                            "\"\\ud800\"", "\"a\nb\"", "[1] 2", "tru"}) {
+        TENUKI_EXPECT(parse_fails(bad));
+    }
+    TENUKI_EXPECT(parse_fails(std::string(100, '[') + std::string(100, ']')));
+    TENUKI_EXPECT(!parse_fails(std::string(60, '[') + std::string(60, ']')));
+
+    bool mismatch = false;
+    try {
+        analysis::parse_json("2.5").as_int();
+    } catch (const std::invalid_argument&) {
+        mismatch = true;
+    }
+    TENUKI_EXPECT(mismatch);
+
+    std::ostringstream out;
+    analysis::write_json_string(out, std::string("q\"\\\n\x01", 5));
+    TENUKI_EXPECT_EQ(out.str(), std::string("\"q\\\"\\\\\\n\\u0001\""));
+    TENUKI_EXPECT_EQ(analysis::parse_json(out.str()).as_string(), std::string("q\"\\\n\x01", 5));
+}
+
+void test_parse_query_fields() {
+    const analysis::AnalysisQuery query = analysis::parse_query(
+        R"({"id":"g","boardXSize":9,"boardYSize":9,"rules":"japanese","komi":6.5,)"
+        R"("initialStones":[["B","C3"]],"initialPlayer":"W","moves":[["W","J9"],["B","pass"]],)"
+        R"("analyzeTurns":[2,0],"maxVisits":30,"includeOwnership":true})");
+    TENUKI_EXPECT_EQ(query.id, std::string("g"));
+    TENUKI_EXPECT_EQ(query.rules.board_size, 9u);
+    TENUKI_EXPECT(query.rules.ko_rule == go::KoRule::SimpleKo);
+    TENUKI_EXPECT_EQ(query.rules.komi, 6.5);
+    TENUKI_EXPECT_EQ(query.initial_stones.size(), 1u);
+    TENUKI_EXPECT_EQ(query.initial_stones[0].second.vertex, 6 * 9 + 2);
+    TENUKI_EXPECT(query.initial_player == go::Player::White);
+    TENUKI_EXPECT_EQ(query.moves[0].second.vertex, 8);
+    TENUKI_EXPECT(query.moves[1].second.is_pass());
+    TENUKI_EXPECT(query.analyze_turns == std::vector<int>({2, 0}));
+    TENUKI_EXPECT_EQ(query.max_visits, 30);
+    TENUKI_EXPECT(query.include_ownership);
+
+    // Defaults: 19x19, final position only.
+    const analysis::AnalysisQuery plain = analysis::parse_query(R"({"id":"p","moves":[["B","Q16"]]})");
+    TENUKI_EXPECT_EQ(plain.rules.board_size, 19u);
+    TENUKI_EXPECT(plain.analyze_turns == std::vector<int>({1}));
+
+    for (const char* bad : {R"({"moves":[]})", R"({"id":"x","boardXSize":9,"boardYSize":13})",
+                            R"({"id":"x","rules":"aga-ish"})", R"({"id":"x","boardXSize":9,"moves":[["B","K1"]]})",
+                            R"({"id":"x","moves":[["B","D4","x"]]})", R"({"id":"x","maxVisits":0})",
+                            R"({"id":"x","moves":[["Q","D4"]]})", R"({"id":7})"}) {
+        bool rejected = false;
+        try {
+            analysis::parse_query(bad);
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        TENUKI_EXPECT(rejected);
+    }
+}
+
+void test_engine_answers_every_turn() {
+    std::mutex mutex;
+    std::vector<std::string> lines;
+    analysis::AnalysisOptions options;
+    options.threads = 3;
+    options.max_visits = 24;
+    options.ownership_playouts = 8;
+    analysis::AnalysisEngine engine(options, nullptr, [&](const std::string& line) {
+        std::scoped_lock lock(mutex);
+        lines.push_back(line);
+    });
+    TENUKI_EXPECT_EQ(engine.threads(), 3);
+
+    engine.submit(R"({"id":"a","boardXSize":9,"boardYSize":9,"moves":[["B","E5"],["W","C3"],["B","G7"]],)"
+                  R"("analyzeTurns":[0,1,2,3],"maxVisits":40})");
+    engine.submit(R"({"id":"b","boardXSize":5,"boardYSize":5,"includeOwnership":true})");
+    engine.submit(R"({"id":"c","boardXSize":5,"boardYSize":5,"moves":[["B","C3"],["W","C3"]]})");
+    engine.submit(R"({"id":"d","moves":[],"analyzeTurns":[1]})");
+    engine.submit(R"({"id":"e","komi":"seven"})");
+    engine.submit(R"(not json)");
+    engine.wait_idle();
+
+    std::map<std::string, std::vector<JsonValue>> by_id;
+    for (const std::string& line : lines) {
+        TENUKI_EXPECT(line.find('\n') == std::string::npos);
+        const JsonValue response = analysis::parse_json(line);
+        by_id[response.find("id")->as_string()].push_back(response);
+    }
+    TENUKI_EXPECT_EQ(lines.size(), 4u + 1u + 4u);
+
+    std::vector<int> turns;
+    for (const JsonValue& response : by_id["a"]) {
+        const int turn = response.find("turnNumber")->as_int();
+        turns.push_back(turn);
+        const JsonValue& root = *response.find("rootInfo");
+        TENUKI_EXPECT_EQ(root.find("currentPlayer")->as_string(), std::string(turn % 2 == 0 ? "B" : "W"));
+        const std::vector<JsonValue>& infos = response.find("moveInfos")->as_array();
+        TENUKI_EXPECT(!infos.empty());
+        int visits = 0;
+        for (std::size_t i = 0; i < infos.size(); ++i) {
+            visits += infos[i].find("visits")->as_int();
+            TENUKI_EXPECT_EQ(infos[i].find("order")->as_int(), static_cast<int>(i));
+            TENUKI_EXPECT(i == 0 || infos[i - 1].find("visits")->as_int() >= infos[i].find("visits")->as_int());
+            const std::vector<JsonValue>& pv = infos[i].find("pv")->as_array();
+            TENUKI_EXPECT_EQ(pv.front().as_string(), infos[i].find("move")->as_string());
+            const double winrate = infos[i].find("winrate")->as_number();
+            TENUKI_EXPECT(winrate >= 0.0 && winrate <= 1.0);
+        }
+        TENUKI_EXPECT_EQ(root.find("visits")->as_int(), visits);
+        // The root is expanded before the search, so each of the 40 playouts visits a move.
+        TENUKI_EXPECT_EQ(visits, 40);
+        // Occupied points are never suggested.
+        for (const JsonValue& info : infos) {
+            const std::string& move = info.find("move")->as_string();
+            TENUKI_EXPECT(!(turn >= 1 && move == "E5") && !(turn >= 2 && move == "C3"));
+        }
+        TENUKI_EXPECT(response.find("ownership") == nullptr);
+    }
+    std::sort(turns.begin(), turns.end());
+    TENUKI_EXPECT(turns == std::vector<int>({0, 1, 2, 3}));
+
+    TENUKI_EXPECT_EQ(by_id["b"].size(), 1u);
+    const std::vector<JsonValue>& ownership = by_id["b"][0].find("ownership")->as_array();
+    TENUKI_EXPECT_EQ(ownership.size(), 25u);
+    for (const JsonValue& owner : ownership) {
+        TENUKI_EXPECT(owner.as_number() >= -1.0 && owner.as_number() <= 1.0);
+    }
+
+    TENUKI_EXPECT_EQ(by_id["c"][0].find("error")->as_string(), std::string("Illegal move 2: C3"));
+    TENUKI_EXPECT(by_id["d"][0].find("error") != nullptr);
+    TENUKI_EXPECT(by_id["e"][0].find("error") != nullptr);
+    TENUKI_EXPECT(by_id[""][0].find("error") != nullptr);
+
+    const analysis::AnalysisEngine::Counters counters = engine.counters();
+    TENUKI_EXPECT_EQ(counters.positions, 5u);
+}
+
+} // namespace
+
+void run_analysis_tests() {
+    test_json_parses_and_rejects();
+    test_parse_query_fields();
+    test_engine_answers_every_turn();
+}
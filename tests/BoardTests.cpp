@@ -1,5 +1,15 @@
 #include "TestUtils.hpp"
 #include "go/Board.hpp"
+#include "go/Pattern.hpp"
+#include "go/PlayoutBoard.hpp"
+#include "go/PlayoutLanes.hpp"
+#include "go/Scoring.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
 
 using go::Board;
 using go::KoRule;
@@ -20,6 +30,47 @@ void surround_center(Board& board) {
     TENUKI_EXPECT(board.play_move(Player::Black, Move(7)));
 }
 
+// Flood-fill liberty count, independent of the board's chain bookkeeping.
+int reference_liberties(const Board& board, std::size_t vertex) {
+    const std::size_t size = board.board_size();
+    const PointState color = board.point_state(vertex);
+    std::vector<bool> seen(size * size, false);
+    std::vector<bool> liberty(size * size, false);
+    std::vector<std::size_t> stack{vertex};
+    seen[vertex] = true;
+    int liberties = 0;
+    while (!stack.empty()) {
+        const std::size_t v = stack.back();
+        stack.pop_back();
+        const std::size_t x = v % size;
+        const std::size_t y = v / size;
+        std::vector<std::size_t> neighbors;
+        if (x > 0) neighbors.push_back(v - 1);
+        if (x + 1 < size) neighbors.push_back(v + 1);
+        if (y > 0) neighbors.push_back(v - size);
+        if (y + 1 < size) neighbors.push_back(v + size);
+        for (std::size_t n : neighbors) {
+            const PointState state = board.point_state(n);
+            if (state == PointState::Empty && !liberty[n]) {
+                liberty[n] = true;
+                ++liberties;
+            } else if (state == color && !seen[n]) {
+                seen[n] = true;
+                stack.push_back(n);
+            }
+        }
+    }
+    return liberties;
+}
+
+void expect_liberties_match(const Board& board) {
+    const std::size_t area = board.board_size() * board.board_size();
+    for (std::size_t v = 0; v < area; ++v) {
+        const int expected = board.point_state(v) == PointState::Empty ? 0 : reference_liberties(board, v);
+        TENUKI_EXPECT_EQ(board.liberties(v), expected);
+    }
+}
+
 } // namespace
 
 void test_simple_capture() {
@@ -92,6 +143,47 @@ void test_positional_superko_prevents_cycle() {
     TENUKI_EXPECT_FALSE(board.play_move(Player::White, Move(18)));
 }
 
+void test_set_rules_keeps_position() {
+    Rules rules;
+    rules.board_size = 3;
+    Board board(rules);
+    surround_center(board);
+    TENUKI_EXPECT_FALSE(board.is_legal(Player::White, Move(4)));
+
+    // Allowing suicide makes the same move legal; the stones and history stay.
+    const auto key = board.state_key();
+    const std::size_t seen = board.seen_positions().size();
+    Rules tromp_taylor = rules;
+    go::apply_rules_name(tromp_taylor, "tromp-taylor");
+    tromp_taylor.komi = 6.5;
+    board.set_rules(tromp_taylor);
+    TENUKI_EXPECT_EQ(board.rules().komi, 6.5);
+    TENUKI_EXPECT_EQ(board.state_key(), key);
+    TENUKI_EXPECT_EQ(board.seen_positions().size(), seen);
+    TENUKI_EXPECT(board.play_move(Player::White, Move(4)));
+
+    Rules larger = tromp_taylor;
+    larger.board_size = 7;
+    bool threw = false;
+    try {
+        board.set_rules(larger);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    TENUKI_EXPECT(threw);
+
+    TENUKI_EXPECT_NE(go::rules_hash(rules), go::rules_hash(tromp_taylor));
+    Rules zero = rules;
+    zero.komi = 0.0;
+    Rules negative_zero = rules;
+    negative_zero.komi = -0.0;
+    TENUKI_EXPECT_EQ(go::rules_hash(zero), go::rules_hash(negative_zero));
+    tromp_taylor.komi = rules.komi;
+    TENUKI_EXPECT_NE(go::rules_hash(rules), go::rules_hash(tromp_taylor));
+    tromp_taylor = rules;
+    TENUKI_EXPECT_EQ(go::rules_hash(rules), go::rules_hash(tromp_taylor));
+}
+
 void test_tromp_taylor_score() {
     Rules rules;
     rules.board_size = 3;
@@ -144,13 +236,447 @@ void test_state_key_includes_side_to_move() {
     TENUKI_EXPECT_NE(after_move, copy.state_key());
 }
 
+void test_incremental_liberties_match_flood_fill() {
+    for (bool allow_suicide : {false, true}) {
+        Rules rules;
+        rules.board_size = 7;
+        rules.allow_suicide = allow_suicide;
+        std::mt19937 rng(allow_suicide ? 17u : 11u);
+        std::uniform_int_distribution<int> vertex_dist(-1, 48);
+        for (int game = 0; game < 20; ++game) {
+            Board board(rules);
+            Player player = Player::Black;
+            for (int attempt = 0; attempt < 300; ++attempt) {
+                const Move move = vertex_dist(rng) < 0 ? Move::Pass() : Move(vertex_dist(rng));
+                const bool legal = board.is_legal(player, move);
+                Board copy = board;
+                TENUKI_EXPECT_EQ(copy.play_move(player, move), legal);
+                if (legal) {
+                    // The incremental hash matches one computed from scratch for the same stones.
+                    std::vector<PointState> points(copy.board_size() * copy.board_size());
+                    for (std::size_t v = 0; v < points.size(); ++v) {
+                        points[v] = copy.point_state(v);
+                    }
+                    Board rebuilt(rules);
+                    rebuilt.set_position(points, copy.to_play(), copy.ko_vertex());
+                    TENUKI_EXPECT_EQ(copy.position_hash(), rebuilt.position_hash());
+                } else {
+                    TENUKI_EXPECT_EQ(copy.position_hash(), board.position_hash());
+                }
+                if (legal) {
+                    board = copy;
+                    player = go::other(player);
+                    expect_liberties_match(board);
+                }
+            }
+        }
+    }
+}
+
+void test_suicide_leaves_chain_without_liberties() {
+    Rules rules;
+    rules.board_size = 3;
+    rules.allow_suicide = true;
+    Board board(rules);
+    surround_center(board);
+    TENUKI_EXPECT(board.play_move(Player::White, Move(4)));
+    TENUKI_EXPECT_EQ(board.point_state(4), PointState::White);
+    TENUKI_EXPECT_EQ(board.liberties(4), 0);
+    TENUKI_EXPECT_EQ(board.liberties(3), 2);
+}
+
+void test_set_position_rebuilds_chains() {
+    Rules rules;
+    rules.board_size = 5;
+    Board board(rules);
+    std::vector<PointState> points(25, PointState::Empty);
+    for (int v : {0, 1, 2, 7, 12}) {
+        points[static_cast<std::size_t>(v)] = PointState::Black;
+    }
+    points[5] = PointState::White;
+    points[6] = PointState::White;
+    board.set_position(points, Player::White);
+    expect_liberties_match(board);
+    TENUKI_EXPECT_EQ(board.liberties(12), 5);
+    TENUKI_EXPECT_EQ(board.liberties(5), 2);
+}
+
+void test_recent_moves_track_history() {
+    Rules rules;
+    rules.board_size = 5;
+    Board board(rules);
+    TENUKI_EXPECT_FALSE(board.recent_move(0).has_value());
+    TENUKI_EXPECT(board.play_move(Player::Black, Move(12)));
+    TENUKI_EXPECT(board.play_move(Player::White, Move::Pass()));
+    TENUKI_EXPECT(board.play_move(Player::Black, Move(7)));
+    TENUKI_EXPECT_EQ(board.recent_move(0)->vertex, 7);
+    TENUKI_EXPECT(board.recent_move(1)->is_pass());
+    TENUKI_EXPECT_EQ(board.recent_move(2)->vertex, 12);
+    TENUKI_EXPECT_FALSE(board.recent_move(3).has_value());
+    TENUKI_EXPECT_FALSE(board.play_move(Player::White, Move(7)));
+    TENUKI_EXPECT_EQ(board.recent_move(0)->vertex, 7);
+}
+
+void test_symmetric_keys_track_transformed_games() {
+    Rules rules;
+    rules.board_size = 7;
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> vertex_dist(0, 48);
+    std::vector<Move> moves;
+    Board board(rules);
+    Player player = Player::Black;
+    for (int attempt = 0; attempt < 80; ++attempt) {
+        const Move move(vertex_dist(rng));
+        if (board.play_move(player, move)) {
+            moves.push_back(move);
+            player = go::other(player);
+        }
+    }
+
+    for (int symmetry = 0; symmetry < go::kSymmetries; ++symmetry) {
+        TENUKI_EXPECT_EQ(go::transform_vertex(go::transform_vertex(10, symmetry, 7), go::inverse_symmetry(symmetry), 7), 10);
+        Board mirrored(rules);
+        Player mover = Player::Black;
+        for (const Move& move : moves) {
+            TENUKI_EXPECT(mirrored.play_move(mover, Move(go::transform_vertex(move.vertex, symmetry, 7))));
+            mover = go::other(mover);
+        }
+        TENUKI_EXPECT_EQ(mirrored.position_hash(), board.symmetric_position_hash(symmetry));
+        TENUKI_EXPECT_EQ(mirrored.canonical_state_key().key, board.canonical_state_key().key);
+
+        const Board transformed = board.transformed(symmetry);
+        TENUKI_EXPECT_EQ(transformed.position_hash(), board.symmetric_position_hash(symmetry));
+        TENUKI_EXPECT_EQ(transformed.recent_move(0)->vertex, go::transform_vertex(moves.back().vertex, symmetry, 7));
+        expect_liberties_match(transformed);
+    }
+    TENUKI_EXPECT_NE(board.canonical_state_key(Player::Black).key, board.canonical_state_key(Player::White).key);
+}
+
+void test_playout_board_tracks_board() {
+    // Light playouts mirrored move by move onto a simple-ko board: legality of every
+    // point, the resulting stones and the final score must agree.
+    for (const std::size_t size : {5u, 9u}) {
+        for (std::uint64_t seed = 1; seed <= 6; ++seed) {
+            Rules rules;
+            rules.board_size = size;
+            rules.ko_rule = KoRule::SimpleKo;
+            rules.komi = 0.5;
+            Board board(rules);
+            go::PlayoutBoard playout;
+            playout.reset(board, Player::Black);
+            go::PlayoutRng rng(seed);
+            int passes = 0;
+            for (int move = 0; move < 400 && passes < 2; ++move) {
+                const Player mover = playout.to_play();
+                for (std::size_t v = 0; v < size * size; ++v) {
+                    TENUKI_EXPECT_EQ(playout.is_legal(playout.padded(v), mover),
+                                     board.is_legal(mover, Move(static_cast<int>(v))));
+                }
+                const int point = playout.play_random(rng);
+                if (point < 0) {
+                    ++passes;
+                    TENUKI_EXPECT(board.play_move(mover, Move::Pass()));
+                    continue;
+                }
+                passes = 0;
+                TENUKI_EXPECT_EQ(playout.padded(playout.unpadded(point)), point);
+                TENUKI_EXPECT(board.play_move(mover, Move(static_cast<int>(playout.unpadded(point)))));
+                TENUKI_EXPECT(board.points() == std::vector<PointState>([&] {
+                    std::vector<PointState> points(size * size);
+                    for (std::size_t v = 0; v < points.size(); ++v) {
+                        points[v] = playout.point_state(v);
+                    }
+                    return points;
+                }()));
+            }
+            TENUKI_EXPECT_EQ(passes, 2);
+
+            const go::ScoreResult score = board.tromp_taylor_score();
+            std::vector<std::int8_t> ownership(size * size, 0);
+            TENUKI_EXPECT_NEAR(playout.score(ownership.data()),
+                               static_cast<float>(score.black_points - score.white_points), 1e-4f);
+            for (std::size_t v = 0; v < ownership.size(); ++v) {
+                if (board.point_state(v) != PointState::Empty) {
+                    TENUKI_EXPECT_EQ(ownership[v], board.point_state(v) == PointState::Black ? 1 : -1);
+                }
+            }
+
+            // A copy rebuilt from the finished board carries the same chains.
+            go::PlayoutBoard rebuilt;
+            rebuilt.reset(board, board.to_play());
+            for (std::size_t v = 0; v < size * size; ++v) {
+                TENUKI_EXPECT_EQ(rebuilt.is_legal(rebuilt.padded(v), board.to_play()),
+                                 board.is_legal(board.to_play(), Move(static_cast<int>(v))));
+            }
+        }
+    }
+}
+
+void test_playout_board_eyes() {
+    Rules rules;
+    rules.board_size = 5;
+    Board board(rules);
+    // Black owns the corner point 0 (neighbours 1 and 5) and the edge point 2.
+    const std::vector<int> black{1, 5, 6, 3, 7, 8};
+    const std::vector<int> white{20, 21, 22, 23, 24, 19};
+    for (std::size_t i = 0; i < black.size(); ++i) {
+        TENUKI_EXPECT(board.play_move(Player::Black, Move(black[i])));
+        TENUKI_EXPECT(board.play_move(Player::White, Move(white[i])));
+    }
+    go::PlayoutBoard playout;
+    playout.reset(board, Player::Black);
+    TENUKI_EXPECT(playout.is_eye(playout.padded(0), Player::Black));
+    TENUKI_EXPECT(playout.is_eye(playout.padded(2), Player::Black));
+    TENUKI_EXPECT(!playout.is_eye(playout.padded(0), Player::White));
+    TENUKI_EXPECT(!playout.is_eye(playout.padded(12), Player::Black));
+    // White may not fill black's eyes: both would be suicide.
+    TENUKI_EXPECT(!playout.is_legal(playout.padded(0), Player::White));
+    TENUKI_EXPECT(!playout.is_legal(playout.padded(2), Player::White));
+}
+
+template <std::size_t Lanes>
+void expect_lanes_track_boards(const Board& start, std::uint64_t seed) {
+    // Every lane's moves replayed on its own simple-ko board: the stones and the legality
+    // of every point after each step, the eye rule of PlayoutBoard for the moves chosen and
+    // the final scores and ownership must agree.
+    const std::size_t size = start.board_size();
+    auto lanes = std::make_unique<go::PlayoutLanes<Lanes>>();
+    lanes->reset(start, start.to_play(), seed);
+    std::vector<Board> boards(Lanes, start);
+    go::PlayoutBoard playout;
+    int steps = 0;
+    while (lanes->play_random_moves(1) > 0 || steps == 0) {
+        ++steps;
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            const int move = lanes->last_move(lane);
+            if (move == go::PlayoutLanes<Lanes>::kNoMove) {
+                TENUKI_EXPECT(!lanes->running(lane));
+                continue;
+            }
+            Board& board = boards[lane];
+            const Player mover = board.to_play();
+            playout.reset(board, mover);
+            if (move >= 0) {
+                TENUKI_EXPECT(!playout.is_eye(playout.padded(static_cast<std::size_t>(move)), mover));
+            } else {
+                for (std::size_t v = 0; v < size * size; ++v) {
+                    TENUKI_EXPECT(!board.is_legal(mover, Move(static_cast<int>(v))) ||
+                                  playout.is_eye(playout.padded(v), mover));
+                }
+            }
+            TENUKI_EXPECT(board.play_move(mover, move < 0 ? Move::Pass() : Move(move)));
+            TENUKI_EXPECT(lanes->to_play(lane) == board.to_play());
+            for (std::size_t v = 0; v < size * size; ++v) {
+                TENUKI_EXPECT(lanes->point_state(lane, v) == board.point_state(v));
+                TENUKI_EXPECT_EQ(lanes->is_legal(lane, v, board.to_play()),
+                                 board.is_legal(board.to_play(), Move(static_cast<int>(v))));
+            }
+        }
+    }
+    TENUKI_EXPECT(steps > static_cast<int>(size));
+
+    std::vector<float> scores(Lanes);
+    std::vector<std::int8_t> ownership(Lanes * size * size);
+    lanes->score_all(scores.data(), ownership.data());
+    std::vector<std::int8_t> expected(size * size);
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        TENUKI_EXPECT(!lanes->running(lane));
+        const go::ScoreResult score = go::score_area(boards[lane], expected.data());
+        TENUKI_EXPECT_NEAR(scores[lane], static_cast<float>(score.black_points - score.white_points), 1e-4f);
+        TENUKI_EXPECT(std::equal(expected.begin(), expected.end(),
+                                 ownership.begin() + static_cast<std::ptrdiff_t>(lane * size * size)));
+    }
+}
+
+void test_playout_lanes_track_boards() {
+    for (const std::size_t size : {5u, 9u}) {
+        Rules rules;
+        rules.board_size = size;
+        rules.ko_rule = KoRule::SimpleKo;
+        rules.komi = 0.5;
+        Board board(rules);
+        expect_lanes_track_boards<8>(board, 3);
+        expect_lanes_track_boards<16>(board, 11);
+
+        // From the middle of a game, white to move.
+        std::mt19937 rng(static_cast<unsigned>(size));
+        for (int moves = 0; moves < static_cast<int>(size * size / 2);) {
+            const Move move(static_cast<int>(rng() % (size * size)));
+            moves += board.play_move(board.to_play(), move) ? 1 : 0;
+        }
+        if (board.to_play() == Player::Black) {
+            TENUKI_EXPECT(board.play_move(Player::Black, Move::Pass()));
+        }
+        expect_lanes_track_boards<8>(board, 5);
+        expect_lanes_track_boards<16>(board, 7);
+    }
+}
+
+void expect_patterns_match(const Board& board) {
+    for (std::size_t v = 0; v < board.board_size() * board.board_size(); ++v) {
+        TENUKI_EXPECT_EQ(board.pattern(v), go::compute_pattern(board, v));
+    }
+}
+
+void test_incremental_patterns_match_recomputation() {
+    for (bool allow_suicide : {false, true}) {
+        Rules rules;
+        rules.board_size = 7;
+        rules.allow_suicide = allow_suicide;
+        std::mt19937 rng(allow_suicide ? 29u : 23u);
+        std::uniform_int_distribution<int> vertex_dist(0, 48);
+        for (int game = 0; game < 10; ++game) {
+            Board board(rules);
+            board.set_pattern_tracking(true);
+            expect_patterns_match(board);
+            Player player = Player::Black;
+            for (int move = 0; move < 160; ++move) {
+                Move choice = Move::Pass();
+                for (int attempt = 0; attempt < 20; ++attempt) {
+                    const Move candidate(vertex_dist(rng));
+                    if (board.is_legal(player, candidate)) {
+                        choice = candidate;
+                        break;
+                    }
+                }
+                TENUKI_EXPECT(board.play_move(player, choice));
+                player = go::other(player);
+                expect_patterns_match(board);
+            }
+
+            // Turning tracking on mid-game, setting a position and transforming the
+            // board all start from the same codes.
+            Board late(rules);
+            late.set_position(board.points(), board.to_play());
+            late.set_pattern_tracking(true);
+            expect_patterns_match(late);
+            for (int symmetry = 0; symmetry < go::kSymmetries; ++symmetry) {
+                const Board transformed = board.transformed(symmetry);
+                TENUKI_EXPECT(transformed.tracks_patterns());
+                expect_patterns_match(transformed);
+                for (std::size_t v = 0; v < 49; ++v) {
+                    const auto image = static_cast<std::size_t>(go::transform_vertex(static_cast<int>(v), symmetry, 7));
+                    TENUKI_EXPECT_EQ(transformed.pattern(image), go::transform_pattern(board.pattern(v), symmetry));
+                }
+            }
+            board.clear();
+            expect_patterns_match(board);
+        }
+    }
+}
+
+void test_pattern_codes() {
+    Rules rules;
+    rules.board_size = 5;
+    Board board(rules);
+    board.set_pattern_tracking(true);
+    // The corner sees the edge on five sides.
+    TENUKI_EXPECT_EQ(board.pattern(0), 3u << 0 | 3u << 6 | 3u << 8 | 3u << 12 | 3u << 14);
+    TENUKI_EXPECT(board.play_move(Player::Black, Move(1)));
+    TENUKI_EXPECT(board.play_move(Player::White, Move(2)));
+    TENUKI_EXPECT(board.play_move(Player::Black, Move(6)));
+    // White 2 keeps two liberties, 3 and 7.
+    TENUKI_EXPECT(!go::pattern_atari(board.pattern(3), 3));
+    TENUKI_EXPECT(board.play_move(Player::White, Move(20)));
+    TENUKI_EXPECT(board.play_move(Player::Black, Move(3)));
+    TENUKI_EXPECT(go::pattern_atari(board.pattern(7), 0));
+    TENUKI_EXPECT_EQ(go::pattern_color(board.pattern(7), 0), static_cast<std::uint32_t>(PointState::White));
+    TENUKI_EXPECT_EQ(go::pattern_color(go::pattern_for_player(board.pattern(7), Player::White), 0), 1u);
+    TENUKI_EXPECT_EQ(go::pattern_color(go::pattern_for_player(board.pattern(0), Player::White), 0), 3u);
+    TENUKI_EXPECT(board.play_move(Player::White, Move(21)));
+    TENUKI_EXPECT(board.play_move(Player::Black, Move(7)));
+    TENUKI_EXPECT_EQ(go::pattern_color(board.pattern(7 + 5), 0), static_cast<std::uint32_t>(PointState::Black));
+    TENUKI_EXPECT_EQ(board.point_state(2), PointState::Empty);
+    TENUKI_EXPECT_EQ(board.pattern(2) >> 16, 0u);
+    expect_patterns_match(board);
+}
+
+void test_undo_restores_every_position() {
+    for (bool allow_suicide : {false, true}) {
+        Rules rules;
+        rules.board_size = 7;
+        rules.allow_suicide = allow_suicide;
+        rules.ko_rule = KoRule::PositionalSuperko;
+        std::mt19937 rng(allow_suicide ? 41u : 37u);
+        std::uniform_int_distribution<int> vertex_dist(0, 48);
+        Board board(rules);
+        board.set_pattern_tracking(true);
+        board.set_undo_log(true);
+        TENUKI_EXPECT_FALSE(board.undo());
+
+        std::vector<Board> before;
+        Player player = Player::Black;
+        for (int move = 0; move < 200; ++move) {
+            Move choice = Move::Pass();
+            for (int attempt = 0; attempt < 20; ++attempt) {
+                const Move candidate(vertex_dist(rng));
+                if (board.is_legal(player, candidate)) {
+                    choice = candidate;
+                    break;
+                }
+            }
+            before.push_back(board);
+            TENUKI_EXPECT(board.play_move(player, choice));
+            player = go::other(player);
+        }
+        // A rejected move leaves nothing to undo.
+        const std::size_t depth = board.undo_depth();
+        TENUKI_EXPECT_EQ(depth, before.size());
+        for (std::size_t v = 0; v < 49; ++v) {
+            if (board.point_state(v) != PointState::Empty) {
+                TENUKI_EXPECT_FALSE(board.play_move(player, Move(static_cast<int>(v))));
+                break;
+            }
+        }
+        TENUKI_EXPECT_EQ(board.undo_depth(), depth);
+
+        while (!before.empty()) {
+            TENUKI_EXPECT(board.undo());
+            const Board& expected = before.back();
+            TENUKI_EXPECT(board.points() == expected.points());
+            TENUKI_EXPECT_EQ(board.state_key(), expected.state_key());
+            TENUKI_EXPECT_EQ(board.symmetric_position_hash(5), expected.symmetric_position_hash(5));
+            TENUKI_EXPECT_EQ(board.to_play(), expected.to_play());
+            TENUKI_EXPECT(board.ko_vertex() == expected.ko_vertex());
+            TENUKI_EXPECT(board.seen_positions() == expected.seen_positions());
+            for (std::size_t age = 0; age < Board::kRecentMoves; ++age) {
+                const auto got = board.recent_move(age);
+                const auto want = expected.recent_move(age);
+                TENUKI_EXPECT(got.has_value() == want.has_value() && (!got || got->vertex == want->vertex));
+            }
+            expect_liberties_match(board);
+            expect_patterns_match(board);
+            before.pop_back();
+        }
+        TENUKI_EXPECT_EQ(board.undo_depth(), 0u);
+        TENUKI_EXPECT_FALSE(board.undo());
+
+        // The log restarts with the position.
+        TENUKI_EXPECT(board.play_move(Player::Black, Move(24)));
+        board.set_position(board.points(), Player::White);
+        TENUKI_EXPECT_FALSE(board.undo());
+    }
+}
+
 void run_board_tests() {
     test_simple_capture();
     test_neutral_point_no_territory();
     test_simple_ko();
     test_positional_superko_prevents_cycle();
+    test_set_rules_keeps_position();
     test_tromp_taylor_score();
     test_suicide_rule_respected();
     test_state_key_includes_side_to_move();
+    test_incremental_liberties_match_flood_fill();
+    test_suicide_leaves_chain_without_liberties();
+    test_set_position_rebuilds_chains();
+    test_recent_moves_track_history();
+    test_symmetric_keys_track_transformed_games();
+    test_playout_board_tracks_board();
+    test_playout_board_eyes();
+    test_playout_lanes_track_boards();
+    test_incremental_patterns_match_recomputation();
+    test_pattern_codes();
+    test_undo_restores_every_position();
 }
 
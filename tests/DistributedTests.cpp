@@ -0,0 +1,233 @@
+#include "TestUtils.hpp"
+#include "go/Board.hpp"
+#include "search/Distributed.hpp"
+#include "search/Search.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+std::string temp_endpoint(const char* tag) {
+    return "unix:/tmp/tenuki-test-" + std::to_string(::getpid()) + "-" + tag + ".sock";
+}
+
+search::SearchConfig quiet_config(int playouts) {
+    search::SearchConfig config;
+    config.max_playouts = playouts;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    config.temperature = 0.0f;
+    config.temperature_move_cutoff = 0;
+    return config;
+}
+
+// Reads one whole message header and payload; false once the peer is gone.
+bool read_message(int fd, std::vector<std::uint8_t>& payload) {
+    const auto read_exactly = [fd](std::uint8_t* data, std::size_t size) {
+        while (size > 0) {
+            const ssize_t got = ::read(fd, data, size);
+            if (got <= 0) {
+                return false;
+            }
+            data += got;
+            size -= static_cast<std::size_t>(got);
+        }
+        return true;
+    };
+    std::uint8_t header[12];
+    if (!read_exactly(header, sizeof(header))) {
+        return false;
+    }
+    const std::uint32_t size = static_cast<std::uint32_t>(header[8]) | static_cast<std::uint32_t>(header[9]) << 8 |
+                               static_cast<std::uint32_t>(header[10]) << 16 | static_cast<std::uint32_t>(header[11]) << 24;
+    payload.resize(size);
+    return read_exactly(payload.data(), payload.size());
+}
+
+} // namespace
+
+void test_search_request_roundtrip() {
+    search::SearchRequest request;
+    request.rules.board_size = 3;
+    request.rules.komi = 5.5;
+    request.rules.ko_rule = go::KoRule::SimpleKo;
+    request.rules.scoring_rule = go::ScoringRule::Territory;
+    request.points = {go::PointState::Black, go::PointState::Empty, go::PointState::White,
+                      go::PointState::Empty, go::PointState::Empty, go::PointState::Empty,
+                      go::PointState::Empty, go::PointState::White, go::PointState::Empty};
+    request.to_play = go::Player::White;
+    request.ko_vertex = 4;
+    request.move_number = 12;
+    request.playouts = 33;
+    request.seed = 0xabcdu;
+
+    const search::SearchRequest decoded = search::decode_search_request(search::encode_search_request(request));
+    TENUKI_EXPECT_EQ(decoded.rules.board_size, 3u);
+    TENUKI_EXPECT_NEAR(decoded.rules.komi, 5.5, 1e-9);
+    TENUKI_EXPECT_EQ(decoded.rules.ko_rule, go::KoRule::SimpleKo);
+    TENUKI_EXPECT_EQ(decoded.rules.scoring_rule, go::ScoringRule::Territory);
+    TENUKI_EXPECT(decoded.points == request.points);
+    TENUKI_EXPECT_EQ(decoded.to_play, go::Player::White);
+    TENUKI_EXPECT_EQ(decoded.ko_vertex, 4);
+    TENUKI_EXPECT_EQ(decoded.move_number, 12);
+    TENUKI_EXPECT_EQ(decoded.playouts, 33);
+    TENUKI_EXPECT_EQ(decoded.seed, 0xabcdu);
+
+    std::vector<search::RootMoveStats> stats(2);
+    stats[0].move = -1;
+    stats[0].visit_count = 7;
+    stats[0].value_sum = -1.5f;
+    stats[1].move = 8;
+    stats[1].prior = 0.25f;
+    const auto decoded_stats = search::decode_search_result(search::encode_search_result(stats));
+    TENUKI_EXPECT_EQ(decoded_stats.size(), static_cast<std::size_t>(2));
+    TENUKI_EXPECT_EQ(decoded_stats[0].visit_count, 7);
+    TENUKI_EXPECT_NEAR(decoded_stats[0].value_sum, -1.5f, 1e-6);
+    TENUKI_EXPECT_EQ(decoded_stats[1].move, 8);
+}
+
+void test_coordinator_merges_worker_visits() {
+    const std::string endpoint = temp_endpoint("merge");
+    search::SearchWorker worker(endpoint, quiet_config(1), search::make_uniform_evaluator());
+    worker.listen();
+    std::thread server([&worker]() { worker.serve(); });
+
+    {
+        auto coordinator = std::make_shared<search::DistributedCoordinator>(std::vector<std::string>{endpoint});
+        TENUKI_EXPECT_EQ(coordinator->worker_count(), static_cast<std::size_t>(1));
+
+        go::Rules rules;
+        rules.board_size = 5;
+        go::Board board(rules);
+        TENUKI_EXPECT(board.play_move(go::Player::Black, go::Move(12)));
+
+        const search::SearchConfig config = quiet_config(24);
+        search::SearchAgent agent(config, search::make_uniform_evaluator());
+        agent.set_root_contributor(coordinator);
+        const auto stats = agent.search(board, board.to_play(), 1);
+
+        int visits = 0;
+        for (const search::RootMoveStats& entry : stats) {
+            visits += entry.visit_count;
+            TENUKI_EXPECT(entry.move != 12);
+        }
+        // The worker runs the same playout budget, so the merged root sees twice the visits.
+        TENUKI_EXPECT_EQ(visits, 2 * config.max_playouts);
+
+        coordinator->shutdown_workers();
+    }
+
+    server.join();
+    TENUKI_EXPECT_EQ(worker.requests_served(), 1);
+}
+
+void test_coordinator_drops_late_workers() {
+    const std::string endpoint = temp_endpoint("late");
+    const int listener = search::listen_on_endpoint(endpoint, 1);
+    TENUKI_EXPECT(listener >= 0);
+    // A worker that takes the request and never answers.
+    std::atomic<bool> done{false};
+    std::thread silent([listener, &done]() {
+        const int fd = ::accept(listener, nullptr, nullptr);
+        while (!done.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    });
+
+    {
+        search::DistributedCoordinator coordinator({endpoint}, 5000, 100);
+        TENUKI_EXPECT_EQ(coordinator.worker_count(), static_cast<std::size_t>(1));
+
+        go::Rules rules;
+        rules.board_size = 5;
+        const go::Board board(rules);
+        const auto start = std::chrono::steady_clock::now();
+        coordinator.begin(board, go::Player::Black, 0, 16);
+        TENUKI_EXPECT(coordinator.finish().empty());
+        TENUKI_EXPECT(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+        TENUKI_EXPECT_EQ(coordinator.worker_count(), static_cast<std::size_t>(0));
+    }
+
+    done.store(true);
+    silent.join();
+    ::close(listener);
+    search::remove_endpoint_file(endpoint);
+}
+
+void test_coordinator_drops_superko_moves_from_workers() {
+    go::Rules rules;
+    rules.board_size = 5;
+    rules.ko_rule = go::KoRule::PositionalSuperko;
+    go::Board board(rules);
+    for (const auto& [player, vertex] : {std::pair{go::Player::Black, 7}, {go::Player::White, 8},
+                                         {go::Player::Black, 12}, {go::Player::White, 17},
+                                         {go::Player::Black, 13}, {go::Player::White, 18},
+                                         {go::Player::Black, 19}}) {
+        TENUKI_EXPECT(board.play_move(player, go::Move(vertex)));
+    }
+    TENUKI_EXPECT(board.play_move(go::Player::White, go::Move::Pass()));
+    TENUKI_EXPECT(board.play_move(go::Player::Black, go::Move::Pass()));
+    // Retaking at 18 repeats an earlier position, which only the coordinator knows about.
+    constexpr int kSuperko = 18;
+    TENUKI_EXPECT_FALSE(board.is_legal(go::Player::White, go::Move(kSuperko)));
+
+    const std::string endpoint = temp_endpoint("superko");
+    const int listener = search::listen_on_endpoint(endpoint, 1);
+    TENUKI_EXPECT(listener >= 0);
+    // A worker that puts every visit on the retake, as one replaying the bare stones may.
+    std::thread worker([listener]() {
+        const int fd = ::accept(listener, nullptr, nullptr);
+        std::vector<std::uint8_t> payload;
+        if (fd >= 0 && read_message(fd, payload)) {
+            search::RootMoveStats retake;
+            retake.move = kSuperko;
+            retake.prior = 1.0f;
+            retake.visit_count = 1000;
+            retake.value_sum = 1000.0f;
+            const std::vector<std::uint8_t> result = search::encode_search_result({retake});
+            const std::uint8_t header[12] = {'T', 'N', 'K', 'D', 2, 0, 2, 0,
+                                             static_cast<std::uint8_t>(result.size()), 0, 0, 0};
+            TENUKI_EXPECT(::write(fd, header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)));
+            TENUKI_EXPECT(::write(fd, result.data(), result.size()) == static_cast<ssize_t>(result.size()));
+            while (read_message(fd, payload)) {
+            }
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    });
+
+    {
+        auto coordinator = std::make_shared<search::DistributedCoordinator>(std::vector<std::string>{endpoint});
+        search::SearchAgent agent(quiet_config(16), search::make_uniform_evaluator());
+        agent.set_root_contributor(coordinator);
+        const go::Move move = agent.select_move(board, go::Player::White, 9);
+        TENUKI_EXPECT(move.vertex != kSuperko);
+        TENUKI_EXPECT(board.is_legal(go::Player::White, move));
+        coordinator->shutdown_workers();
+    }
+
+    worker.join();
+    ::close(listener);
+    search::remove_endpoint_file(endpoint);
+}
+
+void run_distributed_tests() {
+    test_search_request_roundtrip();
+    test_coordinator_merges_worker_visits();
+    test_coordinator_drops_late_workers();
+    test_coordinator_drops_superko_moves_from_workers();
+}
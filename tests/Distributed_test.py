@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+
+def read_reply(proc):
+    lines = []
+    while True:
+        line = proc.stdout.readline()
+        if not line:
+            break
+        line = line.decode('utf-8', errors='replace')
+        lines.append(line)
+        if line.strip() == '':
+            break
+    return ''.join(lines)
+
+
+def send(proc, cmd):
+    proc.stdin.write((cmd + "\n").encode('utf-8'))
+    proc.stdin.flush()
+    return read_reply(proc)
+
+
+def expect_ok(reply):
+    assert reply.startswith('='), f"Expected OK reply, got: {reply!r}"
+    first_line = reply.split('\n', 1)[0]
+    return first_line[1:].strip()
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: Distributed_test.py <engine_binary>")
+        sys.exit(2)
+    binary = sys.argv[1]
+    assert os.path.exists(binary), f"Binary not found: {binary}"
+
+    env = os.environ.copy()
+    env.setdefault("TENUKI_MAX_PLAYOUTS", "8")
+
+    tmpdir = tempfile.mkdtemp(prefix="tenuki-dist-")
+    endpoints = [f"unix:{tmpdir}/worker{i}.sock" for i in range(2)]
+    workers = [
+        subprocess.Popen([binary, "--worker", ep], stdin=subprocess.DEVNULL, env=env)
+        for ep in endpoints
+    ]
+    coordinator = subprocess.Popen(
+        [binary, "--workers", ",".join(endpoints)],
+        stdin=subprocess.PIPE,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        env=env,
+    )
+
+    try:
+        expect_ok(send(coordinator, 'boardsize 9'))
+        expect_ok(send(coordinator, 'clear_board'))
+        for color in ['B', 'W', 'B', 'W']:
+            move = expect_ok(send(coordinator, f'genmove {color}'))
+            assert move == 'pass' or re.match(r'^[A-HJ][1-9]$', move), f"Bad move: {move}"
+        expect_ok(send(coordinator, 'quit'))
+        coordinator.wait(timeout=10)
+        assert coordinator.returncode == 0, f"coordinator exited with {coordinator.returncode}"
+    finally:
+        for proc in [coordinator] + workers:
+            try:
+                proc.terminate()
+            except Exception:
+                pass
+            try:
+                proc.wait(timeout=2)
+            except Exception:
+                proc.kill()
+
+
+if __name__ == '__main__':
+    main()
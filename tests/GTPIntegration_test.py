@@ -3,6 +3,7 @@ import os
 import re
 import subprocess
 import sys
+import tempfile
 
 
 def read_reply(proc):
@@ -39,6 +40,32 @@ def expect_fail(reply, expected_substring=None):
     return payload
 
 
+def read_analysis(proc, cmd, count, stop='name'):
+    """Starts an analysis command, returns its first `count` info lines, then stops it
+    by sending `stop` (an empty `stop` sends a blank line, which gets no reply)."""
+    proc.stdin.write((cmd + "\n").encode('utf-8'))
+    proc.stdin.flush()
+    header = proc.stdout.readline().decode('utf-8')
+    assert header.startswith('=') and header.strip() != '', f"Expected analysis header, got: {header!r}"
+    lines = []
+    while len(lines) < count:
+        line = proc.stdout.readline().decode('utf-8')
+        assert line.startswith('info move '), f"Expected info line, got: {line!r}"
+        lines.append(line.strip())
+    # Any input line ends the stream with an empty line before its own reply.
+    proc.stdin.write((stop + "\n").encode('utf-8'))
+    proc.stdin.flush()
+    while True:
+        line = proc.stdout.readline().decode('utf-8')
+        assert line, "Engine closed during analysis"
+        if line.strip() == '':
+            break
+        assert line.startswith('info move '), f"Unexpected line in analysis: {line!r}"
+    if stop:
+        assert expect_ok(read_reply(proc)) == 'Tenuki'
+    return lines
+
+
 def expect_vertex(move):
     assert move == 'pass' or re.match(r'^[A-HJ](?:[1-9]|1[0-9])$', move), f"Bad move: {move}"
 
@@ -109,6 +136,113 @@ def main():
         expect_fail(send(proc, 'play B A0'), 'invalid vertex')
         expect_fail(send(proc, 'play B Z1'), 'invalid vertex')
 
+        # Streaming analysis: info lines until the next command arrives.
+        expect_ok(send(proc, 'boardsize 9'))
+        expect_ok(send(proc, 'clear_board'))
+        expect_ok(send(proc, 'play B E5'))
+        for line in read_analysis(proc, '7 lz-analyze W 5', 3):
+            for entry in line.split('info ')[1:]:
+                match = re.match(r'^move (\S+) visits (\d+) winrate (\d+) prior (\d+) order (\d+) pv( \S+)+ ?$', entry)
+                assert match, f"Bad lz-analyze entry: {entry!r}"
+                expect_vertex(match.group(1))
+                assert 0 <= int(match.group(3)) <= 10000
+        for line in read_analysis(proc, 'kata-analyze 5 maxmoves 2', 2):
+            entries = line.split('info ')[1:]
+            assert 1 <= len(entries) <= 2, f"maxmoves not honoured: {line!r}"
+            assert re.match(r'^move \S+ visits \d+ winrate [01]\.\d+ prior [01]\.\d+ order 0 pv', entries[0]), line
+        # A blank line stops the stream too, as Lizzie does.
+        read_analysis(proc, 'lz-analyze B 5', 1, stop='')
+        assert expect_ok(send(proc, 'name')) == 'Tenuki'
+        expect_fail(send(proc, 'lz-analyze B interval'), 'invalid interval')
+        expect_fail(send(proc, 'kata-analyze B 10 ownership true'), 'unknown analyze argument')
+        move = expect_ok(send(proc, 'genmove W'))
+        expect_vertex(move)
+
+        # SGF: load a game in one command, replay part of it, save it back out.
+        sgf_path = os.path.join(tempfile.mkdtemp(), 'game.sgf')
+        with open(sgf_path, 'w') as handle:
+            handle.write('(;GM[1]SZ[7]KM[5.5];B[dd];W[cc];B[tt];W[ee]\n;B[ce])')
+        loaded = expect_ok(send(proc, f'loadsgf {sgf_path}'))
+        assert re.match(r'^5 moves in \d+\.\d\d ms$', loaded), loaded
+        board = expect_ok(send(proc, 'showboard'))
+        assert 'A B C D E F G' in board and 'H' not in board
+        assert expect_ok(send(proc, 'printsgf')) == '(;SZ[7]KM[5.5];B[dd];W[cc];B[];W[ee];B[ce])'
+        move = expect_ok(send(proc, 'genmove W'))
+        expect_vertex(move)
+        assert expect_ok(send(proc, f'loadsgf {sgf_path} 3')).startswith('2 moves in ')
+        assert expect_ok(send(proc, 'printsgf')) == '(;SZ[7]KM[5.5];B[dd];W[cc])'
+        expect_fail(send(proc, 'play W C5'), 'illegal move')
+        expect_ok(send(proc, 'play B E3'))
+        assert expect_ok(send(proc, 'printsgf')).endswith(';W[cc];B[ee])')
+        saved_path = os.path.join(os.path.dirname(sgf_path), 'saved.sgf')
+        expect_ok(send(proc, f'printsgf {saved_path}'))
+        assert expect_ok(send(proc, f'loadsgf {saved_path}')).startswith('3 moves in ')
+        expect_fail(send(proc, 'loadsgf /nonexistent/game.sgf'), 'cannot load file')
+        # Setup stones: handicap stones are placed, not dropped, and written back out.
+        handicap_path = os.path.join(os.path.dirname(sgf_path), 'handicap.sgf')
+        with open(handicap_path, 'w') as handle:
+            handle.write('(;SZ[7]KM[0.5]HA[2]AB[cc][ee];W[dd])')
+        assert expect_ok(send(proc, f'loadsgf {handicap_path}')).startswith('1 moves in ')
+        assert expect_ok(send(proc, 'printsgf')) == '(;SZ[7]KM[0.5]HA[2]AB[cc][ee];W[dd])'
+        expect_fail(send(proc, 'play B C5'), 'illegal move')
+        expect_ok(send(proc, 'undo'))
+        expect_fail(send(proc, 'undo'), 'cannot undo')
+        expect_fail(send(proc, 'play W E3'), 'illegal move')
+        with open(handicap_path, 'w') as handle:
+            handle.write('(;SZ[7];B[dd];AB[cc])')
+        expect_fail(send(proc, f'loadsgf {handicap_path}'), 'cannot load file')
+        # A file without KM keeps the komi the controller set.
+        expect_ok(send(proc, 'komi 3.5'))
+        with open(handicap_path, 'w') as handle:
+            handle.write('(;SZ[7];B[dd])')
+        expect_ok(send(proc, f'loadsgf {handicap_path}'))
+        assert expect_ok(send(proc, 'printsgf')) == '(;SZ[7]KM[3.5];B[dd])'
+        assert expect_ok(send(proc, f'loadsgf {saved_path}')).startswith('3 moves in ')
+        expect_fail(send(proc, f'loadsgf {sgf_path} 0'), 'invalid move number')
+        with open(sgf_path, 'w') as handle:
+            handle.write('(;SZ[5];B[aa];W[aa])')
+        expect_fail(send(proc, f'loadsgf {sgf_path}'), 'illegal move 2')
+        assert expect_ok(send(proc, 'printsgf')).endswith(';W[cc];B[ee])')
+
+        # Undo: step back through the loaded game and search from the earlier position.
+        expect_ok(send(proc, 'undo'))
+        assert expect_ok(send(proc, 'printsgf')) == '(;SZ[7]KM[5.5];B[dd];W[cc])'
+        expect_ok(send(proc, 'play B E3'))
+        expect_ok(send(proc, 'gg-undo 2'))
+        assert expect_ok(send(proc, 'printsgf')) == '(;SZ[7]KM[5.5];B[dd])'
+        expect_ok(send(proc, 'gg-undo 0'))
+        expect_fail(send(proc, 'gg-undo 2'), 'cannot undo')
+        expect_fail(send(proc, 'gg-undo x'), 'invalid number of moves')
+        expect_vertex(expect_ok(send(proc, 'genmove W')))
+        expect_ok(send(proc, 'gg-undo 2'))
+        expect_fail(send(proc, 'undo'), 'cannot undo')
+        expect_ok(send(proc, 'play B D4'))
+
+        # Komi and rules change in place: the game goes on from the same position.
+        expect_ok(send(proc, 'komi 5.5'))
+        expect_ok(send(proc, 'komi 6.5'))
+        assert expect_ok(send(proc, 'printsgf')) == '(;SZ[7]KM[6.5];B[dd])'
+        expect_ok(send(proc, 'kgs-rules japanese'))
+        expect_fail(send(proc, 'kgs-rules gomoku'), 'unknown rules')
+        expect_vertex(expect_ok(send(proc, 'genmove W')))
+        expect_ok(send(proc, 'undo'))
+        assert expect_ok(send(proc, 'printsgf')) == '(;SZ[7]KM[6.5];B[dd])'
+
+        # Runtime settings: search options change between moves, the rest only at startup.
+        assert expect_ok(send(proc, 'tenuki-set max_playouts')) == '8'
+        expect_ok(send(proc, 'tenuki-set num-threads 2'))
+        assert expect_ok(send(proc, 'tenuki-set num_threads')) == '2'
+        settings = send(proc, 'tenuki-set')
+        assert settings.startswith('= max_playouts 8\n') and '\nparallel_mode tree\n' in settings, settings
+        expect_vertex(expect_ok(send(proc, 'genmove W')))
+        expect_fail(send(proc, 'tenuki-set num_threads many'), 'invalid value')
+        expect_fail(send(proc, 'tenuki-set eval_cache 10'), 'cannot change at runtime')
+        expect_fail(send(proc, 'tenuki-set no_such_option 1'), 'unknown option')
+        for bad in ('max_playouts 0', 'retained_trees -1', 'virtual_loss_visits -1', 'trace_events_per_thread -1',
+                    'random_playouts_min 9'):
+            expect_fail(send(proc, f'tenuki-set {bad}'), 'invalid value')
+        assert expect_ok(send(proc, 'tenuki-set max_playouts')) == '8'
+
         expect_ok(send(proc, 'quit'))
     finally:
         try:
@@ -120,6 +254,44 @@ def main():
         except Exception:
             proc.kill()
 
+    check_startup_options(binary, env)
+
+
+def check_startup_options(binary, env):
+    # Config file, then environment, then flags; --print-config shows the result.
+    config_path = os.path.join(tempfile.mkdtemp(), 'tenuki.cfg')
+    with open(config_path, 'w') as handle:
+        handle.write('# test settings\nboard_size = 9\nnum_threads = 3\ncpuct = 2.5\nkomi = 6.5\n')
+    printed = subprocess.run([binary, '--config', config_path, '--num-threads=2', '--komi', '0.5', '--print-config'],
+                             capture_output=True, env=env, timeout=10)
+    assert printed.returncode == 0, printed.stderr
+    lines = printed.stdout.decode('utf-8').splitlines()
+    for expected in ('board_size = 9', 'num_threads = 2', 'cpuct = 2.5', 'komi = 0.5', 'max_playouts = 8'):
+        assert expected in lines, (expected, lines)
+    rejected = subprocess.run([binary, '--config', config_path, '--cpuct', 'high'], capture_output=True, env=env,
+                              timeout=10)
+    assert rejected.returncode != 0 and b'cpuct' in rejected.stderr
+    # --max-playouts fixes the count as TENUKI_MAX_PLAYOUTS does; the window can move in either order.
+    printed = subprocess.run([binary, '--max-playouts', '40', '--print-config'], capture_output=True, env=env,
+                             timeout=10)
+    lines = printed.stdout.decode('utf-8').splitlines()
+    for expected in ('max_playouts = 40', 'enable_playout_cap_randomization = false', 'random_playouts_min = 40',
+                     'random_playouts_max = 40'):
+        assert expected in lines, (expected, lines)
+    printed = subprocess.run([binary, '--random-playouts-min', '500', '--random-playouts-max', '600', '--print-config'],
+                             capture_output=True, env=env, timeout=10)
+    assert printed.returncode == 0 and 'random_playouts_min = 500' in printed.stdout.decode('utf-8'), printed.stderr
+    rejected = subprocess.run([binary, '--retained-trees', '-1'], capture_output=True, env=env, timeout=10)
+    assert rejected.returncode != 0 and b'retained_trees' in rejected.stderr
+
+    # --autotune settles the thread count before GTP starts.
+    proc = subprocess.run([binary, '--board-size', '5', '--autotune'], input=b'tenuki-set num_threads\nquit\n',
+                          capture_output=True, env=env, timeout=60)
+    assert proc.returncode == 0, proc.stderr
+    tuned = re.search(rb'autotune: using (\d+) threads', proc.stderr)
+    assert tuned, proc.stderr
+    assert proc.stdout.startswith(b'= ' + tuned.group(1) + b'\n'), proc.stdout
+
 
 if __name__ == '__main__':
     main()
@@ -0,0 +1,337 @@
+#include "TestUtils.hpp"
+#include "go/Board.hpp"
+#include "go/Ladder.hpp"
+#include "nn/Features.hpp"
+#include "search/Search.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using go::Board;
+using go::KoRule;
+using go::Move;
+using go::Player;
+using go::PointState;
+using go::Rules;
+using tenuki::test::board_from;
+
+namespace {
+
+std::size_t at(std::size_t x, std::size_t y, std::size_t size = 9) {
+    return y * size + x;
+}
+
+// Chain members and liberties by flood fill over the public board state.
+void chain_of(const Board& board, std::size_t vertex, std::vector<std::size_t>& stones, std::vector<std::size_t>& libs) {
+    const std::size_t size = board.board_size();
+    const PointState color = board.point_state(vertex);
+    std::vector<bool> seen(size * size, false);
+    stones.assign(1, vertex);
+    libs.clear();
+    seen[vertex] = true;
+    for (std::size_t i = 0; i < stones.size(); ++i) {
+        const std::size_t v = stones[i];
+        const std::size_t x = v % size;
+        const std::size_t y = v / size;
+        for (const auto& [nx, ny] : {std::pair{x - 1, y}, std::pair{x + 1, y}, std::pair{x, y - 1}, std::pair{x, y + 1}}) {
+            if (nx >= size || ny >= size || seen[ny * size + nx]) {
+                continue;
+            }
+            const std::size_t n = ny * size + nx;
+            seen[n] = true;
+            if (board.point_state(n) == color) {
+                stones.push_back(n);
+            } else if (board.point_state(n) == PointState::Empty) {
+                libs.push_back(n);
+            }
+        }
+    }
+}
+
+// Straightforward ladder reading on board copies, to check LadderReader against.
+bool reference_attacker_wins(const Board& board, std::size_t prey);
+
+bool reference_defender_loses(const Board& board, std::size_t prey) {
+    const Player defender = go::to_player(board.point_state(prey));
+    std::vector<std::size_t> stones;
+    std::vector<std::size_t> libs;
+    chain_of(board, prey, stones, libs);
+    std::vector<std::size_t> moves = libs;
+    const std::size_t size = board.board_size();
+    for (const std::size_t stone : stones) {
+        const std::size_t x = stone % size;
+        const std::size_t y = stone / size;
+        for (const auto& [nx, ny] : {std::pair{x - 1, y}, std::pair{x + 1, y}, std::pair{x, y - 1}, std::pair{x, y + 1}}) {
+            if (nx >= size || ny >= size) {
+                continue;
+            }
+            const std::size_t n = ny * size + nx;
+            if (board.point_state(n) == go::to_point(go::other(defender)) && board.liberties(n) == 1) {
+                std::vector<std::size_t> attacker_stones;
+                std::vector<std::size_t> attacker_libs;
+                chain_of(board, n, attacker_stones, attacker_libs);
+                moves.push_back(attacker_libs[0]);
+            }
+        }
+    }
+    for (const std::size_t move : moves) {
+        Board next = board;
+        if (!next.play_move(defender, Move(static_cast<int>(move)))) {
+            continue;
+        }
+        if (next.liberties(prey) >= 3 || !reference_attacker_wins(next, prey)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool reference_attacker_wins(const Board& board, std::size_t prey) {
+    const Player attacker = go::other(go::to_player(board.point_state(prey)));
+    std::vector<std::size_t> stones;
+    std::vector<std::size_t> libs;
+    chain_of(board, prey, stones, libs);
+    if (libs.size() == 1) {
+        return board.is_legal(attacker, Move(static_cast<int>(libs[0])));
+    }
+    if (libs.size() != 2) {
+        return false;
+    }
+    for (const std::size_t lib : libs) {
+        Board next = board;
+        if (next.play_move(attacker, Move(static_cast<int>(lib))) && next.liberties(prey) == 1 &&
+            reference_defender_loses(next, prey)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void test_edge_ladder_and_escapes() {
+    // White's corner stone runs along the edge and dies at the far corner.
+    const std::vector<std::string> corner{
+        "OX.......", ".........", ".........", ".........", ".........",
+        ".........", ".........", ".........", "........."};
+    Board board = board_from(corner, Player::White);
+    go::LadderReader reader(board);
+    TENUKI_EXPECT(reader.captured(0, Player::White));
+    TENUKI_EXPECT(reader.captured(0, Player::Black));
+    TENUKI_EXPECT(reader.is_failed_escape(Player::White, at(0, 1)));
+    TENUKI_EXPECT(!reader.captured(1, Player::Black)); // three liberties
+    TENUKI_EXPECT(reader.nodes() > 9);
+    TENUKI_EXPECT(go::ladder_captured(board, 0, Player::White));
+
+    // Queries leave the position untouched.
+    for (std::size_t v = 2; v < 81; ++v) {
+        TENUKI_EXPECT(!reader.captured(v, Player::White));
+    }
+    TENUKI_EXPECT(reader.captured(0, Player::White));
+
+    // With the black stone itself in atari, White escapes by taking it.
+    std::vector<std::string> capture = corner;
+    capture[0] = "OXO......";
+    const Board escape = board_from(capture, Player::White);
+    TENUKI_EXPECT(!go::ladder_captured(escape, 0, Player::White));
+    TENUKI_EXPECT(go::ladder_captured(escape, 0, Player::Black));
+    // Extending instead of capturing still runs into the edge ladder.
+    TENUKI_EXPECT(go::is_failed_ladder_escape(escape, Player::White, at(0, 1)));
+
+    // A friendly stone down the edge joins the running chain.
+    std::vector<std::string> joined = corner;
+    joined[2] = "OO.......";
+    TENUKI_EXPECT(!go::ladder_captured(board_from(joined, Player::White), 0, Player::White));
+}
+
+void test_diagonal_ladder_and_breaker() {
+    // White's stone in atari runs diagonally toward the far corner and dies there.
+    const std::vector<std::string> open{
+        ".........", "..XX.....", ".XO......", "..X......", ".........",
+        ".........", ".........", ".........", "........."};
+    const Board board = board_from(open, Player::White);
+    go::LadderReader reader(board);
+    TENUKI_EXPECT(reader.captured(at(2, 2), Player::White));
+    TENUKI_EXPECT(reader.is_failed_escape(Player::White, at(3, 2)));
+    TENUKI_EXPECT(reader.nodes() > 20);
+    TENUKI_EXPECT(reference_defender_loses(board, at(2, 2)));
+    Board chased = board;
+    TENUKI_EXPECT(chased.play_move(Player::White, Move(static_cast<int>(at(3, 2)))));
+    TENUKI_EXPECT(go::is_ladder_capture(chased, Player::Black, at(4, 2)));
+    TENUKI_EXPECT(!go::is_ladder_capture(chased, Player::Black, at(3, 3)));
+
+    // A white stone on the diagonal breaks it.
+    std::vector<std::string> broken = open;
+    broken[6] = "......O..";
+    const Board breaker = board_from(broken, Player::White);
+    TENUKI_EXPECT(!go::ladder_captured(breaker, at(2, 2), Player::White));
+    TENUKI_EXPECT(!reference_defender_loses(breaker, at(2, 2)));
+    // After the extension Black can still start the ladder, and now it fails.
+    Board extended = breaker;
+    TENUKI_EXPECT(extended.play_move(Player::White, Move(static_cast<int>(at(3, 2)))));
+    go::LadderReader after(extended);
+    TENUKI_EXPECT(!after.captured(at(2, 2), Player::Black));
+    TENUKI_EXPECT(!after.is_capture_move(Player::Black, at(4, 2)));
+    TENUKI_EXPECT(!after.is_capture_move(Player::Black, at(3, 3)));
+}
+
+void test_ladder_reader_aborts_at_log_cap() {
+    const std::vector<std::string> open{
+        ".........", "..XX.....", ".XO......", "..X......", ".........",
+        ".........", ".........", ".........", "........."};
+    const Board board = board_from(open, Player::White);
+    go::LadderReader reader(board);
+    TENUKI_EXPECT(reader.captured(at(2, 2), Player::White));
+    TENUKI_EXPECT(!reader.aborted());
+
+    // Room for a few moves only: the escape cannot be read out, which must not read as
+    // the defender having no legal escape.
+    for (std::size_t room : {0u, 1u, 4u, 8u}) {
+        reader.set_log_limit(go::LadderReader::kMaxPoints + room);
+        TENUKI_EXPECT(!reader.captured(at(2, 2), Player::White));
+        TENUKI_EXPECT(reader.aborted());
+        TENUKI_EXPECT(!reader.is_failed_escape(Player::White, at(3, 2)));
+        TENUKI_EXPECT(reader.aborted());
+    }
+
+    // Answers are back once the log is large enough again.
+    reader.set_log_limit(go::LadderReader::kMaxLog);
+    TENUKI_EXPECT(reader.captured(at(2, 2), Player::White));
+    TENUKI_EXPECT(reader.is_failed_escape(Player::White, at(3, 2)));
+    TENUKI_EXPECT(!reader.aborted());
+}
+
+void test_ladder_reader_matches_reference() {
+    Rules rules;
+    rules.board_size = 7;
+    rules.ko_rule = KoRule::SimpleKo;
+    std::mt19937 rng(41);
+    std::uniform_int_distribution<int> vertex_dist(0, 48);
+    int ladders = 0;
+    for (int game = 0; game < 12; ++game) {
+        Board board(rules);
+        for (int move = 0; move < 70; ++move) {
+            const Player player = board.to_play();
+            for (int attempt = 0; attempt < 20; ++attempt) {
+                const Move candidate(vertex_dist(rng));
+                if (board.is_legal(player, candidate)) {
+                    TENUKI_EXPECT(board.play_move(player, candidate));
+                    break;
+                }
+            }
+            if (move % 7 != 6) {
+                continue;
+            }
+            go::LadderReader reader(board);
+            for (std::size_t v = 0; v < 49; ++v) {
+                const PointState state = board.point_state(v);
+                if (state != PointState::Empty) {
+                    const int liberties = board.liberties(v);
+                    for (const Player to_move : {Player::Black, Player::White}) {
+                        const bool owner = go::to_point(to_move) == state;
+                        const bool expected = owner ? liberties == 1 && reference_defender_loses(board, v)
+                                                    : liberties >= 1 && liberties <= 2 && reference_attacker_wins(board, v);
+                        TENUKI_EXPECT_EQ(reader.captured(v, to_move), expected);
+                        ladders += expected ? 1 : 0;
+                    }
+                    continue;
+                }
+                for (const Player player : {Player::Black, Player::White}) {
+                    bool capture = false;
+                    bool failed_escape = false;
+                    Board next = board;
+                    if (next.play_move(player, Move(static_cast<int>(v)))) {
+                        std::vector<std::size_t> stones;
+                        std::vector<std::size_t> libs;
+                        for (std::size_t n = 0; n < 49; ++n) {
+                            if (board.point_state(n) == go::to_point(go::other(player)) && board.liberties(n) == 2 &&
+                                next.point_state(n) != PointState::Empty && next.liberties(n) == 1) {
+                                chain_of(board, n, stones, libs);
+                                const bool adjacent = libs[0] == v || libs[1] == v;
+                                capture = capture || (adjacent && reference_defender_loses(next, n));
+                            }
+                            if (board.point_state(n) == go::to_point(player) && board.liberties(n) == 1) {
+                                chain_of(board, n, stones, libs);
+                                if (libs[0] == v && next.liberties(v) <= 2) {
+                                    failed_escape = reference_attacker_wins(next, v);
+                                }
+                            }
+                        }
+                    }
+                    TENUKI_EXPECT_EQ(reader.is_capture_move(player, v), capture);
+                    TENUKI_EXPECT_EQ(reader.is_failed_escape(player, v), failed_escape);
+                }
+            }
+        }
+    }
+    TENUKI_EXPECT(ladders > 20);
+}
+
+void test_ladder_feature_planes() {
+    const Board board = board_from({"OX.......", ".........", ".........", ".........", ".........",
+                                    ".........", ".........", ".........", "........."},
+                                   Player::White);
+    std::vector<float> planes(static_cast<std::size_t>(nn::kLadderInputPlanes) * 81);
+    nn::encode_features(board, Player::White, nn::FeatureSet::Ladder, nn::TensorLayout::NCHW, planes.data());
+    const auto plane = [&](std::size_t p, std::size_t v) { return planes[p * 81 + v]; };
+    TENUKI_EXPECT_EQ(plane(16, 0), 1.0f);
+    TENUKI_EXPECT_EQ(plane(16, 1), 0.0f);
+    std::vector<float> extended(static_cast<std::size_t>(nn::kExtendedInputPlanes) * 81);
+    nn::encode_features(board, Player::White, nn::FeatureSet::Extended, nn::TensorLayout::NCHW, extended.data());
+    TENUKI_EXPECT(std::equal(extended.begin(), extended.end(), planes.begin()));
+    TENUKI_EXPECT_EQ(nn::feature_set_for_planes(nn::kLadderInputPlanes), nn::FeatureSet::Ladder);
+
+    // Black to move: taking the lone white stone is a capture, not a ladder start, and
+    // White's chain counts as dead.
+    nn::encode_features(board, Player::Black, nn::FeatureSet::Ladder, nn::TensorLayout::NCHW, planes.data());
+    TENUKI_EXPECT_EQ(plane(16, 0), 1.0f);
+    TENUKI_EXPECT_EQ(plane(17, at(0, 1)), 0.0f);
+}
+
+float root_prior(const search::SearchAgent& agent, std::size_t vertex) {
+    for (const search::RootMoveStats& entry : agent.root_statistics()) {
+        if (entry.move == static_cast<int>(vertex)) {
+            return entry.prior;
+        }
+    }
+    return -1.0f;
+}
+
+void test_search_scales_ladder_priors() {
+    const Board board = board_from({".........", "..XX.....", ".XO......", "..X......", ".........",
+                                    ".........", ".........", ".........", "........."},
+                                   Player::White);
+    search::SearchConfig config;
+    config.max_playouts = 8;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    config.read_ladders = true;
+
+    search::SearchAgent escape(config, search::make_uniform_evaluator());
+    escape.search(board, Player::White, 0);
+    TENUKI_EXPECT_NEAR(root_prior(escape, at(3, 2)), config.ladder_escape_factor * root_prior(escape, at(7, 7)), 1e-6f);
+
+    Board chased = board;
+    TENUKI_EXPECT(chased.play_move(Player::White, Move(static_cast<int>(at(3, 2)))));
+    search::SearchAgent capture(config, search::make_uniform_evaluator());
+    capture.search(chased, Player::Black, 0);
+    TENUKI_EXPECT_NEAR(root_prior(capture, at(4, 2)), config.ladder_capture_factor * root_prior(capture, at(7, 7)), 1e-6f);
+    TENUKI_EXPECT_NEAR(root_prior(capture, at(3, 3)), root_prior(capture, at(7, 7)), 1e-6f);
+
+    config.read_ladders = false;
+    search::SearchAgent plain(config, search::make_uniform_evaluator());
+    plain.search(chased, Player::Black, 0);
+    TENUKI_EXPECT_NEAR(root_prior(plain, at(4, 2)), root_prior(plain, at(7, 7)), 1e-6f);
+}
+
+} // namespace
+
+void run_ladder_tests() {
+    test_edge_ladder_and_escapes();
+    test_diagonal_ladder_and_breaker();
+    test_ladder_reader_aborts_at_log_cap();
+    test_ladder_reader_matches_reference();
+    test_ladder_feature_planes();
+    test_search_scales_ladder_priors();
+}
@@ -0,0 +1,571 @@
+#include "TestUtils.hpp"
+#include "go/Board.hpp"
+#include "nn/EvalServer.hpp"
+#include "nn/Features.hpp"
+#include "nn/Kernels.hpp"
+#include "nn/NeuralEvaluator.hpp"
+#include "nn/Network.hpp"
+#include "nn/Quantization.hpp"
+#include "nn/Winograd.hpp"
+#include "search/Scheduler.hpp"
+#include "search/Search.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+std::vector<float> random_values(std::size_t count, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> values(count);
+    for (float& value : values) {
+        value = dist(rng);
+    }
+    return values;
+}
+
+nn::NetworkShape small_shape() {
+    nn::NetworkShape shape;
+    shape.input_planes = nn::kBasicInputPlanes;
+    shape.trunk_channels = 8;
+    shape.blocks = 2;
+    shape.policy_channels = 4;
+    shape.value_channels = 4;
+    shape.value_hidden = 8;
+    return shape;
+}
+
+go::Board sample_board(std::size_t size) {
+    go::Rules rules;
+    rules.board_size = size;
+    go::Board board(rules);
+    TENUKI_EXPECT(board.play_move(go::Player::Black, go::Move(static_cast<int>(size + 1))));
+    TENUKI_EXPECT(board.play_move(go::Player::White, go::Move(static_cast<int>(2 * size + 2))));
+    return board;
+}
+
+} // namespace
+
+void test_gemm_matches_naive_product() {
+    // Odd sizes exercise the row and column tails of the vector kernels.
+    const int m = 7;
+    const int n = 45;
+    const int k = 19;
+    const auto a = random_values(static_cast<std::size_t>(m * k), 1);
+    const auto b = random_values(static_cast<std::size_t>(k * n), 2);
+    auto c = random_values(static_cast<std::size_t>(m * n), 3);
+    auto expected = c;
+    for (int i = 0; i < m; ++i) {
+        for (int j = 0; j < n; ++j) {
+            for (int p = 0; p < k; ++p) {
+                expected[static_cast<std::size_t>(i * n + j)] += a[static_cast<std::size_t>(i * k + p)] * b[static_cast<std::size_t>(p * n + j)];
+            }
+        }
+    }
+    nn::gemm(m, n, k, a.data(), b.data(), c.data());
+    for (std::size_t i = 0; i < c.size(); ++i) {
+        TENUKI_EXPECT_NEAR(c[i], expected[i], 1e-4);
+    }
+}
+
+void test_conv3x3_matches_reference() {
+    const int in_channels = 3;
+    const int out_channels = 5;
+    const int size = 7;
+    const std::size_t spatial = static_cast<std::size_t>(size * size);
+    const auto input = random_values(static_cast<std::size_t>(in_channels) * spatial, 4);
+    const auto weights = random_values(static_cast<std::size_t>(out_channels * in_channels * 9), 5);
+    const auto bias = random_values(static_cast<std::size_t>(out_channels), 6);
+
+    std::vector<float> expected(static_cast<std::size_t>(out_channels) * spatial);
+    nn::conv_reference(input.data(), in_channels, out_channels, size, size, 3, weights.data(), bias.data(), expected.data());
+
+    std::vector<float> columns(static_cast<std::size_t>(in_channels * 9) * spatial);
+    std::vector<float> actual(expected.size());
+    nn::conv3x3(input.data(), in_channels, out_channels, size, size, weights.data(), bias.data(), columns.data(), actual.data());
+    for (std::size_t i = 0; i < actual.size(); ++i) {
+        TENUKI_EXPECT_NEAR(actual[i], expected[i], 1e-4);
+    }
+}
+
+void test_winograd_matches_reference() {
+    const int in_channels = 6;
+    const int out_channels = 10;
+    // 19 and 13 leave partial edge tiles; 9 and 5 also cover tiny boards.
+    for (const int size : {5, 9, 13, 19}) {
+        const std::size_t spatial = static_cast<std::size_t>(size * size);
+        const auto input = random_values(static_cast<std::size_t>(in_channels) * spatial, 20);
+        const auto weights = random_values(static_cast<std::size_t>(out_channels * in_channels * 9), 21);
+        const auto bias = random_values(static_cast<std::size_t>(out_channels), 22);
+
+        std::vector<float> expected(static_cast<std::size_t>(out_channels) * spatial);
+        nn::conv_reference(input.data(), in_channels, out_channels, size, size, 3, weights.data(), bias.data(), expected.data());
+
+        std::vector<float> transformed(nn::winograd_weights_size(in_channels, out_channels));
+        nn::winograd_transform_weights(weights.data(), in_channels, out_channels, transformed.data());
+        const std::size_t tiles = nn::winograd_tile_count(size, size);
+        std::vector<float> input_scratch(static_cast<std::size_t>(nn::kWinogradPoints * in_channels) * tiles);
+        std::vector<float> output_scratch(static_cast<std::size_t>(nn::kWinogradPoints * out_channels) * tiles);
+        std::vector<float> actual(expected.size());
+        nn::conv3x3_winograd(input.data(), in_channels, out_channels, size, size, transformed.data(), bias.data(),
+                             input_scratch.data(), output_scratch.data(), actual.data());
+        for (std::size_t i = 0; i < actual.size(); ++i) {
+            TENUKI_EXPECT_NEAR(actual[i], expected[i], 1e-4 * std::max(1.0, std::fabs(static_cast<double>(expected[i]))));
+        }
+    }
+}
+
+void test_weights_roundtrip() {
+    const nn::NetworkWeights weights = nn::make_random_weights(small_shape(), 7);
+    std::stringstream stream;
+    nn::save_weights(weights, stream);
+    const std::string bytes = stream.str();
+
+    std::istringstream in(bytes);
+    const nn::NetworkWeights loaded = nn::load_weights(in);
+    TENUKI_EXPECT_EQ(loaded.shape.blocks, 2);
+    TENUKI_EXPECT_EQ(loaded.shape.trunk_channels, 8);
+    TENUKI_EXPECT(loaded.input.weights == weights.input.weights);
+    TENUKI_EXPECT(loaded.blocks[1].second.bias == weights.blocks[1].second.bias);
+    TENUKI_EXPECT(loaded.value_output.weights == weights.value_output.weights);
+
+    bool truncated_rejected = false;
+    try {
+        std::istringstream truncated(bytes.substr(0, bytes.size() - 3));
+        nn::load_weights(truncated);
+    } catch (const std::runtime_error&) {
+        truncated_rejected = true;
+    }
+    TENUKI_EXPECT(truncated_rejected);
+
+    bool magic_rejected = false;
+    try {
+        std::istringstream wrong("XXXX" + bytes.substr(4));
+        nn::load_weights(wrong);
+    } catch (const std::runtime_error&) {
+        magic_rejected = true;
+    }
+    TENUKI_EXPECT(magic_rejected);
+}
+
+void test_neural_evaluator_batch_matches_single() {
+    auto network = std::make_shared<const nn::Network>(nn::make_random_weights(small_shape(), 11));
+    nn::NeuralEvaluator single(network, 1);
+    nn::NeuralEvaluator threaded(network, 3);
+
+    const go::Board small = sample_board(5);
+    const go::Board large = sample_board(9);
+    const go::Board empty = go::Board(large.rules());
+    const std::vector<search::EvaluationRequest> requests{
+        {&small, go::Player::Black}, {&large, go::Player::Black}, {&empty, go::Player::White}, {&large, go::Player::White}};
+    const auto batch = threaded.evaluate_batch(requests);
+    TENUKI_EXPECT_EQ(batch.size(), requests.size());
+
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        const auto expected = single.evaluate(*requests[i].board, requests[i].to_play);
+        const std::size_t size = requests[i].board->board_size();
+        TENUKI_EXPECT_EQ(batch[i].policy.size(), size * size + 1);
+        float total = 0.0f;
+        for (std::size_t move = 0; move < batch[i].policy.size(); ++move) {
+            TENUKI_EXPECT_NEAR(batch[i].policy[move], expected.policy[move], 1e-6);
+            total += batch[i].policy[move];
+        }
+        TENUKI_EXPECT_NEAR(total, 1.0f, 1e-4);
+        TENUKI_EXPECT_NEAR(batch[i].value, expected.value, 1e-6);
+        TENUKI_EXPECT(batch[i].value >= -1.0f && batch[i].value <= 1.0f);
+    }
+    // Features are relative to the side to move, so the same stones evaluate differently.
+    TENUKI_EXPECT(batch[1].value != batch[3].value);
+
+    // The pool and its scratch buffers are reused by the next batch.
+    const auto again = threaded.evaluate_batch(requests);
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        TENUKI_EXPECT_EQ(again[i].value, batch[i].value);
+        TENUKI_EXPECT(again[i].policy == batch[i].policy);
+    }
+}
+
+void test_conv_algorithms_agree() {
+    const nn::NetworkWeights weights = nn::make_random_weights(small_shape(), 17);
+    const nn::Network im2col(weights, nn::ConvAlgorithm::Im2col);
+    const nn::Network winograd(weights, nn::ConvAlgorithm::Winograd);
+    TENUKI_EXPECT_EQ(nn::parse_conv_algorithm("im2col"), nn::ConvAlgorithm::Im2col);
+
+    const go::Board board = sample_board(19);
+    std::vector<float> inputs(nn::kBasicInputPlanes * 19 * 19);
+    nn::encode_basic_features(board, go::Player::Black, inputs.data());
+    std::vector<float> expected_policy(19 * 19 + 1);
+    std::vector<float> actual_policy(expected_policy.size());
+    float expected_value = 0.0f;
+    float actual_value = 0.0f;
+    im2col.forward(inputs.data(), 1, 19, expected_policy.data(), &expected_value);
+    winograd.forward(inputs.data(), 1, 19, actual_policy.data(), &actual_value);
+    for (std::size_t i = 0; i < expected_policy.size(); ++i) {
+        TENUKI_EXPECT_NEAR(actual_policy[i], expected_policy[i], 1e-3);
+    }
+    TENUKI_EXPECT_NEAR(actual_value, expected_value, 1e-4);
+}
+
+void test_int8_gemm_matches_naive_product() {
+    const int m = 9;
+    const int n = 37;
+    const int k = 40;
+    std::mt19937 rng(31);
+    std::uniform_int_distribution<int> weight(-nn::kWeightLevels, nn::kWeightLevels);
+    std::uniform_int_distribution<int> activation(0, nn::kActivationLevels);
+    std::vector<std::int8_t> a(static_cast<std::size_t>(m * k));
+    for (auto& value : a) {
+        value = static_cast<std::int8_t>(weight(rng));
+    }
+    std::vector<float> columns(static_cast<std::size_t>(k * n));
+    for (auto& value : columns) {
+        value = static_cast<float>(activation(rng));
+    }
+    // With a unit scale the packed codes are the column values themselves.
+    std::vector<std::uint8_t> packed(columns.size());
+    nn::quantize_pack(columns.data(), k, k, n, 1.0f, packed.data());
+    std::vector<std::int32_t> c(static_cast<std::size_t>(m * n));
+    nn::gemm_u8s8(m, n, k, a.data(), packed.data(), c.data());
+    for (int i = 0; i < m; ++i) {
+        for (int j = 0; j < n; ++j) {
+            std::int32_t expected = 0;
+            for (int p = 0; p < k; ++p) {
+                expected += static_cast<std::int32_t>(a[static_cast<std::size_t>(i * k + p)]) *
+                            static_cast<std::int32_t>(columns[static_cast<std::size_t>(p * n + j)]);
+            }
+            TENUKI_EXPECT_EQ(c[static_cast<std::size_t>(i * n + j)], expected);
+        }
+    }
+}
+
+void test_int8_network_tracks_fp32() {
+    const nn::Network fp32(nn::make_random_weights(small_shape(), 23));
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> vertex(0, 80);
+    const std::size_t stride = static_cast<std::size_t>(nn::kBasicInputPlanes) * 81;
+    const int count = 8;
+    std::vector<float> inputs(static_cast<std::size_t>(count) * stride);
+    for (int i = 0; i < count; ++i) {
+        go::Board board = sample_board(9);
+        for (int stone = 0; stone < 20; ++stone) {
+            board.play_move(board.to_play(), go::Move(vertex(rng)));
+        }
+        nn::encode_basic_features(board, board.to_play(), inputs.data() + static_cast<std::size_t>(i) * stride);
+    }
+
+    nn::CalibrationTable table;
+    fp32.calibrate(inputs.data(), count, 9, table);
+    TENUKI_EXPECT_EQ(table.activation_max.size(), fp32.quantizable_layer_count());
+    TENUKI_EXPECT_NEAR(table.activation_max[0], 1.0f, 1e-6); // binary input planes
+
+    std::stringstream stream;
+    nn::save_calibration(table, stream);
+    const nn::CalibrationTable loaded = nn::load_calibration(stream);
+    TENUKI_EXPECT(loaded.activation_max == table.activation_max);
+
+    nn::Network int8 = fp32;
+    int8.quantize(loaded);
+    TENUKI_EXPECT_EQ(int8.precision(), nn::Precision::Int8);
+
+    const std::size_t policy_size = 82;
+    std::vector<float> expected_policy(static_cast<std::size_t>(count) * policy_size);
+    std::vector<float> actual_policy(expected_policy.size());
+    std::vector<float> expected_values(static_cast<std::size_t>(count));
+    std::vector<float> actual_values(expected_values.size());
+    fp32.forward(inputs.data(), count, 9, expected_policy.data(), expected_values.data());
+    search::SchedulerOptions pool_options;
+    pool_options.threads = 2;
+    search::SearchScheduler pool(pool_options);
+    int8.forward(inputs.data(), count, 9, actual_policy.data(), actual_values.data(), &pool);
+    for (std::size_t i = 0; i < expected_policy.size(); ++i) {
+        TENUKI_EXPECT_NEAR(actual_policy[i], expected_policy[i], 0.05);
+    }
+    for (std::size_t i = 0; i < expected_values.size(); ++i) {
+        TENUKI_EXPECT_NEAR(actual_values[i], expected_values[i], 0.02);
+    }
+
+    nn::CalibrationTable truncated = table;
+    truncated.activation_max.pop_back();
+    bool rejected = false;
+    try {
+        int8.quantize(truncated);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    TENUKI_EXPECT(rejected);
+}
+
+void test_int8_network_tracks_fp32_with_komi() {
+    // Black to move sees negative komi; its plane has to survive the unsigned int8 input.
+    nn::NetworkShape shape = small_shape();
+    shape.input_planes = nn::kExtendedInputPlanes;
+    const nn::Network fp32(nn::make_random_weights(shape, 31));
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<int> vertex(0, 80);
+    const std::size_t stride = static_cast<std::size_t>(nn::kExtendedInputPlanes) * 81;
+    const int count = 6;
+    std::vector<float> inputs(static_cast<std::size_t>(count) * stride);
+    for (int i = 0; i < count; ++i) {
+        go::Board board = sample_board(9);
+        go::Rules rules = board.rules();
+        rules.komi = i % 2 == 0 ? 7.5 : 6.5;
+        board.set_rules(rules);
+        for (int stone = 0; stone < 10; ++stone) {
+            board.play_move(board.to_play(), go::Move(vertex(rng)));
+        }
+        nn::encode_features(board, go::Player::Black, nn::FeatureSet::Extended, nn::TensorLayout::NCHW,
+                            inputs.data() + static_cast<std::size_t>(i) * stride);
+        TENUKI_EXPECT(inputs[static_cast<std::size_t>(i) * stride + 14 * 81] > 0.0f);
+    }
+
+    nn::CalibrationTable table;
+    fp32.calibrate(inputs.data(), count, 9, table);
+    nn::Network int8 = fp32;
+    int8.quantize(table);
+
+    std::vector<float> expected_policy(static_cast<std::size_t>(count) * 82);
+    std::vector<float> actual_policy(expected_policy.size());
+    std::vector<float> expected_values(static_cast<std::size_t>(count));
+    std::vector<float> actual_values(expected_values.size());
+    fp32.forward(inputs.data(), count, 9, expected_policy.data(), expected_values.data());
+    int8.forward(inputs.data(), count, 9, actual_policy.data(), actual_values.data());
+    for (std::size_t i = 0; i < expected_policy.size(); ++i) {
+        TENUKI_EXPECT_NEAR(actual_policy[i], expected_policy[i], 0.05);
+    }
+    for (std::size_t i = 0; i < expected_values.size(); ++i) {
+        TENUKI_EXPECT_NEAR(actual_values[i], expected_values[i], 0.02);
+    }
+}
+
+void test_extended_features_encode_board_state() {
+    go::Rules rules;
+    rules.board_size = 5;
+    rules.komi = 7.5;
+    go::Board board(rules);
+    // Black 12 is in atari after White surrounds it on three sides.
+    for (const auto& [player, vertex] : {std::pair{go::Player::Black, 12}, std::pair{go::Player::White, 7},
+                                         std::pair{go::Player::Black, 0}, std::pair{go::Player::White, 11},
+                                         std::pair{go::Player::Black, 24}, std::pair{go::Player::White, 13}}) {
+        TENUKI_EXPECT(board.play_move(player, go::Move(vertex)));
+    }
+    TENUKI_EXPECT(board.play_move(go::Player::Black, go::Move::Pass()));
+
+    const std::size_t area = 25;
+    std::vector<float> planes(static_cast<std::size_t>(nn::kExtendedInputPlanes) * area);
+    nn::encode_features(board, go::Player::White, nn::FeatureSet::Extended, nn::TensorLayout::NCHW, planes.data());
+    const auto plane = [&](std::size_t index, std::size_t vertex) { return planes[index * area + vertex]; };
+
+    TENUKI_EXPECT_EQ(plane(0, 7), 1.0f);  // own (white) stone
+    TENUKI_EXPECT_EQ(plane(1, 12), 1.0f); // opponent stone
+    TENUKI_EXPECT_EQ(plane(2, 6), 1.0f);
+    TENUKI_EXPECT_EQ(plane(3, 12), 1.0f); // one liberty
+    TENUKI_EXPECT_EQ(plane(4, 0), 1.0f);  // corner stone, two liberties
+    TENUKI_EXPECT_EQ(plane(5, 7), 1.0f);  // three liberties
+    TENUKI_EXPECT_EQ(plane(3, 7), 0.0f);
+    for (std::size_t vertex = 0; vertex < area; ++vertex) {
+        const bool legal = board.is_legal(go::Player::White, go::Move(static_cast<int>(vertex)));
+        TENUKI_EXPECT_EQ(plane(7, vertex), legal && board.point_state(vertex) == go::PointState::Empty ? 1.0f : 0.0f);
+        TENUKI_EXPECT_EQ(plane(15, vertex), 1.0f);
+        TENUKI_EXPECT_EQ(plane(13, vertex), 0.0f);
+        TENUKI_EXPECT_NEAR(plane(14, vertex), 0.75f, 1e-6); // +7.5 for White
+    }
+    std::vector<float> black_planes(planes.size());
+    nn::encode_features(board, go::Player::Black, nn::FeatureSet::Extended, nn::TensorLayout::NCHW,
+                        black_planes.data());
+    TENUKI_EXPECT_NEAR(black_planes[14 * area], 0.25f, 1e-6); // -7.5 for Black
+    // Most recent move was a pass; then 13, 24, 11, 0.
+    for (std::size_t vertex = 0; vertex < area; ++vertex) {
+        TENUKI_EXPECT_EQ(plane(8, vertex), 0.0f);
+    }
+    TENUKI_EXPECT_EQ(plane(9, 13), 1.0f);
+    TENUKI_EXPECT_EQ(plane(10, 24), 1.0f);
+    TENUKI_EXPECT_EQ(plane(11, 11), 1.0f);
+    TENUKI_EXPECT_EQ(plane(12, 0), 1.0f);
+}
+
+void test_feature_layouts_agree() {
+    const go::Board board = sample_board(9);
+    for (nn::FeatureSet set : {nn::FeatureSet::Basic, nn::FeatureSet::Extended, nn::FeatureSet::Ladder}) {
+        nn::FeatureBatch nchw(set, nn::TensorLayout::NCHW, 9, 3);
+        nn::FeatureBatch nhwc(set, nn::TensorLayout::NHWC, 9, 3);
+        TENUKI_EXPECT_EQ(reinterpret_cast<std::uintptr_t>(nchw.data()) % nn::FeatureBatch::kAlignment, 0u);
+        TENUKI_EXPECT_EQ(nchw.stride(), static_cast<std::size_t>(nn::feature_planes(set)) * 81);
+        nchw.encode(2, board, go::Player::Black);
+        nhwc.encode(2, board, go::Player::Black);
+        const std::size_t planes = static_cast<std::size_t>(nn::feature_planes(set));
+        for (std::size_t p = 0; p < planes; ++p) {
+            for (std::size_t vertex = 0; vertex < 81; ++vertex) {
+                TENUKI_EXPECT_EQ(nchw.position(2)[p * 81 + vertex], nhwc.position(2)[vertex * planes + p]);
+            }
+        }
+    }
+    std::vector<float> basic(static_cast<std::size_t>(nn::kBasicInputPlanes) * 81);
+    nn::encode_basic_features(board, go::Player::Black, basic.data());
+    nn::FeatureBatch batch(nn::FeatureSet::Basic, nn::TensorLayout::NCHW, 9, 1);
+    batch.encode(0, board, go::Player::Black);
+    TENUKI_EXPECT(std::equal(basic.begin(), basic.end(), batch.data()));
+}
+
+void test_search_with_neural_evaluator() {
+    auto network = std::make_shared<const nn::Network>(nn::make_random_weights(small_shape(), 13));
+    auto evaluator = std::make_shared<nn::NeuralEvaluator>(network, 1);
+
+    go::Board board = sample_board(5);
+    search::SearchConfig config;
+    config.max_playouts = 24;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    search::SearchAgent agent(config, evaluator);
+    const go::Move move = agent.select_move(board, board.to_play(), 2);
+    TENUKI_EXPECT(board.is_legal(board.to_play(), move));
+
+    nn::NetworkShape extended = small_shape();
+    extended.input_planes = nn::kExtendedInputPlanes;
+    auto extended_evaluator = std::make_shared<nn::NeuralEvaluator>(
+        std::make_shared<const nn::Network>(nn::make_random_weights(extended, 14)), 1);
+    TENUKI_EXPECT_EQ(extended_evaluator->feature_set(), nn::FeatureSet::Extended);
+    search::SearchAgent extended_agent(config, extended_evaluator);
+    TENUKI_EXPECT(board.is_legal(board.to_play(), extended_agent.select_move(board, board.to_play(), 2)));
+
+    nn::NetworkShape mismatched = small_shape();
+    mismatched.input_planes = nn::kBasicInputPlanes + 1;
+    bool rejected = false;
+    try {
+        nn::NeuralEvaluator wrong(std::make_shared<const nn::Network>(nn::make_random_weights(mismatched, 1)));
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    TENUKI_EXPECT(rejected);
+}
+
+void test_eval_server_matches_local_evaluator() {
+    nn::NetworkShape shape = small_shape();
+    shape.input_planes = nn::kExtendedInputPlanes;
+    auto local = std::make_shared<nn::NeuralEvaluator>(
+        std::make_shared<const nn::Network>(nn::make_random_weights(shape, 29)), 1);
+
+    nn::EvalServerOptions options;
+    options.slots = 4;
+    options.max_batch = 4;
+    options.max_wait = std::chrono::microseconds(2000);
+    options.max_board_size = 9;
+    const std::string name = "/tenuki-test-" + std::to_string(::getpid()) + "-eval";
+    auto server = std::make_unique<nn::EvalServer>(name, local, options);
+    std::thread serving([&server] { server->serve(); });
+
+    std::vector<go::Board> boards;
+    for (const std::size_t size : {5u, 7u, 9u}) {
+        boards.push_back(sample_board(size));
+        go::Board board = sample_board(size);
+        TENUKI_EXPECT(board.play_move(go::Player::Black, go::Move(static_cast<int>(3 * size + 1))));
+        boards.push_back(board);
+    }
+    auto expect_matches = [&](const search::EvaluationResult& actual, const go::Board& board, go::Player to_play) {
+        const search::EvaluationResult expected = local->evaluate(board, to_play);
+        TENUKI_EXPECT_EQ(actual.policy.size(), expected.policy.size());
+        for (std::size_t move = 0; move < expected.policy.size() && move < actual.policy.size(); ++move) {
+            TENUKI_EXPECT_NEAR(actual.policy[move], expected.policy[move], 1e-5f);
+        }
+        TENUKI_EXPECT_NEAR(actual.value, expected.value, 1e-5f);
+    };
+
+    {
+        // Two "engines", each with search threads sharing its client, compete for four slots.
+        nn::SharedMemoryEvaluator first(name);
+        nn::SharedMemoryEvaluator second(name);
+        TENUKI_EXPECT_EQ(first.feature_set(), nn::FeatureSet::Extended);
+        TENUKI_EXPECT_EQ(first.max_board_size(), 9u);
+        std::vector<std::thread> threads;
+        std::vector<std::vector<search::EvaluationResult>> results(4);
+        for (std::size_t t = 0; t < results.size(); ++t) {
+            nn::SharedMemoryEvaluator& client = t % 2 == 0 ? first : second;
+            threads.emplace_back([&, t, &client = client] {
+                for (std::size_t round = 0; round < 3; ++round) {
+                    for (std::size_t i = 0; i < boards.size(); ++i) {
+                        const go::Board& board = boards[(i + t) % boards.size()];
+                        results[t].push_back(client.evaluate(board, board.to_play()));
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (std::size_t t = 0; t < results.size(); ++t) {
+            for (std::size_t k = 0; k < results[t].size(); ++k) {
+                const go::Board& board = boards[(k % boards.size() + t) % boards.size()];
+                expect_matches(results[t][k], board, board.to_play());
+            }
+        }
+
+        // More positions than slots go out in rounds.
+        std::vector<search::EvaluationRequest> requests;
+        for (const go::Board& board : boards) {
+            requests.push_back({&board, go::Player::White});
+        }
+        const auto batch = first.evaluate_batch(requests);
+        TENUKI_EXPECT_EQ(batch.size(), boards.size());
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            expect_matches(batch[i], boards[i], go::Player::White);
+        }
+
+        bool rejected = false;
+        try {
+            first.evaluate(sample_board(13), go::Player::Black);
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        TENUKI_EXPECT(rejected);
+
+        server->stop();
+        serving.join();
+        const nn::EvalServer::Stats stats = server->stats();
+        TENUKI_EXPECT_EQ(stats.positions, static_cast<std::uint64_t>(4 * 3 * boards.size() + boards.size()));
+        TENUKI_EXPECT(stats.batches <= stats.positions);
+        server.reset();
+
+        bool shut_down = false;
+        try {
+            second.evaluate(boards.front(), go::Player::Black);
+        } catch (const std::runtime_error&) {
+            shut_down = true;
+        }
+        TENUKI_EXPECT(shut_down);
+    }
+
+    bool missing = false;
+    try {
+        nn::SharedMemoryEvaluator absent(name);
+    } catch (const std::runtime_error&) {
+        missing = true;
+    }
+    TENUKI_EXPECT(missing);
+}
+
+void run_nn_tests() {
+    test_gemm_matches_naive_product();
+    test_conv3x3_matches_reference();
+    test_winograd_matches_reference();
+    test_weights_roundtrip();
+    test_neural_evaluator_batch_matches_single();
+    test_conv_algorithms_agree();
+    test_int8_gemm_matches_naive_product();
+    test_int8_network_tracks_fp32();
+    test_int8_network_tracks_fp32_with_komi();
+    test_extended_features_encode_board_state();
+    test_feature_layouts_agree();
+    test_search_with_neural_evaluator();
+    test_eval_server_matches_local_evaluator();
+}
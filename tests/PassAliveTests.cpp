@@ -0,0 +1,249 @@
+#include "TestUtils.hpp"
+#include "go/Board.hpp"
+#include "go/PassAlive.hpp"
+#include "go/PlayoutBoard.hpp"
+#include "search/RolloutEvaluator.hpp"
+#include "search/Search.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using go::Board;
+using go::KoRule;
+using go::Move;
+using go::Player;
+using go::PointState;
+using go::Rules;
+using tenuki::test::board_from;
+
+namespace {
+
+std::size_t at(std::size_t x, std::size_t y) {
+    return y * 7 + x;
+}
+
+// Top edge: a black and a white group with one eye each share the liberty at (3,0),
+// a seki. Below, a living white wall on the left and a living black wall on the right.
+const std::vector<std::string> kSeki{
+    ".XX.OO.",
+    "XXXXOOO",
+    "OOOOXXX",
+    ".O.OX.X",
+    "OOOOXXX",
+    "O.OOX.X",
+    ".OOOXX."};
+
+void test_pass_alive_seki_and_life() {
+    const Board board = board_from(kSeki, Player::Black);
+    go::PassAliveMap map;
+    map.update(board);
+    // The seki groups, their eyes and the shared liberty stay open.
+    for (const std::size_t v : {at(0, 0), at(1, 0), at(3, 0), at(4, 0), at(6, 0), at(3, 1), at(6, 1)}) {
+        TENUKI_EXPECT_EQ(map.owner(v), 0);
+    }
+    // Both walls live with their eyes.
+    for (const std::size_t v : {at(0, 2), at(0, 3), at(2, 3), at(1, 5), at(0, 6), at(3, 6)}) {
+        TENUKI_EXPECT_EQ(map.owner(v), -1);
+    }
+    for (const std::size_t v : {at(4, 2), at(5, 3), at(5, 5), at(6, 6), at(5, 6)}) {
+        TENUKI_EXPECT_EQ(map.owner(v), 1);
+    }
+    TENUKI_EXPECT_EQ(map.settled_count(), 49u - 14u);
+    TENUKI_EXPECT(!map.holds_dead_stones(at(5, 3)));
+    TENUKI_EXPECT(map.is_pointless(Player::Black, at(5, 3)));
+    TENUKI_EXPECT(map.is_pointless(Player::White, at(5, 3)));
+    TENUKI_EXPECT(!map.is_pointless(Player::Black, at(3, 0)));
+
+    // A single eye is not enough, however big.
+    const Board one_eye = board_from({"...X...", "XXXX...", ".......", ".......", ".......", ".......", "......."},
+                                     Player::White);
+    map.update(one_eye);
+    TENUKI_EXPECT_EQ(map.settled_count(), 0u);
+    // Two single-point eyes are.
+    const Board two_eyes = board_from({".X.X...", "XXXX...", ".......", ".......", ".......", ".......", "......."},
+                                      Player::White);
+    map.update(two_eyes);
+    TENUKI_EXPECT_EQ(map.settled_count(), 8u);
+    TENUKI_EXPECT_EQ(map.owner(at(2, 0)), 1);
+    TENUKI_EXPECT_EQ(map.owner(at(4, 0)), 0);
+
+    // Nothing on an empty board.
+    map.update(Board(one_eye.rules()));
+    TENUKI_EXPECT_EQ(map.settled_count(), 0u);
+}
+
+void test_pass_alive_dead_stones_and_cache() {
+    // The black wall's lower eye now holds a dead white stone.
+    std::vector<std::string> rows = kSeki;
+    rows[6] = ".OOOXO.";
+    Board board = board_from(rows, Player::Black);
+    go::PassAliveMap map;
+    map.update(board);
+    TENUKI_EXPECT_EQ(map.owner(at(5, 6)), 1);
+    TENUKI_EXPECT(map.holds_dead_stones(at(5, 5)));
+    TENUKI_EXPECT(map.holds_dead_stones(at(6, 6)));
+    TENUKI_EXPECT(!map.is_pointless(Player::Black, at(5, 5)));
+    TENUKI_EXPECT(map.is_pointless(Player::White, at(5, 5)));
+    TENUKI_EXPECT(map.is_pointless(Player::Black, at(5, 3)));
+    TENUKI_EXPECT_EQ(map.computations(), 1u);
+
+    // Passing leaves the stones alone and the map is not recomputed; a move is.
+    map.update(board);
+    TENUKI_EXPECT(board.play_move(Player::Black, Move::Pass()));
+    map.update(board);
+    TENUKI_EXPECT_EQ(map.computations(), 1u);
+    TENUKI_EXPECT(board.play_move(Player::White, Move(static_cast<int>(at(3, 0)))));
+    map.update(board);
+    TENUKI_EXPECT_EQ(map.computations(), 2u);
+    TENUKI_EXPECT_EQ(&go::pass_alive_map(board), &go::pass_alive_map(board));
+}
+
+// Chains the map calls pass-alive survive anything the opponent plays while their
+// owner passes.
+void test_pass_alive_survives_opponent_play() {
+    Rules rules;
+    rules.board_size = 7;
+    rules.ko_rule = KoRule::SimpleKo;
+    std::mt19937 rng(42);
+    int settled_positions = 0;
+    for (std::uint64_t seed = 1; seed <= 40; ++seed) {
+        // Finished light playouts never fill their own eyes, so they are full of life.
+        go::PlayoutBoard playout;
+        playout.reset(Board(rules), Player::Black);
+        go::PlayoutRng playout_rng(seed);
+        int passes = 0;
+        for (int move = 0; move < 300 && passes < 2; ++move) {
+            passes = playout.play_random(playout_rng) < 0 ? passes + 1 : 0;
+        }
+        std::vector<PointState> points(49);
+        for (std::size_t v = 0; v < points.size(); ++v) {
+            points[v] = playout.point_state(v);
+        }
+        for (const Player owner : {Player::Black, Player::White}) {
+            Board board(rules);
+            board.set_position(points, go::other(owner));
+            go::PassAliveMap map;
+            map.update(board);
+            const std::int8_t sign = owner == Player::Black ? 1 : -1;
+            std::vector<std::size_t> settled;
+            for (std::size_t v = 0; v < 49; ++v) {
+                if (map.owner(v) == sign) {
+                    settled.push_back(v);
+                }
+            }
+            if (settled.empty()) {
+                continue;
+            }
+            ++settled_positions;
+            std::uniform_int_distribution<int> vertex_dist(0, 48);
+            for (int move = 0; move < 120; ++move) {
+                for (int attempt = 0; attempt < 16; ++attempt) {
+                    const Move candidate(vertex_dist(rng));
+                    if (board.is_legal(go::other(owner), candidate)) {
+                        TENUKI_EXPECT(board.play_move(go::other(owner), candidate));
+                        break;
+                    }
+                }
+                TENUKI_EXPECT(board.play_move(owner, Move::Pass()));
+                for (const std::size_t v : settled) {
+                    if (points[v] == go::to_point(owner)) {
+                        TENUKI_EXPECT_EQ(board.point_state(v), go::to_point(owner));
+                    }
+                }
+            }
+        }
+    }
+    TENUKI_EXPECT(settled_positions > 20);
+}
+
+void test_settled_playouts() {
+    const Board board = board_from(kSeki, Player::Black);
+    const go::PassAliveMap& map = go::pass_alive_map(board);
+    go::PlayoutBoard playout;
+    playout.reset(board, Player::Black);
+    const std::size_t open = playout.empty_count();
+    playout.settle(map.owners());
+    TENUKI_EXPECT_EQ(playout.empty_count(), open - 7u);
+    go::PlayoutRng rng(3);
+    for (int move = 0; move < 200; ++move) {
+        const int point = playout.play_random(rng);
+        if (point >= 0) {
+            TENUKI_EXPECT_EQ(map.owner(playout.unpadded(point)), 0);
+        }
+    }
+    std::vector<std::int8_t> ownership(49);
+    playout.score(ownership.data());
+    for (std::size_t v = 0; v < 49; ++v) {
+        if (map.owner(v) != 0) {
+            TENUKI_EXPECT_EQ(ownership[v], map.owner(v));
+        }
+    }
+
+    // A fully settled board: every game is two passes and the score is exact.
+    Rules rules;
+    rules.board_size = 5;
+    rules.komi = 7.5;
+    Board settled(rules);
+    std::vector<PointState> points(25, PointState::Black);
+    points[0] = PointState::Empty;
+    points[12] = PointState::Empty;
+    settled.set_position(points, Player::White);
+    search::RolloutConfig config;
+    config.playouts = 8;
+    config.settle_pass_alive = true;
+    search::RolloutEvaluator evaluator(config);
+    const search::RolloutEvaluator::Rollouts stats = evaluator.rollouts(settled, Player::White);
+    TENUKI_EXPECT_EQ(stats.moves, 16);
+    TENUKI_EXPECT_NEAR(stats.mean_score, 17.5f, 1e-5f);
+    TENUKI_EXPECT_NEAR(stats.value, -1.0f, 1e-6f);
+}
+
+std::vector<int> root_moves(const search::SearchAgent& agent) {
+    std::vector<int> moves;
+    for (const search::RootMoveStats& entry : agent.root_statistics()) {
+        moves.push_back(entry.move);
+    }
+    std::sort(moves.begin(), moves.end());
+    return moves;
+}
+
+void test_search_prunes_pass_alive_moves() {
+    search::SearchConfig config;
+    config.max_playouts = 8;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    config.prune_pass_alive = true;
+
+    // Black may only fill its seki eye, play the shared liberty or pass.
+    const Board board = board_from(kSeki, Player::Black);
+    search::SearchAgent pruned(config, search::make_uniform_evaluator());
+    pruned.search(board, Player::Black, 0);
+    TENUKI_EXPECT(root_moves(pruned) == std::vector<int>({-1, static_cast<int>(at(0, 0)), static_cast<int>(at(3, 0))}));
+
+    config.prune_pass_alive = false;
+    search::SearchAgent plain(config, search::make_uniform_evaluator());
+    plain.search(board, Player::Black, 0);
+    TENUKI_EXPECT_EQ(root_moves(plain).size(), 6u);
+
+    // With a dead white stone in its eye, Black keeps the moves that capture it.
+    std::vector<std::string> rows = kSeki;
+    rows[6] = ".OOOXO.";
+    config.prune_pass_alive = true;
+    search::SearchAgent capture(config, search::make_uniform_evaluator());
+    capture.search(board_from(rows, Player::Black), Player::Black, 0);
+    const std::vector<int> moves = root_moves(capture);
+    TENUKI_EXPECT(std::find(moves.begin(), moves.end(), static_cast<int>(at(6, 6))) != moves.end());
+    TENUKI_EXPECT(std::find(moves.begin(), moves.end(), static_cast<int>(at(5, 3))) == moves.end());
+}
+
+} // namespace
+
+void run_pass_alive_tests() {
+    test_pass_alive_seki_and_life();
+    test_pass_alive_dead_stones_and_cache();
+    test_pass_alive_survives_opponent_play();
+    test_settled_playouts();
+    test_search_prunes_pass_alive_moves();
+}
@@ -21,6 +21,9 @@ void test_sgf_malformed_inputs_do_not_throw() {
     load_should_not_throw("(;B[];W[aa])");
     load_should_not_throw("(;C[unterminated comment\n ;B[aa])");
     load_should_not_throw("(;SZ[19]KM[7.5];B[qq])");
+    load_should_not_throw("(;AB[]AW[]PL[]HA[x];B[aa])");
+    load_should_not_throw("((((;B[aa]");
+    load_should_not_throw(")));AB[aa:ss]AE[");
 }
 
 void run_sgf_fuzz_tests() {
@@ -3,7 +3,9 @@
 #include "go/Board.hpp"
 
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 static void test_sgf_roundtrip_simple() {
     sgf::GameTree game;
@@ -20,7 +22,8 @@ static void test_sgf_roundtrip_simple() {
     sgf::GameTree loaded = sgf::load(iss);
 
     TENUKI_EXPECT_EQ(loaded.board_size, 9u);
-    TENUKI_EXPECT_NEAR(loaded.komi, 6.5, 1e-6);
+    TENUKI_EXPECT(loaded.komi.has_value());
+    TENUKI_EXPECT_NEAR(*loaded.komi, 6.5, 1e-6);
     TENUKI_EXPECT_EQ(loaded.moves.size(), static_cast<std::size_t>(3));
     TENUKI_EXPECT_EQ(loaded.moves[0].player, go::Player::Black);
     TENUKI_EXPECT_FALSE(loaded.moves[0].move.is_pass());
@@ -35,8 +38,67 @@ static void test_sgf_load_minimal() {
     TENUKI_EXPECT(loaded.moves.back().move.is_pass());
 }
 
+static void test_sgf_load_checks_coordinates() {
+    std::istringstream old_pass("(;SZ[19];B[tt];W[dd])");
+    const sgf::GameTree loaded = sgf::load(old_pass);
+    TENUKI_EXPECT(loaded.moves[0].move.is_pass());
+    TENUKI_EXPECT_EQ(loaded.moves[1].move.vertex, 3 * 19 + 3);
+
+    std::istringstream off_board("(;SZ[9];B[ja])");
+    bool rejected = false;
+    try {
+        sgf::load(off_board);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    TENUKI_EXPECT(rejected);
+}
+
+static void test_sgf_setup_stones() {
+    std::istringstream iss("(;SZ[9]HA[3]AB[cc][gc:gd]AW[ee]PL[W];W[dd];B[ff])");
+    const sgf::GameTree loaded = sgf::load(iss);
+    TENUKI_EXPECT_EQ(loaded.setup.handicap, 3);
+    TENUKI_EXPECT_FALSE(loaded.komi.has_value());
+    TENUKI_EXPECT(loaded.setup.black == (std::vector<int>{2 * 9 + 2, 2 * 9 + 6, 3 * 9 + 6}));
+    TENUKI_EXPECT(loaded.setup.white == std::vector<int>{4 * 9 + 4});
+    TENUKI_EXPECT(loaded.setup.to_play == go::Player::White);
+    TENUKI_EXPECT_EQ(loaded.moves.size(), static_cast<std::size_t>(2));
+
+    go::Rules rules;
+    rules.board_size = loaded.board_size;
+    go::Board board(rules);
+    sgf::apply_setup(loaded, board);
+    TENUKI_EXPECT_EQ(board.point_state(2 * 9 + 6), go::PointState::Black);
+    TENUKI_EXPECT_EQ(board.point_state(4 * 9 + 4), go::PointState::White);
+    TENUKI_EXPECT_EQ(board.to_play(), go::Player::White);
+    TENUKI_EXPECT(board.play_move(go::Player::White, loaded.moves[0].move));
+
+    std::ostringstream oss;
+    sgf::save(loaded, oss);
+    TENUKI_EXPECT_EQ(oss.str(), std::string("(;SZ[9]HA[3]AB[cc][gc][gd]AW[ee]PL[W];W[dd];B[ff])"));
+
+    std::istringstream late("(;SZ[9];B[aa];AB[bb])");
+    bool rejected = false;
+    try {
+        sgf::load(late);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    TENUKI_EXPECT(rejected);
+}
+
+static void test_sgf_load_follows_main_line() {
+    std::istringstream iss("(;SZ[9];B[aa](;W[bb];B[cc](;W[dd])(;W[ee]))(;W[ff]))(;SZ[9];B[gg])");
+    const sgf::GameTree loaded = sgf::load(iss);
+    TENUKI_EXPECT_EQ(loaded.moves.size(), static_cast<std::size_t>(4));
+    TENUKI_EXPECT_EQ(loaded.moves[3].move.vertex, 3 * 9 + 3);
+}
+
 void run_sgf_tests() {
     test_sgf_roundtrip_simple();
     test_sgf_load_minimal();
+    test_sgf_load_checks_coordinates();
+    test_sgf_setup_stones();
+    test_sgf_load_follows_main_line();
 }
 
@@ -0,0 +1,199 @@
+#include "TestUtils.hpp"
+#include "go/Board.hpp"
+#include "go/Scoring.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <vector>
+
+using go::Board;
+using go::PointState;
+using go::Rules;
+
+namespace {
+
+// Breadth-first region fill, the way Board::tromp_taylor_score() used to score.
+go::ScoreResult reference_score(const Board& board, std::vector<std::int8_t>& ownership) {
+    const std::size_t size = board.board_size();
+    const std::size_t area = size * size;
+    go::ScoreResult result;
+    std::vector<bool> visited(area, false);
+    ownership.assign(area, 0);
+    for (std::size_t v = 0; v < area; ++v) {
+        if (board.point_state(v) == PointState::Black) {
+            result.black_points += 1.0;
+            ownership[v] = 1;
+        } else if (board.point_state(v) == PointState::White) {
+            result.white_points += 1.0;
+            ownership[v] = -1;
+        } else if (!visited[v]) {
+            std::queue<std::size_t> queue;
+            std::vector<std::size_t> region;
+            queue.push(v);
+            visited[v] = true;
+            bool borders_black = false;
+            bool borders_white = false;
+            while (!queue.empty()) {
+                const std::size_t cur = queue.front();
+                queue.pop();
+                region.push_back(cur);
+                const std::size_t x = cur % size;
+                const std::size_t y = cur / size;
+                std::vector<std::size_t> neighbors;
+                if (x > 0) {
+                    neighbors.push_back(cur - 1);
+                }
+                if (x + 1 < size) {
+                    neighbors.push_back(cur + 1);
+                }
+                if (y > 0) {
+                    neighbors.push_back(cur - size);
+                }
+                if (y + 1 < size) {
+                    neighbors.push_back(cur + size);
+                }
+                for (const std::size_t n : neighbors) {
+                    if (board.point_state(n) == PointState::Empty && !visited[n]) {
+                        visited[n] = true;
+                        queue.push(n);
+                    } else if (board.point_state(n) == PointState::Black) {
+                        borders_black = true;
+                    } else if (board.point_state(n) == PointState::White) {
+                        borders_white = true;
+                    }
+                }
+            }
+            const std::int8_t owner = borders_black == borders_white ? 0 : borders_black ? 1 : -1;
+            if (owner > 0) {
+                result.black_points += static_cast<double>(region.size());
+            } else if (owner < 0) {
+                result.white_points += static_cast<double>(region.size());
+            }
+            for (const std::size_t point : region) {
+                ownership[point] = owner;
+            }
+        }
+    }
+    result.white_points += board.rules().komi;
+    return result;
+}
+
+void expect_matches_reference(const Board& board) {
+    std::vector<std::int8_t> expected_ownership;
+    const go::ScoreResult expected = reference_score(board, expected_ownership);
+    std::vector<std::int8_t> ownership(expected_ownership.size(), 5);
+    const go::ScoreResult score = go::score_area(board, ownership.data());
+    TENUKI_EXPECT_EQ(score.black_points, expected.black_points);
+    TENUKI_EXPECT_EQ(score.white_points, expected.white_points);
+    TENUKI_EXPECT(ownership == expected_ownership);
+    const go::ScoreResult through_board = board.tromp_taylor_score();
+    TENUKI_EXPECT_EQ(through_board.black_points, expected.black_points);
+    TENUKI_EXPECT_EQ(through_board.white_points, expected.white_points);
+}
+
+void test_score_matches_reference_fuzz() {
+    std::mt19937 rng(43);
+    for (const std::size_t size : {1u, 2u, 3u, 4u, 5u, 7u, 9u, 13u, 19u, 24u, 25u}) {
+        Rules rules;
+        rules.board_size = size;
+        rules.komi = size % 2 == 0 ? 0.5 : 7.5;
+        Board board(rules);
+        for (int round = 0; round < 60; ++round) {
+            // From nearly empty boards with lone stones to nearly full ones.
+            const double empty_share = 0.05 + 0.9 * static_cast<double>(round % 10) / 9.0;
+            const double black_share = static_cast<double>(round % 7) / 6.0;
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            std::vector<PointState> points(size * size);
+            for (PointState& point : points) {
+                point = unit(rng) < empty_share ? PointState::Empty
+                        : unit(rng) < black_share ? PointState::Black
+                                                  : PointState::White;
+            }
+            board.set_position(points, go::Player::Black);
+            expect_matches_reference(board);
+        }
+    }
+}
+
+void test_score_long_regions() {
+    // A one-point-wide corridor snaking through the whole board takes the flood round
+    // after round of sweeps; a single stone at its far end owns all of it.
+    for (const std::size_t size : {5u, 9u, 19u, 25u}) {
+        Rules rules;
+        rules.board_size = size;
+        Board board(rules);
+        std::vector<PointState> points(size * size, PointState::Empty);
+        for (std::size_t y = 1; y < size; y += 2) {
+            for (std::size_t x = 0; x < size; ++x) {
+                points[y * size + x] = PointState::White;
+            }
+            // Openings alternate between the right and left ends.
+            points[y * size + ((y / 2) % 2 == 0 ? size - 1 : 0)] = PointState::Empty;
+        }
+        board.set_position(points, go::Player::Black);
+        expect_matches_reference(board);
+        points[(size - 1) * size + (size - 1)] = PointState::Black;
+        board.set_position(points, go::Player::Black);
+        expect_matches_reference(board);
+    }
+
+    // The empty board belongs to nobody, a single stone owns everything.
+    Rules rules;
+    rules.board_size = 19;
+    rules.komi = 6.5;
+    Board board(rules);
+    go::ScoreResult score = go::score_area(board);
+    TENUKI_EXPECT_EQ(score.black_points, 0.0);
+    TENUKI_EXPECT_EQ(score.white_points, 6.5);
+    TENUKI_EXPECT(board.play_move(go::Player::Black, go::Move(180)));
+    score = go::score_area(board);
+    TENUKI_EXPECT_EQ(score.black_points, 361.0);
+}
+
+void test_score_batch() {
+    std::mt19937 rng(44);
+    std::vector<Board> boards;
+    for (const std::size_t size : {9u, 13u, 19u, 7u}) {
+        Rules rules;
+        rules.board_size = size;
+        Board board(rules);
+        std::uniform_int_distribution<int> vertex(0, static_cast<int>(size * size) - 1);
+        for (int move = 0; move < static_cast<int>(size * size); ++move) {
+            const go::Move candidate(vertex(rng));
+            if (board.is_legal(board.to_play(), candidate)) {
+                TENUKI_EXPECT(board.play_move(board.to_play(), candidate));
+            }
+        }
+        boards.push_back(board);
+    }
+    std::vector<const Board*> pointers;
+    std::size_t total_area = 0;
+    for (const Board& board : boards) {
+        pointers.push_back(&board);
+        total_area += board.board_size() * board.board_size();
+    }
+    std::vector<go::ScoreResult> scores(boards.size());
+    std::vector<std::int8_t> ownership(total_area);
+    go::score_area_batch(pointers.data(), pointers.size(), scores.data(), ownership.data());
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < boards.size(); ++i) {
+        std::vector<std::int8_t> expected_ownership;
+        const go::ScoreResult expected = reference_score(boards[i], expected_ownership);
+        TENUKI_EXPECT_EQ(scores[i].black_points, expected.black_points);
+        TENUKI_EXPECT_EQ(scores[i].white_points, expected.white_points);
+        TENUKI_EXPECT(std::equal(expected_ownership.begin(), expected_ownership.end(),
+                                 ownership.begin() + static_cast<std::ptrdiff_t>(offset)));
+        offset += expected_ownership.size();
+    }
+    go::score_area_batch(pointers.data(), pointers.size(), scores.data());
+    TENUKI_EXPECT_EQ(scores[3].black_points, boards[3].tromp_taylor_score().black_points);
+}
+
+} // namespace
+
+void run_scoring_tests() {
+    test_score_matches_reference_fuzz();
+    test_score_long_regions();
+    test_score_batch();
+}
@@ -1,11 +1,30 @@
 #include "TestUtils.hpp"
 #include "go/Board.hpp"
+#include "go/Pattern.hpp"
+#include "go/Symmetry.hpp"
+#include "search/BatchingEvaluator.hpp"
+#include "search/EvalCache.hpp"
+#include "search/MockEvaluator.hpp"
+#include "search/Options.hpp"
+#include "search/PatternEvaluator.hpp"
+#include "search/RolloutEvaluator.hpp"
 #include "search/Search.hpp"
+#include "search/SymmetricEvaluator.hpp"
+#include "search/Topology.hpp"
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <memory>
+#include <optional>
 #include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace {
 
@@ -44,6 +63,70 @@ public:
     std::atomic<int> calls{0};
 };
 
+// Deliberately orientation-dependent: the prior grows with the vertex index and the
+// value counts stones on the first row. Counts batches and positions it was given.
+class OrientedEvaluator : public search::Evaluator {
+public:
+    search::EvaluationResult evaluate(const go::Board& board, go::Player) override {
+        const std::size_t size = board.board_size();
+        search::EvaluationResult result;
+        result.policy.resize(size * size + 1);
+        for (std::size_t vertex = 0; vertex < size * size; ++vertex) {
+            result.policy[vertex] = 1.0f + static_cast<float>(vertex) +
+                                    (board.point_state(vertex) == go::PointState::Black ? 100.0f : 0.0f);
+        }
+        result.policy[size * size] = 0.5f;
+        for (std::size_t x = 0; x < size; ++x) {
+            if (board.point_state(x) != go::PointState::Empty) {
+                result.value += 0.1f;
+            }
+        }
+        return result;
+    }
+
+    std::vector<search::EvaluationResult> evaluate_batch(const std::vector<search::EvaluationRequest>& requests) override {
+        batches.fetch_add(1, std::memory_order_relaxed);
+        positions.fetch_add(static_cast<int>(requests.size()), std::memory_order_relaxed);
+        return search::Evaluator::evaluate_batch(requests);
+    }
+
+    std::atomic<int> batches{0};
+    std::atomic<int> positions{0};
+};
+
+// Depends only on the stones, so it commutes with every board symmetry.
+class EquivariantEvaluator : public OrientedEvaluator {
+public:
+    search::EvaluationResult evaluate(const go::Board& board, go::Player) override {
+        const std::size_t size = board.board_size();
+        search::EvaluationResult result;
+        result.policy.assign(size * size + 1, 1.0f);
+        for (std::size_t vertex = 0; vertex < size * size; ++vertex) {
+            if (board.point_state(vertex) != go::PointState::Empty) {
+                result.policy[vertex] = 0.0f;
+                result.value += board.point_state(vertex) == go::PointState::Black ? 0.05f : -0.05f;
+            }
+        }
+        for (std::size_t vertex = 0; vertex < size * size; ++vertex) {
+            const std::size_t x = vertex % size;
+            const std::size_t y = vertex / size;
+            const std::size_t edge = std::min(std::min(x, size - 1 - x), std::min(y, size - 1 - y));
+            result.policy[vertex] *= 1.0f + static_cast<float>(edge);
+        }
+        return result;
+    }
+};
+
+go::Board asymmetric_board() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+    TENUKI_EXPECT(board.play_move(go::Player::Black, go::Move(1)));
+    TENUKI_EXPECT(board.play_move(go::Player::White, go::Move(7)));
+    TENUKI_EXPECT(board.play_move(go::Player::Black, go::Move(13)));
+    return board;
+}
+
 go::Move choose_alternate_move(const go::Board& board, const go::Move& primary) {
     const std::size_t area = board.board_size() * board.board_size();
     for (std::size_t idx = 0; idx < area; ++idx) {
@@ -117,6 +200,97 @@ void test_search_prefers_high_prior_move() {
     TENUKI_EXPECT_EQ(move.vertex, 0);
 }
 
+// Values +1 for the side to move once it holds the centre of a 5x5 board, -1 once the
+// opponent does: the search has to back values up for the player choosing each edge.
+class CentreEvaluator : public search::Evaluator {
+public:
+    search::EvaluationResult evaluate(const go::Board& board, go::Player to_play) override {
+        search::EvaluationResult result;
+        result.policy.assign(board.board_size() * board.board_size() + 1, 1.0f);
+        const go::PointState centre = board.point_state(12);
+        result.value = centre == go::PointState::Empty ? 0.0f : centre == go::to_point(to_play) ? 1.0f : -1.0f;
+        return result;
+    }
+};
+
+void test_search_backs_up_values_for_moving_player() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+
+    search::SearchConfig config;
+    config.max_playouts = 400;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    config.temperature = 0.0f;
+    config.temperature_move_cutoff = 0;
+
+    search::SearchAgent agent(config, std::make_shared<CentreEvaluator>());
+    const go::Move move = agent.select_move(board, go::Player::Black, 0);
+    TENUKI_EXPECT_EQ(move.vertex, 12);
+    for (const search::RootMoveStats& entry : agent.root_statistics()) {
+        if (entry.move == 12) {
+            TENUKI_EXPECT_NEAR(entry.value_sum / static_cast<float>(entry.visit_count), 1.0f, 1e-6f);
+        }
+    }
+}
+
+void test_analysis_reports_until_stopped() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+
+    for (const int threads : {1, 3}) {
+        search::SearchConfig config;
+        config.dirichlet_epsilon = 0.0f;
+        config.num_threads = threads;
+        search::SearchAgent agent(config, std::make_shared<CentreEvaluator>());
+
+        std::atomic<bool> stop{false};
+        int reports = 0;
+        int last_visits = 0;
+        const std::vector<search::RootMoveStats> stats = agent.analyze(
+            board, go::Player::Black, 0, stop, std::chrono::milliseconds(2),
+            [&](const std::vector<search::MoveAnalysis>& moves) {
+                TENUKI_EXPECT(!moves.empty());
+                int visits = 0;
+                for (std::size_t i = 0; i < moves.size(); ++i) {
+                    TENUKI_EXPECT(moves[i].stats.visit_count > 0);
+                    TENUKI_EXPECT(i == 0 || moves[i - 1].stats.visit_count >= moves[i].stats.visit_count);
+                    TENUKI_EXPECT(!moves[i].pv.empty() && moves[i].pv.front() == moves[i].stats.move);
+                    TENUKI_EXPECT(moves[i].pv.size() <= 16u);
+                    visits += moves[i].stats.visit_count;
+                }
+                TENUKI_EXPECT(visits >= last_visits);
+                last_visits = visits;
+                if (++reports >= 4 && visits >= 300) {
+                    stop.store(true);
+                }
+            });
+        TENUKI_EXPECT(reports >= 4);
+        int total = 0;
+        for (const search::RootMoveStats& entry : stats) {
+            total += entry.visit_count;
+        }
+        TENUKI_EXPECT(total >= last_visits);
+
+        // The best line starts in the centre and keeps growing with the tree; a later
+        // search of the same position reuses it.
+        const std::vector<search::MoveAnalysis> snapshot = agent.analysis_snapshot();
+        TENUKI_EXPECT_EQ(snapshot.front().stats.move, 12);
+        TENUKI_EXPECT(snapshot.front().pv.size() > 1u);
+        TENUKI_EXPECT_EQ(agent.analysis_snapshot(1).front().pv.size(), 1u);
+    }
+
+    // Already stopped: no report and no harm.
+    search::SearchAgent agent(search::SearchConfig{}, std::make_shared<CountingEvaluator>());
+    std::atomic<bool> stop{true};
+    int reports = 0;
+    agent.analyze(board, go::Player::Black, 0, stop, std::chrono::milliseconds(1),
+                  [&](const std::vector<search::MoveAnalysis>&) { ++reports; });
+    TENUKI_EXPECT_EQ(reports, 0);
+}
+
 void test_search_returns_pass_when_no_legal_moves() {
     go::Rules rules;
     rules.board_size = 1;
@@ -217,12 +391,784 @@ void test_notify_move_resets_tree_when_child_unexpanded() {
     TENUKI_EXPECT(evaluator->calls.load(std::memory_order_relaxed) > calls_after_first);
 }
 
+// Notes whether a simulation handed it a board that still keeps an undo log.
+class UndoLogProbe : public CentreEvaluator {
+public:
+    search::EvaluationResult evaluate(const go::Board& board, go::Player to_play) override {
+        if (board.keeps_undo_log()) {
+            saw_undo_log = true;
+        }
+        return CentreEvaluator::evaluate(board, to_play);
+    }
+
+    std::atomic<bool> saw_undo_log{false};
+};
+
+void test_undo_restores_retained_trees() {
+    const auto root_visits = [](const search::SearchAgent& agent) {
+        int visits = 0;
+        for (const search::RootMoveStats& entry : agent.root_statistics()) {
+            visits += entry.visit_count;
+        }
+        return visits;
+    };
+
+    for (int retained : {8, 0}) {
+        go::Rules rules;
+        rules.board_size = 5;
+        go::Board board(rules);
+        board.set_undo_log(true);
+
+        search::SearchConfig config;
+        config.max_playouts = 120;
+        config.enable_playout_cap_randomization = false;
+        config.dirichlet_epsilon = 0.0f;
+        config.temperature = 0.0f;
+        config.temperature_move_cutoff = 0;
+        config.retained_trees = retained;
+        const auto probe = std::make_shared<UndoLogProbe>();
+        search::SearchAgent agent(config, probe);
+
+        // Search three positions in a row, then step back to the first.
+        std::vector<go::Move> moves;
+        std::vector<int> visits;
+        for (int ply = 0; ply < 2; ++ply) {
+            const go::Move move = agent.select_move(board, board.to_play(), ply);
+            visits.push_back(root_visits(agent));
+            moves.push_back(move);
+            TENUKI_EXPECT(board.play_move(board.to_play(), move));
+            agent.notify_move(move, board, board.to_play());
+        }
+        agent.search(board, board.to_play(), 2);
+        visits.push_back(root_visits(agent));
+        TENUKI_EXPECT_EQ(visits[0], 120);
+        TENUKI_EXPECT(visits[1] >= 120 && visits[2] >= 120);
+
+        TENUKI_EXPECT(board.undo() && board.undo());
+        agent.notify_position(board, board.to_play());
+        if (retained == 0) {
+            TENUKI_EXPECT_EQ(root_visits(agent), 0);
+            continue;
+        }
+        TENUKI_EXPECT_EQ(root_visits(agent), visits[0]);
+
+        // Replaying the same moves walks back down the reassembled trees.
+        for (std::size_t ply = 0; ply < moves.size(); ++ply) {
+            TENUKI_EXPECT(board.play_move(board.to_play(), moves[ply]));
+            agent.notify_move(moves[ply], board, board.to_play());
+            TENUKI_EXPECT_EQ(root_visits(agent), visits[ply + 1]);
+        }
+
+        // Searching after an undo resumes the retained tree rather than starting over.
+        TENUKI_EXPECT(board.undo());
+        agent.search(board, board.to_play(), 1);
+        TENUKI_EXPECT_EQ(root_visits(agent), visits[1] + 120);
+        // The game keeps its undo log; the boards simulations copy do not.
+        TENUKI_EXPECT(board.keeps_undo_log());
+        TENUKI_EXPECT_FALSE(probe->saw_undo_log.load());
+    }
+}
+
+void test_rules_change_switches_trees() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+    search::SearchConfig config;
+    config.max_playouts = 80;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    search::SearchAgent agent(config, std::make_shared<CentreEvaluator>());
+    const auto root_visits = [&agent]() {
+        int visits = 0;
+        for (const search::RootMoveStats& entry : agent.root_statistics()) {
+            visits += entry.visit_count;
+        }
+        return visits;
+    };
+
+    agent.search(board, board.to_play(), 0);
+    TENUKI_EXPECT_EQ(root_visits(), 80);
+    // Values searched under one komi are not reused under another...
+    go::Rules other = rules;
+    other.komi = 0.5;
+    board.set_rules(other);
+    agent.search(board, board.to_play(), 0);
+    TENUKI_EXPECT_EQ(root_visits(), 80);
+    // ...but the first tree is kept, and comes back with the first komi.
+    board.set_rules(rules);
+    agent.notify_position(board, board.to_play());
+    TENUKI_EXPECT_EQ(root_visits(), 80);
+    agent.search(board, board.to_play(), 0);
+    TENUKI_EXPECT_EQ(root_visits(), 160);
+}
+
+void test_engine_options_round_trip() {
+    search::EngineOptions options;
+    search::set_option(options, "max-playouts", "77");
+    search::set_option(options, "parallel_mode", "root");
+    search::set_option(options, "pin_threads", "on");
+    search::set_option(options, "cpuct", " 2.5 ");
+    search::set_option(options, "weights", "nets/a b.bin");
+    TENUKI_EXPECT_EQ(options.search.max_playouts, 77);
+    TENUKI_EXPECT(options.search.parallel_mode == search::ParallelMode::RootParallel);
+    TENUKI_EXPECT(options.search.pin_threads);
+    TENUKI_EXPECT_NEAR(options.search.cpuct, 2.5f, 1e-6);
+    TENUKI_EXPECT_EQ(search::get_option(options, "num_threads"), std::string("1"));
+    TENUKI_EXPECT(search::is_search_option("num-threads"));
+    TENUKI_EXPECT(search::is_option("eval_cache") && !search::is_search_option("eval_cache"));
+
+    // Every option survives a trip through the config file format.
+    std::istringstream file(search::format_options(options) + "\n# comment\nnum_threads = 3 # trailing\n");
+    search::EngineOptions loaded;
+    search::load_options(loaded, file);
+    for (const std::string& name : search::option_names()) {
+        if (name != "num_threads") {
+            TENUKI_EXPECT_EQ(search::get_option(loaded, name), search::get_option(options, name));
+        }
+    }
+    TENUKI_EXPECT_EQ(loaded.search.num_threads, 3);
+
+    for (const auto& [name, value] : {std::pair<std::string, std::string>{"max_playouts", "many"},
+                                      {"max_playouts", "12x"},
+                                      {"parallel_mode", "leaf"},
+                                      {"pin_threads", "maybe"},
+                                      {"seed", "-1"},
+                                      {"cpuct", "inf"},
+                                      {"no_such_option", "1"}}) {
+        bool threw = false;
+        try {
+            search::set_option(loaded, name, value);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        TENUKI_EXPECT(threw);
+    }
+    TENUKI_EXPECT_EQ(loaded.search.max_playouts, 77);
+
+    std::istringstream bad("max_playouts = 5\nnum_threads\n");
+    bool threw = false;
+    try {
+        search::load_options(loaded, bad);
+    } catch (const std::invalid_argument& ex) {
+        threw = std::string(ex.what()).rfind("line 2:", 0) == 0;
+    }
+    TENUKI_EXPECT(threw);
+    TENUKI_EXPECT_EQ(loaded.search.max_playouts, 77);
+}
+
+void test_engine_options_validation() {
+    search::EngineOptions options;
+    search::set_option(options, "max_playouts", "50");
+    TENUKI_EXPECT_FALSE(options.search.enable_playout_cap_randomization);
+    TENUKI_EXPECT_EQ(options.search.random_playouts_min, 50);
+    TENUKI_EXPECT_EQ(options.search.random_playouts_max, 50);
+    search::set_option(options, "enable_playout_cap_randomization", "true");
+    TENUKI_EXPECT(options.search.enable_playout_cap_randomization);
+
+    for (const auto& [name, value] : {std::pair<std::string, std::string>{"max_playouts", "0"},
+                                      {"max_playouts", "-3"},
+                                      {"retained_trees", "-1"},
+                                      {"virtual_loss_visits", "-1"},
+                                      {"trace_events_per_thread", "-1"},
+                                      {"random_playouts_min", "51"},
+                                      {"random_playouts_max", "49"}}) {
+        bool threw = false;
+        try {
+            search::set_option(options, name, value);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        TENUKI_EXPECT(threw);
+    }
+    TENUKI_EXPECT_EQ(options.search.max_playouts, 50);
+    TENUKI_EXPECT_EQ(options.search.retained_trees, 8);
+
+    // A window moved past the old one is checked only once both ends are in.
+    search::set_options(options, {{"random_playouts_min", "300"}, {"random_playouts_max", "400"}});
+    TENUKI_EXPECT_EQ(options.search.random_playouts_min, 300);
+    std::istringstream file("random_playouts_min = 500\nrandom_playouts_max = 600\n");
+    search::load_options(options, file);
+    TENUKI_EXPECT_EQ(options.search.random_playouts_max, 600);
+
+    std::istringstream inverted("random_playouts_min = 700\n");
+    bool threw = false;
+    try {
+        search::load_options(options, inverted);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    TENUKI_EXPECT(threw);
+    TENUKI_EXPECT_EQ(options.search.random_playouts_min, 500);
+}
+
+void test_set_config_keeps_tree() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+    search::SearchConfig config;
+    config.max_playouts = 60;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    search::SearchAgent agent(config, std::make_shared<CentreEvaluator>());
+    agent.search(board, board.to_play(), 0);
+
+    config.num_threads = 2;
+    config.max_playouts = 40;
+    agent.set_config(config);
+    TENUKI_EXPECT_EQ(agent.config().num_threads, 2);
+    int visits = 0;
+    for (const search::RootMoveStats& entry : agent.search(board, board.to_play(), 0)) {
+        visits += entry.visit_count;
+    }
+    TENUKI_EXPECT_EQ(visits, 100);
+
+    const search::AutotuneResult tuned = search::autotune_threads(config, std::make_shared<CentreEvaluator>(), board, 3, 32);
+    TENUKI_EXPECT_EQ(tuned.timings.size(), 3u); // 1, 2 and 3 threads
+    TENUKI_EXPECT_EQ(tuned.timings.back().threads, 3);
+    TENUKI_EXPECT(tuned.threads >= 1 && tuned.threads <= 3);
+    for (const search::ThreadTiming& timing : tuned.timings) {
+        TENUKI_EXPECT(timing.playouts_per_second > 0.0);
+    }
+}
+
+void test_root_parallel_search_merges_group_statistics() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+
+    auto evaluator = std::make_shared<CountingEvaluator>();
+
+    search::SearchConfig config;
+    config.max_playouts = 64;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.25f;
+    config.temperature = 0.0f;
+    config.temperature_move_cutoff = 0;
+    config.num_threads = 4;
+    config.parallel_mode = search::ParallelMode::RootParallel;
+
+    search::SearchAgent agent(config, evaluator);
+    const go::Move move = agent.select_move(board, go::Player::Black, 0);
+    TENUKI_EXPECT(board.is_legal(go::Player::Black, move));
+
+    // One root expansion per independent tree plus one evaluation per playout.
+    TENUKI_EXPECT_EQ(evaluator->calls.load(std::memory_order_relaxed), config.max_playouts + config.num_threads);
+
+    int merged_visits = 0;
+    for (const search::RootMoveStats& entry : agent.root_statistics()) {
+        merged_visits += entry.visit_count;
+    }
+    TENUKI_EXPECT_EQ(merged_visits, config.max_playouts);
+}
+
+void test_hybrid_root_parallel_groups_share_trees() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+
+    auto evaluator = std::make_shared<CountingEvaluator>();
+
+    search::SearchConfig config;
+    config.max_playouts = 48;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    config.temperature = 0.0f;
+    config.temperature_move_cutoff = 0;
+    config.num_threads = 4;
+    config.parallel_mode = search::ParallelMode::RootParallel;
+    config.root_parallel_groups = 2;
+
+    search::SearchAgent agent(config, evaluator);
+    go::Move move = agent.select_move(board, go::Player::Black, 0);
+    TENUKI_EXPECT_EQ(evaluator->calls.load(std::memory_order_relaxed), config.max_playouts + 2);
+
+    // Both trees descend on notify_move and keep contributing visits to the merged root.
+    TENUKI_EXPECT(board.play_move(go::Player::Black, move));
+    agent.notify_move(move, board, board.to_play());
+    move = agent.select_move(board, board.to_play(), 1);
+    TENUKI_EXPECT(board.is_legal(board.to_play(), move));
+
+    // Each merged move sums its visits and values over the trees holding it, and every
+    // move of every tree is merged.
+    const std::vector<std::vector<search::RootMoveStats>> trees = agent.tree_statistics();
+    TENUKI_EXPECT_EQ(trees.size(), 2u);
+    const std::vector<search::RootMoveStats> merged = agent.root_statistics();
+    for (const search::RootMoveStats& entry : merged) {
+        int visits = 0;
+        double value_sum = 0.0;
+        float prior = 0.0f;
+        int holders = 0;
+        for (const auto& tree : trees) {
+            for (const search::RootMoveStats& child : tree) {
+                if (child.move == entry.move) {
+                    visits += child.visit_count;
+                    value_sum += static_cast<double>(child.value_sum);
+                    prior += child.prior;
+                    ++holders;
+                }
+            }
+        }
+        TENUKI_EXPECT(holders > 0);
+        TENUKI_EXPECT_EQ(entry.visit_count, visits);
+        TENUKI_EXPECT_NEAR(static_cast<double>(entry.value_sum), value_sum, 1e-4);
+        TENUKI_EXPECT_NEAR(static_cast<double>(entry.prior), static_cast<double>(prior / static_cast<float>(holders)), 1e-6);
+    }
+    for (const auto& tree : trees) {
+        for (const search::RootMoveStats& child : tree) {
+            const bool found = std::any_of(merged.begin(), merged.end(), [&](const search::RootMoveStats& entry) {
+                return entry.move == child.move;
+            });
+            TENUKI_EXPECT(found);
+        }
+    }
+}
+
+void test_merge_tree_statistics_keeps_every_move() {
+    const auto stats = [](int move, float prior, int visits, float value_sum) {
+        search::RootMoveStats entry;
+        entry.move = move;
+        entry.prior = prior;
+        entry.visit_count = visits;
+        entry.value_sum = value_sum;
+        return entry;
+    };
+    // Trees that descended through different moves need not hold the same children.
+    const std::vector<std::vector<search::RootMoveStats>> trees{
+        {stats(3, 0.5f, 10, 4.0f), stats(7, 0.5f, 6, -1.0f)},
+        {stats(7, 0.25f, 2, 1.0f), stats(-1, 0.75f, 5, 2.5f)},
+    };
+    const std::vector<search::RootMoveStats> merged = search::merge_tree_statistics(trees);
+    TENUKI_EXPECT_EQ(merged.size(), 3u);
+    TENUKI_EXPECT_EQ(merged[0].move, 3);
+    TENUKI_EXPECT_EQ(merged[0].visit_count, 10);
+    TENUKI_EXPECT_NEAR(merged[0].prior, 0.5, 1e-6);
+    TENUKI_EXPECT_EQ(merged[1].move, 7);
+    TENUKI_EXPECT_EQ(merged[1].visit_count, 8);
+    TENUKI_EXPECT_NEAR(merged[1].value_sum, 0.0, 1e-6);
+    TENUKI_EXPECT_NEAR(merged[1].prior, 0.375, 1e-6);
+    TENUKI_EXPECT_EQ(merged[2].move, -1);
+    TENUKI_EXPECT_EQ(merged[2].visit_count, 5);
+    TENUKI_EXPECT_NEAR(merged[2].value_sum, 2.5, 1e-6);
+
+    std::vector<search::RootMoveStats> local{stats(3, 0.5f, 10, 4.0f)};
+    search::merge_root_statistics(local, {stats(3, 0.1f, 1, 1.0f), stats(9, 0.2f, 4, 2.0f)});
+    TENUKI_EXPECT_EQ(local.size(), 1u);
+    TENUKI_EXPECT_EQ(local[0].visit_count, 11);
+}
+
+void test_cpu_list_parsing_and_topology() {
+    const std::vector<int> cpus = search::parse_cpu_list("0-3, 8,10-11,bogus");
+    const std::vector<int> expected{0, 1, 2, 3, 8, 10, 11};
+    TENUKI_EXPECT(cpus == expected);
+
+    // Only cpus in the affinity mask are kept, and nodes left without any are dropped.
+    search::CpuTopology sysfs;
+    sysfs.numa_nodes = {{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9}};
+    const search::CpuTopology restricted = search::restrict_topology(sysfs, {1, 3, 8});
+    TENUKI_EXPECT_EQ(restricted.numa_nodes.size(), 2u);
+    TENUKI_EXPECT(restricted.numa_nodes[0] == std::vector<int>({1, 3}));
+    TENUKI_EXPECT(restricted.numa_nodes[1] == std::vector<int>({8}));
+    TENUKI_EXPECT_EQ(search::restrict_topology(sysfs, {}).cpu_count(), 10u);
+
+    const search::CpuTopology topology = search::detect_topology();
+    TENUKI_EXPECT(topology.cpu_count() >= 1u);
+    TENUKI_EXPECT(search::cpu_for_worker(topology, 0, 0) >= 0);
+    const std::vector<int> allowed = search::allowed_cpus();
+    for (const auto& node : topology.numa_nodes) {
+        for (int cpu : node) {
+            TENUKI_EXPECT(allowed.empty() || std::find(allowed.begin(), allowed.end(), cpu) != allowed.end());
+        }
+    }
+}
+
+void test_pinned_search_runs_expected_playouts() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+
+    auto evaluator = std::make_shared<CountingEvaluator>();
+
+    search::SearchConfig config;
+    config.max_playouts = 32;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    config.temperature = 0.0f;
+    config.temperature_move_cutoff = 0;
+    config.num_threads = 2;
+    config.pin_threads = true;
+    config.numa_local_trees = true;
+
+    search::SearchAgent agent(config, evaluator);
+    agent.select_move(board, go::Player::Black, 0);
+
+    // One tree per NUMA node (a single tree on uniform-memory hosts) plus one evaluation per playout.
+    const search::CpuTopology topology = search::detect_topology();
+    const int trees = topology.is_numa() ? std::min(2, static_cast<int>(topology.numa_nodes.size())) : 1;
+    TENUKI_EXPECT_EQ(evaluator->calls.load(std::memory_order_relaxed), config.max_playouts + trees);
+#if defined(__linux__)
+    // The topology only holds cpus the process may run on, so every pin succeeds.
+    TENUKI_EXPECT_EQ(agent.pin_failures(), 0);
+#endif
+}
+
+void test_search_stats_count_every_phase() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+
+    search::SearchConfig config;
+    config.max_playouts = 40;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    config.num_threads = 3;
+
+    search::SearchAgent quiet(config, search::make_uniform_evaluator());
+    quiet.select_move(board, go::Player::Black, 0);
+    TENUKI_EXPECT_EQ(quiet.stats().simulations, 0u);
+
+#if TENUKI_SEARCH_STATS
+    config.collect_stats = true;
+    search::SearchAgent agent(config, search::make_uniform_evaluator());
+    agent.select_move(board, go::Player::Black, 0);
+
+    const search::SearchStats& stats = agent.stats();
+    const auto playouts = static_cast<std::uint64_t>(config.max_playouts);
+    TENUKI_EXPECT_EQ(stats.simulations, playouts);
+    TENUKI_EXPECT_EQ(stats.phase(search::SearchPhase::Evaluation).count, playouts);
+    TENUKI_EXPECT_EQ(stats.phase(search::SearchPhase::Legality).count, playouts);
+    TENUKI_EXPECT_EQ(stats.phase(search::SearchPhase::Backprop).count, playouts);
+    TENUKI_EXPECT(stats.phase(search::SearchPhase::Selection).count >= playouts);
+    TENUKI_EXPECT(stats.phase(search::SearchPhase::BoardPlay).count >= playouts);
+    TENUKI_EXPECT(stats.max_depth >= 1u);
+    TENUKI_EXPECT(stats.wall_nanoseconds > 0u);
+    TENUKI_EXPECT(search::format_search_stats(stats).find("evaluation 40") != std::string::npos);
+#endif
+}
+
+void test_search_trace_exports_balanced_chrome_events() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+
+    search::SearchConfig config;
+    config.max_playouts = 24;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    config.num_threads = 2;
+    config.enable_trace = true;
+
+    search::SearchAgent agent(config, search::make_uniform_evaluator());
+    const go::Move move = agent.select_move(board, go::Player::Black, 0);
+    TENUKI_EXPECT(board.play_move(go::Player::Black, move));
+    agent.notify_move(move, board, board.to_play());
+
+#if TENUKI_SEARCH_TRACE
+    std::ostringstream oss;
+    TENUKI_EXPECT(agent.write_trace(oss));
+    const std::string json = oss.str();
+    TENUKI_EXPECT(json.find("\"traceEvents\"") != std::string::npos);
+
+    auto count = [&json](const std::string& needle) {
+        std::size_t n = 0;
+        for (std::size_t pos = json.find(needle); pos != std::string::npos; pos = json.find(needle, pos + 1)) {
+            ++n;
+        }
+        return n;
+    };
+    TENUKI_EXPECT_EQ(count("\"name\":\"simulation\",\"cat\":\"search\",\"ph\":\"B\""), static_cast<std::size_t>(24));
+    TENUKI_EXPECT_EQ(count("\"name\":\"simulation\",\"cat\":\"search\",\"ph\":\"E\""), static_cast<std::size_t>(24));
+    TENUKI_EXPECT_EQ(count("\"name\":\"search\",\"cat\":\"search\",\"ph\":\"B\""), static_cast<std::size_t>(1));
+    TENUKI_EXPECT_EQ(count("\"name\":\"tree_reuse\",\"cat\":\"search\",\"ph\":\"E\""), static_cast<std::size_t>(1));
+#endif
+
+    search::SearchAgent untraced(search::SearchConfig{}, search::make_uniform_evaluator());
+    std::ostringstream ignored;
+    TENUKI_EXPECT_FALSE(untraced.write_trace(ignored));
+}
+
+void test_symmetry_average_maps_policy_back() {
+    auto inner = std::make_shared<OrientedEvaluator>();
+    search::SymmetricEvaluator averaged(inner, search::SymmetryMode::Average);
+    const go::Board board = asymmetric_board();
+    std::vector<go::Board> orientations;
+    for (int symmetry = 0; symmetry < go::kSymmetries; ++symmetry) {
+        orientations.push_back(board.transformed(symmetry));
+    }
+    std::vector<search::EvaluationRequest> requests;
+    for (const go::Board& oriented : orientations) {
+        requests.push_back({&oriented, go::Player::White});
+    }
+    const auto results = averaged.evaluate_batch(requests);
+    TENUKI_EXPECT_EQ(inner->batches.load(), 1);
+    TENUKI_EXPECT_EQ(inner->positions.load(), 8 * go::kSymmetries);
+
+    // Averaging over all orientations is invariant: vertex v of the original matches
+    // its image in every transformed copy.
+    for (int symmetry = 0; symmetry < go::kSymmetries; ++symmetry) {
+        const auto& result = results[static_cast<std::size_t>(symmetry)];
+        TENUKI_EXPECT_NEAR(result.value, results[0].value, 1e-6);
+        TENUKI_EXPECT_NEAR(result.policy[25], 0.5f, 1e-6);
+        for (int vertex = 0; vertex < 25; ++vertex) {
+            TENUKI_EXPECT_NEAR(result.policy[static_cast<std::size_t>(go::transform_vertex(vertex, symmetry, 5))],
+                               results[0].policy[static_cast<std::size_t>(vertex)], 1e-4);
+        }
+    }
+
+    // A single random orientation must still put the black-stone bonus on black stones.
+    search::SymmetricEvaluator random(std::make_shared<OrientedEvaluator>(), search::SymmetryMode::Random, 5);
+    for (int i = 0; i < 16; ++i) {
+        const auto result = random.evaluate(board, go::Player::White);
+        for (int vertex : {1, 13}) {
+            TENUKI_EXPECT(result.policy[static_cast<std::size_t>(vertex)] > 100.0f);
+        }
+        TENUKI_EXPECT(result.policy[7] < 100.0f);
+    }
+}
+
+void test_eval_cache_merges_symmetric_positions() {
+    auto inner = std::make_shared<EquivariantEvaluator>();
+    search::CachingEvaluator cache(inner, 64);
+    const go::Board board = asymmetric_board();
+    const auto first = cache.evaluate(board, go::Player::White);
+    TENUKI_EXPECT_EQ(cache.stats().misses, 1u);
+
+    for (int symmetry = 1; symmetry < go::kSymmetries; ++symmetry) {
+        const go::Board oriented = board.transformed(symmetry);
+        const auto cached = cache.evaluate(oriented, go::Player::White);
+        const auto direct = inner->evaluate(oriented, go::Player::White);
+        TENUKI_EXPECT_NEAR(cached.value, direct.value, 1e-6);
+        for (std::size_t move = 0; move < direct.policy.size(); ++move) {
+            TENUKI_EXPECT_NEAR(cached.policy[move], direct.policy[move], 1e-6);
+        }
+    }
+    TENUKI_EXPECT_EQ(cache.stats().hits, 7u);
+    TENUKI_EXPECT_EQ(inner->positions.load(), 1);
+
+    // The other side to move is a different entry; orientations within one batch share
+    // a single inner evaluation.
+    const go::Board mirrored = board.transformed(3);
+    const auto batch = cache.evaluate_batch({{&board, go::Player::Black}, {&mirrored, go::Player::Black}});
+    TENUKI_EXPECT_EQ(inner->positions.load(), 2);
+    TENUKI_EXPECT_NEAR(batch[1].policy[static_cast<std::size_t>(go::transform_vertex(4, 3, 5))], batch[0].policy[4], 1e-6);
+    TENUKI_EXPECT_NEAR(first.value, batch[0].value, 1e-6);
+
+    // The same stones under other rules are another entry.
+    go::Board japanese = board;
+    go::Rules rules = board.rules();
+    go::apply_rules_name(rules, "japanese");
+    japanese.set_rules(rules);
+    cache.evaluate(japanese, go::Player::White);
+    TENUKI_EXPECT_EQ(inner->positions.load(), 3);
+    rules = board.rules();
+    rules.komi += 1.0;
+    japanese.set_rules(rules);
+    cache.evaluate(japanese, go::Player::White);
+    TENUKI_EXPECT_EQ(inner->positions.load(), 4);
+}
+
+void test_latency_evaluator_models_batch_cost() {
+    for (bool spin : {false, true}) {
+        search::LatencyModel model;
+        model.batch_latency = std::chrono::microseconds(2000);
+        model.position_cost = std::chrono::microseconds(1000);
+        model.spin = spin;
+        search::LatencyEvaluator evaluator(model);
+        const go::Board board = asymmetric_board();
+        const auto start = std::chrono::steady_clock::now();
+        const auto results = evaluator.evaluate_batch({{&board, go::Player::White}, {&board, go::Player::White}, {&board, go::Player::Black}});
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        TENUKI_EXPECT(elapsed.count() >= 0.005);
+        TENUKI_EXPECT_EQ(results.size(), 3u);
+        TENUKI_EXPECT_EQ(results[0].policy.size(), 26u);
+        evaluator.evaluate(board, go::Player::White);
+
+        const auto stats = evaluator.stats();
+        TENUKI_EXPECT_EQ(stats.batches, 2u);
+        TENUKI_EXPECT_EQ(stats.positions, 4u);
+        TENUKI_EXPECT_EQ(stats.batch_sizes[3], 1u);
+        TENUKI_EXPECT_EQ(stats.batch_sizes[1], 1u);
+        TENUKI_EXPECT(stats.busy_seconds >= 0.008);
+        evaluator.reset_stats();
+        TENUKI_EXPECT_EQ(evaluator.stats().batches, 0u);
+    }
+}
+
+void test_batching_evaluator_groups_concurrent_requests() {
+    auto device = std::make_shared<search::LatencyEvaluator>(search::LatencyModel{});
+    // A long wait means only a full batch of four can release the callers.
+    search::BatchingEvaluator batching(device, 4, std::chrono::seconds(30));
+    const go::Board board = asymmetric_board();
+    std::vector<std::thread> callers;
+    std::atomic<int> completed{0};
+    for (int i = 0; i < 4; ++i) {
+        callers.emplace_back([&] {
+            if (batching.evaluate(board, go::Player::White).policy.size() == 26) {
+                completed.fetch_add(1);
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    TENUKI_EXPECT_EQ(completed.load(), 4);
+    TENUKI_EXPECT_EQ(device->stats().batches, 1u);
+    TENUKI_EXPECT_EQ(device->stats().batch_sizes[4], 1u);
+
+    // A lone caller is released by the timeout with a batch of one.
+    search::BatchingEvaluator patient(device, 8, std::chrono::microseconds(500));
+    TENUKI_EXPECT_EQ(patient.evaluate(board, go::Player::Black).policy.size(), 26u);
+    TENUKI_EXPECT_EQ(device->stats().batch_sizes[1], 1u);
+
+    search::SearchConfig config;
+    config.max_playouts = 64;
+    config.num_threads = 4;
+    config.enable_playout_cap_randomization = false;
+    auto counted = std::make_shared<search::LatencyEvaluator>(search::LatencyModel{});
+    search::SearchAgent agent(config, std::make_shared<search::BatchingEvaluator>(counted, 4, std::chrono::microseconds(200)));
+    const go::Move move = agent.select_move(board, board.to_play(), 3);
+    TENUKI_EXPECT(board.is_legal(board.to_play(), move));
+    TENUKI_EXPECT(counted->stats().positions > 0u);
+}
+
+void test_rollout_evaluator_scores_decided_positions() {
+    // Black fills the board except two separate eyes; no playout can change that.
+    go::Rules rules;
+    rules.board_size = 5;
+    rules.komi = 7.5;
+    go::Board board(rules);
+    std::vector<go::PointState> points(25, go::PointState::Black);
+    points[0] = go::PointState::Empty;
+    points[12] = go::PointState::Empty;
+    board.set_position(points, go::Player::White);
+
+    search::RolloutConfig config;
+    config.playouts = 8;
+    config.amaf_policy = true;
+    search::RolloutEvaluator evaluator(config);
+    const search::RolloutEvaluator::Rollouts white = evaluator.rollouts(board, go::Player::White);
+    TENUKI_EXPECT_NEAR(white.value, -1.0f, 1e-6f);
+    TENUKI_EXPECT_NEAR(white.mean_score, 25.0f - 7.5f, 1e-4f);
+    for (float owner : white.ownership) {
+        TENUKI_EXPECT_NEAR(owner, 1.0f, 1e-6f);
+    }
+    TENUKI_EXPECT_EQ(white.moves, 8 * 2); // both sides pass at once
+    const search::EvaluationResult black = evaluator.evaluate(board, go::Player::Black);
+    TENUKI_EXPECT_NEAR(black.value, 1.0f, 1e-6f);
+    float total = 0.0f;
+    for (float prior : black.policy) {
+        total += prior;
+    }
+    TENUKI_EXPECT_EQ(black.policy.size(), static_cast<std::size_t>(26));
+    TENUKI_EXPECT_NEAR(total, 1.0f, 1e-5f);
+    TENUKI_EXPECT_EQ(evaluator.counters().playouts, static_cast<std::uint64_t>(16));
+
+    // From the empty board the value stays a mean of +-1 outcomes and AMAF sees every game.
+    go::Board empty(rules);
+    const search::RolloutEvaluator::Rollouts open = evaluator.rollouts(empty, go::Player::Black);
+    TENUKI_EXPECT(open.value >= -1.0f && open.value <= 1.0f);
+    TENUKI_EXPECT(open.moves > 8 * 10);
+    float games = 0.0f;
+    for (float count : open.amaf_games) {
+        TENUKI_EXPECT(count <= 8.0f);
+        games += count;
+    }
+    TENUKI_EXPECT(games > 0.0f);
+
+    search::SearchConfig search_config;
+    search_config.max_playouts = 32;
+    search_config.num_threads = 2;
+    search_config.enable_playout_cap_randomization = false;
+    search::SearchAgent agent(search_config, std::make_shared<search::RolloutEvaluator>(config));
+    TENUKI_EXPECT(empty.is_legal(go::Player::Black, agent.select_move(empty, go::Player::Black, 0)));
+
+    // A new evaluator plays its own seed's games, even one built where an old one lived.
+    std::optional<search::RolloutEvaluator> reused;
+    reused.emplace(config);
+    const search::RolloutEvaluator::Rollouts first = reused->rollouts(empty, go::Player::Black);
+    reused.emplace(config);
+    const search::RolloutEvaluator::Rollouts again = reused->rollouts(empty, go::Player::Black);
+    TENUKI_EXPECT_EQ(again.moves, first.moves);
+    TENUKI_EXPECT(again.ownership == first.ownership);
+}
+
+void test_pattern_evaluator_priors_follow_weights() {
+    go::Rules rules;
+    rules.board_size = 5;
+    go::Board board(rules);
+    // Favour the lower-right corner shape; the table finds the other three corners too.
+    const std::uint32_t corner = go::compute_pattern(board, 24);
+    const search::PatternWeights weights({{corner, 2.0f}}, -1.0f);
+    TENUKI_EXPECT_EQ(weights.size(), static_cast<std::size_t>(4));
+    TENUKI_EXPECT_EQ(weights.canonical_entries().size(), static_cast<std::size_t>(1));
+    TENUKI_EXPECT_NEAR(weights.weight(go::compute_pattern(board, 0)), 2.0f, 1e-6f);
+    TENUKI_EXPECT_NEAR(weights.weight(go::compute_pattern(board, 12)), 0.0f, 1e-6f);
+
+    std::stringstream stream;
+    search::save_pattern_weights(weights, stream);
+    const std::string bytes = stream.str();
+    const search::PatternWeights loaded = search::load_pattern_weights(stream);
+    TENUKI_EXPECT_EQ(loaded.size(), weights.size());
+    TENUKI_EXPECT_NEAR(loaded.weight(go::compute_pattern(board, 4)), 2.0f, 1e-6f);
+    TENUKI_EXPECT_NEAR(loaded.pass_weight(), -1.0f, 1e-6f);
+    bool truncated_rejected = false;
+    try {
+        std::istringstream truncated(bytes.substr(0, bytes.size() - 2));
+        search::load_pattern_weights(truncated);
+    } catch (const std::runtime_error&) {
+        truncated_rejected = true;
+    }
+    TENUKI_EXPECT(truncated_rejected);
+
+    auto value_source = std::make_shared<BiasedEvaluator>(-1, 0.25f);
+    search::PatternEvaluator evaluator(loaded, value_source);
+    TENUKI_EXPECT(board.play_move(go::Player::Black, go::Move(12)));
+    const search::EvaluationResult untracked = evaluator.evaluate(board, go::Player::White);
+    board.set_pattern_tracking(true);
+    const search::EvaluationResult tracked = evaluator.evaluate(board, go::Player::White);
+    TENUKI_EXPECT_NEAR(tracked.value, 0.25f, 1e-6f);
+    TENUKI_EXPECT(tracked.policy == untracked.policy);
+    float total = 0.0f;
+    for (float prior : tracked.policy) {
+        total += prior;
+    }
+    TENUKI_EXPECT_NEAR(total, 1.0f, 1e-5f);
+    TENUKI_EXPECT_EQ(tracked.policy[12], 0.0f);
+    TENUKI_EXPECT_NEAR(tracked.policy[0], tracked.policy[24], 1e-7f);
+    TENUKI_EXPECT_NEAR(tracked.policy[0] / tracked.policy[6], std::exp(2.0f), 1e-3f);
+    TENUKI_EXPECT_NEAR(tracked.policy[6] / tracked.policy[25], std::exp(1.0f), 1e-3f);
+
+    const std::vector<search::EvaluationResult> batch =
+        evaluator.evaluate_batch({{&board, go::Player::White}, {&board, go::Player::Black}});
+    TENUKI_EXPECT(batch[0].policy == tracked.policy);
+    TENUKI_EXPECT_NEAR(batch[1].value, 0.25f, 1e-6f);
+}
+
 void run_search_tests() {
     test_search_generates_legal_move();
     test_tree_reuse_after_moves();
     test_search_prefers_high_prior_move();
+    test_search_backs_up_values_for_moving_player();
+    test_analysis_reports_until_stopped();
     test_search_returns_pass_when_no_legal_moves();
     test_search_uses_randomized_playout_cap_when_enabled();
     test_notify_move_resets_tree_when_child_unexpanded();
+    test_undo_restores_retained_trees();
+    test_rules_change_switches_trees();
+    test_engine_options_round_trip();
+    test_engine_options_validation();
+    test_set_config_keeps_tree();
     test_multithreaded_search_runs_expected_playouts();
+    test_root_parallel_search_merges_group_statistics();
+    test_hybrid_root_parallel_groups_share_trees();
+    test_merge_tree_statistics_keeps_every_move();
+    test_cpu_list_parsing_and_topology();
+    test_pinned_search_runs_expected_playouts();
+    test_search_stats_count_every_phase();
+    test_search_trace_exports_balanced_chrome_events();
+    test_symmetry_average_maps_policy_back();
+    test_eval_cache_merges_symmetric_positions();
+    test_latency_evaluator_models_batch_cost();
+    test_batching_evaluator_groups_concurrent_requests();
+    test_rollout_evaluator_scores_decided_positions();
+    test_pattern_evaluator_priors_follow_weights();
 }
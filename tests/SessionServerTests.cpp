@@ -0,0 +1,192 @@
+#include "TestUtils.hpp"
+#include "go/Board.hpp"
+#include "gtp/SessionServer.hpp"
+#include "search/Distributed.hpp"
+#include "search/Scheduler.hpp"
+#include "search/Search.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+std::string temp_endpoint(const char* tag) {
+    return "unix:/tmp/tenuki-test-" + std::to_string(::getpid()) + "-" + tag + ".sock";
+}
+
+search::SearchConfig quiet_config(int playouts) {
+    search::SearchConfig config;
+    config.max_playouts = playouts;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    config.temperature = 0.0f;
+    config.temperature_move_cutoff = 0;
+    return config;
+}
+
+// Sends the commands, then reads until the server hangs up after quit.
+std::string converse(const std::string& endpoint, const std::string& commands) {
+    const int fd = search::connect_to_endpoint(endpoint);
+    if (fd < 0) {
+        throw std::runtime_error("cannot connect to " + endpoint);
+    }
+    TENUKI_EXPECT_EQ(::send(fd, commands.data(), commands.size(), 0), static_cast<ssize_t>(commands.size()));
+    std::string reply;
+    char buffer[512];
+    ssize_t received = 0;
+    while ((received = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        reply.append(buffer, static_cast<std::size_t>(received));
+    }
+    ::close(fd);
+    return reply;
+}
+
+void test_scheduler_runs_every_step() {
+    search::SchedulerOptions options;
+    options.threads = 3;
+    options.slice_steps = 4;
+    search::SearchScheduler scheduler(options);
+    TENUKI_EXPECT_EQ(scheduler.threads(), 3);
+
+    std::atomic<int> next{0};
+    std::atomic<int> ran{0};
+    const std::function<bool(int)> step = [&](int worker) {
+        TENUKI_EXPECT(worker >= 0 && worker < 3);
+        if (next.fetch_add(1) >= 1000) {
+            return false;
+        }
+        ran.fetch_add(1);
+        return true;
+    };
+    const search::SearchScheduler::JobStats stats = scheduler.run(step, 3);
+    TENUKI_EXPECT_EQ(ran.load(), 1000);
+    TENUKI_EXPECT(stats.steps >= 1000u);
+    TENUKI_EXPECT(stats.slices >= 250u);
+    TENUKI_EXPECT(stats.wall >= stats.queue_wait);
+    TENUKI_EXPECT_EQ(scheduler.counters().jobs, 1u);
+
+    const std::function<bool(int)> failing = [](int) -> bool { throw std::runtime_error("step failed"); };
+    bool rethrown = false;
+    try {
+        scheduler.run(failing, 2);
+    } catch (const std::runtime_error&) {
+        rethrown = true;
+    }
+    TENUKI_EXPECT(rethrown);
+}
+
+void test_scheduler_caps_parallelism_per_job() {
+    search::SchedulerOptions options;
+    options.threads = 4;
+    options.slice_steps = 1;
+    search::SearchScheduler scheduler(options);
+
+    // Two jobs at once, each allowed two workers: neither may ever hold more.
+    std::atomic<int> peak{0};
+    const auto run_job = [&]() {
+        std::atomic<int> in_flight{0};
+        std::atomic<int> remaining{200};
+        const std::function<bool(int)> step = [&](int) {
+            const int now = in_flight.fetch_add(1) + 1;
+            int seen = peak.load();
+            while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            in_flight.fetch_sub(1);
+            return remaining.fetch_sub(1) > 1;
+        };
+        scheduler.run(step, 2);
+    };
+    std::thread other(run_job);
+    run_job();
+    other.join();
+    TENUKI_EXPECT(peak.load() >= 1 && peak.load() <= 2);
+    TENUKI_EXPECT_EQ(scheduler.counters().jobs, 2u);
+}
+
+void test_agents_share_scheduler() {
+    search::SchedulerOptions options;
+    options.threads = 2;
+    auto scheduler = std::make_shared<search::SearchScheduler>(options);
+
+    std::vector<std::thread> games;
+    std::vector<int> visits(4, 0);
+    for (std::size_t g = 0; g < visits.size(); ++g) {
+        games.emplace_back([&, g]() {
+            search::SearchConfig config = quiet_config(60);
+            config.num_threads = 0; // as many pool workers as the pool has
+            search::SearchAgent agent(config, search::make_uniform_evaluator());
+            agent.set_scheduler(scheduler);
+            go::Rules rules;
+            rules.board_size = 5;
+            go::Board board(rules);
+            for (const search::RootMoveStats& stats : agent.search(board, go::Player::Black, 0)) {
+                visits[g] += stats.visit_count;
+            }
+        });
+    }
+    for (std::thread& game : games) {
+        game.join();
+    }
+    for (int total : visits) {
+        TENUKI_EXPECT_EQ(total, 60);
+    }
+    TENUKI_EXPECT_EQ(scheduler->counters().jobs, 4u);
+}
+
+void test_session_server_serves_concurrent_games() {
+    const std::string endpoint = temp_endpoint("sessions");
+    gtp::SessionServerOptions options;
+    options.rules.board_size = 5;
+    options.search = quiet_config(24);
+    search::SchedulerOptions pool;
+    pool.threads = 2;
+    gtp::SessionServer server(endpoint, options, std::make_shared<search::SearchScheduler>(pool));
+    server.listen();
+    std::thread serving([&server]() { server.serve(); });
+
+    const std::string commands = "1 genmove b\n2 play w a1\n3 genmove b\n4 tenuki-session-stats\n5 showboard\nquit\n";
+    std::vector<std::string> replies(2);
+    std::vector<std::thread> clients;
+    for (std::size_t c = 0; c < replies.size(); ++c) {
+        clients.emplace_back([&, c]() { replies[c] = converse(endpoint, commands); });
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+
+    for (const std::string& reply : replies) {
+        TENUKI_EXPECT(reply.rfind("=1 ", 0) == 0);
+        TENUKI_EXPECT(reply.find("=2\n\n") != std::string::npos);
+        TENUKI_EXPECT(reply.find("=3 ") != std::string::npos);
+        TENUKI_EXPECT(reply.find("=4 searches 2 mean_ms ") != std::string::npos);
+        // Each session kept its own board: one white stone at A1 and two black moves.
+        TENUKI_EXPECT(reply.find(" 1 O ") != std::string::npos);
+        TENUKI_EXPECT(reply.find("?") == std::string::npos);
+    }
+
+    server.stop();
+    serving.join();
+    const gtp::SessionServer::Stats stats = server.stats();
+    TENUKI_EXPECT_EQ(stats.sessions_started, 2u);
+    TENUKI_EXPECT_EQ(stats.sessions_active, 0u);
+    TENUKI_EXPECT_EQ(stats.searches.searches, 4u);
+    TENUKI_EXPECT(stats.searches.max_search_time >= stats.searches.max_queue_wait);
+}
+
+} // namespace
+
+void run_session_server_tests() {
+    test_scheduler_runs_every_step();
+    test_scheduler_caps_parallelism_per_job();
+    test_agents_share_scheduler();
+    test_session_server_serves_concurrent_games();
+}
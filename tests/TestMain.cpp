@@ -2,18 +2,32 @@
 
 void run_board_tests();
 void run_search_tests();
+void run_distributed_tests();
+void run_nn_tests();
 void run_sgf_tests();
 void run_sgf_fuzz_tests();
 void run_search_stress_tests();
 void run_model_quality_tests();
+void run_ladder_tests();
+void run_pass_alive_tests();
+void run_scoring_tests();
+void run_analysis_tests();
+void run_session_server_tests();
 
 int main() {
     run_board_tests();
     run_search_tests();
+    run_distributed_tests();
+    run_nn_tests();
     run_sgf_tests();
     run_sgf_fuzz_tests();
     run_search_stress_tests();
     run_model_quality_tests();
+    run_ladder_tests();
+    run_pass_alive_tests();
+    run_scoring_tests();
+    run_analysis_tests();
+    run_session_server_tests();
     std::cout << "All tests passed\n";
     return 0;
 }
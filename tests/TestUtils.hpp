@@ -1,11 +1,14 @@
 #pragma once
 
+#include "go/Board.hpp"
+
 #include <cmath>
 #include <ostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 namespace tenuki::test {
 
@@ -88,6 +91,22 @@ inline void expect_near(const Lhs& lhs,
     }
 }
 
+// A simple-ko board from rows top to bottom: X black, O white, anything else empty.
+inline go::Board board_from(const std::vector<std::string>& rows, go::Player to_play) {
+    go::Rules rules;
+    rules.board_size = rows.size();
+    rules.ko_rule = go::KoRule::SimpleKo;
+    go::Board board(rules);
+    std::vector<go::PointState> points;
+    for (const std::string& row : rows) {
+        for (const char c : row) {
+            points.push_back(c == 'X' ? go::PointState::Black : c == 'O' ? go::PointState::White : go::PointState::Empty);
+        }
+    }
+    board.set_position(points, to_play);
+    return board;
+}
+
 } // namespace tenuki::test
 
 #define TENUKI_EXPECT(expr) \
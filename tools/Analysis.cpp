@@ -0,0 +1,146 @@
+#include "analysis/AnalysisEngine.hpp"
+#include "nn/NeuralEvaluator.hpp"
+#include "search/BatchingEvaluator.hpp"
+#include "search/RolloutEvaluator.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+
+struct Options {
+    analysis::AnalysisOptions engine;
+    std::string weights_path;
+    nn::NeuralEvaluatorOptions network;
+    int batch = 0;
+    int rollouts = 0;
+};
+
+bool parse_int(const char* value, int& out) {
+    char* end = nullptr;
+    long parsed = std::strtol(value, &end, 10);
+    if (end == value || *end != '\0') {
+        return false;
+    }
+    if (parsed < std::numeric_limits<int>::min() || parsed > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+int parse_positive(const char* name, const char* value) {
+    int parsed = 0;
+    if (!parse_int(value, parsed) || parsed <= 0) {
+        throw std::invalid_argument(std::string("Invalid value for ") + name);
+    }
+    return parsed;
+}
+
+Options parse_options(int argc, char** argv) {
+    Options options;
+    if (const char* weights = std::getenv("TENUKI_WEIGHTS")) {
+        options.weights_path = weights;
+    }
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+            options.engine.threads = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--visits") == 0 && i + 1 < argc) {
+            options.engine.max_visits = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--ownership-playouts") == 0 && i + 1 < argc) {
+            options.engine.ownership_playouts = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--weights") == 0 && i + 1 < argc) {
+            options.weights_path = argv[++i];
+        } else if (std::strcmp(arg, "--nn-threads") == 0 && i + 1 < argc) {
+            options.network.threads = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--batch") == 0 && i + 1 < argc) {
+            options.batch = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--rollouts") == 0 && i + 1 < argc) {
+            options.rollouts = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--help") == 0) {
+            throw std::invalid_argument("");
+        } else {
+            std::ostringstream oss;
+            oss << "Unknown option: " << arg;
+            throw std::invalid_argument(oss.str());
+        }
+    }
+    return options;
+}
+
+void print_usage() {
+    std::cout << "Usage: tenuki_analysis [options] < queries.jsonl > responses.jsonl\n"
+              << "  Reads one JSON query per line (KataGo analysis engine fields: id, moves,\n"
+              << "  initialStones, initialPlayer, rules, komi, boardXSize, boardYSize,\n"
+              << "  analyzeTurns, maxVisits, includeOwnership) and writes one JSON response\n"
+              << "  per analysed turn as soon as it finishes.\n"
+              << "  --threads N             Positions searched at once (default: hardware threads)\n"
+              << "  --visits N              Visits per position unless maxVisits is given (default 500)\n"
+              << "  --weights FILE          Evaluate with this network (also read from TENUKI_WEIGHTS)\n"
+              << "  --nn-threads N          Threads per network batch (default 1)\n"
+              << "  --batch N               Batch up to N evaluations across positions\n"
+              << "  --rollouts N            Without a network, value leaves by N light playouts\n"
+              << "  --ownership-playouts N  Playouts behind includeOwnership (default 64)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::invalid_argument& ex) {
+        if (std::strlen(ex.what()) > 0) {
+            std::cerr << ex.what() << "\n";
+        }
+        print_usage();
+        return std::strlen(ex.what()) > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    std::shared_ptr<search::Evaluator> evaluator = search::make_uniform_evaluator();
+    try {
+        if (!options.weights_path.empty()) {
+            evaluator = nn::make_neural_evaluator(options.weights_path, options.network);
+        } else if (options.rollouts > 0) {
+            search::RolloutConfig rollout_config;
+            rollout_config.playouts = options.rollouts;
+            evaluator = std::make_shared<search::RolloutEvaluator>(rollout_config);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    if (options.batch > 1) {
+        evaluator = std::make_shared<search::BatchingEvaluator>(evaluator, options.batch);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    analysis::AnalysisEngine engine(options.engine, evaluator, [](const std::string& line) {
+        std::cout << line << '\n';
+        std::cout.flush();
+    });
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        engine.submit(line);
+    }
+    engine.wait_idle();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const analysis::AnalysisEngine::Counters counters = engine.counters();
+    std::cerr << "# threads=" << engine.threads() << " positions=" << counters.positions << " visits=" << counters.visits
+              << std::fixed << std::setprecision(2) << " seconds=" << seconds
+              << " positions_per_second=" << (seconds > 0.0 ? static_cast<double>(counters.positions) / seconds : 0.0)
+              << " visits_per_second=" << (seconds > 0.0 ? static_cast<double>(counters.visits) / seconds : 0.0) << "\n";
+    return EXIT_SUCCESS;
+}
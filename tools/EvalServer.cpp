@@ -0,0 +1,158 @@
+#include "nn/EvalServer.hpp"
+#include "nn/Features.hpp"
+#include "nn/NeuralEvaluator.hpp"
+#include "nn/Network.hpp"
+#include "nn/Quantization.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+
+struct Options {
+    std::string name = "/tenuki-eval";
+    std::string weights_path;
+    bool random = false;
+    nn::NeuralEvaluatorOptions network;
+    nn::EvalServerOptions server;
+};
+
+nn::EvalServer* g_server = nullptr;
+
+void handle_signal(int) {
+    if (g_server) {
+        g_server->stop();
+    }
+}
+
+bool parse_int(const char* value, int& out) {
+    char* end = nullptr;
+    long parsed = std::strtol(value, &end, 10);
+    if (end == value || *end != '\0') {
+        return false;
+    }
+    if (parsed < std::numeric_limits<int>::min() || parsed > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+int parse_positive(const char* name, const char* value) {
+    int parsed = 0;
+    if (!parse_int(value, parsed) || parsed <= 0) {
+        throw std::invalid_argument(std::string("Invalid value for ") + name);
+    }
+    return parsed;
+}
+
+Options parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--name") == 0 && i + 1 < argc) {
+            options.name = argv[++i];
+        } else if (std::strcmp(arg, "--weights") == 0 && i + 1 < argc) {
+            options.weights_path = argv[++i];
+        } else if (std::strcmp(arg, "--random") == 0) {
+            options.random = true;
+        } else if (std::strcmp(arg, "--slots") == 0 && i + 1 < argc) {
+            options.server.slots = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--max-batch") == 0 && i + 1 < argc) {
+            options.server.max_batch = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--max-wait") == 0 && i + 1 < argc) {
+            options.server.max_wait = std::chrono::microseconds(parse_positive(arg, argv[++i]));
+        } else if (std::strcmp(arg, "--board-size") == 0 && i + 1 < argc) {
+            options.server.max_board_size = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+            options.network.threads = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--conv") == 0 && i + 1 < argc) {
+            options.network.conv = nn::parse_conv_algorithm(argv[++i]);
+        } else if (std::strcmp(arg, "--precision") == 0 && i + 1 < argc) {
+            options.network.precision = nn::parse_precision(argv[++i]);
+        } else if (std::strcmp(arg, "--calibration") == 0 && i + 1 < argc) {
+            options.network.calibration_path = argv[++i];
+        } else if (std::strcmp(arg, "--help") == 0) {
+            throw std::invalid_argument("");
+        } else {
+            std::ostringstream oss;
+            oss << "Unknown option: " << arg;
+            throw std::invalid_argument(oss.str());
+        }
+    }
+    if (options.weights_path.empty() == !options.random) {
+        throw std::invalid_argument("exactly one of --weights and --random is required");
+    }
+    return options;
+}
+
+void print_usage() {
+    std::cout << "Usage: tenuki_eval_server (--weights FILE | --random) [options]\n"
+              << "  --name NAME            Shared memory name engines connect to (default /tenuki-eval,\n"
+              << "                         TENUKI_EVAL_SERVER in tenuki_cli)\n"
+              << "  --weights FILE         Network weights to serve\n"
+              << "  --random               Serve a random 6x64 extended-feature network instead\n"
+              << "  --slots N              Positions in flight across all engines (default 64)\n"
+              << "  --max-batch N          Largest batch per forward pass (default 16)\n"
+              << "  --max-wait US          How long a partial batch waits to fill (default 1000)\n"
+              << "  --board-size N         Largest board engines may send (default 19)\n"
+              << "  --threads N            Threads per batch (default 1)\n"
+              << "  --conv im2col|winograd 3x3 convolution algorithm (default winograd)\n"
+              << "  --precision fp32|int8  Inference precision (int8 needs --calibration)\n"
+              << "  --calibration FILE     Calibration table from nn_calibrate\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::invalid_argument& ex) {
+        if (std::strlen(ex.what()) > 0) {
+            std::cerr << ex.what() << "\n";
+        }
+        print_usage();
+        return std::strlen(ex.what()) > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    try {
+        std::shared_ptr<nn::Network> network;
+        if (options.random) {
+            nn::NetworkShape shape;
+            shape.input_planes = nn::kExtendedInputPlanes;
+            shape.trunk_channels = 64;
+            shape.blocks = 6;
+            shape.policy_channels = 32;
+            shape.value_channels = 32;
+            shape.value_hidden = 64;
+            network = std::make_shared<nn::Network>(nn::make_random_weights(shape, 0x5eed1234u), options.network.conv);
+        } else {
+            network = nn::load_network(options.weights_path, options.network);
+        }
+        auto evaluator = std::make_shared<nn::NeuralEvaluator>(std::move(network), options.network.threads);
+        nn::EvalServer server(options.name, evaluator, options.server);
+        g_server = &server;
+        std::signal(SIGINT, handle_signal);
+        std::signal(SIGTERM, handle_signal);
+        std::cerr << "# serving " << options.name << " features=" << nn::feature_set_name(evaluator->feature_set())
+                  << " slots=" << options.server.slots << " max_batch=" << options.server.max_batch << "\n";
+        server.serve();
+        g_server = nullptr;
+        const nn::EvalServer::Stats stats = server.stats();
+        std::cerr << "# batches=" << stats.batches << " positions=" << stats.positions << std::fixed
+                  << std::setprecision(2) << " mean_batch=" << stats.mean_batch() << "\n";
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,381 @@
+#include "go/Board.hpp"
+#include "nn/Features.hpp"
+#include "nn/Kernels.hpp"
+#include "nn/NeuralEvaluator.hpp"
+#include "nn/Network.hpp"
+#include "nn/Quantization.hpp"
+#include "nn/Winograd.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::size_t board_size = 19;
+    std::string weights_path;
+    int blocks = 6;
+    int channels = 64;
+    int iterations = 8;
+    int threads = 1;
+    unsigned int seed = 0x5eed1234u;
+    std::vector<int> batch_sizes{1, 2, 4, 8, 16, 32};
+    nn::ConvAlgorithm conv = nn::ConvAlgorithm::Winograd;
+    nn::Precision precision = nn::Precision::Float32;
+    std::string calibration_path;
+    bool layers = false;
+    std::vector<int> layer_board_sizes{9, 13, 19};
+    nn::FeatureSet features = nn::FeatureSet::Extended;
+    bool encode = false;
+};
+
+bool parse_int(const char* value, int& out) {
+    char* end = nullptr;
+    long parsed = std::strtol(value, &end, 10);
+    if (end == value || *end != '\0') {
+        return false;
+    }
+    if (parsed < std::numeric_limits<int>::min() || parsed > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+bool parse_list(const char* value, std::vector<int>& out) {
+    std::vector<int> values;
+    std::istringstream ss(value);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        if (token.empty()) {
+            continue;
+        }
+        int parsed = 0;
+        if (!parse_int(token.c_str(), parsed) || parsed <= 0) {
+            return false;
+        }
+        values.push_back(parsed);
+    }
+    if (values.empty()) {
+        return false;
+    }
+    out = std::move(values);
+    return true;
+}
+
+int parse_positive(const char* name, const char* value) {
+    int parsed = 0;
+    if (!parse_int(value, parsed) || parsed <= 0) {
+        throw std::invalid_argument(std::string("Invalid value for ") + name);
+    }
+    return parsed;
+}
+
+Options parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--board-size") == 0 && i + 1 < argc) {
+            options.board_size = static_cast<std::size_t>(parse_positive(arg, argv[++i]));
+        } else if (std::strcmp(arg, "--weights") == 0 && i + 1 < argc) {
+            options.weights_path = argv[++i];
+        } else if (std::strcmp(arg, "--blocks") == 0 && i + 1 < argc) {
+            int value = 0;
+            if (!parse_int(argv[++i], value) || value < 0) {
+                throw std::invalid_argument("Invalid value for --blocks");
+            }
+            options.blocks = value;
+        } else if (std::strcmp(arg, "--channels") == 0 && i + 1 < argc) {
+            options.channels = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--iterations") == 0 && i + 1 < argc) {
+            options.iterations = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+            options.threads = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--seed") == 0 && i + 1 < argc) {
+            int value = 0;
+            if (!parse_int(argv[++i], value)) {
+                throw std::invalid_argument("Invalid value for --seed");
+            }
+            options.seed = static_cast<unsigned int>(value);
+        } else if (std::strcmp(arg, "--batch-sizes") == 0 && i + 1 < argc) {
+            if (!parse_list(argv[++i], options.batch_sizes)) {
+                throw std::invalid_argument("Invalid value for --batch-sizes");
+            }
+        } else if (std::strcmp(arg, "--conv") == 0 && i + 1 < argc) {
+            options.conv = nn::parse_conv_algorithm(argv[++i]);
+        } else if (std::strcmp(arg, "--precision") == 0 && i + 1 < argc) {
+            options.precision = nn::parse_precision(argv[++i]);
+        } else if (std::strcmp(arg, "--calibration") == 0 && i + 1 < argc) {
+            options.calibration_path = argv[++i];
+        } else if (std::strcmp(arg, "--layers") == 0) {
+            options.layers = true;
+        } else if (std::strcmp(arg, "--features") == 0 && i + 1 < argc) {
+            options.features = nn::parse_feature_set(argv[++i]);
+        } else if (std::strcmp(arg, "--encode") == 0) {
+            options.encode = true;
+        } else if (std::strcmp(arg, "--board-sizes") == 0 && i + 1 < argc) {
+            if (!parse_list(argv[++i], options.layer_board_sizes)) {
+                throw std::invalid_argument("Invalid value for --board-sizes");
+            }
+        } else if (std::strcmp(arg, "--help") == 0) {
+            throw std::invalid_argument("");
+        } else {
+            std::ostringstream oss;
+            oss << "Unknown option: " << arg;
+            throw std::invalid_argument(oss.str());
+        }
+    }
+    return options;
+}
+
+void print_usage() {
+    std::cout << "Usage: nn_benchmark [options]\n"
+              << "  --board-size N         Board size (default 19)\n"
+              << "  --weights PATH         Network weights file (default: random network)\n"
+              << "  --blocks N             Residual blocks of the random network (default 6)\n"
+              << "  --channels N           Trunk channels of the random network (default 64)\n"
+              << "  --batch-sizes a,b,c    Batch sizes to measure (default 1,2,4,8,16,32)\n"
+              << "  --threads N            Threads per batch (default 1)\n"
+              << "  --iterations N         Batches per measurement (default 8)\n"
+              << "  --seed N               Seed for the random network and positions\n"
+              << "  --conv im2col|winograd 3x3 convolution algorithm (default winograd)\n"
+              << "  --precision fp32|int8  Inference precision (default fp32)\n"
+              << "  --calibration FILE     int8 calibration table (default: calibrate on the benchmark positions)\n"
+              << "  --layers               Time one trunk 3x3 layer per algorithm instead of batches\n"
+              << "  --board-sizes a,b,c    Board sizes for --layers (default 9,13,19)\n"
+              << "  --features SET         Input features of the random network: basic|extended|ladder\n"
+              << "                         (default extended)\n"
+              << "  --encode               Time feature encoding alone, in positions per second\n";
+}
+
+// Mid-game-like positions: random stones on roughly a third of the points.
+std::vector<go::Board> make_positions(std::size_t board_size, std::size_t count, unsigned int seed) {
+    go::Rules rules;
+    rules.board_size = board_size;
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> vertex_dist(0, static_cast<int>(board_size * board_size) - 1);
+    std::vector<go::Board> boards;
+    boards.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        go::Board board(rules);
+        go::Player player = go::Player::Black;
+        for (std::size_t stone = 0; stone < board_size * board_size / 3; ++stone) {
+            if (board.play_move(player, go::Move(vertex_dist(rng)))) {
+                player = go::other(player);
+            }
+        }
+        boards.push_back(std::move(board));
+    }
+    return boards;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Times a single channels -> channels 3x3 layer with every algorithm on each board size.
+void run_layer_timings(const Options& options) {
+    const int channels = options.channels;
+    const std::size_t weight_count = static_cast<std::size_t>(channels) * static_cast<std::size_t>(channels) * 9;
+    std::mt19937 rng(options.seed);
+    std::normal_distribution<float> dist(0.0f, 0.1f);
+    std::vector<float> weights(weight_count);
+    for (float& value : weights) {
+        value = dist(rng);
+    }
+    const std::vector<float> bias(static_cast<std::size_t>(channels), 0.0f);
+    std::vector<float> transformed(nn::winograd_weights_size(channels, channels));
+    nn::winograd_transform_weights(weights.data(), channels, channels, transformed.data());
+
+    std::cout << "# Tenuki NN Layer Benchmark\n";
+    std::cout << "# channels=" << channels << " iterations=" << options.iterations << " gemm=" << nn::gemm_backend() << "\n";
+    std::cout << "board_size,algorithm,microseconds_per_layer,speedup_vs_im2col\n";
+    for (int size : options.layer_board_sizes) {
+        const std::size_t spatial = static_cast<std::size_t>(size) * static_cast<std::size_t>(size);
+        const std::size_t tiles = nn::winograd_tile_count(size, size);
+        std::vector<float> input(static_cast<std::size_t>(channels) * spatial);
+        for (float& value : input) {
+            value = dist(rng);
+        }
+        std::vector<float> output(input.size());
+        std::vector<float> columns(static_cast<std::size_t>(channels) * 9 * spatial);
+        std::vector<float> winograd_in(static_cast<std::size_t>(nn::kWinogradPoints) * static_cast<std::size_t>(channels) * tiles);
+        std::vector<float> winograd_out(winograd_in.size());
+
+        const auto time_layer = [&](auto&& layer) {
+            layer(); // warm-up
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < options.iterations; ++i) {
+                layer();
+            }
+            return seconds_since(start) * 1e6 / static_cast<double>(options.iterations);
+        };
+        const double reference = time_layer([&] {
+            nn::conv_reference(input.data(), channels, channels, size, size, 3, weights.data(), bias.data(), output.data());
+        });
+        const double im2col = time_layer([&] {
+            nn::conv3x3(input.data(), channels, channels, size, size, weights.data(), bias.data(), columns.data(), output.data());
+        });
+        const double winograd = time_layer([&] {
+            nn::conv3x3_winograd(input.data(), channels, channels, size, size, transformed.data(), bias.data(),
+                                 winograd_in.data(), winograd_out.data(), output.data());
+        });
+
+        std::cout << std::fixed;
+        for (const auto& [name, micros] : {std::pair<const char*, double>{"reference", reference},
+                                           std::pair<const char*, double>{"im2col", im2col},
+                                           std::pair<const char*, double>{"winograd", winograd}}) {
+            std::cout << size << "," << name << "," << std::setprecision(1) << micros << "," << std::setprecision(2)
+                      << (micros > 0.0 ? im2col / micros : 0.0) << "\n";
+        }
+        std::cout.unsetf(std::ios::floatfield);
+    }
+}
+
+// Encodes the benchmark positions into one preallocated batch per feature set and
+// layout, batch-size positions at a time.
+void run_encode_timings(const Options& options) {
+    int largest_batch = 1;
+    for (int batch : options.batch_sizes) {
+        largest_batch = std::max(largest_batch, batch);
+    }
+    const std::size_t count = static_cast<std::size_t>(largest_batch);
+    const auto boards = make_positions(options.board_size, count, options.seed);
+
+    std::cout << "# Tenuki Feature Encoding Benchmark\n";
+    std::cout << "# board_size=" << options.board_size << " batch=" << count << " iterations=" << options.iterations
+              << "\n";
+    std::cout << "features,layout,planes,seconds,positions,positions_per_second\n";
+    for (nn::FeatureSet set : {nn::FeatureSet::Basic, nn::FeatureSet::Extended, nn::FeatureSet::Ladder}) {
+        for (nn::TensorLayout layout : {nn::TensorLayout::NCHW, nn::TensorLayout::NHWC}) {
+            nn::FeatureBatch batch(set, layout, options.board_size, count);
+            const auto encode_all = [&] {
+                for (std::size_t slot = 0; slot < count; ++slot) {
+                    batch.encode(slot, boards[slot], boards[slot].to_play());
+                }
+            };
+            encode_all(); // warm-up
+            const auto start = std::chrono::steady_clock::now();
+            for (int iteration = 0; iteration < options.iterations; ++iteration) {
+                encode_all();
+            }
+            const double elapsed = seconds_since(start);
+            const double positions = static_cast<double>(count) * static_cast<double>(options.iterations);
+            std::cout << nn::feature_set_name(set) << "," << nn::tensor_layout_name(layout) << ","
+                      << nn::feature_planes(set) << "," << std::fixed << std::setprecision(6) << elapsed << ","
+                      << std::setprecision(0) << positions << "," << std::setprecision(2)
+                      << (elapsed > 0.0 ? positions / elapsed : 0.0) << "\n";
+            std::cout.unsetf(std::ios::floatfield);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::invalid_argument& ex) {
+        if (std::strlen(ex.what()) > 0) {
+            std::cerr << ex.what() << "\n";
+        }
+        print_usage();
+        return std::strlen(ex.what()) > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    if (options.layers) {
+        run_layer_timings(options);
+        return EXIT_SUCCESS;
+    }
+    if (options.encode) {
+        run_encode_timings(options);
+        return EXIT_SUCCESS;
+    }
+
+    std::shared_ptr<nn::Network> network;
+    try {
+        if (!options.weights_path.empty()) {
+            network = std::make_shared<nn::Network>(nn::load_weights_file(options.weights_path), options.conv);
+        } else {
+            nn::NetworkShape shape;
+            shape.input_planes = nn::feature_planes(options.features);
+            shape.trunk_channels = options.channels;
+            shape.blocks = options.blocks;
+            shape.policy_channels = 32;
+            shape.value_channels = 32;
+            shape.value_hidden = 64;
+            network = std::make_shared<nn::Network>(nn::make_random_weights(shape, options.seed), options.conv);
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    int largest_batch = 1;
+    for (int batch : options.batch_sizes) {
+        largest_batch = std::max(largest_batch, batch);
+    }
+    const auto boards = make_positions(options.board_size, static_cast<std::size_t>(largest_batch), options.seed);
+
+    if (options.precision == nn::Precision::Int8) {
+        try {
+            nn::CalibrationTable table;
+            if (!options.calibration_path.empty()) {
+                table = nn::load_calibration_file(options.calibration_path);
+            } else {
+                nn::FeatureBatch inputs(nn::feature_set_for_planes(network->shape().input_planes),
+                                        nn::TensorLayout::NCHW, options.board_size, boards.size());
+                for (std::size_t i = 0; i < boards.size(); ++i) {
+                    inputs.encode(i, boards[i], boards[i].to_play());
+                }
+                network->calibrate(inputs.data(), static_cast<int>(boards.size()), static_cast<int>(options.board_size), table);
+            }
+            network->quantize(table);
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    nn::NeuralEvaluator evaluator(network, options.threads);
+
+    const nn::NetworkShape& shape = network->shape();
+    std::cout << "# Tenuki NN Benchmark\n";
+    std::cout << "# board_size=" << options.board_size << " blocks=" << shape.blocks
+              << " channels=" << shape.trunk_channels << " threads=" << options.threads
+              << " iterations=" << options.iterations << " conv=" << nn::conv_algorithm_name(options.conv)
+              << " precision=" << nn::precision_name(network->precision()) << " gemm=" << nn::gemm_backend()
+              << " int8_gemm=" << nn::int8_gemm_backend() << "\n";
+    std::cout << "batch,threads,seconds,positions,positions_per_second\n";
+
+    for (int batch : options.batch_sizes) {
+        std::vector<search::EvaluationRequest> requests;
+        for (int i = 0; i < batch; ++i) {
+            requests.push_back({&boards[static_cast<std::size_t>(i)], boards[static_cast<std::size_t>(i)].to_play()});
+        }
+        evaluator.evaluate_batch(requests); // warm-up
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < options.iterations; ++iteration) {
+            evaluator.evaluate_batch(requests);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const double positions = static_cast<double>(batch) * static_cast<double>(options.iterations);
+        const double rate = elapsed.count() > 0.0 ? positions / elapsed.count() : 0.0;
+        std::cout << batch << "," << options.threads << "," << std::fixed << std::setprecision(6) << elapsed.count()
+                  << "," << std::setprecision(0) << positions << "," << std::setprecision(2) << rate << "\n";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+#include "go/Board.hpp"
+#include "nn/Features.hpp"
+#include "nn/Kernels.hpp"
+#include "nn/NeuralEvaluator.hpp"
+#include "nn/Network.hpp"
+#include "nn/Quantization.hpp"
+#include "sgf/SGF.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string weights_path;
+    std::string output_path;
+    std::vector<std::string> sgf_paths;
+    int max_positions = 4096;
+    int every = 1;
+    int batch = 16;
+    int threads = 1;
+    nn::ConvAlgorithm conv = nn::ConvAlgorithm::Winograd;
+};
+
+struct Position {
+    go::Board board;
+    go::Player to_play;
+};
+
+bool parse_int(const char* value, int& out) {
+    char* end = nullptr;
+    long parsed = std::strtol(value, &end, 10);
+    if (end == value || *end != '\0') {
+        return false;
+    }
+    if (parsed < std::numeric_limits<int>::min() || parsed > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+int parse_positive(const char* name, const char* value) {
+    int parsed = 0;
+    if (!parse_int(value, parsed) || parsed <= 0) {
+        throw std::invalid_argument(std::string("Invalid value for ") + name);
+    }
+    return parsed;
+}
+
+Options parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--weights") == 0 && i + 1 < argc) {
+            options.weights_path = argv[++i];
+        } else if (std::strcmp(arg, "--output") == 0 && i + 1 < argc) {
+            options.output_path = argv[++i];
+        } else if (std::strcmp(arg, "--max-positions") == 0 && i + 1 < argc) {
+            options.max_positions = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--every") == 0 && i + 1 < argc) {
+            options.every = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--batch") == 0 && i + 1 < argc) {
+            options.batch = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+            options.threads = parse_positive(arg, argv[++i]);
+        } else if (std::strcmp(arg, "--conv") == 0 && i + 1 < argc) {
+            options.conv = nn::parse_conv_algorithm(argv[++i]);
+        } else if (std::strcmp(arg, "--help") == 0) {
+            throw std::invalid_argument("");
+        } else if (arg[0] == '-') {
+            std::ostringstream oss;
+            oss << "Unknown option: " << arg;
+            throw std::invalid_argument(oss.str());
+        } else {
+            options.sgf_paths.emplace_back(arg);
+        }
+    }
+    if (options.weights_path.empty() || options.output_path.empty() || options.sgf_paths.empty()) {
+        throw std::invalid_argument("--weights, --output and at least one SGF file are required");
+    }
+    return options;
+}
+
+void print_usage() {
+    std::cout << "Usage: nn_calibrate --weights FILE --output FILE [options] GAME.sgf...\n"
+              << "  --weights FILE         Network weights to quantize\n"
+              << "  --output FILE          Calibration table to write (TENUKI_NN_CALIBRATION)\n"
+              << "  --max-positions N      Stop after N positions (default 4096)\n"
+              << "  --every N              Sample every Nth move of each game (default 1)\n"
+              << "  --batch N              Evaluation batch size for the report (default 16)\n"
+              << "  --threads N            Threads per batch (default 1)\n"
+              << "  --conv im2col|winograd fp32 convolution algorithm (default winograd)\n";
+}
+
+// Replays every game and keeps the position before each sampled move.
+std::vector<Position> collect_positions(const Options& options) {
+    std::vector<Position> positions;
+    const std::size_t limit = static_cast<std::size_t>(options.max_positions);
+    for (const std::string& path : options.sgf_paths) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        const sgf::GameTree game = sgf::load(in);
+        go::Rules rules;
+        rules.board_size = game.board_size;
+        rules.komi = game.komi.value_or(rules.komi);
+        go::Board board(rules);
+        sgf::apply_setup(game, board);
+        for (std::size_t index = 0; index < game.moves.size() && positions.size() < limit; ++index) {
+            const sgf::MoveRecord& record = game.moves[index];
+            if (index % static_cast<std::size_t>(options.every) == 0) {
+                positions.push_back({board, record.player});
+            }
+            if (!board.play_move(record.player, record.move)) {
+                std::cerr << "# " << path << ": illegal move " << index + 1 << ", rest of game skipped\n";
+                break;
+            }
+        }
+        if (positions.size() >= limit) {
+            break;
+        }
+    }
+    return positions;
+}
+
+std::vector<search::EvaluationResult> evaluate_all(nn::NeuralEvaluator& evaluator, const std::vector<Position>& positions,
+                                                   int batch, double& seconds) {
+    std::vector<search::EvaluationResult> results;
+    results.reserve(positions.size());
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t begin = 0; begin < positions.size(); begin += static_cast<std::size_t>(batch)) {
+        const std::size_t end = std::min(positions.size(), begin + static_cast<std::size_t>(batch));
+        std::vector<search::EvaluationRequest> requests;
+        for (std::size_t i = begin; i < end; ++i) {
+            requests.push_back({&positions[i].board, positions[i].to_play});
+        }
+        for (auto& result : evaluator.evaluate_batch(requests)) {
+            results.push_back(std::move(result));
+        }
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return results;
+}
+
+std::size_t argmax(const std::vector<float>& values) {
+    return static_cast<std::size_t>(std::max_element(values.begin(), values.end()) - values.begin());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::invalid_argument& ex) {
+        if (std::strlen(ex.what()) > 0) {
+            std::cerr << ex.what() << "\n";
+        }
+        print_usage();
+        return std::strlen(ex.what()) > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    try {
+        const auto fp32 = std::make_shared<nn::Network>(nn::load_weights_file(options.weights_path), options.conv);
+        const std::vector<Position> positions = collect_positions(options);
+        if (positions.empty()) {
+            std::cerr << "no positions found\n";
+            return EXIT_FAILURE;
+        }
+
+        // Calibrate one board size at a time; the table keeps the maxima over all of them.
+        nn::CalibrationTable table;
+        const nn::FeatureSet features = nn::feature_set_for_planes(fp32->shape().input_planes);
+        std::map<std::size_t, std::vector<const Position*>> positions_by_size;
+        for (const Position& position : positions) {
+            positions_by_size[position.board.board_size()].push_back(&position);
+        }
+        nn::FeatureBatch inputs;
+        for (const auto& [size, group] : positions_by_size) {
+            inputs.reserve(features, nn::TensorLayout::NCHW, size, group.size());
+            for (std::size_t slot = 0; slot < group.size(); ++slot) {
+                inputs.encode(slot, group[slot]->board, group[slot]->to_play);
+            }
+            fp32->calibrate(inputs.data(), static_cast<int>(group.size()), static_cast<int>(size), table);
+        }
+
+        std::ofstream out(options.output_path, std::ios::binary);
+        if (!out) {
+            throw std::runtime_error("cannot write " + options.output_path);
+        }
+        nn::save_calibration(table, out);
+        out.close();
+
+        auto int8 = std::make_shared<nn::Network>(*fp32);
+        int8->quantize(table);
+        nn::NeuralEvaluator reference(fp32, options.threads);
+        nn::NeuralEvaluator quantized(int8, options.threads);
+        double fp32_seconds = 0.0;
+        double int8_seconds = 0.0;
+        const auto expected = evaluate_all(reference, positions, options.batch, fp32_seconds);
+        const auto actual = evaluate_all(quantized, positions, options.batch, int8_seconds);
+
+        std::size_t agree = 0;
+        double value_error = 0.0;
+        double policy_error = 0.0;
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            if (argmax(expected[i].policy) == argmax(actual[i].policy)) {
+                ++agree;
+            }
+            value_error += std::fabs(static_cast<double>(expected[i].value - actual[i].value));
+            double total_variation = 0.0;
+            for (std::size_t move = 0; move < expected[i].policy.size(); ++move) {
+                total_variation += std::fabs(static_cast<double>(expected[i].policy[move] - actual[i].policy[move]));
+            }
+            policy_error += total_variation / 2.0;
+        }
+        const double count = static_cast<double>(positions.size());
+
+        std::cout << "# Tenuki int8 calibration\n";
+        std::cout << "# positions=" << positions.size() << " layers=" << table.activation_max.size()
+                  << " gemm=" << nn::gemm_backend() << " int8_gemm=" << nn::int8_gemm_backend()
+                  << " table=" << options.output_path << "\n";
+        std::cout << "layer,activation_max\n";
+        for (std::size_t layer = 0; layer < table.activation_max.size(); ++layer) {
+            std::cout << layer << "," << table.activation_max[layer] << "\n";
+        }
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << "metric,value\n";
+        std::cout << "policy_top1_agreement," << static_cast<double>(agree) / count << "\n";
+        std::cout << "policy_total_variation_mean," << policy_error / count << "\n";
+        std::cout << "value_mae," << value_error / count << "\n";
+        std::cout << std::setprecision(2);
+        std::cout << "fp32_evals_per_second," << (fp32_seconds > 0.0 ? count / fp32_seconds : 0.0) << "\n";
+        std::cout << "int8_evals_per_second," << (int8_seconds > 0.0 ? count / int8_seconds : 0.0) << "\n";
+        std::cout << "speedup," << (int8_seconds > 0.0 ? fp32_seconds / int8_seconds : 0.0) << "\n";
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,25 +1,111 @@
 #include "go/Board.hpp"
+#include "go/Ladder.hpp"
+#include "go/PlayoutLanes.hpp"
+#include "search/BatchingEvaluator.hpp"
+#include "search/Distributed.hpp"
+#include "search/MockEvaluator.hpp"
+#include "search/RolloutEvaluator.hpp"
 #include "search/Search.hpp"
+#include "search/Topology.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 namespace {
 
+enum class Placement {
+    None,
+    Pinned,
+    NumaTrees
+};
+
 struct Options {
     std::size_t board_size = 19;
     int playouts = 512;
     int iterations = 16;
     unsigned int seed = 0x5eed1234u;
     std::vector<int> thread_counts{1, 2, 4};
+    std::vector<search::ParallelMode> modes{search::ParallelMode::TreeParallel};
+    int groups = 0;
+    int processes = 1;
+    std::vector<Placement> placements{Placement::None};
+    bool stats = false;
+    // Mock evaluator sweep (--mock-latency): threads x batch sizes x latencies.
+    std::vector<int> mock_latencies_us;
+    std::vector<int> batch_sizes{1, 4, 16};
+    int position_cost_us = 0;
+    int batch_wait_us = 1000;
+    bool spin = false;
+    // Light playout throughput (--rollouts): games per thread from the empty board.
+    int rollouts = 0;
+    // Boards advanced together: 1 is the single-board RolloutEvaluator, 8 and 16 the
+    // lane kernel.
+    std::vector<int> lanes{1};
+    // Ladder reader timing (--ladders): reads per position.
+    int ladder_reads = 0;
 };
 
+const char* placement_name(Placement placement) {
+    switch (placement) {
+    case Placement::Pinned:
+        return "pinned";
+    case Placement::NumaTrees:
+        return "numa";
+    default:
+        return "none";
+    }
+}
+
+bool parse_placements(const char* value, std::vector<Placement>& out) {
+    const std::string text(value);
+    if (text == "none") {
+        out = {Placement::None};
+    } else if (text == "pin") {
+        out = {Placement::Pinned};
+    } else if (text == "numa") {
+        out = {Placement::NumaTrees};
+    } else if (text == "all") {
+        out = {Placement::None, Placement::Pinned, Placement::NumaTrees};
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* mode_name(search::ParallelMode mode) {
+    return mode == search::ParallelMode::RootParallel ? "root" : "tree";
+}
+
+bool parse_modes(const char* value, std::vector<search::ParallelMode>& out) {
+    const std::string text(value);
+    if (text == "tree") {
+        out = {search::ParallelMode::TreeParallel};
+    } else if (text == "root") {
+        out = {search::ParallelMode::RootParallel};
+    } else if (text == "both") {
+        out = {search::ParallelMode::TreeParallel, search::ParallelMode::RootParallel};
+    } else {
+        return false;
+    }
+    return true;
+}
+
 bool parse_int(const char* value, int& out) {
     char* end = nullptr;
     long parsed = std::strtol(value, &end, 10);
@@ -43,7 +129,7 @@ bool parse_size_t(const char* value, std::size_t& out) {
     return true;
 }
 
-bool parse_threads(const char* value, std::vector<int>& out) {
+bool parse_list(const char* value, std::vector<int>& out, int minimum) {
     std::vector<int> counts;
     std::istringstream ss(value);
     std::string token;
@@ -52,7 +138,7 @@ bool parse_threads(const char* value, std::vector<int>& out) {
             continue;
         }
         int parsed = 0;
-        if (!parse_int(token.c_str(), parsed) || parsed <= 0) {
+        if (!parse_int(token.c_str(), parsed) || parsed < minimum) {
             return false;
         }
         counts.push_back(parsed);
@@ -93,9 +179,71 @@ Options parse_options(int argc, char** argv) {
             }
             options.seed = static_cast<unsigned int>(value);
         } else if (std::strcmp(arg, "--threads") == 0 && i + 1 < argc) {
-            if (!parse_threads(argv[++i], options.thread_counts)) {
+            if (!parse_list(argv[++i], options.thread_counts, 1)) {
                 throw std::invalid_argument("Invalid value for --threads");
             }
+        } else if (std::strcmp(arg, "--mode") == 0 && i + 1 < argc) {
+            if (!parse_modes(argv[++i], options.modes)) {
+                throw std::invalid_argument("Invalid value for --mode");
+            }
+        } else if (std::strcmp(arg, "--groups") == 0 && i + 1 < argc) {
+            int value = 0;
+            if (!parse_int(argv[++i], value) || value < 0) {
+                throw std::invalid_argument("Invalid value for --groups");
+            }
+            options.groups = value;
+        } else if (std::strcmp(arg, "--stats") == 0) {
+            options.stats = true;
+        } else if (std::strcmp(arg, "--placement") == 0 && i + 1 < argc) {
+            if (!parse_placements(argv[++i], options.placements)) {
+                throw std::invalid_argument("Invalid value for --placement");
+            }
+        } else if (std::strcmp(arg, "--processes") == 0 && i + 1 < argc) {
+            int value = 0;
+            if (!parse_int(argv[++i], value) || value <= 0) {
+                throw std::invalid_argument("Invalid value for --processes");
+            }
+            options.processes = value;
+        } else if (std::strcmp(arg, "--mock-latency") == 0 && i + 1 < argc) {
+            if (!parse_list(argv[++i], options.mock_latencies_us, 0)) {
+                throw std::invalid_argument("Invalid value for --mock-latency");
+            }
+        } else if (std::strcmp(arg, "--batch-sizes") == 0 && i + 1 < argc) {
+            if (!parse_list(argv[++i], options.batch_sizes, 1)) {
+                throw std::invalid_argument("Invalid value for --batch-sizes");
+            }
+        } else if (std::strcmp(arg, "--position-cost") == 0 && i + 1 < argc) {
+            int value = 0;
+            if (!parse_int(argv[++i], value) || value < 0) {
+                throw std::invalid_argument("Invalid value for --position-cost");
+            }
+            options.position_cost_us = value;
+        } else if (std::strcmp(arg, "--batch-wait") == 0 && i + 1 < argc) {
+            int value = 0;
+            if (!parse_int(argv[++i], value) || value < 0) {
+                throw std::invalid_argument("Invalid value for --batch-wait");
+            }
+            options.batch_wait_us = value;
+        } else if (std::strcmp(arg, "--spin") == 0) {
+            options.spin = true;
+        } else if (std::strcmp(arg, "--rollouts") == 0 && i + 1 < argc) {
+            int value = 0;
+            if (!parse_int(argv[++i], value) || value <= 0) {
+                throw std::invalid_argument("Invalid value for --rollouts");
+            }
+            options.rollouts = value;
+        } else if (std::strcmp(arg, "--lanes") == 0 && i + 1 < argc) {
+            if (!parse_list(argv[++i], options.lanes, 1) ||
+                std::any_of(options.lanes.begin(), options.lanes.end(),
+                            [](int lanes) { return lanes != 1 && lanes != 8 && lanes != 16; })) {
+                throw std::invalid_argument("Invalid value for --lanes (1, 8 or 16)");
+            }
+        } else if (std::strcmp(arg, "--ladders") == 0 && i + 1 < argc) {
+            int value = 0;
+            if (!parse_int(argv[++i], value) || value <= 0) {
+                throw std::invalid_argument("Invalid value for --ladders");
+            }
+            options.ladder_reads = value;
         } else if (std::strcmp(arg, "--help") == 0) {
             throw std::invalid_argument("");
         } else {
@@ -109,11 +257,312 @@ Options parse_options(int argc, char** argv) {
 
 void print_usage() {
     std::cout << "Usage: search_benchmark [options]\n"
-              << "  --board-size N      Board size (default 19)\n"
-              << "  --playouts N        Playouts per search (default 512)\n"
-              << "  --iterations N      Number of searches per measurement (default 16)\n"
-              << "  --threads a,b,c     Comma separated thread counts (default 1,2,4)\n"
-              << "  --seed N            RNG seed (default 0x5eed1234)\n";
+              << "  --board-size N         Board size (default 19)\n"
+              << "  --playouts N           Playouts per search (default 512)\n"
+              << "  --iterations N         Number of searches per measurement (default 16)\n"
+              << "  --threads a,b,c        Comma separated thread counts (default 1,2,4)\n"
+              << "  --mode tree|root|both  Shared-tree or root-parallel search (default tree)\n"
+              << "  --groups N             Independent trees in root mode, 0 = one per thread (default 0)\n"
+              << "  --placement none|pin|numa|all  Worker cpu pinning / per-NUMA-node trees (default none)\n"
+              << "  --stats                Collect per-phase search counters and print them per row\n"
+              << "  --processes N          Also run a coordinator plus N-1 local worker processes and\n"
+              << "                         a single process with the same total threads (default 1)\n"
+              << "  --seed N               RNG seed (default 0x5eed1234)\n"
+              << "  --mock-latency a,b,c   Instead of the uniform evaluator, sweep a mock evaluator with these\n"
+              << "                         per-batch latencies (microseconds) over --threads x --batch-sizes\n"
+              << "  --batch-sizes a,b,c    Largest batch gathered from search threads (default 1,4,16)\n"
+              << "  --position-cost N      Mock cost per position in a batch, microseconds (default 0)\n"
+              << "  --batch-wait N         Longest wait for a batch to fill, microseconds (default 1000)\n"
+              << "  --spin                 Mock evaluator busy-waits instead of sleeping\n"
+              << "  --rollouts N           Instead of searching, time N light playouts per thread from the\n"
+              << "                         empty board for each --threads count\n"
+              << "  --lanes a,b,c          Rollout kernels to time: 1 (single board), 8 or 16 lanes\n"
+              << "                         (default 1)\n"
+              << "  --ladders N            Instead of searching, time N ladder reads of a diagonal ladder, the\n"
+              << "                         same ladder broken, and a scan of a random middle game\n";
+}
+
+search::SearchConfig make_config(const Options& options, search::ParallelMode mode, int thread_count,
+                                 Placement placement = Placement::None) {
+    search::SearchConfig config;
+    config.max_playouts = options.playouts;
+    config.enable_playout_cap_randomization = false;
+    config.dirichlet_epsilon = 0.0f;
+    config.temperature = 0.0f;
+    config.temperature_move_cutoff = 0;
+    config.num_threads = thread_count;
+    config.seed = options.seed;
+    config.parallel_mode = mode;
+    config.root_parallel_groups = options.groups;
+    config.pin_threads = placement != Placement::None;
+    config.numa_local_trees = placement == Placement::NumaTrees;
+    config.collect_stats = options.stats;
+    return config;
+}
+
+void print_row(const char* mode, int groups, Placement placement, int threads, double seconds, double total_playouts) {
+    const double playouts_per_second = seconds > 0.0 ? total_playouts / seconds : 0.0;
+    std::cout << mode << ','
+              << groups << ','
+              << placement_name(placement) << ','
+              << threads << ','
+              << std::fixed << std::setprecision(6) << seconds << ','
+              << static_cast<long long>(total_playouts) << ','
+              << std::setprecision(2) << std::fixed << playouts_per_second << '\n';
+}
+
+void run_measurement(const Options& options, go::Board& board, search::ParallelMode mode, int thread_count,
+                     Placement placement = Placement::None) {
+    const search::SearchConfig config = make_config(options, mode, thread_count, placement);
+    search::SearchAgent agent(config, search::make_uniform_evaluator());
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < options.iterations; ++i) {
+        agent.reset();
+        board.clear();
+        board.set_to_play(go::Player::Black);
+        agent.select_move(board, board.to_play(), 0);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::chrono::duration<double> elapsed = end - start;
+    const double total_playouts = static_cast<double>(options.iterations) * static_cast<double>(options.playouts);
+
+    int groups = 1;
+    const search::CpuTopology topology = search::detect_topology();
+    if (placement == Placement::NumaTrees && topology.is_numa() && thread_count > 1) {
+        groups = std::min(static_cast<int>(topology.numa_nodes.size()), thread_count);
+    } else if (mode == search::ParallelMode::RootParallel && thread_count > 1) {
+        groups = options.groups > 0 ? std::min(options.groups, thread_count) : thread_count;
+    }
+    print_row(mode_name(mode), groups, placement, thread_count, elapsed.count(), total_playouts);
+    if (agent.pin_failures() > 0) {
+        std::cout << "# " << agent.pin_failures() << " worker(s) could not be pinned and ran unpinned\n";
+    }
+
+    if (options.stats) {
+        // Counters of the last iteration only.
+        std::istringstream lines(search::format_search_stats(agent.stats()));
+        std::string line;
+        while (std::getline(lines, line)) {
+            std::cout << "#   " << line << '\n';
+        }
+    }
+}
+
+// Coordinator in this process plus `processes - 1` forked workers, each running `thread_count` threads.
+void run_distributed_measurement(const Options& options, go::Board& board, int thread_count) {
+    const search::SearchConfig config = make_config(options, search::ParallelMode::TreeParallel, thread_count);
+    std::vector<std::string> endpoints;
+    std::vector<pid_t> children;
+    for (int p = 1; p < options.processes; ++p) {
+        const std::string endpoint = "unix:/tmp/tenuki-bench-" + std::to_string(::getpid()) + "-" + std::to_string(p) + ".sock";
+        const pid_t pid = ::fork();
+        if (pid == 0) {
+            search::SearchWorker worker(endpoint, config, search::make_uniform_evaluator());
+            worker.serve();
+            std::_Exit(EXIT_SUCCESS);
+        }
+        endpoints.push_back(endpoint);
+        children.push_back(pid);
+    }
+
+    {
+        auto coordinator = std::make_shared<search::DistributedCoordinator>(endpoints);
+        search::SearchAgent agent(config, search::make_uniform_evaluator());
+        agent.set_root_contributor(coordinator);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.iterations; ++i) {
+            agent.reset();
+            board.clear();
+            board.set_to_play(go::Player::Black);
+            agent.select_move(board, board.to_play(), 0);
+        }
+        auto end = std::chrono::steady_clock::now();
+        coordinator->shutdown_workers();
+
+        std::chrono::duration<double> elapsed = end - start;
+        const double total_playouts = static_cast<double>(options.iterations) * static_cast<double>(options.playouts) *
+                                      static_cast<double>(options.processes);
+        print_row("dist", options.processes, Placement::None, thread_count * options.processes, elapsed.count(), total_playouts);
+    }
+
+    for (pid_t pid : children) {
+        ::waitpid(pid, nullptr, 0);
+    }
+}
+
+// Search threads feed a BatchingEvaluator in front of a LatencyEvaluator; utilization
+// is the share of wall time the mock device spent on batches.
+void run_mock_sweep(const Options& options, go::Board& board) {
+    std::cout << "# mock evaluator: position_cost_us=" << options.position_cost_us
+              << " batch_wait_us=" << options.batch_wait_us << " wait=" << (options.spin ? "spin" : "sleep") << "\n";
+    std::cout << "latency_us,batch,threads,seconds,total_playouts,playouts_per_second,mean_batch,utilization\n";
+    for (int latency : options.mock_latencies_us) {
+        for (int batch : options.batch_sizes) {
+            for (int thread_count : options.thread_counts) {
+                search::LatencyModel model;
+                model.batch_latency = std::chrono::microseconds(latency);
+                model.position_cost = std::chrono::microseconds(options.position_cost_us);
+                model.spin = options.spin;
+                auto device = std::make_shared<search::LatencyEvaluator>(model);
+                auto batching = std::make_shared<search::BatchingEvaluator>(
+                    device, batch, std::chrono::microseconds(options.batch_wait_us));
+                search::SearchAgent agent(make_config(options, search::ParallelMode::TreeParallel, thread_count), batching);
+
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < options.iterations; ++i) {
+                    agent.reset();
+                    board.clear();
+                    board.set_to_play(go::Player::Black);
+                    agent.select_move(board, board.to_play(), 0);
+                }
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                const double total_playouts = static_cast<double>(options.iterations) * static_cast<double>(options.playouts);
+                const search::LatencyEvaluator::Stats stats = device->stats();
+                std::cout << latency << ',' << batch << ',' << thread_count << ',' << std::fixed << std::setprecision(6)
+                          << elapsed.count() << ',' << static_cast<long long>(total_playouts) << ','
+                          << std::setprecision(2) << (elapsed.count() > 0.0 ? total_playouts / elapsed.count() : 0.0)
+                          << ',' << stats.mean_batch() << ','
+                          << std::setprecision(3) << (elapsed.count() > 0.0 ? stats.busy_seconds / elapsed.count() : 0.0)
+                          << '\n';
+                std::cout.unsetf(std::ios::floatfield);
+            }
+        }
+    }
+}
+
+// Plays games in blocks of Lanes from board; returns the moves played.
+template <std::size_t Lanes>
+std::uint64_t play_lane_games(const go::Board& board, int games, std::uint64_t seed) {
+    auto lanes = std::make_unique<go::PlayoutLanes<Lanes>>();
+    std::array<float, Lanes> scores{};
+    std::uint64_t moves = 0;
+    for (int block = 0; block * static_cast<int>(Lanes) < games; ++block) {
+        lanes->reset(board, go::Player::Black, seed + static_cast<std::uint64_t>(block) * Lanes);
+        lanes->play_out();
+        lanes->score_all(scores.data());
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            moves += static_cast<std::uint64_t>(lanes->moves_played(lane));
+        }
+    }
+    return moves;
+}
+
+// Every thread plays its own share of games; with one thread per core the
+// per-thread column is the per-core playout rate. Lane kernels round the games up to
+// whole blocks.
+void run_rollout_sweep(const Options& options, const go::Board& board) {
+    std::cout << "lanes,threads,seconds,total_playouts,playouts_per_second,playouts_per_second_per_thread,"
+                 "moves_per_playout\n";
+    for (int lane_count : options.lanes) {
+        for (int thread_count : options.thread_counts) {
+            search::RolloutConfig config;
+            config.playouts = options.rollouts;
+            config.seed = options.seed;
+            search::RolloutEvaluator evaluator(config);
+            std::atomic<std::uint64_t> lane_playouts{0};
+            std::atomic<std::uint64_t> lane_moves{0};
+            std::vector<std::thread> threads;
+            const auto start = std::chrono::steady_clock::now();
+            for (int t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&, t] {
+                    const std::uint64_t seed = std::uint64_t{options.seed} + 0x9e3779b97f4a7c15u * static_cast<std::uint64_t>(t + 1);
+                    const int blocks = (options.rollouts + lane_count - 1) / lane_count;
+                    std::uint64_t moves = 0;
+                    if (lane_count == 8) {
+                        moves = play_lane_games<8>(board, options.rollouts, seed);
+                    } else if (lane_count == 16) {
+                        moves = play_lane_games<16>(board, options.rollouts, seed);
+                    } else {
+                        evaluator.rollouts(board, go::Player::Black);
+                        return;
+                    }
+                    lane_playouts.fetch_add(static_cast<std::uint64_t>(blocks * lane_count));
+                    lane_moves.fetch_add(moves);
+                });
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            const search::RolloutEvaluator::Counters counters = evaluator.counters();
+            const std::uint64_t total = counters.playouts + lane_playouts.load();
+            const double playouts = static_cast<double>(total);
+            const double per_second = elapsed.count() > 0.0 ? playouts / elapsed.count() : 0.0;
+            std::cout << lane_count << ',' << thread_count << ',' << std::fixed << std::setprecision(6)
+                      << elapsed.count() << ',' << total << ',' << std::setprecision(2) << per_second << ','
+                      << per_second / thread_count << ','
+                      << (playouts > 0.0 ? static_cast<double>(counters.moves + lane_moves.load()) / playouts : 0.0)
+                      << '\n';
+            std::cout.unsetf(std::ios::floatfield);
+        }
+    }
+}
+
+// Times LadderReader on a ladder running diagonally across the board, the same
+// ladder with a breaker near the far corner, and a whole-board scan of a random
+// position (every chain from both sides plus every capture move, counted as one read).
+void run_ladder_sweep(const Options& options, const go::Board& board) {
+    const std::size_t size = options.board_size;
+    std::vector<go::PointState> points(size * size, go::PointState::Empty);
+    // White's stone in atari at (2,2), Black above, left, below and at (3,1).
+    points[2 * size + 2] = go::PointState::White;
+    for (const std::size_t vertex : {1 * size + 2, 2 * size + 1, 3 * size + 2, 1 * size + 3}) {
+        points[vertex] = go::PointState::Black;
+    }
+    go::Board ladder = board;
+    ladder.set_position(points, go::Player::White);
+    points[(size - 3) * size + size - 3] = go::PointState::White;
+    go::Board broken = board;
+    broken.set_position(points, go::Player::White);
+
+    go::Board middle = board;
+    std::mt19937 rng(options.seed);
+    std::uniform_int_distribution<int> vertex_dist(0, static_cast<int>(size * size) - 1);
+    for (std::size_t move = 0; move < size * size / 2; ++move) {
+        const go::Player player = middle.to_play();
+        for (int attempt = 0; attempt < 32; ++attempt) {
+            const go::Move candidate(vertex_dist(rng));
+            if (middle.is_legal(player, candidate)) {
+                middle.play_move(player, candidate);
+                break;
+            }
+        }
+    }
+
+    std::cout << "position,reads,seconds,us_per_read,nodes_per_read,result\n";
+    go::LadderReader reader;
+    const auto measure = [&](const char* name, const go::Board& position, auto&& read) {
+        reader.reset(position);
+        int result = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.ladder_reads; ++i) {
+            result = read();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const double reads = static_cast<double>(options.ladder_reads);
+        std::cout << name << ',' << options.ladder_reads << ',' << std::fixed << std::setprecision(6) << elapsed.count()
+                  << ',' << std::setprecision(3) << elapsed.count() * 1e6 / reads << ','
+                  << std::setprecision(1) << static_cast<double>(reader.nodes()) / reads << ',' << result << '\n';
+        std::cout.unsetf(std::ios::floatfield);
+    };
+    const std::size_t prey = 2 * size + 2;
+    measure("ladder", ladder, [&] { return reader.captured(prey, go::Player::White) ? 1 : 0; });
+    measure("broken", broken, [&] { return reader.captured(prey, go::Player::White) ? 1 : 0; });
+    measure("scan", middle, [&] {
+        int found = 0;
+        for (std::size_t vertex = 0; vertex < size * size; ++vertex) {
+            if (middle.point_state(vertex) == go::PointState::Empty) {
+                found += reader.is_capture_move(middle.to_play(), vertex) ? 1 : 0;
+            } else {
+                found += reader.captured(vertex, go::Player::Black) ? 1 : 0;
+                found += reader.captured(vertex, go::Player::White) ? 1 : 0;
+            }
+        }
+        return found;
+    });
 }
 
 } // namespace
@@ -139,38 +588,37 @@ int main(int argc, char** argv) {
               << " playouts=" << options.playouts
               << " iterations=" << options.iterations
               << " seed=" << options.seed << "\n";
-    std::cout << "threads,seconds,total_playouts,playouts_per_second\n";
-
-    for (int thread_count : options.thread_counts) {
-        search::SearchConfig config;
-        config.max_playouts = options.playouts;
-        config.enable_playout_cap_randomization = false;
-        config.dirichlet_epsilon = 0.0f;
-        config.temperature = 0.0f;
-        config.temperature_move_cutoff = 0;
-        config.num_threads = thread_count;
-        config.seed = options.seed;
-
-        search::SearchAgent agent(config, search::make_uniform_evaluator());
+    std::cout << "# topology " << search::describe_topology(search::detect_topology()) << "\n";
+    if (options.ladder_reads > 0) {
+        run_ladder_sweep(options, board);
+        return EXIT_SUCCESS;
+    }
+    if (options.rollouts > 0) {
+        run_rollout_sweep(options, board);
+        return EXIT_SUCCESS;
+    }
+    if (!options.mock_latencies_us.empty()) {
+        run_mock_sweep(options, board);
+        return EXIT_SUCCESS;
+    }
+    std::cout << "mode,groups,placement,threads,seconds,total_playouts,playouts_per_second\n";
 
-        auto start = std::chrono::steady_clock::now();
-        for (int i = 0; i < options.iterations; ++i) {
-            agent.reset();
-            board.clear();
-            board.set_to_play(go::Player::Black);
-            agent.select_move(board, board.to_play(), 0);
+    for (search::ParallelMode mode : options.modes) {
+        for (Placement placement : options.placements) {
+            for (int thread_count : options.thread_counts) {
+                run_measurement(options, board, mode, thread_count, placement);
+            }
         }
-        auto end = std::chrono::steady_clock::now();
+    }
 
-        std::chrono::duration<double> elapsed = end - start;
-        const double total_playouts = static_cast<double>(options.iterations) * static_cast<double>(options.playouts);
-        const double seconds = elapsed.count();
-        const double playouts_per_second = seconds > 0.0 ? total_playouts / seconds : 0.0;
-
-        std::cout << thread_count << ','
-                  << std::fixed << std::setprecision(6) << seconds << ','
-                  << static_cast<long long>(total_playouts) << ','
-                  << std::setprecision(2) << std::fixed << playouts_per_second << '\n';
+    if (options.processes > 1) {
+        // Compare against one process doing the same total work with the same total thread count.
+        Options single = options;
+        single.playouts = options.playouts * options.processes;
+        for (int thread_count : options.thread_counts) {
+            run_distributed_measurement(options, board, thread_count);
+            run_measurement(single, board, search::ParallelMode::TreeParallel, thread_count * options.processes);
+        }
     }
 
     return EXIT_SUCCESS;